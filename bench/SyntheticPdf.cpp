@@ -0,0 +1,325 @@
+#include "SyntheticPdf.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+// Bump when the output changes, files generated by older versions are ignored then
+static const int GENERATOR_VERSION = 1;
+
+// splitmix64, same sequence on every platform unlike the std distributions
+class SyntheticRandom {
+    public:
+        explicit SyntheticRandom(uint64_t seed) : state(seed) {};
+        uint64_t next() {
+            uint64_t z = (this->state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+        size_t below(size_t bound) { return static_cast<size_t>(this->next() % bound); }
+
+    private:
+        uint64_t state;
+};
+
+// Output stream counting the bytes written, offsets for the xref come from it
+class SyntheticWriter {
+    public:
+        explicit SyntheticWriter(const std::string& path) : file(path, std::ios::binary) {};
+        bool isOk() { return static_cast<bool>(this->file); }
+        size_t getPosition() { return this->written + this->pending.size(); }
+        std::string& out() { return this->pending; }
+        void flush(bool force = false) {
+            if (!force && this->pending.size() < (1 << 20)) return;
+            this->file.write(this->pending.data(), static_cast<std::streamsize>(this->pending.size()));
+            this->written += this->pending.size();
+            this->pending.clear();
+        }
+
+    private:
+        std::ofstream file;
+        std::string pending;
+        size_t written = 0;
+};
+
+static void writeScalar(std::string& out, SyntheticObjectKind kind, SyntheticRandom& random, size_t objects) {
+    char text[64];
+    switch (kind) {
+        case SYNTH_INTEGER:
+            out += std::to_string(static_cast<int64_t>(random.below(2000001)) - 1000000);
+            break;
+        case SYNTH_REAL:
+            std::snprintf(text, sizeof(text), "%.4f", (static_cast<double>(random.below(2000001)) - 1000000) / 997.0);
+            out += text;
+            break;
+        case SYNTH_NAME:
+            // Every 8th name carries a #xx escape
+            std::snprintf(text, sizeof(text), random.below(8) == 0 ? "/Name#20%llx" : "/Name%llx", static_cast<unsigned long long>(random.below(1 << 20)));
+            out += text;
+            break;
+        case SYNTH_STRING_LITERAL:
+            out += "(Synthetic text " + std::to_string(random.below(100000)) + " with \\(escapes\\) and (nesting)\\n)";
+            break;
+        case SYNTH_STRING_HEXADECIMAL:
+            std::snprintf(text, sizeof(text), "<%016llX%016llX>", static_cast<unsigned long long>(random.next()), static_cast<unsigned long long>(random.next()));
+            out += text;
+            break;
+        case SYNTH_BOOLEAN:
+            out += random.below(2) ? "true" : "false";
+            break;
+        case SYNTH_NULL:
+            out += "null";
+            break;
+        default:
+            out += std::to_string(random.below(objects) + 1) + " 0 R";
+            break;
+    }
+}
+
+static SyntheticObjectKind randomScalarKind(SyntheticRandom& random) {
+    return static_cast<SyntheticObjectKind>(SYNTH_INTEGER + random.below(SYNTH_REFERENCE - SYNTH_INTEGER + 1));
+}
+
+// Array or dictionary of depth levels, a few scalars on each level & the next level last
+static void writeContainer(std::string& out, bool dictionary, size_t depth, SyntheticRandom& random, size_t objects) {
+    out += dictionary ? "<<" : "[";
+    for (size_t i = 0; i < 4; i++) {
+        if (dictionary) out += " /Key" + std::to_string(i);
+        out += ' ';
+        writeScalar(out, randomScalarKind(random), random, objects);
+    }
+    if (depth > 1) {
+        out += dictionary ? " /Next " : " ";
+        writeContainer(out, dictionary, depth - 1, random, objects);
+    }
+    out += dictionary ? " >>" : " ]";
+}
+
+static void writeValue(std::string& out, SyntheticObjectKind kind, const SyntheticPdfOptions& options, SyntheticRandom& random) {
+    if (kind == SYNTH_MIXED) kind = static_cast<SyntheticObjectKind>(SYNTH_INTEGER + random.below(SYNTH_STREAM));
+    switch (kind) {
+        case SYNTH_ARRAY:
+            writeContainer(out, false, std::max<size_t>(options.depth, 1), random, options.objects);
+            break;
+        case SYNTH_DICTIONARY:
+            writeContainer(out, true, std::max<size_t>(options.depth, 1), random, options.objects);
+            break;
+        case SYNTH_FONT: {
+            size_t number = random.below(options.objects) + 1;
+            out += "<< /Type /Font /Subtype /TrueType /BaseFont /Font" + std::to_string(number) +
+                " /FirstChar 32 /LastChar 131 /FontDescriptor " + std::to_string(random.below(options.objects) + 1) + " 0 R" +
+                " /Encoding << /Type /Encoding /BaseEncoding /WinAnsiEncoding >> /Widths [";
+            for (size_t i = 0; i < 100; i++) out += std::to_string(250 + random.below(750)) + " ";
+            out += "] >>";
+            break;
+        }
+        case SYNTH_STREAM: {
+            std::string data;
+            size_t length = 32 + random.below(96);
+            for (size_t i = 0; i < length; i++) data.push_back(static_cast<char>(random.below(256)));
+            out += "<< /Length " + std::to_string(length) + " >>\nstream\n" + data + "\nendstream";
+            break;
+        }
+        default:
+            writeScalar(out, kind, random, options.objects);
+            break;
+    }
+}
+
+static void writeObject(SyntheticWriter& writer, size_t number, const SyntheticPdfOptions& options, SyntheticRandom& random) {
+    std::string& out = writer.out();
+    out += std::to_string(number) + " 0 obj\n";
+    writeValue(out, options.kind, options, random);
+    out += "\nendobj\n";
+    writer.flush();
+}
+
+// Classic xref section with one subsection per run of consecutive object numbers
+static void writeXRef(SyntheticWriter& writer, const std::vector<std::pair<size_t, size_t>>& entries, bool withFreeHead, bool lineRecords) {
+    std::string& out = writer.out();
+    char record[32];
+    const char* format = lineRecords ? "%010zu 00000 n\n" : "%010zu 00000 n \n";
+    out += "xref\n";
+    if (withFreeHead) out += "0 " + std::to_string(entries.size() + 1) + (lineRecords ? "\n0000000000 65535 f\n" : "\n0000000000 65535 f \n");
+    for (size_t i = 0; i < entries.size();) {
+        size_t run = 1;
+        while (i + run < entries.size() && entries[i + run].first == entries[i].first + run) run++;
+        if (!withFreeHead) out += std::to_string(entries[i].first) + " " + std::to_string(run) + "\n";
+        for (size_t j = i; j < i + run; j++) {
+            std::snprintf(record, sizeof(record), format, entries[j].second);
+            out += record;
+            writer.flush();
+        }
+        i += run;
+    }
+}
+
+// Node of a balanced page tree, numbered in writing order: catalog, root, then every level top down
+struct SyntheticPageNode {
+    size_t number = 0;
+    size_t parent = 0;
+    size_t count = 1;
+    std::vector<size_t> kids;
+};
+
+static void writePageTree(SyntheticWriter& writer, std::vector<std::pair<size_t, size_t>>& entries, size_t base, size_t first, const SyntheticPdfOptions& options) {
+    size_t fanout = std::max<size_t>(options.pageFanout, 2);
+    std::vector<std::vector<SyntheticPageNode>> levels(1, std::vector<SyntheticPageNode>(options.pages));
+    while (levels.back().size() > 1) {
+        std::vector<SyntheticPageNode>& below = levels.back();
+        std::vector<SyntheticPageNode> level((below.size() + fanout - 1) / fanout);
+        for (size_t i = 0; i < below.size(); i++) {
+            level[i / fanout].kids.push_back(i);
+        }
+        for (SyntheticPageNode& node: level) {
+            node.count = 0;
+            for (size_t kid: node.kids) node.count += below[kid].count;
+        }
+        levels.push_back(std::move(level));
+    }
+    // A single page still gets a /Pages root above it
+    if (levels.size() == 1) levels.push_back(std::vector<SyntheticPageNode>{SyntheticPageNode{0, 0, 1, {0}}});
+
+    size_t number = first + 1;
+    for (size_t level = levels.size(); level-- > 0;) {
+        for (SyntheticPageNode& node: levels[level]) node.number = number++;
+    }
+    for (size_t level = 1; level < levels.size(); level++) {
+        for (SyntheticPageNode& node: levels[level]) {
+            for (size_t kid: node.kids) levels[level - 1][kid].parent = node.number;
+        }
+    }
+
+    std::string& out = writer.out();
+    entries.push_back({first, writer.getPosition() - base});
+    out += std::to_string(first) + " 0 obj\n<< /Type /Catalog /Pages " + std::to_string(levels.back()[0].number) + " 0 R >>\nendobj\n";
+    size_t page = 0;
+    for (size_t level = levels.size(); level-- > 0;) {
+        for (SyntheticPageNode& node: levels[level]) {
+            entries.push_back({node.number, writer.getPosition() - base});
+            out += std::to_string(node.number) + " 0 obj\n<< ";
+            if (level == 0) {
+                out += "/Type /Page /Parent " + std::to_string(node.parent) + " 0 R /PageIndex " + std::to_string(page);
+                // Some pages override the inherited media box
+                if (page % 7 == 3) out += " /MediaBox [0 0 595 842]";
+                page++;
+            } else {
+                out += "/Type /Pages /Count " + std::to_string(node.count) + " /Kids [";
+                for (size_t kid: node.kids) out += std::to_string(levels[level - 1][kid].number) + " 0 R ";
+                out += "]";
+                if (level + 1 == levels.size()) {
+                    out += " /MediaBox [0 0 612 792] /Resources << /Font << /F1 << /Type /Font /Subtype /Type1 /BaseFont /Helvetica >> >> >>";
+                } else {
+                    out += " /Parent " + std::to_string(node.parent) + " 0 R";
+                }
+            }
+            out += " >>\nendobj\n";
+            writer.flush();
+        }
+    }
+}
+
+bool SyntheticPdf::write(const std::string& path, const SyntheticPdfOptions& options) {
+    SyntheticWriter writer(path);
+    if (!writer.isOk() || options.objects == 0) return false;
+    SyntheticRandom random(options.seed);
+
+    // Offsets count from %PDF-, the leading bytes come before
+    for (size_t i = 0; i < options.leadingBytes; i++) writer.out().push_back(static_cast<char>('A' + random.below(26)));
+    size_t base = writer.getPosition();
+    writer.out() += "%PDF-1.7\n%\xE2\xE3\xCF\xD3\n";
+
+    std::vector<std::pair<size_t, size_t>> entries;
+    entries.reserve(options.objects);
+    for (size_t number = 1; number <= options.objects; number++) {
+        entries.push_back({number, writer.getPosition() - base});
+        writeObject(writer, number, options, random);
+    }
+    // Catalog & page tree follow the other objects
+    size_t root = 1;
+    if (options.pages > 0) {
+        root = options.objects + 1;
+        writePageTree(writer, entries, base, root, options);
+    }
+    size_t size = entries.size() + 1;
+    size_t xref = writer.getPosition() - base;
+    writeXRef(writer, entries, true, options.xrefLineRecords);
+    std::string trailer = "trailer\n<< /Size " + std::to_string(size) + " /Root " + std::to_string(root) + " 0 R >>\n";
+    writer.out() += trailer + "startxref\n" + std::to_string(xref) + "\n%%EOF\n";
+
+    // Each update rewrites a few objects & links its xref section to the previous one
+    for (size_t update = 0; update < options.updates; update++) {
+        std::vector<size_t> numbers;
+        for (size_t i = 0; i < options.updatedObjects; i++) numbers.push_back(random.below(options.objects) + 1);
+        std::sort(numbers.begin(), numbers.end());
+        numbers.erase(std::unique(numbers.begin(), numbers.end()), numbers.end());
+
+        entries.clear();
+        for (size_t number: numbers) {
+            entries.push_back({number, writer.getPosition() - base});
+            writeObject(writer, number, options, random);
+        }
+        size_t prev = xref;
+        xref = writer.getPosition() - base;
+        writeXRef(writer, entries, false, options.xrefLineRecords);
+        writer.out() += "trailer\n<< /Size " + std::to_string(size) + " /Root " + std::to_string(root) + " 0 R /Prev " + std::to_string(prev) +
+            " >>\nstartxref\n" + std::to_string(xref) + "\n%%EOF\n";
+    }
+
+    writer.flush(true);
+    return writer.isOk();
+}
+
+std::string SyntheticPdf::path(const SyntheticPdfOptions& options) {
+    std::string name = "wavepdf_synthetic_v" + std::to_string(GENERATOR_VERSION) + "_" + std::to_string(options.objects) + "_" +
+        kindName(options.kind) + "_d" + std::to_string(options.depth) + "_u" + std::to_string(options.updates) + "x" +
+        std::to_string(options.updatedObjects) + "_l" + std::to_string(options.leadingBytes) + "_s" + std::to_string(options.seed) +
+        (options.pages > 0 ? "_p" + std::to_string(options.pages) + "x" + std::to_string(options.pageFanout) : "") +
+        (options.xrefLineRecords ? "_lines" : "") + ".pdf";
+    std::string path = (std::filesystem::temp_directory_path() / name).string();
+    if (std::filesystem::exists(path)) return path;
+
+    // Written under another name first, an interrupted run doesn't leave a truncated file behind
+    std::string partial = path + ".partial";
+    if (!write(partial, options)) return "";
+    std::filesystem::rename(partial, path);
+    return path;
+}
+
+size_t SyntheticPdf::maxObjects() {
+    const char* limit = std::getenv("WAVEPDF_BENCH_MAX_OBJECTS");
+    return limit ? static_cast<size_t>(std::strtoull(limit, nullptr, 10)) : 1000000;
+}
+
+std::string SyntheticPdf::prepare(benchmark::State& state, const SyntheticPdfOptions& options) {
+    if (options.objects > maxObjects()) {
+        state.SkipWithError("More objects than WAVEPDF_BENCH_MAX_OBJECTS");
+        return "";
+    }
+    std::string path = SyntheticPdf::path(options);
+    if (path.empty()) state.SkipWithError("Can't write synthetic PDF");
+    return path;
+}
+
+const char* SyntheticPdf::kindName(SyntheticObjectKind kind) {
+    switch (kind) {
+        case SYNTH_MIXED: return "mixed";
+        case SYNTH_INTEGER: return "integer";
+        case SYNTH_REAL: return "real";
+        case SYNTH_NAME: return "name";
+        case SYNTH_STRING_LITERAL: return "literal";
+        case SYNTH_STRING_HEXADECIMAL: return "hex";
+        case SYNTH_BOOLEAN: return "boolean";
+        case SYNTH_NULL: return "null";
+        case SYNTH_REFERENCE: return "reference";
+        case SYNTH_ARRAY: return "array";
+        case SYNTH_DICTIONARY: return "dictionary";
+        case SYNTH_STREAM: return "stream";
+        case SYNTH_FONT: return "font";
+    }
+    return "unknown";
+}
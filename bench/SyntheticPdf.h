@@ -0,0 +1,66 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Value written for each object, SYNTH_MIXED picks one of the others per object (fonts excluded)
+enum SyntheticObjectKind {
+    SYNTH_MIXED,
+    SYNTH_INTEGER,
+    SYNTH_REAL,
+    SYNTH_NAME,
+    SYNTH_STRING_LITERAL,
+    SYNTH_STRING_HEXADECIMAL,
+    SYNTH_BOOLEAN,
+    SYNTH_NULL,
+    SYNTH_REFERENCE,
+    SYNTH_ARRAY,
+    SYNTH_DICTIONARY,
+    SYNTH_STREAM,
+    /* Font-like dictionary with names, a reference, a nested dictionary & a /Widths array
+        of 100 numbers, the shape dominating real documents */
+    SYNTH_FONT
+};
+
+struct SyntheticPdfOptions {
+    size_t objects = 1000;
+    SyntheticObjectKind kind = SYNTH_MIXED;
+    // Nesting levels of array & dictionary values, each level holds a few scalars
+    size_t depth = 2;
+    // Incremental updates appended to the file, each rewriting updatedObjects objects
+    size_t updates = 0;
+    size_t updatedObjects = 10;
+    // Arbitrary bytes before %PDF- (ISO32000 7.5.2 note 1)
+    size_t leadingBytes = 0;
+    /* Xref records end in a single \n instead of a 2 byte EOL. They aren't valid fixed
+        20 byte records (ISO32000 7.5.4), readers have to fall back to parsing lines */
+    bool xrefLineRecords = false;
+    /* Balanced page tree with this many pages & kids per node, written after the other
+        objects with the catalog as /Root. The root holds /MediaBox & /Resources for inheritance */
+    size_t pages = 0;
+    size_t pageFanout = 10;
+    uint64_t seed = 1;
+};
+
+/* Deterministic synthetic PDF files for benchmarks, the same options always give the same
+    bytes. Objects are written as "N 0 obj\n<value>\nendobj\n" with a classic xref table per
+    revision, so the value of an object starts at its xref offset + syntheticValueOffset(N).
+    Page dictionaries carry their zero based page number as /PageIndex */
+class SyntheticPdf {
+    public:
+        // Write the file, false if it can't be written
+        static bool write(const std::string& path, const SyntheticPdfOptions& options);
+        // Path of the file for these options in the temp directory, generated on first use
+        static std::string path(const SyntheticPdfOptions& options);
+        static size_t valueOffset(size_t number) { return std::to_string(number).size() + 7; }
+        static const char* kindName(SyntheticObjectKind kind);
+
+        /* Files above this many objects are skipped unless WAVEPDF_BENCH_MAX_OBJECTS allows them,
+            10^7 objects are about 1 GB of generated PDF */
+        static size_t maxObjects();
+        // Generated file for the options, empty if the benchmark has to be skipped
+        static std::string prepare(benchmark::State& state, const SyntheticPdfOptions& options);
+};
@@ -0,0 +1,72 @@
+#include "../src/utility/content/ContentParser.h"
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+
+/* Text heavy page content like word processors write it: one text object per line with
+    font, position, shown strings & kerned TJ arrays, some fills & color changes in between */
+static std::string textPage(size_t lines) {
+    std::string content;
+    uint64_t state = 42;
+    const char* words[] = {"Lorem", "ipsum", "dolor", "sit", "amet,", "consectetur", "adipiscing", "elit", "sed", "do"};
+    for (size_t line = 0; line < lines; line++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        content += "BT\n/F" + std::to_string(1 + (state >> 60) % 4) + " 10.5 Tf\n72 " + std::to_string(720 - line % 60 * 12) + ".25 Td\n[(";
+        for (size_t word = 0; word < 8; word++) {
+            content += words[(state >> (word * 4)) % 10];
+            content += word % 3 == 2 ? ") -" + std::to_string(20 + word * 7) + " (" : " ";
+        }
+        content += ")] TJ\n0 -12.5 Td (" + std::string(words[line % 10]) + " \\(continued\\)) Tj\nET\n";
+        if (line % 10 == 0) content += "q 0.2 0.4 0.6 rg 72 " + std::to_string(line % 700) + " 468 0.5 re f Q\n";
+    }
+    return content;
+}
+
+// Operators only counted, the cost of tokenizing & the operand stack
+class CountingVisitor : public ContentVisitor {
+    public:
+        size_t operands = 0;
+        void onOperator(ContentOperator /*op*/, const OperandStack& stack) override { operands += stack.size(); }
+};
+
+static void BM_ContentParse(benchmark::State& state) {
+    std::string content = textPage(static_cast<size_t>(state.range(0)));
+    ContentParser parser;
+    CountingVisitor visitor;
+    size_t operators = 0;
+    for (auto _ : state) {
+        ContentStats stats = parser.parse(content, visitor);
+        operators += stats.operators;
+    }
+    benchmark::DoNotOptimize(visitor.operands);
+    state.counters["operators/s"] = benchmark::Counter(static_cast<double>(operators), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(content.size()));
+}
+BENCHMARK(BM_ContentParse)->Arg(60)->Arg(6000);
+
+// Text extraction through the dispatch table, shown strings are decoded
+static void BM_ContentDispatchText(benchmark::State& state) {
+    std::string content = textPage(static_cast<size_t>(state.range(0)));
+    ContentParser parser;
+    ContentDispatcher dispatcher;
+    std::string decoded;
+    size_t characters = 0;
+    dispatcher.on(OP_SHOW_TEXT, [&](const OperandStack& operands) {
+        ContentParser::decodeString(operands[0], decoded);
+        characters += decoded.size();
+    });
+    dispatcher.on(OP_SHOW_TEXT_ARRAY, [&](const OperandStack& operands) {
+        const Value& array = operands[0];
+        for (size_t i = 0; i < array.size(); i++) {
+            ContentParser::decodeString(array.getItems()[i], decoded);
+            characters += decoded.size();
+        }
+    });
+    for (auto _ : state) {
+        parser.parse(content, dispatcher);
+    }
+    benchmark::DoNotOptimize(characters);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(content.size()));
+}
+BENCHMARK(BM_ContentDispatchText)->Arg(60)->Arg(6000);
@@ -0,0 +1,202 @@
+#include "../src/utility/filters/FilterPipeline.h"
+#include <benchmark/benchmark.h>
+#include <zlib.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Decoded size of every input, large enough that per stream setup doesn't matter
+static constexpr size_t FILTER_BENCH_BYTES = 4 * 1024 * 1024;
+
+// Deterministic image like bytes: gradients with noise & some flat runs
+static std::string imageBytes(size_t length) {
+    std::string data(length, '\0');
+    uint32_t state = 1;
+    for (size_t i = 0; i < length; i++) {
+        state = state * 1103515245 + 12345;
+        bool flat = (i / 4096) % 4 == 0;
+        data[i] = static_cast<char>(flat ? 0xFF : (i % 256) + ((state >> 24) & 7));
+    }
+    return data;
+}
+
+static std::string encodeFlate(const std::string& data) {
+    uLongf length = compressBound(static_cast<uLong>(data.size()));
+    std::string output(length, '\0');
+    compress2(reinterpret_cast<Bytef*>(&output[0]), &length, reinterpret_cast<const Bytef*>(data.data()), static_cast<uLong>(data.size()), 6);
+    output.resize(length);
+    return output;
+}
+
+// Lines of 64 digits like most writers produce
+static std::string encodeHex(const std::string& data) {
+    static const char digits[] = "0123456789abcdef";
+    std::string output;
+    for (size_t i = 0; i < data.size(); i++) {
+        output += digits[static_cast<uint8_t>(data[i]) >> 4];
+        output += digits[static_cast<uint8_t>(data[i]) & 15];
+        if (i % 32 == 31) output += '\n';
+    }
+    return output + ">";
+}
+
+static std::string encode85(const std::string& data) {
+    std::string output;
+    for (size_t i = 0; i + 4 <= data.size(); i += 4) {
+        uint32_t value = static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << 24 | static_cast<uint8_t>(data[i + 1]) << 16 |
+            static_cast<uint8_t>(data[i + 2]) << 8 | static_cast<uint8_t>(data[i + 3]);
+        char group[5];
+        for (int j = 4; j >= 0; j--) {
+            group[j] = static_cast<char>('!' + value % 85);
+            value /= 85;
+        }
+        output.append(group, 5);
+        if (i % 64 == 60) output += '\n';
+    }
+    return output + "~>";
+}
+
+static std::string encodeRunLength(const std::string& data) {
+    std::string output;
+    size_t i = 0;
+    while (i < data.size()) {
+        size_t run = 1;
+        while (i + run < data.size() && run < 128 && data[i + run] == data[i]) run++;
+        if (run > 1) {
+            output += static_cast<char>(257 - run);
+            output += data[i];
+            i += run;
+            continue;
+        }
+        size_t literal = 1;
+        while (i + literal + 1 < data.size() && literal < 128 && data[i + literal] != data[i + literal + 1]) literal++;
+        output += static_cast<char>(literal - 1);
+        output.append(data, i, literal);
+        i += literal;
+    }
+    return output + static_cast<char>(128);
+}
+
+// EarlyChange 1 encoder, the table is cleared before it is full
+static std::string encodeLZW(const std::string& data) {
+    std::string output;
+    uint32_t bits = 0;
+    int bitCount = 0, codeLength = 9;
+    size_t decoderNext = 258, codes = 0;
+    auto emit = [&](uint32_t code) {
+        bits = bits << codeLength | code;
+        bitCount += codeLength;
+        while (bitCount >= 8) {
+            bitCount -= 8;
+            output += static_cast<char>(bits >> bitCount);
+        }
+        bits &= (1u << bitCount) - 1;
+        if (code == 256) {
+            codeLength = 9;
+            decoderNext = 258;
+            codes = 0;
+            return;
+        }
+        if (codes++ > 0 && decoderNext < 4096) decoderNext++;
+        if (decoderNext + 1 >= (size_t(1) << codeLength) && codeLength < 12) codeLength++;
+    };
+
+    // Entries keyed by prefix code & next byte
+    std::unordered_map<uint32_t, uint32_t> table;
+    uint32_t nextCode = 258;
+    emit(256);
+    uint32_t word = static_cast<uint8_t>(data[0]);
+    for (size_t i = 1; i < data.size(); i++) {
+        uint32_t key = word << 8 | static_cast<uint8_t>(data[i]);
+        auto found = table.find(key);
+        if (found != table.end()) {
+            word = found->second;
+            continue;
+        }
+        emit(word);
+        table[key] = nextCode++;
+        word = static_cast<uint8_t>(data[i]);
+        if (nextCode == 4095) {
+            emit(256);
+            table.clear();
+            nextCode = 258;
+        }
+    }
+    emit(word);
+    emit(257);
+    if (bitCount > 0) output += static_cast<char>(bits << (8 - bitCount));
+    return output;
+}
+
+// Pull the whole stream in chunks like a consumer would, nothing is kept
+static void runFilter(benchmark::State& state, const std::string& encoded, const std::vector<FilterSpec>& filters, size_t decodedSize) {
+    std::vector<char> chunk(FILTER_CHUNK_SIZE);
+    for (auto _ : state) {
+        std::unique_ptr<ByteSource> source = FilterPipeline::create(std::make_unique<SpanSource>(encoded), filters);
+        size_t total = 0, length;
+        while ((length = source->read(chunk.data(), chunk.size())) > 0) total += length;
+        if (total != decodedSize || source->hasFailed()) {
+            state.SkipWithError("Decoded data has the wrong size");
+            return;
+        }
+        benchmark::DoNotOptimize(chunk.data());
+    }
+    state.counters["encoded/s"] = benchmark::Counter(static_cast<double>(state.iterations() * encoded.size()), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(decodedSize));
+}
+
+static void BM_FilterFlate(benchmark::State& state) {
+    std::string data = imageBytes(FILTER_BENCH_BYTES);
+    runFilter(state, encodeFlate(data), {FilterSpec{NAME_FLATE_DECODE, DecodeParams()}}, data.size());
+}
+BENCHMARK(BM_FilterFlate);
+
+// PNG Up predictor on rows of 1024 RGB pixels, the common case for images & xref streams
+static void BM_FilterFlatePredictor(benchmark::State& state) {
+    const size_t rowLength = 3 * 1024;
+    std::string data = imageBytes(FILTER_BENCH_BYTES);
+    std::string encoded;
+    for (size_t row = 0; row + rowLength <= data.size(); row += rowLength) {
+        encoded += '\2';
+        for (size_t i = 0; i < rowLength; i++) encoded += static_cast<char>(data[row + i] - (row > 0 ? data[row - rowLength + i] : 0));
+    }
+    DecodeParams params;
+    params.predictor = 12;
+    params.colors = 3;
+    params.columns = 1024;
+    runFilter(state, encodeFlate(encoded), {FilterSpec{NAME_FLATE_DECODE, params}}, data.size() / rowLength * rowLength);
+}
+BENCHMARK(BM_FilterFlatePredictor);
+
+static void BM_FilterLZW(benchmark::State& state) {
+    std::string data = imageBytes(FILTER_BENCH_BYTES);
+    runFilter(state, encodeLZW(data), {FilterSpec{NAME_LZW_DECODE, DecodeParams()}}, data.size());
+}
+BENCHMARK(BM_FilterLZW);
+
+static void BM_FilterASCIIHex(benchmark::State& state) {
+    std::string data = imageBytes(FILTER_BENCH_BYTES);
+    runFilter(state, encodeHex(data), {FilterSpec{NAME_ASCII_HEX_DECODE, DecodeParams()}}, data.size());
+}
+BENCHMARK(BM_FilterASCIIHex);
+
+static void BM_FilterASCII85(benchmark::State& state) {
+    std::string data = imageBytes(FILTER_BENCH_BYTES);
+    runFilter(state, encode85(data), {FilterSpec{NAME_ASCII85_DECODE, DecodeParams()}}, data.size());
+}
+BENCHMARK(BM_FilterASCII85);
+
+static void BM_FilterRunLength(benchmark::State& state) {
+    std::string data = imageBytes(FILTER_BENCH_BYTES);
+    runFilter(state, encodeRunLength(data), {FilterSpec{NAME_RUN_LENGTH_DECODE, DecodeParams()}}, data.size());
+}
+BENCHMARK(BM_FilterRunLength);
+
+// Typical chain of older writers, ASCII85 around Flate
+static void BM_FilterChain(benchmark::State& state) {
+    std::string data = imageBytes(FILTER_BENCH_BYTES);
+    std::vector<FilterSpec> filters{FilterSpec{NAME_ASCII85_DECODE, DecodeParams()}, FilterSpec{NAME_FLATE_DECODE, DecodeParams()}};
+    runFilter(state, encode85(encodeFlate(data)), filters, data.size());
+}
+BENCHMARK(BM_FilterChain);
@@ -0,0 +1,72 @@
+#include "../src/utility/PdfReader.h"
+#include "../src/utility/graph/ObjectGraph.h"
+#include "SyntheticPdf.h"
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+/* Document of dictionaries whose values refer to random objects, parsed once. Each object
+    has a few references, so the graph has cycles & shared objects of every size */
+static std::unique_ptr<PdfReader> parsedReader(benchmark::State& state) {
+    SyntheticPdfOptions options;
+    options.objects = static_cast<size_t>(state.range(0));
+    options.kind = SYNTH_DICTIONARY;
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return nullptr;
+    std::unique_ptr<PdfReader> reader = std::make_unique<PdfReader>(path);
+    if (!reader->process() || !reader->parseDocument(0)) {
+        state.SkipWithError(reader->getLog().c_str());
+        return nullptr;
+    }
+    return reader;
+}
+
+// Building the forward & reverse adjacency from the arena model, objects x threads
+static void BM_GraphBuild(benchmark::State& state) {
+    std::unique_ptr<PdfReader> reader = parsedReader(state);
+    if (!reader) return;
+    ObjectGraph graph;
+    for (auto _ : state) {
+        if (!graph.build(*reader, static_cast<size_t>(state.range(1)))) state.SkipWithError("Graph not built");
+    }
+    state.counters["edges"] = static_cast<double>(graph.getEdgeCount());
+    state.counters["dangling"] = static_cast<double>(graph.getDanglingCount());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(graph.getNodeCount()));
+}
+BENCHMARK(BM_GraphBuild)->ArgsProduct({{100000, 1000000, 10000000}, {1, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/* Breadth first distances from /Root & every 16th object, objects x threads. The catalog of a
+    synthetic document only leads to its pages, the other roots make the frontiers wide */
+static void BM_GraphReachability(benchmark::State& state) {
+    std::unique_ptr<PdfReader> reader = parsedReader(state);
+    if (!reader) return;
+    ObjectGraph graph;
+    graph.build(*reader, 0);
+    std::vector<size_t> roots = ObjectGraph::trailerRoots(*reader);
+    for (size_t node = 0; node < graph.getNodeCount(); node += 16) roots.push_back(graph.getNumbers()[node]);
+    size_t reached = 0;
+    for (auto _ : state) {
+        std::vector<uint32_t> distances = graph.distances(roots, static_cast<size_t>(state.range(1)));
+        reached = distances.size() - std::count(distances.begin(), distances.end(), GRAPH_UNREACHED);
+    }
+    state.counters["reached"] = static_cast<double>(reached);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(graph.getEdgeCount()));
+}
+BENCHMARK(BM_GraphReachability)->ArgsProduct({{100000, 1000000, 10000000}, {1, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Strongly connected components & the cycles among them
+static void BM_GraphComponents(benchmark::State& state) {
+    std::unique_ptr<PdfReader> reader = parsedReader(state);
+    if (!reader) return;
+    ObjectGraph graph;
+    graph.build(*reader, 0);
+    size_t count = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(graph.components(count));
+    }
+    state.counters["components"] = static_cast<double>(count);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(graph.getEdgeCount()));
+}
+BENCHMARK(BM_GraphComponents)->Arg(100000)->Arg(1000000)->Arg(10000000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,38 @@
+#include "../src/utility/parser/Lexer.h"
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+// Benchmarks run from the build directory like the tests
+static std::string readSample(const std::string& name) {
+    std::ifstream input("../tests/samples/" + name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+/* Every token of a whole sample file, stream data included. Malformed tokens in binary
+    stream data are counted too, the lexer skips them the same way */
+static void BM_LexSample(benchmark::State& state, const std::string& name) {
+    std::string data = readSample(name);
+    if (data.empty()) {
+        state.SkipWithError(("Couldn't read sample " + name).c_str());
+        return;
+    }
+
+    size_t tokens = 0;
+    for (auto _ : state) {
+        Lexer lexer(data);
+        Token token;
+        while (lexer.next(token) != LEX_END) {
+            benchmark::DoNotOptimize(token);
+            tokens++;
+        }
+    }
+    state.counters["tokens/s"] = benchmark::Counter(static_cast<double>(tokens), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+}
+BENCHMARK_CAPTURE(BM_LexSample, sample, std::string("sample.pdf"));
+BENCHMARK_CAPTURE(BM_LexSample, sample2, std::string("sample2.pdf"));
+BENCHMARK_CAPTURE(BM_LexSample, sample_cycles, std::string("sample_cycles.pdf"));
+BENCHMARK_CAPTURE(BM_LexSample, sample_incremental, std::string("sample_incremental.pdf"));
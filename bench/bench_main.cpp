@@ -0,0 +1,14 @@
+#include <wx/wx.h>
+#include <benchmark/benchmark.h>
+
+// Benchmarks run PdfReader, which logs through wxWidgets
+int main(int argc, char** argv) {
+    wxInitializer initializer;
+    if (!initializer.IsOk()) return 1;
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "../src/utility/PdfReader.h"
+#include "SyntheticPdf.h"
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+// Heap bytes currently allocated, including blocks served by mmap
+static size_t heapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+#else
+static size_t heapInUse() { return 0; }
+#endif
+
+// Synthetic file of font-like objects, the shape dominating real documents
+static std::string objectsFile(benchmark::State& state) {
+    SyntheticPdfOptions options;
+    options.objects = static_cast<size_t>(state.range(0));
+    options.kind = SYNTH_FONT;
+    return SyntheticPdf::prepare(state, options);
+}
+
+// Every object through the shared_ptr object model, all of them kept in the cache
+static void BM_ParseObjectsShared(benchmark::State& state) {
+    size_t objects = static_cast<size_t>(state.range(0));
+    std::string path = objectsFile(state);
+    if (path.empty()) return;
+    size_t heap = 0;
+    for (auto _ : state) {
+        PdfReader reader(path);
+        if (!reader.process()) state.SkipWithError(reader.getLog().c_str());
+        reader.setObjectCacheLimits(objects + 1, SIZE_MAX);
+        size_t before = heapInUse();
+        for (size_t number = 1; number <= objects; number++) {
+            benchmark::DoNotOptimize(reader.getObject(number));
+        }
+        heap = heapInUse() - before;
+    }
+    state.SetItemsProcessed(state.iterations() * objects);
+    state.counters["heap_MB"] = static_cast<double>(heap) / (1024 * 1024);
+}
+BENCHMARK(BM_ParseObjectsShared)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// Same objects parsed into one arena
+static void BM_ParseObjectsArena(benchmark::State& state) {
+    size_t objects = static_cast<size_t>(state.range(0));
+    std::string path = objectsFile(state);
+    if (path.empty()) return;
+    size_t heap = 0;
+    for (auto _ : state) {
+        PdfReader reader(path);
+        if (!reader.process()) state.SkipWithError(reader.getLog().c_str());
+        size_t before = heapInUse();
+        if (!reader.parseDocument()) state.SkipWithError(reader.getLog().c_str());
+        heap = heapInUse() - before;
+    }
+    state.SetItemsProcessed(state.iterations() * objects);
+    state.counters["heap_MB"] = static_cast<double>(heap) / (1024 * 1024);
+}
+BENCHMARK(BM_ParseObjectsArena)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// Whole document parse split over a number of threads, wall time is what scales
+static void BM_ParseObjectsParallel(benchmark::State& state) {
+    size_t objects = static_cast<size_t>(state.range(0));
+    size_t threads = static_cast<size_t>(state.range(1));
+    std::string path = objectsFile(state);
+    if (path.empty()) return;
+    PdfReader reader(path);
+    if (!reader.process()) state.SkipWithError(reader.getLog().c_str());
+    for (auto _ : state) {
+        if (!reader.parseDocument(threads)) state.SkipWithError(reader.getLog().c_str());
+    }
+    state.SetItemsProcessed(state.iterations() * objects);
+}
+BENCHMARK(BM_ParseObjectsParallel)->ArgsProduct({{100000}, {1, 2, 4, 8, 16}})->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,191 @@
+#include "../src/utility/PdfReader.h"
+#include "../src/utility/pages/PageTree.h"
+#include "SyntheticPdf.h"
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// %PDF- search, arg is the number of arbitrary bytes in front of it
+static void BM_ReadFileHeader(benchmark::State& state) {
+    SyntheticPdfOptions options;
+    options.leadingBytes = static_cast<size_t>(state.range(0));
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return;
+    PdfReader reader(path);
+    for (auto _ : state) {
+        if (!reader.readFileHeader()) state.SkipWithError(reader.getLog().c_str());
+    }
+}
+BENCHMARK(BM_ReadFileHeader)->Arg(0)->Arg(1000);
+
+static void BM_ParseXRefOffset(benchmark::State& state) {
+    std::string path = SyntheticPdf::prepare(state, SyntheticPdfOptions());
+    if (path.empty()) return;
+    PdfReader reader(path);
+    if (!reader.readFileHeader() || !reader.validateEOF()) state.SkipWithError(reader.getLog().c_str());
+    for (auto _ : state) {
+        if (!reader.parseXRefOffset()) state.SkipWithError(reader.getLog().c_str());
+    }
+}
+BENCHMARK(BM_ParseXRefOffset);
+
+// Single xref table with one entry per object
+static void BM_ParseXRefTable(benchmark::State& state) {
+    SyntheticPdfOptions options;
+    options.objects = static_cast<size_t>(state.range(0));
+    options.kind = SYNTH_INTEGER;
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return;
+    PdfReader reader(path);
+    if (!reader.readFileHeader() || !reader.validateEOF() || !reader.parseXRefOffset()) state.SkipWithError(reader.getLog().c_str());
+    for (auto _ : state) {
+        if (!reader.parseXRefTable()) state.SkipWithError(reader.getLog().c_str());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParseXRefTable)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond);
+
+// /Prev chain of incremental updates, 10 rewritten objects per update
+static void BM_ParseXRefChain(benchmark::State& state) {
+    SyntheticPdfOptions options;
+    options.objects = 10000;
+    options.updates = static_cast<size_t>(state.range(0));
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return;
+    PdfReader reader(path);
+    if (!reader.readFileHeader() || !reader.validateEOF() || !reader.parseXRefOffset()) state.SkipWithError(reader.getLog().c_str());
+    for (auto _ : state) {
+        if (!reader.parseXRefTable()) state.SkipWithError(reader.getLog().c_str());
+    }
+    state.counters["revisions"] = static_cast<double>(reader.getRevisionCount());
+}
+BENCHMARK(BM_ParseXRefChain)->RangeMultiplier(10)->Range(1, 1000)->Unit(benchmark::kMillisecond);
+
+// parseObject on the value of every object, all of one type
+static void BM_ParseObject(benchmark::State& state, SyntheticObjectKind kind, size_t depth) {
+    SyntheticPdfOptions options;
+    options.objects = 10000;
+    options.kind = kind;
+    options.depth = depth;
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return;
+    PdfReader reader(path);
+    if (!reader.process()) {
+        state.SkipWithError(reader.getLog().c_str());
+        return;
+    }
+
+    std::vector<size_t> offsets;
+    for (size_t number = 1; number <= options.objects; number++) {
+        std::optional<xrefEntry> entry = reader.getXRefIndex().lookup(number);
+        if (entry.has_value()) offsets.push_back(entry->entryOne + SyntheticPdf::valueOffset(number));
+    }
+    for (auto _ : state) {
+        for (size_t offset: offsets) benchmark::DoNotOptimize(reader.parseObject(offset));
+    }
+    state.SetItemsProcessed(state.iterations() * offsets.size());
+}
+BENCHMARK_CAPTURE(BM_ParseObject, integer, SYNTH_INTEGER, 0);
+BENCHMARK_CAPTURE(BM_ParseObject, real, SYNTH_REAL, 0);
+BENCHMARK_CAPTURE(BM_ParseObject, name, SYNTH_NAME, 0);
+BENCHMARK_CAPTURE(BM_ParseObject, literal_string, SYNTH_STRING_LITERAL, 0);
+BENCHMARK_CAPTURE(BM_ParseObject, hex_string, SYNTH_STRING_HEXADECIMAL, 0);
+BENCHMARK_CAPTURE(BM_ParseObject, boolean, SYNTH_BOOLEAN, 0);
+BENCHMARK_CAPTURE(BM_ParseObject, null, SYNTH_NULL, 0);
+BENCHMARK_CAPTURE(BM_ParseObject, reference, SYNTH_REFERENCE, 0);
+BENCHMARK_CAPTURE(BM_ParseObject, array, SYNTH_ARRAY, 2);
+BENCHMARK_CAPTURE(BM_ParseObject, dictionary, SYNTH_DICTIONARY, 2);
+BENCHMARK_CAPTURE(BM_ParseObject, array_deep, SYNTH_ARRAY, 200);
+BENCHMARK_CAPTURE(BM_ParseObject, dictionary_deep, SYNTH_DICTIONARY, 200);
+
+// End to end process() on mixed objects
+static void BM_Process(benchmark::State& state) {
+    SyntheticPdfOptions options;
+    options.objects = static_cast<size_t>(state.range(0));
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return;
+    for (auto _ : state) {
+        PdfReader reader(path);
+        if (!reader.process()) state.SkipWithError(reader.getLog().c_str());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Process)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond);
+
+// Same files opened again through their parse index file, arg 1 is the number of incremental updates
+static void BM_ProcessIndexed(benchmark::State& state) {
+    SyntheticPdfOptions options;
+    options.objects = static_cast<size_t>(state.range(0));
+    options.updates = static_cast<size_t>(state.range(1));
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return;
+    std::string directory = (std::filesystem::temp_directory_path() / "wavepdf_bench_index").string();
+    {
+        PdfReader reader(path);
+        reader.setIndexDirectory(directory);
+        if (!reader.process()) state.SkipWithError(reader.getLog().c_str());
+    }
+    for (auto _ : state) {
+        PdfReader reader(path);
+        reader.setIndexDirectory(directory);
+        if (!reader.process() || !reader.isIndexLoaded()) state.SkipWithError("Parse index not used");
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ProcessIndexed)->ArgsProduct({{1000, 100000, 1000000, 10000000}, {0, 100}})->Unit(benchmark::kMillisecond);
+
+// Index rebuilt from an object scan of the whole file, objects x threads
+static void BM_RecoverXRef(benchmark::State& state) {
+    SyntheticPdfOptions options;
+    options.objects = static_cast<size_t>(state.range(0));
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return;
+    PdfReader reader(path);
+    if (!reader.readFileHeader()) state.SkipWithError(reader.getLog().c_str());
+    for (auto _ : state) {
+        if (!reader.recoverXRef(static_cast<size_t>(state.range(1)))) state.SkipWithError(reader.getLog().c_str());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+}
+BENCHMARK(BM_RecoverXRef)->ArgsProduct({{1000, 100000, 10000000}, {1, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/* Jump to page 3/4 of a freshly opened document (cold, a new PageTree every iteration) &
+    random jumps once the tree knows the nodes (warm). Arg is the page count, fanout 10 */
+static void BM_PageLookup(benchmark::State& state, bool warm) {
+    SyntheticPdfOptions options;
+    options.objects = 10;
+    options.pages = static_cast<size_t>(state.range(0));
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return;
+    PdfReader reader(path);
+    if (!reader.process()) {
+        state.SkipWithError(reader.getLog().c_str());
+        return;
+    }
+
+    PageTree tree(reader);
+    uint64_t random = 1;
+    size_t loads = 0;
+    for (auto _ : state) {
+        if (!warm) {
+            state.PauseTiming();
+            // Parsed objects are dropped as well, every load parses again
+            tree.clear();
+            reader.setObjectCacheLimits(1, 0);
+            reader.setObjectCacheLimits(4096, 16 * 1024 * 1024);
+            state.ResumeTiming();
+        }
+        random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t index = warm ? static_cast<size_t>(random >> 33) % options.pages : options.pages * 3 / 4;
+        size_t before = tree.getStats().objectLoads;
+        std::optional<Page> page = tree.getPage(index);
+        if (!page.has_value()) state.SkipWithError("Page not found");
+        loads += tree.getStats().objectLoads - before;
+    }
+    state.counters["loads/lookup"] = static_cast<double>(loads) / static_cast<double>(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_PageLookup, cold, false)->RangeMultiplier(10)->Range(100, 1000000);
+BENCHMARK_CAPTURE(BM_PageLookup, warm, true)->RangeMultiplier(10)->Range(100, 1000000);
@@ -0,0 +1,106 @@
+#include "../src/utility/PdfReader.h"
+#include "../src/utility/writer/IncrementalWriter.h"
+#include "../src/utility/writer/DocumentRewriter.h"
+#include "../src/utility/objects/IntegerObject.h"
+#include "SyntheticPdf.h"
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Writer with the first changed objects of a document replaced by small dictionaries
+static void changeObjects(IncrementalWriter& writer, size_t changed) {
+    for (size_t number = 1; number <= changed; number++) {
+        std::shared_ptr<DictionaryObject> dictionary = std::make_shared<DictionaryObject>(0);
+        dictionary->addElement(NAME_COUNT, std::make_shared<IntegerObject>(0, 0, static_cast<int64_t>(number)));
+        writer.setObject(number, dictionary);
+    }
+}
+
+/* Incremental update written to a file of its own, objects x changed objects.
+    The time follows the change, the size of the document doesn't matter */
+static void BM_IncrementalSave(benchmark::State& state) {
+    SyntheticPdfOptions options;
+    options.objects = static_cast<size_t>(state.range(0));
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return;
+    PdfReader reader(path);
+    if (!reader.process()) {
+        state.SkipWithError(reader.getLog().c_str());
+        return;
+    }
+    IncrementalWriter writer(reader);
+    changeObjects(writer, static_cast<size_t>(state.range(1)));
+
+    std::string output = (std::filesystem::temp_directory_path() / "wavepdf_bench_update.bin").string();
+    for (auto _ : state) {
+        std::ofstream out(output, std::ios::binary | std::ios::trunc);
+        if (!writer.writeUpdate(out)) state.SkipWithError(writer.getErrorMessage().c_str());
+    }
+    state.counters["update_bytes"] = static_cast<double>(std::filesystem::file_size(output));
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+    std::filesystem::remove(output);
+}
+BENCHMARK(BM_IncrementalSave)->ArgsProduct({{1000, 100000, 1000000, 10000000}, {1, 1000}})->Unit(benchmark::kMillisecond);
+
+// Same update behind a copy of the original file (save as), grows with the document
+static void BM_SaveCopy(benchmark::State& state) {
+    SyntheticPdfOptions options;
+    options.objects = static_cast<size_t>(state.range(0));
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return;
+    PdfReader reader(path);
+    if (!reader.process()) {
+        state.SkipWithError(reader.getLog().c_str());
+        return;
+    }
+    IncrementalWriter writer(reader);
+    changeObjects(writer, 1);
+
+    std::string output = (std::filesystem::temp_directory_path() / "wavepdf_bench_copy.pdf").string();
+    for (auto _ : state) {
+        if (!writer.save(output)) state.SkipWithError(writer.getErrorMessage().c_str());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(reader.getFileSize()));
+    std::filesystem::remove(output);
+}
+BENCHMARK(BM_SaveCopy)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+/* "Save as optimized" of a document with 50 incremental updates, objects x threads. Output size,
+    share of the input & dropped objects are reported as counters. keepAll keeps unreachable
+    objects, most synthetic objects aren't referenced from /Root */
+static void BM_RewriteOptimized(benchmark::State& state, bool keepAll) {
+    SyntheticPdfOptions options;
+    options.objects = static_cast<size_t>(state.range(0));
+    options.kind = SYNTH_MIXED;
+    options.updates = 50;
+    std::string path = SyntheticPdf::prepare(state, options);
+    if (path.empty()) return;
+    PdfReader reader(path);
+    if (!reader.process()) {
+        state.SkipWithError(reader.getLog().c_str());
+        return;
+    }
+
+    RewriteOptions rewrite;
+    rewrite.threads = static_cast<size_t>(state.range(1));
+    rewrite.removeUnreachable = !keepAll;
+    std::string output = (std::filesystem::temp_directory_path() / "wavepdf_bench_rewrite.pdf").string();
+    RewriteStats stats;
+    for (auto _ : state) {
+        DocumentRewriter rewriter(reader, rewrite);
+        std::ofstream out(output, std::ios::binary | std::ios::trunc);
+        if (!rewriter.write(out)) state.SkipWithError(rewriter.getErrorMessage().c_str());
+        stats = rewriter.getStats();
+    }
+    state.counters["bytes_out"] = static_cast<double>(stats.bytesOut);
+    state.counters["size_ratio"] = stats.bytesIn > 0 ? static_cast<double>(stats.bytesOut) / static_cast<double>(stats.bytesIn) : 0;
+    state.counters["unreachable"] = static_cast<double>(stats.unreachable);
+    state.counters["object_streams"] = static_cast<double>(stats.objectStreams);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(stats.objectsIn));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(stats.bytesIn));
+    std::filesystem::remove(output);
+}
+BENCHMARK_CAPTURE(BM_RewriteOptimized, reachable, false)->ArgsProduct({{1000, 100000, 1000000}, {1, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_RewriteOptimized, keepAll, true)->ArgsProduct({{1000, 100000, 1000000}, {1, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
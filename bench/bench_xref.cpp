@@ -0,0 +1,85 @@
+#include "../src/utility/PdfReader.h"
+#include "../src/utility/xref/XRefEntryDecoder.h"
+#include "SyntheticPdf.h"
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* Synthetic file with a single xref table of the given size. Records with a 1 byte EOL
+    aren't valid fixed records, they force the tolerant line parser for the whole table */
+static std::string xrefFile(benchmark::State& state, bool fixedRecords) {
+    SyntheticPdfOptions options;
+    // The free head of object 0 is the first entry
+    options.objects = static_cast<size_t>(state.range(0)) - 1;
+    options.kind = SYNTH_INTEGER;
+    options.xrefLineRecords = !fixedRecords;
+    return SyntheticPdf::prepare(state, options);
+}
+
+// Whole process() on a table decoded through the fixed-record fast path
+static void BM_XRefTableFixedRecords(benchmark::State& state) {
+    std::string path = xrefFile(state, true);
+    if (path.empty()) return;
+    for (auto _ : state) {
+        PdfReader reader(path);
+        if (!reader.process()) state.SkipWithError(reader.getLog().c_str());
+        benchmark::DoNotOptimize(reader.getXRefTable());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_XRefTableFixedRecords)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+// Same table size through the tolerant line parser (split, istringstream & stoull per entry)
+static void BM_XRefTableTolerantLines(benchmark::State& state) {
+    std::string path = xrefFile(state, false);
+    if (path.empty()) return;
+    for (auto _ : state) {
+        PdfReader reader(path);
+        if (!reader.process()) state.SkipWithError(reader.getLog().c_str());
+        benchmark::DoNotOptimize(reader.getXRefTable());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_XRefTableTolerantLines)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+// Decoder alone on records in memory
+static void BM_XRefEntryDecoder(benchmark::State& state) {
+    size_t count = static_cast<size_t>(state.range(0));
+    std::string records;
+    char record[32];
+    for (size_t i = 0; i < count; i++) {
+        std::snprintf(record, sizeof(record), "%010zu 00000 n \n", i * 131);
+        records += record;
+    }
+    std::vector<xrefEntry> entries;
+    entries.reserve(count);
+    for (auto _ : state) {
+        entries.clear();
+        benchmark::DoNotOptimize(XRefEntryDecoder::decode(records, 0, count, entries));
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_XRefEntryDecoder)->Arg(1000000);
+
+// Random lookups in the merged index of a single 1M entry revision
+static void BM_XRefIndexLookup(benchmark::State& state) {
+    size_t count = static_cast<size_t>(state.range(0));
+    xrefSubsection section{0, count, {}, true};
+    section.objects.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        section.objects.push_back({i * 131, 0, i, 'n'});
+    }
+    XRefIndex index;
+    index.addRevision({section});
+
+    size_t number = 0;
+    for (auto _ : state) {
+        // Stride through the table to defeat the cache
+        number = (number + 7919) % count;
+        benchmark::DoNotOptimize(index.lookup(number));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_XRefIndexLookup)->Arg(1000000);
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <wx/wx.h>
+#include "utility/batch/BatchRunner.h"
+
+static void printUsage(const char* name) {
+    std::cerr << "Usage: " << name << " [options] <file|directory>...\n"
+        << "Runs PdfReader::process() headless over documents, directories are searched for .pdf files\n\n"
+        << "  --list <file>       read document paths from a file, one per line\n"
+        << "  --threads <n>       documents processed at once (default: all cores)\n"
+        << "  --max-open <n>      documents open at the same time (default: 64)\n"
+        << "  --memory-mb <n>     bytes of open documents kept in memory (default: 1024)\n"
+        << "  --mode <mode>       buffer mode: auto, memory, mapped or windowed (default: auto)\n"
+        << "  --objects           also parse every object of each document\n"
+        << "  --recover           rebuild the xref of damaged documents by scanning for objects\n"
+        << "  --index-dir <dir>   keep parse index files in a directory, unchanged documents skip xref parsing\n"
+        << "  --quiet             only print the summary\n\n"
+        << "Per document: status, milliseconds, bytes, path & failure reason as tab separated lines on stdout.\n"
+        << "The summary goes to stderr. Exit code 1 if any document failed\n";
+}
+
+static bool parseCount(const std::string& text, size_t& value) {
+    try {
+        size_t used;
+        unsigned long long parsed = std::stoull(text, &used);
+        if (used != text.size()) return false;
+        value = static_cast<size_t>(parsed);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+int main(int argc, char** argv) {
+    // PdfReader logs through wxWidgets, no GUI needed
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        std::cerr << "Failed to initialize wxWidgets\n";
+        return 2;
+    }
+
+    BatchOptions options;
+    std::vector<std::string> inputs;
+    bool quiet = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        size_t count;
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--list" && hasValue) {
+            if (!BatchRunner::readFileList(argv[++i], inputs)) {
+                std::cerr << "Can't read file list " << argv[i] << "\n";
+                return 2;
+            }
+        } else if (arg == "--threads" && hasValue && parseCount(argv[i+1], count)) {
+            options.threads = count;
+            i++;
+        } else if (arg == "--max-open" && hasValue && parseCount(argv[i+1], count) && count > 0) {
+            options.maxOpenFiles = count;
+            i++;
+        } else if (arg == "--memory-mb" && hasValue && parseCount(argv[i+1], count) && count > 0) {
+            options.memoryBudget = count * 1024 * 1024;
+            i++;
+        } else if (arg == "--mode" && hasValue) {
+            std::string mode = argv[++i];
+            if (mode == "auto") options.bufferOptions.mode = BUFFER_AUTO;
+            else if (mode == "memory") options.bufferOptions.mode = BUFFER_MEMORY;
+            else if (mode == "mapped") options.bufferOptions.mode = BUFFER_MAPPED;
+            else if (mode == "windowed") options.bufferOptions.mode = BUFFER_WINDOWED;
+            else {
+                std::cerr << "Unknown buffer mode " << mode << "\n";
+                return 2;
+            }
+        } else if (arg == "--objects") {
+            options.parseObjects = true;
+        } else if (arg == "--recover") {
+            options.recoverXRef = true;
+        } else if (arg == "--index-dir" && hasValue) {
+            options.indexDirectory = argv[++i];
+        } else if (arg == "--quiet") {
+            quiet = true;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Invalid option " << arg << "\n";
+            printUsage(argv[0]);
+            return 2;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    BatchRunner runner(options);
+    BatchSummary summary = runner.run(inputs, [quiet](const DocumentResult& result) {
+        if (quiet) return;
+        std::cout << (result.ok ? "ok" : "failed") << '\t' << std::fixed << std::setprecision(3) << result.seconds * 1000
+            << '\t' << result.bytes << '\t' << result.path << '\t' << result.errorMessage;
+        if (!result.log.empty() && result.log != result.errorMessage) std::cout << ": " << result.log;
+        std::cout << '\n';
+    });
+
+    std::cerr << std::fixed << std::setprecision(2)
+        << "Documents: " << summary.documents << " (" << summary.failures << " failed) in " << summary.seconds << " s\n"
+        << "Throughput: " << summary.documentsPerSecond() << " documents/s, " << summary.megabytesPerSecond() << " MB/s\n"
+        << "Latency: p50 " << summary.latencyP50 * 1000 << " ms, p99 " << summary.latencyP99 * 1000
+        << " ms, max " << summary.latencyMax * 1000 << " ms\n";
+    for (const auto& reason: summary.failureReasons) {
+        std::cerr << "  " << reason.second << "x " << reason.first << "\n";
+    }
+    return summary.failures > 0 ? 1 : 0;
+}
@@ -1,17 +1,26 @@
 #include <iostream>
+#include <future>
+#include <memory>
 #include <wx/wx.h>
 #include "utility/PdfReader.h"
+#include "utility/loading/DocumentLoader.h"
 
 enum {
     ID_Hello = 1,
-    ID_OPEN_FILE = 2
+    ID_OPEN_FILE = 2,
+    ID_CANCEL_LOAD = 3
 };
 
+// Posted from the loading thread, the id of the load is the event's int
+wxDEFINE_EVENT(EVT_LOAD_PROGRESS, wxThreadEvent);
+wxDEFINE_EVENT(EVT_FIRST_PAGE, wxThreadEvent);
+
 class MyFrame : public wxFrame {
     public:
         MyFrame() : wxFrame(nullptr, wxID_ANY, "Hello World") {
             wxMenu *menuFile = new wxMenu;
             menuFile->Append(ID_OPEN_FILE, "&Open\tCtrl-O");
+            menuFile->Append(ID_CANCEL_LOAD, "&Cancel Loading", "Stop loading the current document");
             menuFile->Append(ID_Hello, "&Hello...\tCtrl-H",
                              "Help string shown in status bar for this menu item");
             menuFile->AppendSeparator();
@@ -25,6 +34,7 @@ class MyFrame : public wxFrame {
             menuBar->Append(menuHelp, "&Help");
             
             SetMenuBar( menuBar );
+            menuBar->Enable(ID_CANCEL_LOAD, false);
             
             CreateStatusBar();
             SetStatusText("Welcome to wxWidgets!");
@@ -33,6 +43,10 @@ class MyFrame : public wxFrame {
             Bind(wxEVT_MENU, &MyFrame::OnAbout, this, wxID_ABOUT);
             Bind(wxEVT_MENU, &MyFrame::OnExit, this, wxID_EXIT);
             Bind(wxEVT_MENU, &MyFrame::OnOpenFile, this, ID_OPEN_FILE);
+            Bind(wxEVT_MENU, &MyFrame::OnCancelLoad, this, ID_CANCEL_LOAD);
+            Bind(EVT_LOAD_PROGRESS, &MyFrame::OnLoadProgress, this);
+            Bind(EVT_FIRST_PAGE, &MyFrame::OnFirstPage, this);
+            Bind(wxEVT_CLOSE_WINDOW, &MyFrame::OnClose, this);
         }
  
     private:
@@ -53,15 +67,81 @@ class MyFrame : public wxFrame {
             if (openFileDialog.ShowModal() == wxID_CANCEL)
                 return;     // user cancelled dialog
 
-            PdfReader pdf(openFileDialog.GetPath());
+            // A load still running is cancelled, its queued events carry an old id
+            this->loader = std::make_unique<DocumentLoader>();
+            this->document = LoadedDocument();
+            int id = ++this->loadId;
+            this->loadingName = openFileDialog.GetFilename();
+            GetMenuBar()->Enable(ID_CANCEL_LOAD, true);
 
-            if (!pdf.process()) {
-                wxMessageBox(_(pdf.getErrorMessage()),
+            // Parsing runs on the loader's thread, the UI only gets events
+            this->loading = this->loader->start(openFileDialog.GetPath(), [this, id](const LoadProgress& progress) {
+                wxThreadEvent* update = new wxThreadEvent(EVT_LOAD_PROGRESS);
+                update->SetInt(id);
+                update->SetPayload(progress);
+                wxQueueEvent(this, update);
+            }, [this, id](const FirstPage& page) {
+                wxThreadEvent* update = new wxThreadEvent(EVT_FIRST_PAGE);
+                update->SetInt(id);
+                update->SetPayload(page);
+                wxQueueEvent(this, update);
+            });
+        }
+        void OnCancelLoad(wxCommandEvent& event) {
+            if (this->loader) this->loader->cancel();
+        }
+        void OnClose(wxCloseEvent& event) {
+            // Waits for the loading thread, it posts events to this frame
+            this->loader.reset();
+            event.Skip();
+        }
+        void OnLoadProgress(wxThreadEvent& event) {
+            if (event.GetInt() != this->loadId) return;
+            LoadProgress progress = event.GetPayload<LoadProgress>();
+            switch (progress.stage) {
+                case LOAD_INDEX:
+                    SetStatusText("Reading cross-reference table...");
+                    break;
+                case LOAD_FIRST_PAGE:
+                    SetStatusText("Loading first page...");
+                    break;
+                case LOAD_OBJECTS:
+                    SetStatusText(wxString::Format("Parsing objects: %lu of %lu", static_cast<unsigned long>(progress.objectsDone),
+                        static_cast<unsigned long>(progress.objectCount)));
+                    break;
+                default:
+                    this->OnLoadFinished();
+                    break;
+            }
+        }
+        void OnFirstPage(wxThreadEvent& event) {
+            if (event.GetInt() != this->loadId) return;
+            FirstPage page = event.GetPayload<FirstPage>();
+            SetTitle(wxString::Format("%s - page 1 of %lu", this->loadingName, static_cast<unsigned long>(page.pageCount)));
+            SetStatusText(wxString::Format("First page ready after %.0f ms, loading the rest...", page.seconds * 1000));
+        }
+        // The final stage is reported after the result was set, get() doesn't block
+        void OnLoadFinished() {
+            GetMenuBar()->Enable(ID_CANCEL_LOAD, false);
+            this->document = this->loading.get();
+            if (this->document.stage == LOAD_DONE) {
+                SetStatusText(wxString::Format("Loaded %lu pages in %.2f s", static_cast<unsigned long>(this->document.pages->getPageCount()),
+                    this->document.seconds));
+            } else if (this->document.stage == LOAD_CANCELLED) {
+                SetStatusText("Loading cancelled");
+            } else {
+                SetStatusText("");
+                wxMessageBox(_(this->document.errorMessage),
                     _("Error"),
                     wxOK | wxICON_ERROR);
-                return;
             }
         }
+
+        std::unique_ptr<DocumentLoader> loader;
+        std::future<LoadedDocument> loading;
+        LoadedDocument document;
+        int loadId = 0;
+        wxString loadingName;
 };
 
 class MyApp : public wxApp {
@@ -1,33 +1,92 @@
 #include "Buffer.h"
-
-#include <wx/wfstream.h>
+#include "buffer/MemoryBackend.h"
+#include "buffer/MappedBackend.h"
+#include "buffer/WindowedBackend.h"
+#include "buffer/ViewBackend.h"
+#include "parser/CharClass.h"
+
+#include <stdexcept>
+#include <algorithm>
 #include <wx/log.h>
 #include <wx/string.h>
 
 
-Buffer::Buffer(wxString filePath) {
-    this->filePath = filePath;
+Buffer::Buffer(wxString filePath, BufferMode mode) : Buffer(filePath, BufferOptions{mode}) {}
 
-    wxFileInputStream input_stream(this->filePath);
-    if (!input_stream.IsOk()) {
-        //throw std::runtime_error("Error reading file "+this->filePath)
-        return;
+Buffer::Buffer(wxString filePath, const BufferOptions& options) {
+    this->filePath = filePath;
+    this->mode = options.mode;
+    this->options = options;
+
+    if (this->mode == BUFFER_AUTO || this->mode == BUFFER_MAPPED) {
+        this->backend = std::make_unique<MappedBackend>(this->filePath);
+        if (this->backend->isReady()) {
+            this->mode = BUFFER_MAPPED;
+        } else if (this->mode == BUFFER_AUTO) {
+            wxLogDebug("Buffer: mapping failed, reading file into memory");
+            this->mode = BUFFER_MEMORY;
+        }
+    }
+    if (this->mode == BUFFER_MEMORY) {
+        this->backend = std::make_unique<MemoryBackend>(this->filePath);
+    } else if (this->mode == BUFFER_WINDOWED) {
+        this->backend = std::make_unique<WindowedBackend>(this->filePath, options.blockSize, options.memoryCap);
     }
 
-    size_t size = input_stream.GetLength(); // Get file byte size
-    this->data.resize(size);
+    this->init();
+}
+
+std::unique_ptr<Buffer> Buffer::fromData(std::string data) {
+    std::unique_ptr<Buffer> buffer(new Buffer());
+    buffer->backend = std::make_unique<MemoryBackend>(std::move(data));
+    buffer->init();
+    return buffer;
+}
 
-    input_stream.Read(this->data.data(), size);
+std::unique_ptr<Buffer> Buffer::createCursor() {
+    std::unique_ptr<Buffer> cursor(new Buffer());
+    cursor->filePath = this->filePath;
+    cursor->mode = this->mode;
+    cursor->options = this->options;
+    cursor->arbitraryStartByteOffset = this->arbitraryStartByteOffset;
+    if (!this->ready) return cursor;
+
+    if (this->backend->isContiguous()) {
+        // Contiguous backends hand out the whole data as their first chunk
+        BufferChunk whole = this->size > 0 ? this->backend->fetch(0) : BufferChunk{};
+        cursor->backend = std::make_unique<ViewBackend>(whole.data, whole.length);
+    } else {
+        cursor->backend = std::make_unique<WindowedBackend>(this->filePath, this->options.blockSize, this->options.memoryCap);
+        // Spooled pipes can't be opened a second time
+        if (!cursor->backend->isReady() || cursor->backend->getSize() != this->size) return cursor;
+    }
+    cursor->init();
+    return cursor;
+}
 
-    if (!input_stream) {
+// Take over size & first chunk once the backend is loaded
+void Buffer::init() {
+    if (!this->backend->isReady()) {
         //throw std::runtime_error("Error reading file "+this->filePath)
         return;
     }
+
+    // Size doesn't change for the lifetime of the backend
+    this->size = this->backend->getSize();
+    if (this->size > 0) {
+        this->chunk = this->backend->fetch(0);
+    }
     this->ready = true;
 }
 
+// Replace the current chunk with the one containing pos
+void Buffer::fetchChunk(size_t pos) {
+    this->chunk = this->backend->fetch(pos);
+}
+
 void Buffer::setPosition(size_t pos) {
-    if (pos >= this->data.size() || pos < 0) {
+    // Position right after the last byte is the end marker
+    if (pos > this->size) {
         throw std::runtime_error("Invalid marker position for buffer size");
     }
     this->readingPos = pos;
@@ -38,17 +97,29 @@ size_t Buffer::getPosition() {
 }
 
 bool Buffer::markerIsAtEnd() {
-    return this->readingPos == this->data.size();
+    return this->readingPos == this->size;
 }
 
 char Buffer::readNext() {
     if (this->markerIsAtEnd()) {
         throw std::runtime_error("Attempt to read after buffer end");
     }
-    char read = this->data.at(this->readingPos);
+    // Bounds are checked above, only refetch when leaving the current chunk
+    if (this->readingPos - this->chunk.start >= this->chunk.length) {
+        this->fetchChunk(this->readingPos);
+    }
     // Increment markerPos so we can read the next char next time
-    this->readingPos++;
-    return read;
+    return this->chunk.data[this->readingPos++ - this->chunk.start];
+}
+
+char Buffer::byteAt(size_t pos) {
+    if (pos >= this->size) {
+        throw std::runtime_error("Attempt to read after buffer end");
+    }
+    if (pos - this->chunk.start >= this->chunk.length) {
+        this->fetchChunk(pos);
+    }
+    return this->chunk.data[pos - this->chunk.start];
 }
 
 bool Buffer::isReady() {
@@ -56,42 +127,97 @@ bool Buffer::isReady() {
 }
 
 size_t Buffer::getSize() {
-    return this->data.size();
+    return this->size;
 }
 
+// Skip all six PDF whitespace characters, the marker stays at the end if only whitespace follows
 void Buffer::skipToNextContent() {
-    char current = this->readNext();
-    while (!this->markerIsAtEnd() && (current == ' ' || current == '\n' || current == '\r')) {
-        current = this->readNext();
+    while (!this->markerIsAtEnd()) {
+        if (!isPdfWhitespace(this->readNext())) {
+            this->backOne();
+            return;
+        }
     }
-    this->backOne();
 }
 
 void Buffer::backOne() {
-    this->setPosition(this->getPosition()-1);
-    if (this->getPosition() < 0) {
-        this->setPosition(0);
+    if (this->getPosition() == 0) {
+        return;
     }
+    this->setPosition(this->getPosition()-1);
 }
 
 void Buffer::setArbitraryStartByteOffset(size_t s) {
     this->arbitraryStartByteOffset = s;
 }
 
-// Function to read from the buffer at a given byte range
-std::string Buffer::readByteRange(size_t start, size_t end) {
+// Function to view the buffer at a given byte range (end inclusive, clamped to the buffer end)
+std::string_view Buffer::viewByteRange(size_t start, size_t end) {
     // Validate byte range
-    if (start >= this->data.size() || end > this->data.size() || start >= end) {
+    if (start >= this->size || end > this->size || start >= end) {
         throw std::runtime_error("Invalid byte range");
     }
 
-    std::string extracted(this->data.begin() + start, this->data.begin() + end + 1);
-    return extracted;
+    size_t stop = end + 1 > this->size ? this->size : end + 1;
+    if (start < this->chunk.start || start - this->chunk.start >= this->chunk.length) {
+        this->fetchChunk(start);
+    }
+    if (stop - this->chunk.start <= this->chunk.length) {
+        return std::string_view(this->chunk.data + (start - this->chunk.start), stop - start);
+    }
+
+    // Range spans multiple chunks, copy them together
+    this->scratch.clear();
+    this->scratch.reserve(stop - start);
+    size_t pos = start;
+    while (pos < stop) {
+        if (pos < this->chunk.start || pos - this->chunk.start >= this->chunk.length) {
+            this->fetchChunk(pos);
+        }
+        size_t chunkEnd = this->chunk.start + this->chunk.length;
+        size_t copyEnd = chunkEnd < stop ? chunkEnd : stop;
+        this->scratch.append(this->chunk.data + (pos - this->chunk.start), copyEnd - pos);
+        pos = copyEnd;
+    }
+    return std::string_view(this->scratch);
+}
+
+std::string_view Buffer::viewSpan(size_t start, size_t length) {
+    if (start >= this->size || length == 0) return std::string_view();
+    length = std::min(length, this->size - start);
+    if (start < this->chunk.start || start - this->chunk.start >= this->chunk.length) {
+        this->fetchChunk(start);
+    }
+    if (start + length - this->chunk.start <= this->chunk.length) {
+        return std::string_view(this->chunk.data + (start - this->chunk.start), length);
+    }
+    // Spans more than one chunk, at least two bytes then
+    return this->viewByteRange(start, start + length - 1);
+}
+
+// Function to view the buffer based on offset + respecting the arbitrary start bytes
+std::string_view Buffer::viewOffsetRange(size_t start, std::optional<size_t> end) {
+    size_t startByte = start + this->arbitraryStartByteOffset;
+    size_t endByte = end.has_value() ? end.value() + this->arbitraryStartByteOffset : this->size;
+    return this->viewByteRange(startByte, endByte);
+}
+
+// Function to read from the buffer at a given byte range
+std::string Buffer::readByteRange(size_t start, size_t end) {
+    return std::string(this->viewByteRange(start, end));
 }
 
 // Function to read from the buffer based on offset + respecting the arbitrary start bytes
 std::string Buffer::readOffsetRange(size_t start, std::optional<size_t> end) {
-    size_t startByte = start + this->arbitraryStartByteOffset;
-    size_t endByte = end.has_value() ? end.value() + this->arbitraryStartByteOffset : this->data.size();
-    return this->readByteRange(startByte, endByte);
+    return std::string(this->viewOffsetRange(start, end));
+}
+
+BufferStats Buffer::getStats() {
+    return this->ready ? this->backend->getStats() : BufferStats{};
+}
+
+void Buffer::advise(size_t start, size_t length, BufferAdvice advice) {
+    if (this->ready) {
+        this->backend->advise(start, length, advice);
+    }
 }
@@ -1,31 +1,85 @@
 #pragma once
 
+#include "buffer/BufferBackend.h"
+
 #include <vector>
 #include <string>
+#include <string_view>
 #include <optional>
+#include <memory>
 #include <wx/string.h>
 
+enum BufferMode {
+    BUFFER_AUTO,     // Memory map if possible, fall back to reading into memory
+    BUFFER_MEMORY,   // Copy the whole file into memory
+    BUFFER_MAPPED,   // Memory map the file, fails for non regular files
+    BUFFER_WINDOWED  // Keep a bounded set of blocks in memory, read the rest on demand
+};
+
+struct BufferOptions {
+    BufferMode mode = BUFFER_AUTO;
+    // Only used by BUFFER_WINDOWED
+    size_t blockSize = 64 * 1024;
+    size_t memoryCap = 4 * 1024 * 1024;
+};
+
 class Buffer {
     public:
-        Buffer(wxString filePath);
+        Buffer(wxString filePath, BufferMode mode = BUFFER_AUTO);
+        Buffer(wxString filePath, const BufferOptions& options);
+        // Buffer over bytes already in memory, e.g. a decoded stream
+        static std::unique_ptr<Buffer> fromData(std::string data);
+        /* Independent reading position over the same bytes, e.g. one per thread. Contiguous buffers
+            share their bytes & the cursor must not outlive this buffer, windowed buffers reopen
+            the file with their own block cache. Not ready if that fails */
+        std::unique_ptr<Buffer> createCursor();
         void setPosition(size_t pos);
         size_t getPosition();
         bool markerIsAtEnd();
         char readNext();
+        // Byte at a position without moving the marker
+        char byteAt(size_t pos);
         bool isReady();
         size_t getSize();
         void skipToNextContent();
         void backOne();
+        BufferMode getMode() { return mode; }
+        BufferStats getStats();
 
         void setArbitraryStartByteOffset(size_t s);
+        size_t getArbitraryStartByteOffset() { return arbitraryStartByteOffset; }
 
         std::string readByteRange(size_t start, size_t end);
         std::string readOffsetRange(size_t start, std::optional<size_t> end = std::nullopt);
 
+        /* Zero-copy variants. For contiguous backends the views stay valid as long as
+            the buffer lives, in windowed mode only until the next access to the buffer */
+        std::string_view viewByteRange(size_t start, size_t end);
+        std::string_view viewOffsetRange(size_t start, std::optional<size_t> end = std::nullopt);
+        // Up to length bytes from an absolute position, empty at the end of the buffer
+        std::string_view viewSpan(size_t start, size_t length);
+        // Whole file is in one chunk, views are free & stay valid
+        bool isContiguous() { return ready && backend->isContiguous(); }
+
+        // Hint the expected access pattern for a byte range to the backend
+        void advise(size_t start, size_t length, BufferAdvice advice);
+
     private:
+        Buffer() = default;
+        void init();
+        void fetchChunk(size_t pos);
+
         wxString filePath;
-        std::vector<char> data;
-        size_t readingPos;
+        BufferMode mode = BUFFER_MEMORY;
+        BufferOptions options;
+        std::unique_ptr<BufferBackend> backend;
+        size_t size = 0;
+        size_t readingPos = 0;
         bool ready = false;
-        size_t arbitraryStartByteOffset;
-};
\ No newline at end of file
+        size_t arbitraryStartByteOffset = 0;
+
+        // Chunk of the backend currently read from, the whole file for contiguous backends
+        BufferChunk chunk;
+        // Holds views spanning more than one chunk in windowed mode
+        std::string scratch;
+};
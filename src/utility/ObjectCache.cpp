@@ -0,0 +1,64 @@
+#include "ObjectCache.h"
+#include "objects/StreamObject.h"
+
+// Bookkeeping per cached object on top of its source bytes
+static constexpr size_t ENTRY_OVERHEAD = 64;
+
+std::shared_ptr<BaseObject> ObjectCache::get(size_t number, uint16_t generation) {
+    auto found = this->lookup.find(makeKey(number, generation));
+    if (found == this->lookup.end()) {
+        this->stats.misses++;
+        return nullptr;
+    }
+    this->stats.hits++;
+    this->entries.splice(this->entries.begin(), this->entries, found->second);
+    return found->second->obj;
+}
+
+void ObjectCache::put(size_t number, uint16_t generation, std::shared_ptr<BaseObject> obj) {
+    uint64_t key = makeKey(number, generation);
+    // Objects parsed from object streams have positions in the decoded data, the range is still their size.
+    // A stream holds only its dictionary, the data stays in the file
+    std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(obj);
+    size_t end = stream ? stream->getDataStart() : obj->getEnd() + 1;
+    size_t cost = ENTRY_OVERHEAD + (end > obj->getStart() ? end - obj->getStart() : 0);
+
+    auto found = this->lookup.find(key);
+    if (found != this->lookup.end()) {
+        this->bytes -= found->second->cost;
+        this->entries.erase(found->second);
+        this->lookup.erase(found);
+    }
+
+    this->entries.push_front(Entry{key, obj, cost});
+    this->lookup[key] = this->entries.begin();
+    this->bytes += cost;
+    this->evict();
+}
+
+void ObjectCache::clear() {
+    this->entries.clear();
+    this->lookup.clear();
+    this->bytes = 0;
+    this->stats.cachedObjects = 0;
+    this->stats.cachedBytes = 0;
+}
+
+void ObjectCache::setLimits(size_t maxObjects, size_t maxBytes) {
+    this->maxObjects = maxObjects;
+    this->maxBytes = maxBytes;
+    this->evict();
+}
+
+// Drop least recently used objects until both limits hold, the newest object always stays
+void ObjectCache::evict() {
+    while (this->entries.size() > 1 && (this->entries.size() > this->maxObjects || this->bytes > this->maxBytes)) {
+        Entry& last = this->entries.back();
+        this->bytes -= last.cost;
+        this->lookup.erase(last.key);
+        this->entries.pop_back();
+        this->stats.evictions++;
+    }
+    this->stats.cachedObjects = this->entries.size();
+    this->stats.cachedBytes = this->bytes;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "objects/BaseObject.h"
+
+#include <list>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+struct ObjectCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t objectsParsed = 0;
+    size_t cyclesDetected = 0;
+    size_t cachedObjects = 0;
+    size_t cachedBytes = 0;
+};
+
+/* LRU cache of parsed indirect objects keyed by (object number, generation).
+    Bounded by object count & by the summed source size of the cached objects,
+    streams count with their dictionary only */
+class ObjectCache {
+    public:
+        ObjectCache(size_t maxObjects = 4096, size_t maxBytes = 16 * 1024 * 1024) : maxObjects(maxObjects), maxBytes(maxBytes) {};
+
+        // nullptr if not cached, counts hit or miss
+        std::shared_ptr<BaseObject> get(size_t number, uint16_t generation);
+        void put(size_t number, uint16_t generation, std::shared_ptr<BaseObject> obj);
+        void clear();
+
+        void setLimits(size_t maxObjects, size_t maxBytes);
+        ObjectCacheStats& getStats() { return stats; }
+
+    private:
+        struct Entry {
+            uint64_t key;
+            std::shared_ptr<BaseObject> obj;
+            size_t cost;
+        };
+
+        static uint64_t makeKey(size_t number, uint16_t generation) { return (static_cast<uint64_t>(number) << 16) | generation; }
+        void evict();
+
+        size_t maxObjects;
+        size_t maxBytes;
+        size_t bytes = 0;
+
+        // Most recently used object at the front
+        std::list<Entry> entries;
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> lookup;
+        ObjectCacheStats stats;
+};
@@ -3,6 +3,22 @@
 #include "objects/NameObject.h"
 #include "objects/ArrayObject.h"
 #include "objects/DictionaryObject.h"
+#include "objects/IntegerObject.h"
+#include "objects/RealObject.h"
+#include "objects/ReferenceObject.h"
+#include "objects/StreamObject.h"
+#include "objects/StringObject.h"
+#include "objects/BooleanObject.h"
+#include "objects/NullObject.h"
+#include "filters/FilterPipeline.h"
+#include "xref/XRefStream.h"
+#include "xref/XRefEntryDecoder.h"
+#include "xref/XRefRecovery.h"
+#include "xref/TailLocator.h"
+#include "parser/Lexer.h"
+#include "parser/ValueParser.h"
+#include "parser/StreamBounds.h"
+#include "parallel/WorkStealingRange.h"
 
 #include <memory>
 #include <iostream>
@@ -10,17 +26,26 @@
 #include <string>
 #include <optional>
 #include <sstream>
+#include <unordered_set>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <mutex>
 #include <wx/wfstream.h>
 #include <wx/log.h>
 #include <wx/string.h>
 
 // Constructor, save filepath as attribute
-PdfReader::PdfReader(const wxString& filePath) : filePath(filePath), buffer(filePath) {
+PdfReader::PdfReader(const wxString& filePath, const BufferOptions& bufferOptions) : filePath(filePath), buffer(filePath, bufferOptions) {
     if (!this->buffer.isReady()) {
         this->setError("Error opening file");
     }
 }
 
+PdfReader::~PdfReader() {
+    if (this->streamCache) this->streamCache->removeDocument(this->documentId);
+}
+
 // Set error message & log to wxLog
 void PdfReader::setError(const std::string& msg, const std::optional<std::string>& log) {
     this->errorMessage = msg;
@@ -33,7 +58,7 @@ void PdfReader::setError(const std::string& msg, const std::optional<std::string
 }
 
 // Function to get the byte position of the next not whitespace/new line
-size_t PdfReader::getNextContentPos(const std::string& read, size_t start) {
+size_t PdfReader::getNextContentPos(std::string_view read, size_t start) {
     while (start < read.size() && (read[start] == ' ' || read[start] == '\n' || read[start] == '\r')) {
         start++;
     }
@@ -70,39 +95,42 @@ bool PdfReader::canConvertToSizeT(const std::string& s) {
 }
 
 
+// Trailer of a given revision, revisions are stored newest first
+std::shared_ptr<DictionaryObject> PdfReader::getTrailer(std::optional<size_t> revision) {
+    if (this->revisions.empty()) return nullptr;
+    if (!revision.has_value() || revision.value() >= this->revisions.size()) {
+        return this->revisions.front().trailer;
+    }
+    return this->revisions[this->revisions.size() - 1 - revision.value()].trailer;
+}
+
+
 // ********** START FUNCTIONS FOR PROCESS ********** 
 
 // Function to parse the PDF version & wether its binary or not
 bool PdfReader::readFileHeader() {
     if (!this->buffer.isReady()) throw std::logic_error("PdfReader::readFileHeader() called before buffer was loaded");
+    WAVEPDF_PHASE(this->stats, PHASE_READ_FILE_HEADER, this->trace.get());
 
     /* Find start of file (%PDF-) as we need to skip potential 
         preceding arbitrary bytes based on ISO32000 7.5.2 note 1 */
-    bool entryFound = false;
-    size_t startVersion = 0, endVersion = 4;
-    while (!entryFound) {
-        if (this->buffer.readByteRange(startVersion, endVersion) == "%PDF-") {
-            entryFound = true;
-        } else if (endVersion > 1024) {
-            // No file header found in first 1024 bytes
-            this->setError("Invalid PDF Format", "No %PDF- found in first 1024 bytes");
-            return false;
-        } else {
-            startVersion++;
-            endVersion++;
-        }
+    size_t startVersion = TailLocator::findHeader(this->buffer);
+    if (startVersion == std::string::npos) {
+        this->setError("Invalid PDF Format", "No %PDF- found in first 1024 bytes");
+        return false;
     }
+    size_t endVersion = startVersion + 4;
 
     // Set arbitraryStartByteOffset to be added to all offsets as all offsets are calculated from the starting % 
     this->buffer.setArbitraryStartByteOffset(startVersion);
 
     // Read the version number:
-    this->pdfVersion = this->buffer.readByteRange(endVersion+1, endVersion+3);
+    this->pdfVersion = std::string(this->buffer.viewSpan(endVersion+1, 3));
 
     // Check if there is a command following including atleast 4 binary bits
     size_t binaryCheckStart = endVersion+4;
     size_t binaryCheckEnd = binaryCheckStart+50;
-    std::string binaryCheck = this->buffer.readByteRange(binaryCheckStart, binaryCheckEnd);
+    std::string_view binaryCheck = this->buffer.viewSpan(binaryCheckStart, binaryCheckEnd - binaryCheckStart + 1);
     size_t commentStart = this->getNextContentPos(binaryCheck, 0); // Skip whitespace and newlines
     if (commentStart == binaryCheck.size() || binaryCheck[commentStart] != '%'){
         this->pdfIsBinary = false;
@@ -124,12 +152,13 @@ bool PdfReader::readFileHeader() {
 // Function to check if file correctly ends with EOF
 bool PdfReader::validateEOF() {
     if (!this->buffer.isReady()) throw std::logic_error("PdfReader::validateEOF() called before buffer was loaded");
+    WAVEPDF_PHASE(this->stats, PHASE_VALIDATE_EOF, this->trace.get());
 
-    size_t startEOFRead = this->buffer.getSize()-20, endEOFRead = this->buffer.getSize();
-    std::string eof = this->buffer.readByteRange(startEOFRead, endEOFRead);
-    int eofStartPos = eof.find("%%EOF");
-    if (eofStartPos == std::string::npos) {
-        // No %%EOF in bytes read
+    // %%EOF may be followed by trailing garbage, it only has to be within the tail window
+    TailLocator locator(this->tailWindow);
+    this->tail = TailLocation();
+    this->tail.eof = locator.findEOF(this->buffer);
+    if (this->tail.eof == std::string::npos) {
         this->setError("Can't read file", "File missing %%EOF");
         return false;
     }
@@ -139,45 +168,406 @@ bool PdfReader::validateEOF() {
 // Function to locate & read startxref (byte offset for xref)
 bool PdfReader::parseXRefOffset() {
     if (!this->buffer.isReady()) throw std::logic_error("PdfReader::parseXRefOffset() called before buffer was loaded");
+    WAVEPDF_PHASE(this->stats, PHASE_PARSE_XREF_OFFSET, this->trace.get());
 
-    // Locating startxref in buffer
-    size_t startXRefPosRead = this->buffer.getSize()-1024, endXRefPosRead = this->buffer.getSize();
-    std::string xRefPosRead = this->buffer.readByteRange(startXRefPosRead, endXRefPosRead);
-    size_t startXrefPos = xRefPosRead.find("startxref\n");
-    if (startXrefPos == std::string::npos) {
-        // No startxref in bytes read
+    /* Incremental updates append more startxref, the last one is the one in effect. It's searched
+        from the end of the file, an update with a damaged %%EOF must not fall back to the one before */
+    TailLocator locator(this->tailWindow);
+    TailLocation location;
+    location.eof = this->tail.eof;
+    if (!locator.findStartXRef(this->buffer, this->buffer.getSize(), location)) {
         this->setError("Can't read file", "File missing startxref");
         return false;
     }
-    // Extract the number after startxref
-    startXrefPos += 9; // skip the "startxref"
-    startXrefPos = this->getNextContentPos(xRefPosRead, startXrefPos); // skip whitespace and newlines
-    size_t endXRefPos = startXrefPos;
-    while (endXRefPos < xRefPosRead.size() && isdigit(xRefPosRead[endXRefPos])) {
-        // Select all following connected digits -> the xref offset
-        endXRefPos++;
+    if (location.xrefOffset == std::string::npos) {
+        this->setError("Can't read file", "startxref has no valid offset number");
+        return false;
+    }
+    location.trailer = locator.findTrailer(this->buffer, location.startXRef);
+    this->tail = location;
+    this->xRefOffset = location.xrefOffset;
+    return true;
+}
+
+// Function to parse the xref sections of all revisions, following the /Prev chain of the trailers
+bool PdfReader::parseXRefTable() {
+    if (this->xRefOffset == std::string::npos) throw std::logic_error("PdfReader::parseXRefTable() called without parsed xref offset");
+    WAVEPDF_PHASE(this->stats, PHASE_PARSE_XREF_TABLE, this->trace.get());
+
+    this->xrefTable.clear();
+    this->indexedTable.clear();
+    this->xrefIndex.clear();
+    this->revisions.clear();
+
+    // Offsets already parsed, a /Prev pointing back into the chain would loop forever
+    std::unordered_set<size_t> visited;
+    std::optional<size_t> sectionOffset = this->xRefOffset;
+    while (sectionOffset.has_value()) {
+        if (this->isCancelled()) {
+            this->setError("Loading cancelled");
+            return false;
+        }
+        if (!visited.insert(sectionOffset.value()).second) {
+            this->setError("Can't read file", "xref /Prev chain is looping");
+            return false;
+        }
+
+        std::vector<xrefSubsection> subsections;
+        std::shared_ptr<DictionaryObject> trailer;
+        if (this->isClassicXRefAt(sectionOffset.value())) {
+            size_t trailerPos;
+            if (!this->parseXRefAt(sectionOffset.value(), subsections, trailerPos)) return false;
+
+            trailer = this->parseTrailer(trailerPos);
+            if (!trailer) return false;
+
+            // Hybrid files list their compressed objects in an additional xref stream, searched after the table
+            std::optional<int64_t> xRefStm = this->resolveInteger(trailer->getElement(NAME_XREFSTM));
+            if (xRefStm.has_value() && xRefStm.value() >= 0) {
+                std::shared_ptr<DictionaryObject> streamDict;
+                if (!this->parseXRefStream(static_cast<size_t>(xRefStm.value()), subsections, streamDict)) return false;
+            }
+        } else {
+            // PDF 1.5+ cross-reference stream, its dictionary doubles as trailer
+            if (!this->parseXRefStream(sectionOffset.value(), subsections, trailer)) return false;
+        }
+
+        // Sections are merged newest first, the table at startxref stays available as is
+        this->xrefIndex.addRevision(subsections);
+        if (this->revisions.empty()) {
+            this->xrefTable = std::move(subsections);
+        }
+        this->revisions.push_back(xrefRevision{sectionOffset.value(), trailer});
+
+        sectionOffset.reset();
+        std::optional<int64_t> prev = this->resolveInteger(trailer->getElement(NAME_PREV));
+        if (prev.has_value()) {
+            if (prev.value() < 0) {
+                this->setError("Can't read file", "trailer has an invalid /Prev offset");
+                return false;
+            }
+            sectionOffset = static_cast<size_t>(prev.value());
+        }
     }
-    if (startXrefPos == endXRefPos) {
-        this->setError("Can't read file", "startxref has no offset number");
+
+    return true;
+}
+
+const std::vector<xrefSubsection>& PdfReader::getXRefTable() {
+    // Nothing but callers of this needs the table, after loading a parse index it is built on first use
+    if (!this->indexedTable.empty()) {
+        this->xrefTable = ParseIndexFile::restoreTable(this->indexedTable, this->xrefIndex);
+        this->indexedTable.clear();
+    }
+    return this->xrefTable;
+}
+
+// Function to restore what process() parses from the parse index file of this document
+bool PdfReader::loadIndex() {
+    WAVEPDF_PHASE(this->stats, PHASE_LOAD_INDEX, this->trace.get());
+    ParseIndexState state;
+    std::string reason;
+    if (!ParseIndexFile::read(ParseIndexFile::pathFor(this->indexDirectory, this->filePath), this->filePath, this->buffer, state, this->xrefIndex, reason)) {
+        wxLogDebug(wxString("PdfReader: parsing the file, parse index not used: " + reason));
         return false;
     }
-    // Convert string to integer & write to attribute
+
+    // Trailers are the only objects parsed again, they are small & shared by every later lookup
+    this->revisions.clear();
+    for (const std::pair<size_t, size_t>& revision: state.revisions) {
+        std::shared_ptr<DictionaryObject> trailer;
+        try {
+            trailer = std::dynamic_pointer_cast<DictionaryObject>(this->parseObject(revision.second));
+        } catch (const std::runtime_error&) {
+            trailer = nullptr;
+        }
+        if (!trailer) {
+            wxLogDebug("PdfReader: parsing the file, trailer of the parse index not found");
+            this->revisions.clear();
+            this->xrefIndex.clear();
+            return false;
+        }
+        this->revisions.push_back(xrefRevision{revision.first, trailer});
+    }
+
+    this->buffer.setArbitraryStartByteOffset(state.startOffset);
+    this->pdfVersion = state.pdfVersion;
+    this->pdfIsBinary = state.binary;
+    this->tail = state.tail;
+    this->xRefOffset = state.tail.xrefOffset;
+    this->xrefTable.clear();
+    this->indexedTable = std::move(state.table);
+    this->indexLoaded = true;
+    return true;
+}
+
+void PdfReader::saveIndex() {
+    ParseIndexState state;
+    state.pdfVersion = this->pdfVersion;
+    state.binary = this->pdfIsBinary;
+    state.startOffset = this->buffer.getArbitraryStartByteOffset();
+    state.tail = this->tail;
+    for (const xrefRevision& revision: this->revisions) state.revisions.push_back({revision.offset, revision.trailer->getStart()});
+    if (!ParseIndexFile::describeTable(this->xrefTable, this->xrefIndex, state.table) ||
+        !ParseIndexFile::write(ParseIndexFile::pathFor(this->indexDirectory, this->filePath), this->filePath, this->buffer, state, this->xrefIndex)) {
+        wxLogDebug("PdfReader: can't write the parse index file");
+    }
+}
+
+// Function to rebuild the xref index & trailer from a scan for all object headers of the file
+bool PdfReader::recoverXRef(size_t threads) {
+    if (!this->buffer.isReady()) throw std::logic_error("PdfReader::recoverXRef() called before buffer was loaded");
+    WAVEPDF_PHASE(this->stats, PHASE_RECOVER_XREF, this->trace.get());
+
+    // Whatever the failed parse left behind
+    this->xrefTable.clear();
+    this->indexedTable.clear();
+    this->xrefIndex.clear();
+    this->revisions.clear();
+    this->objectStreams.clear();
+    this->objectCache.clear();
+    this->loadingObjects.clear();
+    this->releaseDocument();
+    this->recovered = false;
+
+    RecoveryScan scan = XRefRecovery::scan(this->buffer, threads);
+    size_t startOffset = this->buffer.getArbitraryStartByteOffset();
+    std::vector<xrefSubsection> sections = XRefRecovery::buildSections(scan, startOffset);
+    if (sections.front().objects.empty()) {
+        this->setError("Can't read file", "No objects found when recovering xref");
+        return false;
+    }
+    this->xrefIndex.addRevision(sections);
+
+    // Absolute position of the newest definition of each object & its entry
+    std::unordered_map<size_t, std::pair<size_t, xrefEntry>> newest;
+    for (const xrefEntry& entry: sections.front().objects) newest.emplace(entry.number, std::make_pair(entry.entryOne + startOffset, entry));
+    auto isNewest = [&newest](const RecoveredObject* object) {
+        auto found = newest.find(object->number);
+        return found != newest.end() && found->second.first == object->offset;
+    };
+
+    /* Objects in object streams have no header of their own, they are taken from every
+        object stream that is newer than the direct definition of the same number */
+    bool compressedAdded = false;
+    std::unordered_set<size_t> loadedStreams;
+    for (size_t marker: scan.objectStreams) {
+        const RecoveredObject* streamObject = XRefRecovery::objectAt(scan, marker);
+        if (!streamObject || !isNewest(streamObject) || !loadedStreams.insert(streamObject->number).second) continue;
+
+        ObjectStreamData* objectStream = this->loadObjectStream(streamObject->number, 0);
+        if (!objectStream) continue;
+        for (size_t i = 0; i < objectStream->objects.size(); i++) {
+            size_t number = objectStream->objects[i].first;
+            if (number > MAX_OBJECT_NUMBER) continue;
+            auto found = newest.find(number);
+            if (found != newest.end() && found->second.first > streamObject->offset) continue;
+            newest[number] = std::make_pair(streamObject->offset, xrefEntry{streamObject->number, 0, number, 'c', i});
+            compressedAdded = true;
+        }
+    }
+    if (compressedAdded) {
+        xrefSubsection& section = sections.front();
+        section.objects.clear();
+        for (const auto& object: newest) section.objects.push_back(object.second.second);
+        std::sort(section.objects.begin(), section.objects.end(), [](const xrefEntry& a, const xrefEntry& b) { return a.number < b.number; });
+        section.amountObjects = section.objects.size();
+
+        // Objects cached so far may have been replaced by compressed ones
+        this->xrefIndex.clear();
+        this->xrefIndex.addRevision(sections);
+        this->objectCache.clear();
+    }
+
+    // Newest trailer dictionary or xref stream dictionary with a /Root
+    std::vector<std::pair<size_t, const RecoveredObject*>> trailers;
+    for (size_t position: scan.trailers) trailers.push_back({position, nullptr});
+    for (size_t marker: scan.xrefStreams) {
+        const RecoveredObject* streamObject = XRefRecovery::objectAt(scan, marker);
+        if (streamObject && isNewest(streamObject)) trailers.push_back({streamObject->offset, streamObject});
+    }
+    std::sort(trailers.begin(), trailers.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    for (const auto& candidate: trailers) {
+        std::shared_ptr<DictionaryObject> trailer;
+        if (candidate.second) {
+            std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(this->getObject(candidate.second->number, candidate.second->generation));
+            if (stream) trailer = stream->getDictionary();
+        } else {
+            try {
+                this->buffer.setPosition(candidate.first + 7);
+                this->buffer.skipToNextContent();
+                trailer = std::dynamic_pointer_cast<DictionaryObject>(this->parseObject(this->buffer.getPosition()));
+            } catch (const std::runtime_error&) {
+                // Trailer keyword right at the end of a truncated file
+            }
+        }
+        if (!trailer || !trailer->getElement(NAME_ROOT)) continue;
+
+        this->revisions.push_back(xrefRevision{candidate.first - std::min(candidate.first, startOffset), trailer});
+        this->xrefTable = std::move(sections);
+        this->recovered = true;
+        this->error = false;
+        this->errorMessage.clear();
+        return true;
+    }
+
+    this->setError("Can't read file", "No trailer with /Root found when recovering xref");
+    return false;
+}
+
+// Function to check if a classic xref section (xref keyword) starts at the given offset
+bool PdfReader::isClassicXRefAt(size_t offset) {
+    size_t start = offset + this->buffer.getArbitraryStartByteOffset();
+    if (start + 4 > this->buffer.getSize()) return false;
+    return this->buffer.viewByteRange(start, start + 3) == "xref";
+}
+
+// Function to parse the cross-reference stream object at the given offset, appending its entries to subsections
+bool PdfReader::parseXRefStream(size_t offset, std::vector<xrefSubsection>& subsections, std::shared_ptr<DictionaryObject>& trailer) {
+    size_t start = offset + this->buffer.getArbitraryStartByteOffset();
+    if (start >= this->buffer.getSize()) {
+        this->setError("Can't read file", "xref offset outside of file");
+        return false;
+    }
+
+    std::shared_ptr<BaseObject> obj;
     try {
-        this->xRefOffset = std::stoul(xRefPosRead.substr(startXrefPos, endXRefPos - startXrefPos));
-    } catch (...) {
-        this->setError("Can't read file", "Invalid startxref number");
+        obj = this->parseIndirectObject(this->buffer, start);
+    } catch (const std::runtime_error&) {
+        obj = nullptr;
+    }
+    std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(obj);
+    if (!stream) {
+        this->setError("Can't read file", "xref not found at parsed offset");
+        return false;
+    }
+
+    trailer = stream->getDictionary();
+    std::shared_ptr<NameObject> type = std::dynamic_pointer_cast<NameObject>(trailer->getElement(NAME_TYPE));
+    if (!type || type->getAtom() != NAME_XREF) {
+        this->setError("Can't read file", "xref not found at parsed offset");
+        return false;
+    }
+
+    // Field widths of each row
+    std::shared_ptr<ArrayObject> w = std::dynamic_pointer_cast<ArrayObject>(trailer->getElement(NAME_W));
+    if (!w || w->getObjects().size() != 3) {
+        this->setError("Can't read file", "xref stream has invalid /W");
+        return false;
+    }
+    size_t widths[3];
+    for (size_t i = 0; i < 3; i++) {
+        std::optional<int64_t> width = this->resolveInteger(w->getObjects()[i]);
+        if (!width.has_value() || width.value() < 0 || width.value() > 8) {
+            this->setError("Can't read file", "xref stream has invalid /W");
+            return false;
+        }
+        widths[i] = static_cast<size_t>(width.value());
+    }
+
+    // Object number ranges, defaults to all objects up to /Size
+    std::vector<std::pair<size_t, size_t>> index;
+    std::shared_ptr<ArrayObject> indexArray = std::dynamic_pointer_cast<ArrayObject>(trailer->getElement(NAME_INDEX));
+    if (indexArray) {
+        const std::vector<std::shared_ptr<BaseObject>>& values = indexArray->getObjects();
+        for (size_t i = 0; i + 1 < values.size(); i += 2) {
+            std::optional<int64_t> first = this->resolveInteger(values[i]);
+            std::optional<int64_t> count = this->resolveInteger(values[i+1]);
+            if (!first.has_value() || !count.has_value() || first.value() < 0 || count.value() < 0) {
+                this->setError("Can't read file", "xref stream has invalid /Index");
+                return false;
+            }
+            index.push_back({static_cast<size_t>(first.value()), static_cast<size_t>(count.value())});
+        }
+    } else {
+        std::optional<int64_t> size = this->resolveInteger(trailer->getElement(NAME_SIZE));
+        if (!size.has_value() || size.value() < 0) {
+            this->setError("Can't read file", "xref stream has invalid /Size");
+            return false;
+        }
+        index.push_back({0, static_cast<size_t>(size.value())});
+    }
+
+    std::string data;
+    if (!this->decodeStream(stream, data)) {
+        this->setError("Can't read file", "xref stream could not be decoded");
+        return false;
+    }
+    size_t firstAdded = subsections.size();
+    if (!XRefStreamDecoder::decode(data, widths, index, subsections)) {
+        this->setError("Can't read file", "xref stream data shorter than its /Index");
+        return false;
+    }
+    if (XRefIndex::exceedsObjectLimit(subsections, firstAdded)) {
+        this->setError("Can't read file", "xref stream /Index has object numbers above the limit");
+        return false;
+    }
+    if (XRefIndex::hasOverlap(subsections, firstAdded)) {
+        this->setError("Can't read file", "xref stream /Index has overlapping object numbers");
         return false;
     }
     return true;
 }
 
-// Function to parse the xref table from the file
-bool PdfReader::parseXRefTable() {
-    if (this->xRefOffset == std::string::npos) throw std::logic_error("PdfReader::parseXRefTable() called without parsed xref offset");
+// Function to parse the classic xref section at the given offset, trailerPos is set to the absolute position of the trailer keyword
+bool PdfReader::parseXRefAt(size_t offset, std::vector<xrefSubsection>& subsections, size_t& trailerPos) {
+    size_t xRefStart = offset + this->buffer.getArbitraryStartByteOffset();
+    if (xRefStart >= this->buffer.getSize()) {
+        this->setError("Can't read file", "xref offset outside of file");
+        return false;
+    }
+    size_t available = this->buffer.getSize() - xRefStart;
+    this->buffer.advise(xRefStart, available, ADVICE_SEQUENTIAL);
 
-    // Read from xRefOffset to end
-    std::string xRefRead = this->buffer.readOffsetRange(this->xRefOffset);
+    /* Contiguous buffers can view the rest of the file for free. Windowed buffers would
+        have to assemble it, so start with a small window & grow it while the table doesn't fit */
+    size_t window = this->buffer.getMode() == BUFFER_WINDOWED ? XREF_READ_WINDOW : available;
+    while (true) {
+        bool complete = window >= available;
+        std::optional<size_t> end = complete ? std::nullopt : std::optional<size_t>(offset + window);
+        bool truncated = false;
 
+        subsections.clear();
+        if (this->parseXRefSection(this->buffer.viewOffsetRange(offset, end), complete, truncated, subsections, trailerPos)) {
+            WAVEPDF_COUNT(this->stats.bytesParsed, trailerPos);
+            trailerPos += xRefStart;
+            return true;
+        }
+        if (!truncated) {
+            return false;
+        }
+        window *= 2;
+    }
+}
+
+// Function to parse the trailer dictionary following the trailer keyword at the given absolute position
+std::shared_ptr<DictionaryObject> PdfReader::parseTrailer(size_t trailerPos) {
+    if (trailerPos + 7 >= this->buffer.getSize() || this->buffer.viewByteRange(trailerPos, trailerPos + 6) != "trailer") {
+        this->setError("Can't read file", "trailer missing after xref section");
+        return nullptr;
+    }
+
+    std::shared_ptr<BaseObject> obj;
+    try {
+        this->buffer.setPosition(trailerPos + 7);
+        this->buffer.skipToNextContent();
+        obj = this->parseObject(this->buffer.getPosition());
+    } catch (const std::runtime_error&) {
+        this->setError("Can't read file", "unexpected end of file when parsing trailer");
+        return nullptr;
+    }
+
+    if (obj->getType() != OBJT_DICTIONARY) {
+        this->setError("Can't read file", "trailer is not a dictionary");
+        return nullptr;
+    }
+    return std::dynamic_pointer_cast<DictionaryObject>(obj);
+}
+
+/* Parse one classic xref section from a view starting at the xref keyword, trailerPos is set relative to the view.
+    Sets truncated instead of failing if the view ends early & isn't the complete rest of the file */
+bool PdfReader::parseXRefSection(std::string_view xRefRead, bool viewIsComplete, bool& truncated, std::vector<xrefSubsection>& subsections, size_t& trailerPos) {
     // Verify if xref is starting at parsed offset
     if (xRefRead.substr(0, 4) != "xref") {
         this->setError("Can't read file", "xref not found at parsed offset");
@@ -197,12 +587,16 @@ bool PdfReader::parseXRefTable() {
         }
         
         if (currentReadEnd == xRefRead.size()-1) {
+            if (!viewIsComplete) {
+                truncated = true;
+                return false;
+            }
             this->setError("Can't read file", "unexpencted end of file when parsing xref");
             return false;
         }
 
         currentReadEnd++; // To include the last character
-        std::string line = xRefRead.substr(currentReadPos, currentReadEnd - currentReadPos);
+        std::string line(xRefRead.substr(currentReadPos, currentReadEnd - currentReadPos));
         std::vector<std::string> lineData = this->split(line, ' ');
 
         bool isPartOfXref = false;
@@ -212,33 +606,36 @@ bool PdfReader::parseXRefTable() {
             // Is there a previous finished subsection we can push to the table?
             if (!currentSubsection.objects.empty()) {
                 if (currentSubsection.amountObjects == currentSubsection.objects.size()) {
-                    this->xrefTable.push_back(currentSubsection);
+                    subsections.push_back(currentSubsection);
                 } else {
                     this->setError("Can't read file", "xref subsection object count does not match");
                     return false;
                 }
             }
 
-            // Check if the new subsection object number range collude with an existing subsection
+            // Overlapping object number ranges are checked once the section is complete
             size_t startObject = static_cast<size_t>(std::stoull(lineData[0]));
             size_t amountObjects = static_cast<size_t>(std::stoull(lineData[1]));
-            for (xrefSubsection sec: this->xrefTable) {
-                /* Either:
-                    - the right border of existing range needs to be smaller than left of new
-                    - or the left border of existing needs to be bigger than right of new
-                    to verify the ranges don't overlap
-                */
-                if (!(sec.startObject > startObject+amountObjects || sec.startObject+sec.amountObjects < startObject)) {
-                    this->setError("Can't read file", "xref subsection have overlapping object numbers");
-                    return false;
-                }
-            }
 
             currentSubsection = xrefSubsection{};
             currentSubsection.startObject = startObject;
             currentSubsection.amountObjects = amountObjects;
             currentSubsection.initDone = true;
 
+            /* Fast path: entries are fixed 20 byte records, decode them straight from the view.
+                Records that don't match exactly are left to the line by line parsing below */
+            size_t entriesStart = this->getNextContentPos(xRefRead, currentReadEnd);
+            size_t availableRecords = (xRefRead.size() - entriesStart) / XREF_ENTRY_SIZE;
+            if (amountObjects > availableRecords && !viewIsComplete) {
+                truncated = true;
+                return false;
+            }
+            currentSubsection.objects.reserve(amountObjects < availableRecords ? amountObjects : availableRecords);
+            size_t decoded = XRefEntryDecoder::decode(xRefRead.substr(entriesStart), startObject, amountObjects, currentSubsection.objects);
+            if (decoded > 0) {
+                currentReadEnd = entriesStart + decoded * XREF_ENTRY_SIZE;
+            }
+
             isPartOfXref = true;
         }
 
@@ -271,15 +668,25 @@ bool PdfReader::parseXRefTable() {
             // Push a potential last subsection to xref table
             if (!currentSubsection.objects.empty()) {
                 if (currentSubsection.amountObjects == currentSubsection.objects.size()) {
-                    this->xrefTable.push_back(currentSubsection);
+                    subsections.push_back(currentSubsection);
                 } else {
                     this->setError("Can't read file", "xref subsection object count does not match");
                     return false;
                 }
             }
 
-            // xref table is finished
+            // xref table is finished, the line has to be the trailer
+            trailerPos = currentReadPos;
             continueReading = false;
+
+            if (XRefIndex::exceedsObjectLimit(subsections)) {
+                this->setError("Can't read file", "xref subsection has object numbers above the limit");
+                return false;
+            }
+            if (XRefIndex::hasOverlap(subsections)) {
+                this->setError("Can't read file", "xref subsection have overlapping object numbers");
+                return false;
+            }
         } else {
             currentReadPos = this->getNextContentPos(xRefRead, currentReadEnd);
         }
@@ -288,102 +695,530 @@ bool PdfReader::parseXRefTable() {
     return true;
 }
 
+// Parse the object starting at byteOffset of the file
 std::shared_ptr<BaseObject> PdfReader::parseObject(size_t byteOffset) {
-    // Set marker at starting pos & read first char
-    this->buffer.setPosition(byteOffset);
-    char start = this->buffer.readNext();
+    return this->parseObject(this->buffer, byteOffset);
+}
 
-    switch (start) {
-        case '(':
-            // Object to be parsed is a literal string
-            break;
-        
-        case '<': {
-            char next = this->buffer.readNext();
-            if (next == '<') {
-                // Object to be parsed is a dictionary
-                std::shared_ptr<DictionaryObject> dict = std::make_shared<DictionaryObject>(byteOffset);
-                this->buffer.skipToNextContent();
-                while (this->buffer.readNext() != '>') {
-                    this->buffer.backOne();
+std::shared_ptr<BaseObject> PdfReader::parseObject(Buffer& source, size_t byteOffset) {
+    std::shared_ptr<BaseObject> obj = lexFrom(source, byteOffset, [this](Lexer& lexer) { return this->parseObject(lexer, 0); });
+    WAVEPDF_COUNT(this->stats.bytesParsed, source.getPosition() - byteOffset);
+    return obj;
+}
 
-                    // Read the key
-                    std::shared_ptr<BaseObject> obj = this->parseObject(this->buffer.getPosition());
-                    if (obj->getType() != OBJT_NAME) {
-                        // ERROR TO BE HANDLED!!
-                    }
-                    // Cast the pointer type to NameObject
-                    std::shared_ptr<NameObject> key = std::dynamic_pointer_cast<NameObject>(obj);
-
-                    // Skip to next object & parse -> value
-                    this->buffer.skipToNextContent();
-                    obj = this->parseObject(this->buffer.getPosition());
-                    if (obj->getType() == OBJT_INVALID) {
-                        // ERROR TO BE HANDLED!!
-                    }
+// Parse the next object of the lexer, an OBJT_INVALID object if there is none
+std::shared_ptr<BaseObject> PdfReader::parseObject(Lexer& lexer, size_t depth) {
+    Token token;
+    LexerStatus status = lexer.next(token);
+    // Malformed hex digits are ignored when decoding, the string is still usable
+    if (status != LEX_OK && status != LEX_INVALID_HEX) return std::make_shared<BaseObject>(0, 0);
+    return this->parseObject(lexer, token, depth);
+}
 
-                    // Add key & value to dictionary
-                    dict->addElement(key, obj);
+std::shared_ptr<BaseObject> PdfReader::parseObject(Lexer& lexer, const Token& token, size_t depth) {
+    WAVEPDF_COUNT(this->stats.objectAllocations, 1);
+    // Objects store the position of their last byte
+    size_t last = token.end - 1;
 
-                    this->buffer.skipToNextContent();
-                }
-                dict->setEnd(this->buffer.getPosition()-1);
-                return dict;
-            } else {
-                // Object to be parsed is a hex string
+    switch (token.type) {
+        case TOKEN_INTEGER: {
+            // Unsigned integer followed by another unsigned integer & R is an indirect reference
+            uint16_t generation;
+            if (lexer.readReferenceTail(token, generation)) {
+                return std::make_shared<ReferenceObject>(token.start, lexer.getPosition() - 1, static_cast<size_t>(token.integer), generation);
             }
-            break;
+            return std::make_shared<IntegerObject>(token.start, last, token.integer);
         }
 
-        case '/': {
-            // Object to be parsed is a name
-            char current = this->buffer.readNext();
-            std::vector<char> nameParts;
-            while (current != ' ') {
-                if (current < '!' || current > '~') {
-                    // ERROR TO BE HANDLED!!
-                }
-                if (current == '#') {
-                    char hex[] = {this->buffer.readNext(), this->buffer.readNext(), '\0'};
-                    if (!std::isxdigit(static_cast<unsigned char>(hex[0])) || !std::isxdigit(static_cast<unsigned char>(hex[1]))) {
-                        // ERROR TO BE HANDLED!!
-                    }
-                    current = static_cast<char>(std::stoi(std::string(hex), nullptr, 16));
-                }
-                nameParts.push_back(current);
-                current = this->buffer.readNext();
+        case TOKEN_REAL:
+            return std::make_shared<RealObject>(token.start, last, token.real);
+
+        case TOKEN_NAME: {
+            if (!token.escaped) return std::make_shared<NameObject>(token.start, last, this->names.intern(token.text));
+            std::string name;
+            Lexer::decodeName(token.text, name);
+            return std::make_shared<NameObject>(token.start, last, this->names.intern(name));
+        }
+
+        case TOKEN_STRING_LITERAL: {
+            std::string value;
+            Lexer::decodeLiteralString(token.text, value);
+            return std::make_shared<StringObject>(token.start, last, std::move(value), false);
+        }
+
+        case TOKEN_STRING_HEXADECIMAL: {
+            std::string value;
+            Lexer::decodeHexString(token.text, value);
+            return std::make_shared<StringObject>(token.start, last, std::move(value), true);
+        }
+
+        case TOKEN_TRUE:
+        case TOKEN_FALSE:
+            return std::make_shared<BooleanObject>(token.start, last, token.type == TOKEN_TRUE);
+
+        case TOKEN_NULL:
+            return std::make_shared<NullObject>(token.start, last);
+
+        case TOKEN_ARRAY_BEGIN: {
+            if (depth >= MAX_VALUE_NESTING) break;
+            std::shared_ptr<ArrayObject> array = std::make_shared<ArrayObject>(token.start);
+            Token element;
+            while (true) {
+                LexerStatus status = lexer.next(element);
+                // Unterminated arrays end with the data
+                if (status == LEX_END) break;
+                if (status != LEX_OK && status != LEX_INVALID_HEX) continue;
+                if (element.type == TOKEN_ARRAY_END) break;
+                std::shared_ptr<BaseObject> obj = this->parseObject(lexer, element, depth + 1);
+                if (obj->getType() != OBJT_INVALID) array->addObject(obj);
             }
-            std::shared_ptr<NameObject> obj = std::make_shared<NameObject>(byteOffset, this->buffer.getPosition()-1, std::string(nameParts.begin(), nameParts.end()));
-            return obj;
-        }
-
-        case '[': {
-            // Object to be parsed is an array
-            std::shared_ptr<ArrayObject> obj = std::make_shared<ArrayObject>(byteOffset);
-            this->buffer.skipToNextContent();
-            while (this->buffer.readNext() != ']') {
-                this->buffer.backOne();
-                std::shared_ptr<BaseObject> element = this->parseObject(this->buffer.getPosition());
-                obj->addObject(element);
-                this->buffer.skipToNextContent();
+            array->setEnd(lexer.getPosition() - 1);
+            return array;
+        }
+
+        case TOKEN_DICTIONARY_BEGIN: {
+            if (depth >= MAX_VALUE_NESTING) break;
+            std::shared_ptr<DictionaryObject> dict = std::make_shared<DictionaryObject>(token.start);
+            Token key, value;
+            while (true) {
+                LexerStatus status = lexer.next(key);
+                if (status == LEX_END) break;
+                if (status != LEX_OK) continue;
+                if (key.type == TOKEN_DICTIONARY_END) break;
+                // Anything but a name in key position is skipped
+                if (key.type != TOKEN_NAME) continue;
+                std::shared_ptr<NameObject> name = std::dynamic_pointer_cast<NameObject>(this->parseObject(lexer, key, depth + 1));
+
+                status = lexer.next(value);
+                if (status == LEX_END) break;
+                // Key without a value right before the end
+                if (status == LEX_OK && value.type == TOKEN_DICTIONARY_END) break;
+                if (status != LEX_OK && status != LEX_INVALID_HEX) continue;
+                std::shared_ptr<BaseObject> obj = this->parseObject(lexer, value, depth + 1);
+                if (obj->getType() != OBJT_INVALID) dict->addElement(name, obj);
             }
-            obj->setEnd(this->buffer.getPosition()-1);
-            return obj;
+            dict->setEnd(lexer.getPosition() - 1);
+            return dict;
         }
 
         default:
+            // Keywords & closing tokens aren't objects
             break;
     }
     return std::make_shared<BaseObject>(0, 0);
 }
 
+/* Parse an indirect object definition (N G obj ... endobj) at the given position, 
+    returns its value or the stream, nullptr if no object header is found */
+std::shared_ptr<BaseObject> PdfReader::parseIndirectObject(Buffer& source, size_t byteOffset, size_t depth) {
+    std::shared_ptr<BaseObject> value = lexFrom(source, byteOffset, [this](Lexer& lexer) -> std::shared_ptr<BaseObject> {
+        Token number, generation, keyword;
+        if (lexer.next(number) != LEX_OK || number.type != TOKEN_INTEGER || number.integer < 0 ||
+            lexer.next(generation) != LEX_OK || generation.type != TOKEN_INTEGER || generation.integer < 0 ||
+            lexer.next(keyword) != LEX_OK || keyword.type != TOKEN_KEYWORD || keyword.text != "obj") {
+            return nullptr;
+        }
+        return this->parseObject(lexer, 0);
+    });
+    if (value) WAVEPDF_COUNT(this->stats.bytesParsed, source.getPosition() - byteOffset);
+    if (!value || value->getType() != OBJT_DICTIONARY) return value;
+
+    // A dictionary followed by the stream keyword is the stream's dictionary
+    size_t dataStart = StreamBounds::findDataStart(source, source.getPosition());
+    if (dataStart == std::string::npos) return value;
+    std::shared_ptr<DictionaryObject> dict = std::dynamic_pointer_cast<DictionaryObject>(value);
+
+    std::optional<int64_t> length = this->resolveInteger(dict->getElement(NAME_LENGTH), depth);
+    size_t dataLength = StreamBounds::findDataLength(source, dataStart, length);
+    if (dataLength == std::string::npos) return nullptr;
+
+    size_t end = dataStart + dataLength;
+    WAVEPDF_COUNT(this->stats.bytesParsed, dataLength);
+    return std::make_shared<StreamObject>(byteOffset, end, dict, dataStart, dataLength);
+}
+
+// Function to get the value of an integer, following an indirect reference if needed
+std::optional<int64_t> PdfReader::resolveInteger(std::shared_ptr<BaseObject> obj, size_t depth) {
+    if (obj && obj->getType() == OBJT_INDIRECT) {
+        std::shared_ptr<ReferenceObject> reference = std::dynamic_pointer_cast<ReferenceObject>(obj);
+        obj = this->getObject(reference->getNumber(), reference->getGeneration(), depth + 1);
+    }
+    if (!obj || obj->getType() != OBJT_INTEGER) return std::nullopt;
+    return std::dynamic_pointer_cast<IntegerObject>(obj)->getValue();
+}
+
+// Function to read the /Filter chain of a stream with the /DecodeParms of each filter
+bool PdfReader::getFilters(const std::shared_ptr<DictionaryObject>& dict, std::vector<FilterSpec>& filters) {
+    // Filter & DecodeParms can be a single entry or arrays of entries applied in order
+    std::vector<std::shared_ptr<BaseObject>> names, parms;
+    std::shared_ptr<BaseObject> filter = this->resolve(dict->getElement(NAME_FILTER));
+    if (filter && filter->getType() == OBJT_ARRAY) {
+        names = std::dynamic_pointer_cast<ArrayObject>(filter)->getObjects();
+    } else if (filter && filter->getType() != OBJT_NULL) {
+        names.push_back(filter);
+    }
+    std::shared_ptr<BaseObject> decodeParms = this->resolve(dict->getElement(NAME_DECODE_PARMS));
+    if (decodeParms && decodeParms->getType() == OBJT_ARRAY) {
+        parms = std::dynamic_pointer_cast<ArrayObject>(decodeParms)->getObjects();
+    } else if (decodeParms) {
+        parms.push_back(decodeParms);
+    }
+
+    filters.clear();
+    for (size_t i = 0; i < names.size(); i++) {
+        std::shared_ptr<BaseObject> name = this->resolve(names[i]);
+        if (!name || name->getType() != OBJT_NAME) return false;
+        FilterSpec spec{std::dynamic_pointer_cast<NameObject>(name)->getAtom(), DecodeParams()};
+        std::shared_ptr<DictionaryObject> params = i < parms.size() ? std::dynamic_pointer_cast<DictionaryObject>(this->resolve(parms[i])) : nullptr;
+        if (params) {
+            spec.params.predictor = static_cast<int>(this->resolveInteger(params->getElement(NAME_PREDICTOR)).value_or(1));
+            spec.params.colors = static_cast<int>(this->resolveInteger(params->getElement(NAME_COLORS)).value_or(1));
+            spec.params.bitsPerComponent = static_cast<int>(this->resolveInteger(params->getElement(NAME_BITS_PER_COMPONENT)).value_or(8));
+            spec.params.columns = static_cast<int>(this->resolveInteger(params->getElement(NAME_COLUMNS)).value_or(1));
+            spec.params.earlyChange = static_cast<int>(this->resolveInteger(params->getElement(NAME_EARLY_CHANGE)).value_or(1));
+        }
+        filters.push_back(spec);
+    }
+    return true;
+}
+
+// Function to open the data of a stream as a pull pipeline through its /Filter chain
+std::unique_ptr<ByteSource> PdfReader::openStream(const std::shared_ptr<StreamObject>& stream) {
+    std::vector<FilterSpec> filters;
+    if (!this->getFilters(stream->getDictionary(), filters)) return nullptr;
+    std::unique_ptr<ByteSource> source = std::make_unique<BufferSource>(this->buffer, stream->getDataStart(), stream->getDataLength());
+    return FilterPipeline::create(std::move(source), filters);
+}
+
+// Function to decode the data of a stream from the file through its /Filter chain
+bool PdfReader::decodeStream(const std::shared_ptr<StreamObject>& stream, std::string& output) {
+    WAVEPDF_PHASE(this->stats, PHASE_DECODE_STREAMS, this->trace.get());
+    std::unique_ptr<ByteSource> source = this->openStream(stream);
+    if (!source) return false;
+    return readAll(*source, output, stream->getDataLength());
+}
+
+// Function to copy the still encoded data of a stream from the file
+bool PdfReader::readStreamData(const std::shared_ptr<StreamObject>& stream, std::string& output) {
+    BufferSource source(this->buffer, stream->getDataStart(), stream->getDataLength());
+    return readAll(source, output, stream->getDataLength());
+}
+
+// Function to write the file as it is to a stream, one view of the buffer at a time
+bool PdfReader::copyFile(std::ostream& out) {
+    if (!this->buffer.isReady()) return false;
+    size_t size = this->buffer.getSize();
+    for (size_t pos = 0; pos < size && out;) {
+        std::string_view chunk = this->buffer.viewSpan(pos, std::min(FILE_COPY_CHUNK, size - pos));
+        if (chunk.empty()) return false;
+        out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        pos += chunk.size();
+    }
+    return static_cast<bool>(out);
+}
+
+// Function to get the decoded data of a stream object, from the stream cache if it was decoded before
+std::shared_ptr<const std::string> PdfReader::getDecodedStream(size_t number, uint16_t generation) {
+    if (this->streamCache) {
+        std::shared_ptr<const std::string> cached = this->streamCache->get(this->documentId, number, generation);
+        if (cached) return cached;
+    }
+    std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(this->getObject(number, generation));
+    if (!stream) return nullptr;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::shared_ptr<std::string> data = std::make_shared<std::string>();
+    if (!this->decodeStream(stream, *data)) return nullptr;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (this->streamCache) this->streamCache->put(this->documentId, number, generation, data, seconds);
+    return data;
+}
+
+void PdfReader::setStreamCache(StreamCache* cache) {
+    if (this->streamCache && this->streamCache != cache) this->streamCache->removeDocument(this->documentId);
+    this->streamCache = cache;
+}
+
+std::shared_ptr<BaseObject> PdfReader::getObject(size_t number, uint16_t generation) {
+    return this->getObject(number, generation, 0);
+}
+
+// Function to get an indirect object from the cache, or load it through the xref index
+std::shared_ptr<BaseObject> PdfReader::getObject(size_t number, uint16_t generation, size_t depth) {
+    std::shared_ptr<BaseObject> cached = this->objectCache.get(number, generation);
+    if (cached) return cached;
+
+    // References to free entries or other generations are references to the null object
+    std::optional<xrefEntry> entry = this->xrefIndex.lookup(number);
+    if (!entry.has_value() || entry->type == 'f' || entry->generation != generation) return nullptr;
+
+    // An object needed to load itself (e.g. a stream whose /Length points to the stream) is a cycle
+    uint64_t key = (static_cast<uint64_t>(number) << 16) | generation;
+    if (!this->loadingObjects.insert(key).second) {
+        this->objectCache.getStats().cyclesDetected++;
+        return nullptr;
+    }
+    std::shared_ptr<BaseObject> obj;
+    {
+#if WAVEPDF_INSTRUMENTATION
+        // Nested loads (e.g. an indirect /Length) are part of the outer one
+        std::optional<ScopedPhase> phase;
+        if (depth == 0) phase.emplace(this->stats, PHASE_RESOLVE_OBJECTS, this->trace.get());
+#endif
+        obj = this->loadObject(entry.value(), depth);
+    }
+    this->loadingObjects.erase(key);
+
+    if (obj) {
+        WAVEPDF_COUNT(this->stats.objectsParsed, 1);
+        this->objectCache.getStats().objectsParsed++;
+        this->objectCache.put(number, generation, obj);
+    }
+    return obj;
+}
+
+// Function to follow indirect references until a direct object is reached
+std::shared_ptr<BaseObject> PdfReader::resolve(std::shared_ptr<BaseObject> obj) {
+    std::unordered_set<uint64_t> followed;
+    while (obj && obj->getType() == OBJT_INDIRECT) {
+        std::shared_ptr<ReferenceObject> reference = std::dynamic_pointer_cast<ReferenceObject>(obj);
+        uint64_t key = (static_cast<uint64_t>(reference->getNumber()) << 16) | reference->getGeneration();
+        if (!followed.insert(key).second) {
+            this->objectCache.getStats().cyclesDetected++;
+            return nullptr;
+        }
+        obj = this->getObject(reference->getNumber(), reference->getGeneration());
+    }
+    return obj;
+}
+
+// Function to parse the object an xref entry points to, nullptr if it can't be parsed
+std::shared_ptr<BaseObject> PdfReader::loadObject(const xrefEntry& entry, size_t depth) {
+    // Long chains of objects needed to load each other would exhaust the stack
+    if (depth > MAX_RESOLVE_DEPTH) return nullptr;
+
+    try {
+        if (entry.type == 'n') {
+            size_t start = entry.entryOne + this->buffer.getArbitraryStartByteOffset();
+            if (start >= this->buffer.getSize()) return nullptr;
+            return this->parseIndirectObject(this->buffer, start, depth);
+        }
+        if (entry.type == 'c') {
+            ObjectStreamData* objectStream = this->loadObjectStream(entry.entryOne, depth);
+            if (!objectStream || entry.streamIndex >= objectStream->objects.size()) return nullptr;
+            const std::pair<size_t, size_t>& object = objectStream->objects[entry.streamIndex];
+            if (object.first != entry.number || object.second >= objectStream->data->getSize()) return nullptr;
+            return this->parseObject(*objectStream->data, object.second);
+        }
+    } catch (const std::runtime_error&) {
+        // Object runs past the end of its buffer
+    }
+    return nullptr;
+}
+
+// Function to decode an object stream once & cache its data with the object offsets
+ObjectStreamData* PdfReader::loadObjectStream(size_t number, size_t depth) {
+    auto cached = this->objectStreams.find(number);
+    if (cached != this->objectStreams.end()) return &cached->second;
+
+    std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(this->getObject(number, 0, depth + 1));
+    if (!stream) return nullptr;
+    std::shared_ptr<DictionaryObject> dict = stream->getDictionary();
+    std::optional<int64_t> count = this->resolveInteger(dict->getElement(NAME_N), depth);
+    std::optional<int64_t> first = this->resolveInteger(dict->getElement(NAME_FIRST), depth);
+    if (!count.has_value() || !first.has_value() || count.value() < 0 || first.value() < 0) return nullptr;
+
+    std::string data;
+    if (!this->decodeStream(stream, data)) return nullptr;
+
+    ObjectStreamData objectStream;
+    objectStream.data = Buffer::fromData(std::move(data));
+    if (!objectStream.data->isReady() || objectStream.data->getSize() == 0) return nullptr;
+
+    // Header holds pairs of object number & offset relative to /First
+    Lexer lexer(objectStream.data->viewSpan(0, static_cast<size_t>(first.value())));
+    Token objNumber, objOffset;
+    for (int64_t i = 0; i < count.value(); i++) {
+        if (lexer.next(objNumber) != LEX_OK || lexer.next(objOffset) != LEX_OK) return nullptr;
+        if (objNumber.type != TOKEN_INTEGER || objOffset.type != TOKEN_INTEGER || objNumber.integer < 0 || objOffset.integer < 0) return nullptr;
+        objectStream.objects.push_back({static_cast<size_t>(objNumber.integer), static_cast<size_t>(first.value() + objOffset.integer)});
+    }
+
+    return &this->objectStreams.emplace(number, std::move(objectStream)).first->second;
+}
+
+// Function to parse all objects of the newest revision into the arena
+bool PdfReader::parseDocument(size_t threads) {
+    if (this->xrefIndex.getEntryCount() == 0) {
+        this->setError("Can't parse document", "No xref index, process() has to succeed first");
+        return false;
+    }
+    WAVEPDF_PHASE(this->stats, PHASE_PARSE_DOCUMENT, this->trace.get());
+    this->releaseDocument();
+    // Work & memory follow the xref entries, numbers beyond the xref's dense array get map slots
+    std::vector<size_t> numbers = this->xrefIndex.getObjectNumbers();
+    this->documentObjects.resize(this->xrefIndex.getDenseCount());
+    for (size_t number: numbers) {
+        if (number >= this->documentObjects.size()) this->sparseDocumentObjects.emplace(number, Value());
+    }
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    // More workers than grains would only idle
+    size_t grains = (numbers.size() + DOCUMENT_PARSE_GRAIN - 1) / DOCUMENT_PARSE_GRAIN;
+    threads = std::max<size_t>(1, std::min(threads, grains));
+
+    // Each worker reads through its own cursor, a single worker can use the reader's buffer
+    std::vector<std::unique_ptr<Buffer>> cursors;
+    for (size_t i = 0; threads > 1 && i < threads; i++) {
+        cursors.push_back(this->buffer.createCursor());
+        if (!cursors.back()->isReady()) {
+            wxLogDebug("PdfReader: can't open a second cursor on the file, parsing on one thread");
+            cursors.clear();
+            threads = 1;
+        }
+    }
+
+    // Object cache, object streams & the reader's own buffer are only touched under this lock
+    std::mutex lazyLock;
+    std::vector<ObjectArena> arenas(threads);
+    // Counted per worker & summed after the join
+    std::vector<size_t> workerObjects(threads), workerBytes(threads);
+    WorkStealingRange range(numbers.size(), threads, DOCUMENT_PARSE_GRAIN);
+
+    runOnWorkers(threads, [&](size_t worker) {
+        Buffer& source = threads == 1 ? this->buffer : *cursors[worker];
+        ValueParser parser(arenas[worker], this->names);
+        // Indirect /Length values are rare enough to go through the cached object path
+        ValueParser::LengthResolver resolveLength = [this, &lazyLock](size_t number, uint16_t generation) {
+            std::lock_guard<std::mutex> guard(lazyLock);
+            return this->resolveInteger(this->getObject(number, generation));
+        };
+        // Decoded object streams are shared, every worker reads them through its own cursors
+        std::unordered_map<size_t, std::unique_ptr<Buffer>> objectStreamCursors;
+
+        size_t begin, end;
+        while (!this->isCancelled() && range.next(worker, begin, end)) {
+            WAVEPDF_TRACE(this->trace.get(), "parseGrain");
+            for (size_t i = begin; i < end; i++) {
+                size_t number = numbers[i];
+                std::optional<xrefEntry> entry = this->xrefIndex.lookup(number);
+                if (!entry.has_value()) continue;
+
+                Value value = Value::makeInvalid();
+                try {
+                    if (entry->type == 'n') {
+                        size_t start = entry->entryOne + source.getArbitraryStartByteOffset();
+                        if (start < source.getSize()) {
+                            value = parser.parseIndirect(source, start, resolveLength);
+                            WAVEPDF_COUNT(workerBytes[worker], parser.getEnd() - start);
+                        }
+                    } else if (entry->type == 'c') {
+                        ObjectStreamData* objectStream;
+                        std::unique_ptr<Buffer>& objectStreamCursor = objectStreamCursors[entry->entryOne];
+                        {
+                            std::lock_guard<std::mutex> guard(lazyLock);
+                            objectStream = this->loadObjectStream(entry->entryOne, 0);
+                            if (objectStream && !objectStreamCursor) objectStreamCursor = objectStream->data->createCursor();
+                        }
+                        if (objectStream && entry->streamIndex < objectStream->objects.size()) {
+                            const std::pair<size_t, size_t>& object = objectStream->objects[entry->streamIndex];
+                            if (object.first == number && object.second < objectStreamCursor->getSize()) {
+                                value = parser.parse(*objectStreamCursor, object.second);
+                                WAVEPDF_COUNT(workerBytes[worker], parser.getEnd() - object.second);
+                            }
+                        }
+                    }
+                } catch (const std::runtime_error&) {
+                    // Object runs past the end of its buffer
+                }
+                // Every object number belongs to exactly one grain, no two workers write the same slot.
+                // Map slots were all created up front, workers only look them up
+                if (value.getType() != OBJT_INVALID) {
+                    Value& slot = number < this->documentObjects.size() ? this->documentObjects[number] : this->sparseDocumentObjects.find(number)->second;
+                    slot = value;
+                    WAVEPDF_COUNT(workerObjects[worker], 1);
+                }
+            }
+            if (this->control) this->control->objectsDone.fetch_add(end - begin, std::memory_order_relaxed);
+        }
+    });
+
+    // Values stay where the workers allocated them, the reader's arena just takes over the blocks
+    for (ObjectArena& workerArena: arenas) this->arena.adopt(workerArena);
+    if (this->isCancelled()) {
+        this->releaseDocument();
+        this->setError("Loading cancelled");
+        return false;
+    }
+    for (size_t i = 0; i < threads; i++) {
+        WAVEPDF_COUNT(this->stats.objectsParsed, workerObjects[i]);
+        WAVEPDF_COUNT(this->stats.bytesParsed, workerBytes[i]);
+    }
+    return true;
+}
+
+const Value& PdfReader::getDocumentObject(size_t number) const {
+    static const Value null;
+    if (number < this->documentObjects.size()) return this->documentObjects[number];
+    if (this->sparseDocumentObjects.empty()) return null;
+    auto found = this->sparseDocumentObjects.find(number);
+    return found == this->sparseDocumentObjects.end() ? null : found->second;
+}
+
+void PdfReader::releaseDocument() {
+    this->documentObjects.clear();
+    this->documentObjects.shrink_to_fit();
+    this->sparseDocumentObjects.clear();
+    this->arena.release();
+}
+
+ReaderStats PdfReader::getStats() {
+    ReaderStats current = this->stats;
+    current.cache = this->objectCache.getStats();
+    current.streams = this->getStreamCacheStats();
+    current.buffer = this->buffer.getStats();
+    current.arenaBytesUsed = this->arena.getBytesUsed();
+    current.arenaBytesReserved = this->arena.getBytesReserved();
+    return current;
+}
+
+// Buffer & stream cache stats belong to the file & are kept, cached objects are still cached
+void PdfReader::resetStats() {
+    this->stats = ReaderStats();
+    ObjectCacheStats& cache = this->objectCache.getStats();
+    cache.hits = cache.misses = cache.evictions = cache.objectsParsed = cache.cyclesDetected = 0;
+    if (this->trace) this->trace->clear();
+}
+
+void PdfReader::enableTrace(bool enable) {
+    if (!enable) {
+        this->trace.reset();
+    } else if (!this->trace) {
+        this->trace = std::make_unique<TraceRecorder>();
+    }
+}
+
 // Main function to be called to process the file path
 bool PdfReader::process() {
     if (!this->buffer.isReady()) return false;
+    this->indexLoaded = false;
+    if (!this->indexDirectory.empty() && this->loadIndex()) return true;
     if (!this->readFileHeader()) return false;
-    if (!this->validateEOF()) return false;
-    if (!this->parseXRefOffset()) return false;
-    if (!this->parseXRefTable()) return false;
-    
-    return true;
+
+    bool intact;
+    try {
+        intact = this->validateEOF() && this->parseXRefOffset() && this->parseXRefTable();
+    } catch (const std::runtime_error& e) {
+        // Offsets & ranges outside of the file
+        if (!this->recoveryEnabled) throw;
+        this->setError("Can't read file", e.what());
+        intact = false;
+    }
+    if (intact) {
+        if (!this->indexDirectory.empty()) this->saveIndex();
+        return true;
+    }
+
+    // Damaged end of file or xref, rebuild the index from the objects themselves
+    return this->recoveryEnabled && !this->isCancelled() && this->recoverXRef(this->recoveryThreads);
 }
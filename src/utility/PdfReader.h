@@ -2,79 +2,245 @@
 #define UTILITY_PDFREADER_H
 
 #include "objects/BaseObject.h"
+#include "objects/DictionaryObject.h"
+#include "objects/StreamObject.h"
+#include "objects/ObjectArena.h"
+#include "objects/NameManager.h"
+#include "objects/Value.h"
 #include "Buffer.h"
+#include "parser/Lexer.h"
+#include "ObjectCache.h"
+#include "StreamCache.h"
+#include "xref/XRefEntry.h"
+#include "xref/XRefIndex.h"
+#include "xref/TailLocator.h"
+#include "xref/ParseIndexFile.h"
+#include "filters/FilterPipeline.h"
+#include "instrumentation/Instrumentation.h"
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <optional>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <atomic>
+#include <ostream>
 #include <wx/string.h>
 #include <cstdint>
 
-struct xrefEntry {
-    size_t entryOne;
-    uint16_t generation;
-    size_t number;
-    char type;
-
-    // Equal operator for tests
-    bool operator==(const xrefEntry& other) const {
-        return entryOne == other.entryOne &&
-               generation == other.generation &&
-               number == other.number &&
-               type == other.type;
-    }
+// Initial window for reading the xref table through a windowed buffer
+constexpr size_t XREF_READ_WINDOW = 64 * 1024;
+
+// Bytes written at once when copying the file for a writer
+constexpr size_t FILE_COPY_CHUNK = 1024 * 1024;
+
+// Limit for nested object loads, e.g. a stream /Length stored in another object stream
+constexpr size_t MAX_RESOLVE_DEPTH = 16;
+
+// Decoded object stream (/Type /ObjStm) with the number & data offset of each object in it
+struct ObjectStreamData {
+    std::unique_ptr<Buffer> data;
+    std::vector<std::pair<size_t, size_t>> objects;
+};
+
+// Objects a worker takes at once when parsing the whole document in parallel
+constexpr size_t DOCUMENT_PARSE_GRAIN = 64;
+
+// One xref section of the /Prev chain with its trailer
+struct xrefRevision {
+    size_t offset;
+    std::shared_ptr<DictionaryObject> trailer;
 };
 
-struct xrefSubsection {
-    size_t startObject;
-    size_t amountObjects;
-    std::vector<xrefEntry> objects;
-    bool initDone = false;
-
-    // Equal operator for tests
-    bool operator==(const xrefSubsection& other) const {
-        return startObject == other.startObject &&
-               amountObjects == other.amountObjects &&
-               objects == other.objects;
-    }
+/* Shared with the thread driving a reader: process() & parseDocument() stop between xref
+    sections & grains once cancelled, parseDocument() counts the object numbers it went through */
+struct ReaderControl {
+    std::atomic<bool> cancelled{false};
+    std::atomic<size_t> objectsDone{0};
 };
 
 class PdfReader {
     public:
-        PdfReader(const wxString& filePath);
+        PdfReader(const wxString& filePath, const BufferOptions& bufferOptions = BufferOptions());
+        ~PdfReader();
+        PdfReader(const PdfReader&) = delete;
+        PdfReader& operator=(const PdfReader&) = delete;
         bool process();
 
         // Getter methods
         std::string getErrorMessage() { return errorMessage; }
         std::string getLog() { return log; }
         std::size_t getXRefOffset() {return xRefOffset; }
-        std::vector<xrefSubsection> getXRefTable() { return xrefTable; }
+        // Positions of %%EOF, startxref & the last trailer found by validateEOF() & parseXRefOffset()
+        const TailLocation& getTailLocation() { return tail; }
+        // Bytes at the end of the file searched for them, files with long trailing garbage need more
+        void setTailSearchWindow(size_t bytes) { tailWindow = bytes; }
+        // Table of the newest xref section as parsed, without copying. Built once after loading a parse index
+        const std::vector<xrefSubsection>& getXRefTable();
+        BufferStats getBufferStats() { return buffer.getStats(); }
+
+        // Revisions from incremental updates, the merged index resolves against the newest one
+        const XRefIndex& getXRefIndex() { return xrefIndex; }
+        XRefRevisionView getRevisionView(size_t revision) { return XRefRevisionView(xrefIndex, revision); }
+        size_t getRevisionCount() { return revisions.size(); }
+        // Trailer of a revision (0 = original file), the newest if no revision is given
+        std::shared_ptr<DictionaryObject> getTrailer(std::optional<size_t> revision = std::nullopt);
+
+        /* Indirect objects are parsed on first access through the xref index & cached, nullptr if missing.
+            Their names belong to the reader, the objects must not outlive it */
+        std::shared_ptr<BaseObject> getObject(size_t number, uint16_t generation = 0);
+        // Follow indirect references to a direct object, nullptr for missing objects & reference cycles
+        std::shared_ptr<BaseObject> resolve(std::shared_ptr<BaseObject> obj);
+        // Data of a stream decoded through its /Filter chain, e.g. page content. False for unsupported filters
+        bool decodeStream(const std::shared_ptr<StreamObject>& stream, std::string& output);
+        /* Same as a pipeline the decoded bytes are pulled from in chunks, for streams too large to
+            hold in memory. nullptr for unsupported filters, it must not outlive this reader */
+        std::unique_ptr<ByteSource> openStream(const std::shared_ptr<StreamObject>& stream);
+        /* Decoded data of a stream object through the stream cache, for streams used again & again
+            (fonts, images, form XObjects). nullptr if it isn't a stream or can't be decoded */
+        std::shared_ptr<const std::string> getDecodedStream(size_t number, uint16_t generation = 0);
+        // Cache used by getDecodedStream(), StreamCache::global() by default & nullptr to decode every time
+        void setStreamCache(StreamCache* cache);
+        // Hits, bytes & decode time saved for this document
+        StreamCacheStats getStreamCacheStats() { return streamCache ? streamCache->getStats(documentId) : StreamCacheStats(); }
+        void setObjectCacheLimits(size_t maxObjects, size_t maxBytes) { objectCache.setLimits(maxObjects, maxBytes); }
+        ObjectCacheStats getObjectCacheStats() { return objectCache.getStats(); }
+
+        /* Parse every object of the newest revision into one arena (whole document processing).
+            Values are handles into the arena, releaseDocument() frees all of them at once.
+            With more than one thread the objects are split over workers with their own cursor
+            & arena, 0 threads uses every core */
+        bool parseDocument(size_t threads = 1);
+        // Parsed value of an object, null if it is missing or couldn't be parsed
+        const Value& getDocumentObject(size_t number) const;
+        // parseDocument() succeeded & the model wasn't released since
+        bool hasDocument() const { return !documentObjects.empty() || !sparseDocumentObjects.empty(); }
+        void releaseDocument();
+        const ObjectArena& getArena() const { return arena; }
+
+        /* Steps of process() in the order they have to run, each can be repeated on its own
+            (benchmarks, tools). They throw std::logic_error if a previous step is missing */
+        bool readFileHeader();
+        bool validateEOF();
+        bool parseXRefOffset();
+        bool parseXRefTable();
+        // Parse the direct object starting at a byte position of the file, OBJT_INVALID if there is none
+        std::shared_ptr<BaseObject> parseObject(size_t byteOffset);
+
+        /* Damaged files (missing %%EOF, wrong startxref, broken xref sections): with recovery enabled
+            process() rebuilds the index by scanning the whole file for objects instead of failing */
+        void setRecovery(bool enable, size_t threads = 1) { recoveryEnabled = enable; recoveryThreads = threads; }
+        // Rebuild index & trailer from the objects in the file, 0 threads uses every core
+        bool recoverXRef(size_t threads = 1);
+        // Index comes from recoverXRef(), getLog() holds the reason
+        bool isRecovered() { return recovered; }
+
+        /* With an index directory process() takes the xref state of a file that didn't change from its
+            parse index file there instead of parsing it, & writes that file after parsing. Empty (default) is off */
+        void setIndexDirectory(const std::string& directory) { indexDirectory = directory; }
+        // Last process() restored the xref from a parse index file
+        bool isIndexLoaded() { return indexLoaded; }
+
+        /* Raw access for writers, nothing is decoded. Xref offsets count from the header offset
+            (bytes in front of %PDF-), stream data is copied as it is stored in the file */
+        const wxString& getFilePath() { return filePath; }
+        size_t getFileSize() { return buffer.getSize(); }
+        size_t getHeaderOffset() { return buffer.getArbitraryStartByteOffset(); }
+        const std::string& getPdfVersion() { return pdfVersion; }
+        // Independent reading position over the file for another thread, see Buffer::createCursor()
+        std::unique_ptr<Buffer> createCursor() { return buffer.createCursor(); }
+        // Newest xref section is a cross-reference stream, not a classic table
+        bool hasXRefStream() { return xRefOffset != std::string::npos && !isClassicXRefAt(xRefOffset); }
+        bool readStreamData(const std::shared_ptr<StreamObject>& stream, std::string& output);
+        // Write every byte of the file to a stream in chunks, the file is never held in memory at once
+        bool copyFile(std::ostream& out);
+
+        // Control of another thread (loaders), nullptr to detach. It has to outlive its use here
+        void setControl(ReaderControl* control) { this->control = control; }
+        bool isCancelled() { return control && control->cancelled.load(std::memory_order_relaxed); }
+
+        /* Phase timers & counters since construction or resetStats(), buffer & cache stats included.
+            Timers & parser counters stay zero in builds without WAVEPDF_INSTRUMENTATION */
+        ReaderStats getStats();
+        void resetStats();
+        // Record every phase (& every parseDocument() grain) as an event in Chrome trace JSON
+        void enableTrace(bool enable = true);
+        std::string getTraceJson() { return trace ? trace->toJson() : TraceRecorder().toJson(); }
+        bool writeTrace(const std::string& path) { return trace ? trace->writeJson(path) : TraceRecorder().writeJson(path); }
     private:
         // Helper methods:
         void setError(const std::string& msg, const std::optional<std::string>& log = std::nullopt);
-        size_t getNextContentPos(const std::string& read, size_t start);
+        size_t getNextContentPos(std::string_view read, size_t start);
         std::vector<std::string> split(const std::string& text, char delimiter);
         bool canConvertToSizeT(const std::string& s);
 
         // Important: Helper method for actually parsing objects
-        std::shared_ptr<BaseObject> parseObject(size_t byteOffset);
+        std::shared_ptr<BaseObject> parseObject(Buffer& source, size_t byteOffset);
+        std::shared_ptr<BaseObject> parseObject(Lexer& lexer, size_t depth);
+        std::shared_ptr<BaseObject> parseObject(Lexer& lexer, const Token& token, size_t depth);
+        std::shared_ptr<BaseObject> parseIndirectObject(Buffer& source, size_t byteOffset, size_t depth = 0);
+        bool getFilters(const std::shared_ptr<DictionaryObject>& dict, std::vector<FilterSpec>& filters);
+        std::optional<int64_t> resolveInteger(std::shared_ptr<BaseObject> obj, size_t depth = 0);
+        std::shared_ptr<BaseObject> getObject(size_t number, uint16_t generation, size_t depth);
+        std::shared_ptr<BaseObject> loadObject(const xrefEntry& entry, size_t depth);
+        ObjectStreamData* loadObjectStream(size_t number, size_t depth);
 
         // Methods used for PdfReader::process()
-        bool readFileHeader();
-        bool validateEOF();
-        bool parseXRefOffset();
-        bool parseXRefTable();
+        bool isClassicXRefAt(size_t offset);
+        bool parseXRefStream(size_t offset, std::vector<xrefSubsection>& subsections, std::shared_ptr<DictionaryObject>& trailer);
+        bool parseXRefAt(size_t offset, std::vector<xrefSubsection>& subsections, size_t& trailerPos);
+        bool parseXRefSection(std::string_view xRefRead, bool viewIsComplete, bool& truncated, std::vector<xrefSubsection>& subsections, size_t& trailerPos);
+        std::shared_ptr<DictionaryObject> parseTrailer(size_t trailerPos);
+        bool loadIndex();
+        void saveIndex();
 
         // General attributes:
         wxString filePath;
         Buffer buffer;
+        // Names of this document's objects, released once the objects using them are gone
+        NameScope names;
 
         // Data parsed from PDF
         std::string pdfVersion;
         bool pdfIsBinary;
         size_t xRefOffset = std::string::npos;
+        TailLocation tail;
+        size_t tailWindow = TAIL_SEARCH_WINDOW;
         std::vector<xrefSubsection> xrefTable;
+        // Newest revision first, in /Prev chain order
+        std::vector<xrefRevision> revisions;
+        XRefIndex xrefIndex;
+        // Object streams are decoded once, keyed by their object number
+        std::unordered_map<size_t, ObjectStreamData> objectStreams;
+
+        // Lazily loaded indirect objects & the ones currently being loaded (cycle detection)
+        ObjectCache objectCache;
+        std::unordered_set<uint64_t> loadingObjects;
+
+        // Decoded streams of this document are cached under its process wide id
+        uint64_t documentId = StreamCache::newDocumentId();
+        StreamCache* streamCache = &StreamCache::global();
+
+        // Arena object model of the whole document, indexed by object number up to the xref's dense count
+        ObjectArena arena;
+        std::vector<Value> documentObjects;
+        std::unordered_map<size_t, Value> sparseDocumentObjects;
+
+        bool recoveryEnabled = false;
+        size_t recoveryThreads = 1;
+        bool recovered = false;
+        ReaderControl* control = nullptr;
+        std::string indexDirectory;
+        bool indexLoaded = false;
+        // Layout of the newest table after loading a parse index, the table is built from it on first use
+        std::vector<ParseIndexSubsection> indexedTable;
+
+        // Instrumentation, the trace only exists while enabled
+        ReaderStats stats;
+        std::unique_ptr<TraceRecorder> trace;
 
         // For error handling
         std::string errorMessage;
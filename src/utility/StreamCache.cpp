@@ -0,0 +1,135 @@
+#include "StreamCache.h"
+
+#include <atomic>
+
+// Bookkeeping per cached stream on top of its data
+static constexpr size_t ENTRY_OVERHEAD = 128;
+// Decode time every entry is at least worth, so instant decodes still rank by size
+static constexpr double MIN_DECODE_SECONDS = 1e-6;
+
+StreamCache& StreamCache::global() {
+    static StreamCache cache;
+    return cache;
+}
+
+uint64_t StreamCache::newDocumentId() {
+    static std::atomic<uint64_t> next{1};
+    return next++;
+}
+
+double StreamCache::priority(const Entry& entry) const {
+    double seconds = entry.decodeSeconds > MIN_DECODE_SECONDS ? entry.decodeSeconds : MIN_DECODE_SECONDS;
+    // Microseconds per KB keeps the values in a comfortable range
+    return this->inflation + seconds * 1e6 / (static_cast<double>(entry.cost) / 1024);
+}
+
+std::shared_ptr<const std::string> StreamCache::get(uint64_t document, size_t number, uint16_t generation) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    StreamCacheStats& stats = this->documents[document];
+    auto found = this->entries.find(makeKey(document, number, generation));
+    if (found == this->entries.end()) {
+        stats.misses++;
+        return nullptr;
+    }
+    Entry& entry = found->second;
+    stats.hits++;
+    stats.bytesSaved += entry.data->size();
+    stats.secondsSaved += entry.decodeSeconds;
+
+    // A hit restores the full value on top of the current age
+    this->queue.erase(entry.queued);
+    entry.queued = this->queue.emplace(this->priority(entry), found->first);
+    return entry.data;
+}
+
+void StreamCache::put(uint64_t document, size_t number, uint16_t generation, std::shared_ptr<const std::string> data, double decodeSeconds) {
+    if (!data) return;
+    size_t cost = ENTRY_OVERHEAD + data->size();
+    std::lock_guard<std::mutex> lock(this->mutex);
+    Key key = makeKey(document, number, generation);
+    auto found = this->entries.find(key);
+    if (found != this->entries.end()) this->erase(found);
+    if (cost > this->maxBytes) return;
+
+    Entry entry{std::move(data), cost, decodeSeconds, {}};
+    entry.queued = this->queue.emplace(this->priority(entry), key);
+    this->entries.emplace(key, std::move(entry));
+    this->bytes += cost;
+
+    StreamCacheStats& stats = this->documents[document];
+    stats.insertions++;
+    stats.cachedStreams++;
+    stats.cachedBytes += cost;
+    this->evict();
+}
+
+void StreamCache::erase(std::unordered_map<Key, Entry, KeyHash>::iterator found) {
+    StreamCacheStats& stats = this->documents[found->first.document];
+    stats.cachedStreams--;
+    stats.cachedBytes -= found->second.cost;
+    this->bytes -= found->second.cost;
+    this->queue.erase(found->second.queued);
+    this->entries.erase(found);
+}
+
+// Drop the entries with the lowest priority until the budget holds
+void StreamCache::evict() {
+    while (this->bytes > this->maxBytes && !this->queue.empty()) {
+        auto lowest = this->queue.begin();
+        this->inflation = lowest->first;
+        auto found = this->entries.find(lowest->second);
+        this->documents[found->first.document].evictions++;
+        this->erase(found);
+    }
+}
+
+void StreamCache::removeDocument(uint64_t document) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (auto it = this->entries.begin(); it != this->entries.end();) {
+        auto current = it++;
+        if (current->first.document == document) this->erase(current);
+    }
+    this->documents.erase(document);
+}
+
+void StreamCache::clear() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->entries.clear();
+    this->queue.clear();
+    this->documents.clear();
+    this->bytes = 0;
+    this->inflation = 0;
+}
+
+void StreamCache::setMaxBytes(size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->maxBytes = maxBytes;
+    this->evict();
+}
+
+size_t StreamCache::getMaxBytes() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->maxBytes;
+}
+
+StreamCacheStats StreamCache::getStats(uint64_t document) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto found = this->documents.find(document);
+    return found != this->documents.end() ? found->second : StreamCacheStats();
+}
+
+StreamCacheStats StreamCache::getStats() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    StreamCacheStats total;
+    for (const auto& [document, stats]: this->documents) {
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.insertions += stats.insertions;
+        total.evictions += stats.evictions;
+        total.bytesSaved += stats.bytesSaved;
+        total.secondsSaved += stats.secondsSaved;
+        total.cachedStreams += stats.cachedStreams;
+        total.cachedBytes += stats.cachedBytes;
+    }
+    return total;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+struct StreamCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t insertions = 0;
+    size_t evictions = 0;
+    // Decoded bytes & decode time the hits didn't have to spend again
+    size_t bytesSaved = 0;
+    double secondsSaved = 0;
+    size_t cachedStreams = 0;
+    size_t cachedBytes = 0;
+
+    double hitRate() const { return hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0; }
+};
+
+/* Decoded stream data (fonts, images, form XObjects) keyed by (document, object number,
+    generation). Process wide & thread safe, the data is shared & immutable so readers keep
+    using it after it was evicted. Eviction is GreedyDual-Size: every entry is worth its
+    decode time per byte, the cheapest to decode again per byte freed goes first & the
+    value of the evicted entry ages the others, so entries that stop being hit leave too */
+class StreamCache {
+    public:
+        explicit StreamCache(size_t maxBytes = 64 * 1024 * 1024) : maxBytes(maxBytes) {};
+        StreamCache(const StreamCache&) = delete;
+        StreamCache& operator=(const StreamCache&) = delete;
+
+        // Cache shared by every PdfReader unless they are given another one
+        static StreamCache& global();
+        // Id of a new document, unique in the process
+        static uint64_t newDocumentId();
+
+        // nullptr if not cached, counts hit or miss for the document
+        std::shared_ptr<const std::string> get(uint64_t document, size_t number, uint16_t generation);
+        // Data larger than the whole budget isn't kept
+        void put(uint64_t document, size_t number, uint16_t generation, std::shared_ptr<const std::string> data, double decodeSeconds);
+        // Drop the entries & stats of a document that was closed
+        void removeDocument(uint64_t document);
+        void clear();
+
+        void setMaxBytes(size_t maxBytes);
+        size_t getMaxBytes();
+        StreamCacheStats getStats(uint64_t document);
+        // Summed over all documents
+        StreamCacheStats getStats();
+
+    private:
+        struct Key {
+            uint64_t document;
+            uint64_t object;
+            bool operator==(const Key& other) const { return document == other.document && object == other.object; }
+        };
+        struct KeyHash {
+            size_t operator()(const Key& key) const { return std::hash<uint64_t>()(key.document * 0x9E3779B97F4A7C15ULL ^ key.object); }
+        };
+        struct Entry {
+            std::shared_ptr<const std::string> data;
+            size_t cost;
+            double decodeSeconds;
+            std::multimap<double, Key>::iterator queued;
+        };
+
+        static Key makeKey(uint64_t document, size_t number, uint16_t generation) { return Key{document, (static_cast<uint64_t>(number) << 16) | generation}; }
+        // Value of an entry when it is inserted or hit
+        double priority(const Entry& entry) const;
+        void erase(std::unordered_map<Key, Entry, KeyHash>::iterator found);
+        void evict();
+
+        std::mutex mutex;
+        size_t maxBytes;
+        size_t bytes = 0;
+        // Priority of the last evicted entry, added to new priorities so old entries age
+        double inflation = 0;
+
+        std::unordered_map<Key, Entry, KeyHash> entries;
+        // Lowest priority first
+        std::multimap<double, Key> queue;
+        std::unordered_map<uint64_t, StreamCacheStats> documents;
+};
@@ -0,0 +1,171 @@
+#include "BatchRunner.h"
+#include "BoundedQueue.h"
+#include "../PdfReader.h"
+#include "../parallel/WorkStealingRange.h"
+
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <thread>
+#include <stdexcept>
+#include <wx/log.h>
+
+static bool hasPdfExtension(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+    return extension == ".pdf";
+}
+
+// Nearest rank percentile of sorted values
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+BatchSummary BatchRunner::run(const std::vector<std::string>& inputs, const ResultCallback& onResult) {
+    size_t threads = this->options.threads > 0 ? this->options.threads : std::max(1u, std::thread::hardware_concurrency());
+    BoundedQueue<std::string> queue(this->options.queueCapacity);
+    std::mutex resultLock;
+    std::vector<DocumentResult> results;
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+
+    // Producer runs next to the workers, so the first documents start before the directory walk is done
+    std::thread producer([&inputs, &queue] {
+        for (const std::string& input: inputs) {
+            std::error_code error;
+            if (!std::filesystem::is_directory(input, error)) {
+                // Files that don't exist are reported as failed documents
+                if (!queue.push(input)) return;
+                continue;
+            }
+            std::filesystem::recursive_directory_iterator it(input, std::filesystem::directory_options::skip_permission_denied, error);
+            for (; !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+                std::error_code fileError;
+                if (!it->is_regular_file(fileError) || !hasPdfExtension(it->path())) continue;
+                if (!queue.push(it->path().string())) return;
+            }
+        }
+        queue.close();
+    });
+
+    auto work = [&](size_t /*worker*/) {
+        // Failure reasons are collected per document, wxLog output would only interleave
+        wxLogNull noLog;
+        std::string path;
+        while (queue.pop(path)) {
+            DocumentResult result = this->processDocument(path);
+            std::lock_guard<std::mutex> guard(resultLock);
+            if (onResult) onResult(result);
+            // Paths & logs aren't needed for the summary
+            result.path.clear();
+            result.log.clear();
+            results.push_back(std::move(result));
+        }
+    };
+    try {
+        runOnWorkers(threads, work);
+    } catch (...) {
+        // Unblock the producer before giving up
+        queue.close();
+        producer.join();
+        throw;
+    }
+    producer.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return summarize(results, seconds);
+}
+
+DocumentResult BatchRunner::processDocument(const std::string& path) {
+    DocumentResult result;
+    result.path = path;
+    std::error_code error;
+    uintmax_t size = std::filesystem::file_size(path, error);
+    result.bytes = error ? 0 : static_cast<size_t>(size);
+
+    size_t charge = this->memoryCharge(result.bytes);
+    this->acquire(charge);
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    try {
+        PdfReader reader(path, this->options.bufferOptions);
+        reader.setRecovery(this->options.recoverXRef);
+        reader.setIndexDirectory(this->options.indexDirectory);
+        result.ok = reader.process();
+        if (result.ok && this->options.parseObjects) result.ok = reader.parseDocument();
+        if (result.ok) {
+            result.objects = reader.getXRefIndex().getObjectCount();
+        } else {
+            result.errorMessage = reader.getErrorMessage();
+            result.log = reader.getLog();
+        }
+    } catch (const std::exception& e) {
+        result.ok = false;
+        result.errorMessage = "Exception while processing";
+        result.log = e.what();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    this->release(charge);
+
+    if (!result.ok && result.errorMessage.empty()) result.errorMessage = "Unknown error";
+    return result;
+}
+
+bool BatchRunner::readFileList(const std::string& listPath, std::vector<std::string>& paths) {
+    std::ifstream list(listPath);
+    if (!list) return false;
+    std::string line;
+    while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) paths.push_back(line);
+    }
+    return true;
+}
+
+BatchSummary BatchRunner::summarize(const std::vector<DocumentResult>& results, double seconds) {
+    BatchSummary summary;
+    summary.seconds = seconds;
+    std::vector<double> latencies;
+    latencies.reserve(results.size());
+    for (const DocumentResult& result: results) {
+        summary.documents++;
+        summary.bytes += result.bytes;
+        latencies.push_back(result.seconds);
+        if (!result.ok) {
+            summary.failures++;
+            summary.failureReasons[result.errorMessage]++;
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    summary.latencyP50 = percentile(latencies, 0.5);
+    summary.latencyP99 = percentile(latencies, 0.99);
+    summary.latencyMax = latencies.empty() ? 0 : latencies.back();
+    return summary;
+}
+
+// Documents larger than the whole budget are still processed, just alone
+void BatchRunner::acquire(size_t bytes) {
+    std::unique_lock<std::mutex> lock(this->resourceLock);
+    this->resourceFreed.wait(lock, [this, bytes] {
+        return this->openFiles < std::max<size_t>(this->options.maxOpenFiles, 1) &&
+            (this->bytesInFlight == 0 || this->bytesInFlight + bytes <= this->options.memoryBudget);
+    });
+    this->openFiles++;
+    this->bytesInFlight += bytes;
+}
+
+void BatchRunner::release(size_t bytes) {
+    std::lock_guard<std::mutex> lock(this->resourceLock);
+    this->openFiles--;
+    this->bytesInFlight -= bytes;
+    this->resourceFreed.notify_all();
+}
+
+// Windowed buffers never hold more than their cap, the other modes the whole file
+size_t BatchRunner::memoryCharge(size_t fileSize) const {
+    if (this->options.bufferOptions.mode == BUFFER_WINDOWED) return std::min(fileSize, this->options.bufferOptions.memoryCap);
+    return fileSize;
+}
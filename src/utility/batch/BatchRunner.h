@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../Buffer.h"
+
+#include <vector>
+#include <string>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+struct BatchOptions {
+    // Documents processed at once, 0 uses every core
+    size_t threads = 0;
+    // Back-pressure: documents open at the same time & their bytes in memory
+    size_t maxOpenFiles = 64;
+    size_t memoryBudget = size_t(1024) * 1024 * 1024;
+    // Paths waiting for a worker, the directory walk blocks while the queue is full
+    size_t queueCapacity = 1024;
+    BufferOptions bufferOptions;
+    // Also parse every object of each document into its arena
+    bool parseObjects = false;
+    // Rebuild the xref of damaged documents by scanning for objects
+    bool recoverXRef = false;
+    // Parse index files of the documents are kept there, empty to parse every document fully
+    std::string indexDirectory;
+};
+
+struct DocumentResult {
+    std::string path;
+    size_t bytes = 0;
+    double seconds = 0;
+    bool ok = false;
+    // From PdfReader::getErrorMessage() & getLog() for failed documents
+    std::string errorMessage;
+    std::string log;
+    size_t objects = 0;
+};
+
+struct BatchSummary {
+    size_t documents = 0;
+    size_t failures = 0;
+    size_t bytes = 0;
+    // Wall time of the whole batch
+    double seconds = 0;
+    // Per document processing time
+    double latencyP50 = 0;
+    double latencyP99 = 0;
+    double latencyMax = 0;
+    // Error message -> number of documents failing with it
+    std::map<std::string, size_t> failureReasons;
+
+    double documentsPerSecond() const { return seconds > 0 ? documents / seconds : 0; }
+    double megabytesPerSecond() const { return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0; }
+};
+
+/* Runs PdfReader::process() headless over many documents on a bounded pool of threads.
+    Inputs are files or directories (searched recursively for .pdf files), they are
+    enumerated while the workers run & fed through a bounded queue */
+class BatchRunner {
+    public:
+        // Called once per document from the worker threads, never concurrently
+        using ResultCallback = std::function<void(const DocumentResult&)>;
+
+        explicit BatchRunner(const BatchOptions& options) : options(options) {};
+
+        BatchSummary run(const std::vector<std::string>& inputs, const ResultCallback& onResult = nullptr);
+        DocumentResult processDocument(const std::string& path);
+
+        // Append the paths of a list file, one per line & empty lines skipped. False if it can't be read
+        static bool readFileList(const std::string& listPath, std::vector<std::string>& paths);
+        static BatchSummary summarize(const std::vector<DocumentResult>& results, double seconds);
+
+    private:
+        // Blocks until a document of the given size fits into the open file & memory limits
+        void acquire(size_t bytes);
+        void release(size_t bytes);
+        size_t memoryCharge(size_t fileSize) const;
+
+        BatchOptions options;
+
+        std::mutex resourceLock;
+        std::condition_variable resourceFreed;
+        size_t openFiles = 0;
+        size_t bytesInFlight = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+/* Blocking FIFO with a fixed capacity, push() waits while it is full so a fast
+    producer can't run ahead of the consumers. close() wakes everybody up, pop()
+    drains what is left & returns false afterwards */
+template <typename T>
+class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity) : capacity(capacity > 0 ? capacity : 1) {};
+
+        // False if the queue was closed, the item is dropped then
+        bool push(T item) {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->notFull.wait(lock, [this] { return this->closed || this->items.size() < this->capacity; });
+            if (this->closed) return false;
+            this->items.push_back(std::move(item));
+            this->notEmpty.notify_one();
+            return true;
+        }
+
+        // False once the queue is closed & empty
+        bool pop(T& item) {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->notEmpty.wait(lock, [this] { return this->closed || !this->items.empty(); });
+            if (this->items.empty()) return false;
+            item = std::move(this->items.front());
+            this->items.pop_front();
+            this->notFull.notify_one();
+            return true;
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->closed = true;
+            this->notEmpty.notify_all();
+            this->notFull.notify_all();
+        }
+
+    private:
+        size_t capacity;
+        std::deque<T> items;
+        bool closed = false;
+        std::mutex mutex;
+        std::condition_variable notEmpty;
+        std::condition_variable notFull;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+// Access pattern hints a backend may forward to the OS (madvise for mapped files)
+enum BufferAdvice {
+    ADVICE_NORMAL,
+    ADVICE_SEQUENTIAL,
+    ADVICE_RANDOM,
+    ADVICE_WILLNEED
+};
+
+// Contiguous run of bytes handed out by a backend, starting at byte position start
+struct BufferChunk {
+    const char* data = nullptr;
+    size_t start = 0;
+    size_t length = 0;
+};
+
+// Block cache counters, only the windowed backend fills them
+struct BufferStats {
+    size_t blockHits = 0;
+    size_t blockMisses = 0;
+    size_t blockEvictions = 0;
+    size_t bytesRead = 0;
+    size_t residentBytes = 0;
+};
+
+/* Storage behind a Buffer. Contiguous backends hand out the whole file as one chunk,
+    others fault in smaller chunks on demand. A chunk stays valid until the next fetch() */
+class BufferBackend {
+    public:
+        virtual ~BufferBackend() = default;
+        virtual bool isReady() = 0;
+        virtual size_t getSize() = 0;
+        virtual bool isContiguous() = 0;
+        // Return a chunk containing pos (pos < getSize())
+        virtual BufferChunk fetch(size_t pos) = 0;
+        virtual void advise(size_t /*start*/, size_t /*length*/, BufferAdvice /*advice*/) {}
+        virtual BufferStats getStats() { return BufferStats{}; }
+};
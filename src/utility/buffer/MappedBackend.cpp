@@ -0,0 +1,77 @@
+#include "MappedBackend.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WAVEPDF_HAS_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedBackend::MappedBackend(const wxString& filePath) {
+#ifdef WAVEPDF_HAS_MMAP
+    int fd = open(filePath.fn_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat info;
+    // Only regular files can be mapped, pipes & devices need another backend
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        return;
+    }
+    this->size = static_cast<size_t>(info.st_size);
+
+    if (this->size == 0) {
+        // mmap rejects empty mappings, an empty file is still a valid (empty) buffer
+        close(fd);
+        this->ready = true;
+        return;
+    }
+
+    void* mapped = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        this->size = 0;
+        return;
+    }
+
+    /* Parsing jumps between the tail, the xref & single objects,
+        readahead would pull in big image streams we never touch */
+    madvise(mapped, this->size, MADV_RANDOM);
+
+    this->data = static_cast<const char*>(mapped);
+    this->ready = true;
+#endif
+}
+
+MappedBackend::~MappedBackend() {
+#ifdef WAVEPDF_HAS_MMAP
+    if (this->data != nullptr) {
+        munmap(const_cast<char*>(this->data), this->size);
+    }
+#endif
+}
+
+void MappedBackend::advise(size_t start, size_t length, BufferAdvice advice) {
+#ifdef WAVEPDF_HAS_MMAP
+    if (this->data == nullptr || start >= this->size) return;
+    if (length > this->size - start) length = this->size - start;
+
+    // madvise needs a page aligned start address
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignedStart = start - (start % pageSize);
+    length += start - alignedStart;
+
+    int flag = MADV_NORMAL;
+    switch (advice) {
+        case ADVICE_SEQUENTIAL: flag = MADV_SEQUENTIAL; break;
+        case ADVICE_RANDOM: flag = MADV_RANDOM; break;
+        case ADVICE_WILLNEED: flag = MADV_WILLNEED; break;
+        default: break;
+    }
+    madvise(const_cast<char*>(this->data) + alignedStart, length, flag);
+#endif
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "BufferBackend.h"
+#include <wx/string.h>
+
+/* Backend mapping the file read-only into the address space. Opening costs the same
+    for every file size and only pages actually touched become resident.
+    Only available on POSIX systems, isReady() is false otherwise */
+class MappedBackend: public BufferBackend {
+    public:
+        explicit MappedBackend(const wxString& filePath);
+        ~MappedBackend() override;
+        MappedBackend(const MappedBackend&) = delete;
+        MappedBackend& operator=(const MappedBackend&) = delete;
+
+        bool isReady() override { return ready; }
+        size_t getSize() override { return size; }
+        bool isContiguous() override { return true; }
+        BufferChunk fetch(size_t /*pos*/) override { return BufferChunk{data, 0, size}; }
+        void advise(size_t start, size_t length, BufferAdvice advice) override;
+
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+        bool ready = false;
+};
@@ -0,0 +1,20 @@
+#include "MemoryBackend.h"
+
+#include <wx/wfstream.h>
+
+MemoryBackend::MemoryBackend(const wxString& filePath) {
+    wxFileInputStream input_stream(filePath);
+    if (!input_stream.IsOk()) {
+        return;
+    }
+
+    size_t size = input_stream.GetLength(); // Get file byte size
+    this->data.resize(size);
+
+    input_stream.Read(this->data.data(), size);
+
+    if (!input_stream) {
+        return;
+    }
+    this->ready = true;
+}
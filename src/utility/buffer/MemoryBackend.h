@@ -0,0 +1,21 @@
+#pragma once
+
+#include "BufferBackend.h"
+#include <string>
+#include <wx/string.h>
+
+// Backend holding the whole file in memory, works for every input wxWidgets can open
+class MemoryBackend: public BufferBackend {
+    public:
+        explicit MemoryBackend(const wxString& filePath);
+        // Take over bytes that are already in memory
+        explicit MemoryBackend(std::string data) : data(std::move(data)), ready(true) {};
+        bool isReady() override { return ready; }
+        size_t getSize() override { return data.size(); }
+        bool isContiguous() override { return true; }
+        BufferChunk fetch(size_t /*pos*/) override { return BufferChunk{data.data(), 0, data.size()}; }
+
+    private:
+        std::string data;
+        bool ready = false;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "BufferBackend.h"
+
+/* Backend over bytes owned by another backend, used for cursors on contiguous buffers.
+    Must not outlive the backend the bytes belong to */
+class ViewBackend: public BufferBackend {
+    public:
+        ViewBackend(const char* data, size_t size) : data(data), size(size) {};
+        bool isReady() override { return true; }
+        size_t getSize() override { return size; }
+        bool isContiguous() override { return true; }
+        BufferChunk fetch(size_t /*pos*/) override { return BufferChunk{data, 0, size}; }
+
+    private:
+        const char* data;
+        size_t size;
+};
@@ -0,0 +1,125 @@
+#include "WindowedBackend.h"
+
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+
+// Seek with 64 bit offsets, plain fseek only takes a long
+static bool seekTo(std::FILE* file, size_t pos, int origin = SEEK_SET) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<int64_t>(pos), origin) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(pos), origin) == 0;
+#endif
+}
+
+static int64_t tellPos(std::FILE* file) {
+#ifdef _WIN32
+    return _ftelli64(file);
+#else
+    return static_cast<int64_t>(ftello(file));
+#endif
+}
+
+WindowedBackend::WindowedBackend(const wxString& filePath, size_t blockSize, size_t memoryCap) {
+    // Keep atleast two blocks so reads across one block boundary don't thrash
+    this->blockSize = blockSize == 0 ? 64 * 1024 : blockSize;
+    this->maxBlocks = memoryCap / this->blockSize;
+    if (this->maxBlocks < 2) this->maxBlocks = 2;
+
+    this->file = std::fopen(filePath.fn_str(), "rb");
+    if (this->file == nullptr) {
+        return;
+    }
+
+    // Pipes can't seek, copy them to a temporary file we can read blocks from
+    if (!seekTo(this->file, 0, SEEK_END) || tellPos(this->file) < 0) {
+        if (!this->spoolToTemporary()) {
+            return;
+        }
+    }
+    int64_t end = tellPos(this->file);
+    if (end < 0) {
+        return;
+    }
+    this->size = static_cast<size_t>(end);
+    this->ready = true;
+}
+
+WindowedBackend::~WindowedBackend() {
+    if (this->file != nullptr) {
+        std::fclose(this->file);
+    }
+}
+
+bool WindowedBackend::spoolToTemporary() {
+    std::FILE* spool = std::tmpfile();
+    if (spool == nullptr) {
+        return false;
+    }
+    std::vector<char> chunk(this->blockSize);
+    size_t read;
+    while ((read = std::fread(chunk.data(), 1, chunk.size(), this->file)) > 0) {
+        if (std::fwrite(chunk.data(), 1, read, spool) != read) {
+            std::fclose(spool);
+            return false;
+        }
+    }
+    std::fclose(this->file);
+    this->file = spool;
+    return seekTo(this->file, 0, SEEK_END);
+}
+
+bool WindowedBackend::readBlock(size_t index, std::vector<char>& into) {
+    size_t start = index * this->blockSize;
+    size_t length = this->size - start < this->blockSize ? this->size - start : this->blockSize;
+    into.resize(length);
+    if (!seekTo(this->file, start)) {
+        return false;
+    }
+    if (std::fread(into.data(), 1, length, this->file) != length) {
+        return false;
+    }
+    this->stats.bytesRead += length;
+    return true;
+}
+
+BufferChunk WindowedBackend::fetch(size_t pos) {
+    size_t index = pos / this->blockSize;
+
+    auto found = this->blockLookup.find(index);
+    if (found != this->blockLookup.end()) {
+        // Move block to the front of the LRU list
+        this->stats.blockHits++;
+        this->blocks.splice(this->blocks.begin(), this->blocks, found->second);
+    } else {
+        this->stats.blockMisses++;
+        if (this->blocks.size() >= this->maxBlocks) {
+            // Reuse the least recently used block's storage for the new block
+            this->stats.blockEvictions++;
+            this->blockLookup.erase(this->blocks.back().index);
+            this->blocks.splice(this->blocks.begin(), this->blocks, std::prev(this->blocks.end()));
+        } else {
+            this->blocks.emplace_front();
+        }
+        Block& block = this->blocks.front();
+        block.index = index;
+        if (!this->readBlock(index, block.data)) {
+            this->blocks.pop_front();
+            throw std::runtime_error("Error reading file block");
+        }
+        this->blockLookup[index] = this->blocks.begin();
+    }
+
+    Block& block = this->blocks.front();
+    return BufferChunk{block.data.data(), index * this->blockSize, block.data.size()};
+}
+
+BufferStats WindowedBackend::getStats() {
+    BufferStats current = this->stats;
+    current.residentBytes = 0;
+    for (const Block& block: this->blocks) {
+        current.residentBytes += block.data.capacity();
+    }
+    return current;
+}
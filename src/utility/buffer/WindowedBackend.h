@@ -0,0 +1,45 @@
+#pragma once
+
+#include "BufferBackend.h"
+#include <cstdio>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <wx/string.h>
+
+/* Backend keeping only a bounded LRU set of fixed-size blocks in memory, blocks are
+    read from the file when first touched. Non seekable inputs (pipes) are spooled to
+    a temporary file first, so memory use stays bounded for every kind of input */
+class WindowedBackend: public BufferBackend {
+    public:
+        WindowedBackend(const wxString& filePath, size_t blockSize, size_t memoryCap);
+        ~WindowedBackend() override;
+        WindowedBackend(const WindowedBackend&) = delete;
+        WindowedBackend& operator=(const WindowedBackend&) = delete;
+
+        bool isReady() override { return ready; }
+        size_t getSize() override { return size; }
+        bool isContiguous() override { return false; }
+        BufferChunk fetch(size_t pos) override;
+        BufferStats getStats() override;
+
+    private:
+        struct Block {
+            size_t index;
+            std::vector<char> data;
+        };
+
+        bool spoolToTemporary();
+        bool readBlock(size_t index, std::vector<char>& into);
+
+        std::FILE* file = nullptr;
+        size_t size = 0;
+        size_t blockSize;
+        size_t maxBlocks;
+        bool ready = false;
+
+        // Most recently used block at the front
+        std::list<Block> blocks;
+        std::unordered_map<size_t, std::list<Block>::iterator> blockLookup;
+        BufferStats stats;
+};
@@ -0,0 +1,45 @@
+#include "ContentOperator.h"
+
+namespace {
+    // Operators are 1 to 3 characters, packed into one integer they compare in a single step
+    constexpr uint32_t packKeyword(const char* keyword, size_t length) {
+        uint32_t packed = static_cast<uint32_t>(length) << 24;
+        for (size_t i = 0; i < length; i++) packed |= static_cast<uint32_t>(static_cast<uint8_t>(keyword[i])) << (8 * i);
+        return packed;
+    }
+
+    constexpr size_t keywordLength(const char* keyword) {
+        size_t length = 0;
+        while (keyword[length] != '\0') length++;
+        return length;
+    }
+
+    // Operators bucketed by their first character, the T operators are the most with 13
+    struct OperatorBuckets {
+        uint32_t keys[128][16];
+        uint8_t operators[128][16];
+        uint8_t sizes[128];
+
+        constexpr OperatorBuckets() : keys(), operators(), sizes() {
+            for (int op = 1; op < OP_COUNT; op++) {
+                const char* keyword = CONTENT_OPERATORS[op].keyword;
+                uint8_t first = static_cast<uint8_t>(keyword[0]);
+                keys[first][sizes[first]] = packKeyword(keyword, keywordLength(keyword));
+                operators[first][sizes[first]] = static_cast<uint8_t>(op);
+                sizes[first]++;
+            }
+        }
+    };
+
+    constexpr OperatorBuckets OPERATOR_BUCKETS{};
+}
+
+ContentOperator findContentOperator(std::string_view keyword) {
+    if (keyword.empty() || keyword.size() > 3 || static_cast<uint8_t>(keyword[0]) >= 128) return OP_UNKNOWN;
+    uint8_t first = static_cast<uint8_t>(keyword[0]);
+    uint32_t key = packKeyword(keyword.data(), keyword.size());
+    for (uint8_t i = 0; i < OPERATOR_BUCKETS.sizes[first]; i++) {
+        if (OPERATOR_BUCKETS.keys[first][i] == key) return static_cast<ContentOperator>(OPERATOR_BUCKETS.operators[first][i]);
+    }
+    return OP_UNKNOWN;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+// Content stream operators (ISO32000 Annex A), the comments are the operator keywords
+enum ContentOperator : uint8_t {
+    OP_UNKNOWN,
+    // General graphics state
+    OP_SET_LINE_WIDTH,              // w
+    OP_SET_LINE_CAP,                // J
+    OP_SET_LINE_JOIN,               // j
+    OP_SET_MITER_LIMIT,             // M
+    OP_SET_DASH,                    // d
+    OP_SET_RENDERING_INTENT,        // ri
+    OP_SET_FLATNESS,                // i
+    OP_SET_GRAPHICS_STATE,          // gs
+    // Special graphics state
+    OP_SAVE_STATE,                  // q
+    OP_RESTORE_STATE,               // Q
+    OP_CONCAT_MATRIX,               // cm
+    // Path construction
+    OP_MOVE_TO,                     // m
+    OP_LINE_TO,                     // l
+    OP_CURVE_TO,                    // c
+    OP_CURVE_TO_V,                  // v
+    OP_CURVE_TO_Y,                  // y
+    OP_CLOSE_PATH,                  // h
+    OP_RECTANGLE,                   // re
+    // Path painting
+    OP_STROKE,                      // S
+    OP_CLOSE_STROKE,                // s
+    OP_FILL,                        // f
+    OP_FILL_OBSOLETE,               // F
+    OP_FILL_EVEN_ODD,               // f*
+    OP_FILL_STROKE,                 // B
+    OP_FILL_STROKE_EVEN_ODD,        // B*
+    OP_CLOSE_FILL_STROKE,           // b
+    OP_CLOSE_FILL_STROKE_EVEN_ODD,  // b*
+    OP_END_PATH,                    // n
+    // Clipping paths
+    OP_CLIP,                        // W
+    OP_CLIP_EVEN_ODD,               // W*
+    // Text objects & state
+    OP_BEGIN_TEXT,                  // BT
+    OP_END_TEXT,                    // ET
+    OP_SET_CHAR_SPACING,            // Tc
+    OP_SET_WORD_SPACING,            // Tw
+    OP_SET_HORIZONTAL_SCALING,      // Tz
+    OP_SET_LEADING,                 // TL
+    OP_SET_FONT,                    // Tf
+    OP_SET_TEXT_RENDER,             // Tr
+    OP_SET_TEXT_RISE,               // Ts
+    // Text positioning & showing
+    OP_MOVE_TEXT,                   // Td
+    OP_MOVE_TEXT_LEADING,           // TD
+    OP_SET_TEXT_MATRIX,             // Tm
+    OP_NEXT_LINE,                   // T*
+    OP_SHOW_TEXT,                   // Tj
+    OP_SHOW_TEXT_ARRAY,             // TJ
+    OP_NEXT_LINE_SHOW_TEXT,         // '
+    OP_NEXT_LINE_SHOW_TEXT_SPACING, // "
+    // Type 3 fonts
+    OP_SET_CHAR_WIDTH,              // d0
+    OP_SET_CACHE_DEVICE,            // d1
+    // Color
+    OP_SET_STROKE_COLOR_SPACE,      // CS
+    OP_SET_FILL_COLOR_SPACE,        // cs
+    OP_SET_STROKE_COLOR,            // SC
+    OP_SET_STROKE_COLOR_N,          // SCN
+    OP_SET_FILL_COLOR,              // sc
+    OP_SET_FILL_COLOR_N,            // scn
+    OP_SET_STROKE_GRAY,             // G
+    OP_SET_FILL_GRAY,               // g
+    OP_SET_STROKE_RGB,              // RG
+    OP_SET_FILL_RGB,                // rg
+    OP_SET_STROKE_CMYK,             // K
+    OP_SET_FILL_CMYK,               // k
+    // Shading, XObjects & inline images
+    OP_SHADING_FILL,                // sh
+    OP_PAINT_XOBJECT,               // Do
+    OP_BEGIN_INLINE_IMAGE,          // BI
+    OP_INLINE_IMAGE_DATA,           // ID
+    OP_END_INLINE_IMAGE,            // EI
+    // Marked content
+    OP_MARK_POINT,                  // MP
+    OP_MARK_POINT_PROPS,            // DP
+    OP_BEGIN_MARKED_CONTENT,        // BMC
+    OP_BEGIN_MARKED_CONTENT_PROPS,  // BDC
+    OP_END_MARKED_CONTENT,          // EMC
+    // Compatibility sections
+    OP_BEGIN_COMPATIBILITY,         // BX
+    OP_END_COMPATIBILITY,           // EX
+    OP_COUNT
+};
+
+struct ContentOperatorInfo {
+    const char* keyword;
+    // Operands the operator takes, -1 for a variable amount (color components)
+    int8_t operands;
+};
+
+// Keyword & operand count of every operator, indexed by ContentOperator
+inline constexpr ContentOperatorInfo CONTENT_OPERATORS[OP_COUNT] = {
+    {"", 0},
+    {"w", 1}, {"J", 1}, {"j", 1}, {"M", 1}, {"d", 2}, {"ri", 1}, {"i", 1}, {"gs", 1},
+    {"q", 0}, {"Q", 0}, {"cm", 6},
+    {"m", 2}, {"l", 2}, {"c", 6}, {"v", 4}, {"y", 4}, {"h", 0}, {"re", 4},
+    {"S", 0}, {"s", 0}, {"f", 0}, {"F", 0}, {"f*", 0}, {"B", 0}, {"B*", 0}, {"b", 0}, {"b*", 0}, {"n", 0},
+    {"W", 0}, {"W*", 0},
+    {"BT", 0}, {"ET", 0}, {"Tc", 1}, {"Tw", 1}, {"Tz", 1}, {"TL", 1}, {"Tf", 2}, {"Tr", 1}, {"Ts", 1},
+    {"Td", 2}, {"TD", 2}, {"Tm", 6}, {"T*", 0}, {"Tj", 1}, {"TJ", 1}, {"'", 1}, {"\"", 3},
+    {"d0", 2}, {"d1", 6},
+    {"CS", 1}, {"cs", 1}, {"SC", -1}, {"SCN", -1}, {"sc", -1}, {"scn", -1}, {"G", 1}, {"g", 1}, {"RG", 3}, {"rg", 3}, {"K", 4}, {"k", 4},
+    {"sh", 1}, {"Do", 1}, {"BI", 0}, {"ID", 0}, {"EI", 0},
+    {"MP", 1}, {"DP", 2}, {"BMC", 1}, {"BDC", 2}, {"EMC", 0},
+    {"BX", 0}, {"EX", 0}
+};
+
+// Operator of a keyword token, OP_UNKNOWN for anything else
+ContentOperator findContentOperator(std::string_view keyword);
+inline const char* contentOperatorKeyword(ContentOperator op) { return CONTENT_OPERATORS[op].keyword; }
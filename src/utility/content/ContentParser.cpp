@@ -0,0 +1,242 @@
+#include "ContentParser.h"
+
+#include <cstring>
+
+namespace {
+    // Inline image data ends at EI with whitespace before it & whitespace, a delimiter or the end after it
+    size_t findInlineImageEnd(std::string_view data, size_t from) {
+        size_t position = from;
+        while (position + 2 <= data.size()) {
+            const void* found = std::memchr(data.data() + position, 'E', data.size() - position);
+            if (!found) return std::string::npos;
+            position = static_cast<const char*>(found) - data.data();
+            if (position + 1 < data.size() && data[position + 1] == 'I' && position > 0 && isPdfWhitespace(data[position - 1]) &&
+                (position + 2 == data.size() || !isPdfRegular(data[position + 2]))) {
+                return position;
+            }
+            position++;
+        }
+        return std::string::npos;
+    }
+}
+
+ContentStats ContentParser::parse(std::string_view content, ContentVisitor& visitor) {
+    ContentStats stats;
+    Lexer lexer(content);
+    this->operands.clear();
+
+    Token token;
+    while (true) {
+        LexerStatus status = lexer.next(token);
+        if (status == LEX_END) break;
+        // Malformed hex digits are ignored when decoding, the string is still usable
+        if (status != LEX_OK && status != LEX_INVALID_HEX) {
+            stats.errors++;
+            visitor.onError(token.start, status);
+            continue;
+        }
+
+        if (token.type != TOKEN_KEYWORD) {
+            Value operand = this->parseOperand(lexer, token, 0);
+            if (operand.getType() == OBJT_INVALID) {
+                // Closing ], >> or a brace without an opening one
+                stats.errors++;
+                visitor.onError(token.start, LEX_UNEXPECTED_CHAR);
+            } else {
+                this->operands.push(operand);
+            }
+            continue;
+        }
+
+        ContentOperator op = findContentOperator(token.text);
+        if (op == OP_BEGIN_INLINE_IMAGE) {
+            this->parseInlineImage(lexer, token, visitor, stats);
+        } else if (op == OP_UNKNOWN) {
+            stats.unknownOperators++;
+            visitor.onUnknownOperator(token.text, this->operands);
+        } else {
+            stats.operators++;
+            visitor.onOperator(op, this->operands);
+        }
+        this->operands.clear();
+        if (this->arenaUsed) {
+            this->arena.reset();
+            this->arenaUsed = false;
+        }
+    }
+
+    // Operands without an operator at the end are dropped
+    this->operands.clear();
+    if (this->arenaUsed) {
+        this->arena.reset();
+        this->arenaUsed = false;
+    }
+    return stats;
+}
+
+Value ContentParser::parseOperand(Lexer& lexer, const Token& token, size_t depth) {
+    switch (token.type) {
+        case TOKEN_INTEGER:
+            return Value::makeInteger(token.integer);
+        case TOKEN_REAL:
+            return Value::makeReal(token.real);
+        case TOKEN_NAME:
+            if (!token.escaped) return Value::makeName(this->names.intern(token.text));
+            Lexer::decodeName(token.text, this->text);
+            return Value::makeName(this->names.intern(this->text));
+        // Views into the content, nothing is copied
+        case TOKEN_STRING_LITERAL:
+            return Value::makeString(OBJT_STRING_LITERAL, token.text);
+        case TOKEN_STRING_HEXADECIMAL:
+            return Value::makeString(OBJT_STRING_HEXADECIMAL, token.text);
+        case TOKEN_TRUE:
+            return Value::makeBoolean(true);
+        case TOKEN_FALSE:
+            return Value::makeBoolean(false);
+        case TOKEN_NULL:
+            return Value();
+        case TOKEN_ARRAY_BEGIN:
+            // Deeper nesting is cut off, its elements end up in the enclosing array
+            if (depth >= MAX_VALUE_NESTING) return Value();
+            return this->parseArray(lexer, depth + 1);
+        case TOKEN_DICTIONARY_BEGIN:
+            if (depth >= MAX_VALUE_NESTING) return Value();
+            return this->parseDictionary(lexer, depth + 1);
+        default:
+            return Value::makeInvalid();
+    }
+}
+
+Value ContentParser::parseArray(Lexer& lexer, size_t depth) {
+    // Nested arrays use the same stack above the elements of the enclosing one
+    size_t first = this->items.size();
+    Token token;
+    while (true) {
+        LexerStatus status = lexer.next(token);
+        if (status == LEX_END) break;
+        if (status != LEX_OK && status != LEX_INVALID_HEX) continue;
+        if (token.type == TOKEN_ARRAY_END) break;
+        if (token.type == TOKEN_KEYWORD) {
+            // Unterminated array, the operator still belongs to the content
+            lexer.setPosition(token.start);
+            break;
+        }
+        Value item = this->parseOperand(lexer, token, depth);
+        if (item.getType() != OBJT_INVALID) this->items.push_back(item);
+    }
+
+    size_t count = this->items.size() - first;
+    Value* copy = this->arena.allocateArray<Value>(count);
+    if (count > 0) std::memcpy(static_cast<void*>(copy), this->items.data() + first, count * sizeof(Value));
+    this->items.resize(first);
+    this->arenaUsed = true;
+    return Value::makeArray(copy, count);
+}
+
+Value ContentParser::parseDictionary(Lexer& lexer, size_t depth) {
+    size_t first = this->entries.size();
+    Token token;
+    while (true) {
+        LexerStatus status = lexer.next(token);
+        if (status == LEX_END) break;
+        if (status != LEX_OK && status != LEX_INVALID_HEX) continue;
+        if (token.type == TOKEN_DICTIONARY_END) break;
+        if (token.type == TOKEN_KEYWORD) {
+            lexer.setPosition(token.start);
+            break;
+        }
+        if (token.type != TOKEN_NAME) continue;
+        NameAtom key = this->parseOperand(lexer, token, depth).getAtom();
+
+        status = lexer.next(token);
+        if (status == LEX_END) break;
+        if (token.type == TOKEN_DICTIONARY_END) break;
+        if (token.type == TOKEN_KEYWORD) {
+            lexer.setPosition(token.start);
+            break;
+        }
+        Value value = this->parseOperand(lexer, token, depth);
+        if (value.getType() != OBJT_INVALID) this->entries.push_back(DictEntry{key, value});
+    }
+
+    size_t count = this->entries.size() - first;
+    DictEntry* copy = this->arena.allocateArray<DictEntry>(count);
+    if (count > 0) std::memcpy(static_cast<void*>(copy), this->entries.data() + first, count * sizeof(DictEntry));
+    this->entries.resize(first);
+    this->arenaUsed = true;
+    return Value::makeDictionary(copy, count);
+}
+
+// BI, key value pairs like a dictionary, ID, a single whitespace, the image data, EI (ISO32000 8.9.7)
+void ContentParser::parseInlineImage(Lexer& lexer, const Token& begin, ContentVisitor& visitor, ContentStats& stats) {
+    size_t first = this->entries.size();
+    Token token;
+    bool dataFound = false;
+    while (lexer.next(token) != LEX_END) {
+        if (token.type == TOKEN_KEYWORD) {
+            dataFound = token.text == "ID";
+            break;
+        }
+        if (token.type != TOKEN_NAME) continue;
+        NameAtom key = this->parseOperand(lexer, token, 0).getAtom();
+        if (lexer.next(token) == LEX_END) break;
+        if (token.type == TOKEN_KEYWORD) {
+            lexer.setPosition(token.start);
+            continue;
+        }
+        Value value = this->parseOperand(lexer, token, 1);
+        if (value.getType() != OBJT_INVALID) this->entries.push_back(DictEntry{key, value});
+    }
+    size_t count = this->entries.size() - first;
+    DictEntry* copy = this->arena.allocateArray<DictEntry>(count);
+    if (count > 0) std::memcpy(static_cast<void*>(copy), this->entries.data() + first, count * sizeof(DictEntry));
+    this->entries.resize(first);
+    this->arenaUsed = true;
+    Value dictionary = Value::makeDictionary(copy, count);
+
+    if (!dataFound) {
+        stats.errors++;
+        visitor.onError(begin.start, LEX_UNEXPECTED_CHAR);
+        return;
+    }
+
+    std::string_view content = lexer.getData();
+    size_t dataStart = std::min(token.end + 1, content.size());
+    // PDF 2.0 writers give the data length, it's trusted if EI follows right after it
+    size_t end = std::string::npos, dataEnd = std::string::npos;
+    const Value* length = dictionary.find(NAME_LENGTH);
+    if (!length) length = dictionary.find("L");
+    if (length && length->getType() == OBJT_INTEGER && length->getInteger() >= 0 &&
+        static_cast<uint64_t>(length->getInteger()) <= content.size() - dataStart) {
+        dataEnd = dataStart + static_cast<size_t>(length->getInteger());
+        end = findInlineImageEnd(content, dataEnd);
+        if (end == std::string::npos || end > dataEnd + 2) end = std::string::npos;
+    }
+    if (end == std::string::npos) {
+        end = findInlineImageEnd(content, dataStart);
+        // The whitespace in front of EI isn't part of the data
+        dataEnd = end == std::string::npos ? end : std::max(dataStart, end - 1);
+    }
+    if (end == std::string::npos) {
+        stats.errors++;
+        visitor.onError(begin.start, LEX_UNEXPECTED_CHAR);
+        lexer.setPosition(content.size());
+        return;
+    }
+
+    stats.inlineImages++;
+    visitor.onInlineImage(dictionary, content.substr(dataStart, dataEnd - dataStart));
+    lexer.setPosition(end + 2);
+}
+
+void ContentParser::decodeString(const Value& value, std::string& output) {
+    if (value.getType() == OBJT_STRING_LITERAL) {
+        Lexer::decodeLiteralString(value.getString(), output);
+    } else if (value.getType() == OBJT_STRING_HEXADECIMAL) {
+        Lexer::decodeHexString(value.getString(), output);
+    } else if (value.getType() == OBJT_NAME) {
+        output.assign(value.getString());
+    } else {
+        output.clear();
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ContentOperator.h"
+#include "ContentVisitor.h"
+#include "OperandStack.h"
+#include "../parser/Lexer.h"
+#include "../parser/ValueParser.h"
+#include "../objects/ObjectArena.h"
+#include "../objects/Value.h"
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Scratch arena for array & dictionary operands, reset after every operator that used it
+constexpr size_t CONTENT_ARENA_BLOCK = 16 * 1024;
+
+struct ContentStats {
+    size_t operators = 0;
+    size_t unknownOperators = 0;
+    size_t inlineImages = 0;
+    size_t errors = 0;
+};
+
+/* Interpreter front end for decoded content streams (ISO32000 7.8.2): tokenizes the data into
+    operands & operators & hands every operation to a visitor. Operands go onto a fixed capacity
+    stack, strings stay views into the content, only arrays & dictionaries use a scratch arena
+    that is reused. Nothing is allocated per operator once the scratch space has grown.
+    One parser per thread, it can be reused for any number of streams. The names of all of
+    them are held until the parser goes away */
+class ContentParser {
+    public:
+        ContentParser() : arena(CONTENT_ARENA_BLOCK) {};
+
+        // Run over the whole content, returns the stats of this run
+        ContentStats parse(std::string_view content, ContentVisitor& visitor);
+
+        // Bytes of a string operand with escapes resolved (literal) or hex digits decoded
+        static void decodeString(const Value& value, std::string& output);
+
+    private:
+        // Operand of a token other than a keyword, invalid for closing tokens
+        Value parseOperand(Lexer& lexer, const Token& token, size_t depth);
+        Value parseArray(Lexer& lexer, size_t depth);
+        Value parseDictionary(Lexer& lexer, size_t depth);
+        void parseInlineImage(Lexer& lexer, const Token& begin, ContentVisitor& visitor, ContentStats& stats);
+
+        NameScope names;
+        ObjectArena arena;
+        OperandStack operands;
+        // Elements of the array being parsed, copied into the arena once complete
+        std::vector<Value> items;
+        std::vector<DictEntry> entries;
+        // Decoded names with #xx escapes
+        std::string text;
+        bool arenaUsed = false;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ContentOperator.h"
+#include "OperandStack.h"
+#include "../parser/Lexer.h"
+
+#include <array>
+#include <functional>
+#include <string_view>
+#include <cstddef>
+
+// Receives the operations of a content stream in order, see ContentParser
+class ContentVisitor {
+    public:
+        virtual ~ContentVisitor() = default;
+
+        // Every known operator with the operands in front of it
+        virtual void onOperator(ContentOperator op, const OperandStack& operands) = 0;
+        // Keywords that are no operator, e.g. inside BX/EX compatibility sections
+        virtual void onUnknownOperator(std::string_view /*keyword*/, const OperandStack& /*operands*/) {}
+        /* Inline image (BI ... ID data EI) as one operation, the dictionary with the abbreviated
+            keys as written & the raw image data */
+        virtual void onInlineImage(const Value& /*dictionary*/, std::string_view /*data*/) {}
+        // Malformed token at a position of the content, it was skipped
+        virtual void onError(size_t /*position*/, LexerStatus /*status*/) {}
+};
+
+/* Visitor calling a handler per operator ID through a table, operators without a handler
+    are skipped after a single lookup. Handlers are set up once & called without allocating */
+class ContentDispatcher : public ContentVisitor {
+    public:
+        using Handler = std::function<void(const OperandStack& operands)>;
+
+        void on(ContentOperator op, Handler handler) { handlers[op] = std::move(handler); }
+        void onOperator(ContentOperator op, const OperandStack& operands) override {
+            const Handler& handler = handlers[op];
+            if (handler) handler(operands);
+        }
+
+    private:
+        std::array<Handler, OP_COUNT> handlers;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../objects/Value.h"
+
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+// Operands kept per operator, no operator takes more than a handful (a TJ array counts as one)
+constexpr size_t CONTENT_OPERAND_CAPACITY = 32;
+
+/* Fixed capacity stack of the operands in front of an operator, reused for every operator.
+    Strings, arrays & dictionaries point into the content data or the parser's scratch arena,
+    so the operands are only valid until the visitor returns */
+class OperandStack {
+    public:
+        // False if the stack is full, the operand is dropped
+        bool push(const Value& value) {
+            if (count == CONTENT_OPERAND_CAPACITY) {
+                overflowed = true;
+                return false;
+            }
+            values[count++] = value;
+            return true;
+        }
+        void clear() {
+            count = 0;
+            overflowed = false;
+        }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        // More operands than the capacity came before the operator
+        bool hasOverflowed() const { return overflowed; }
+        const Value& operator[](size_t i) const { return values[i]; }
+
+        // Typed access, default for missing operands & other types
+        double getReal(size_t i, double fallback = 0) const {
+            if (i >= count || (values[i].getType() != OBJT_INTEGER && values[i].getType() != OBJT_REAL)) return fallback;
+            return values[i].getReal();
+        }
+        int64_t getInteger(size_t i, int64_t fallback = 0) const {
+            if (i >= count || values[i].getType() != OBJT_INTEGER) return fallback;
+            return values[i].getInteger();
+        }
+        NameAtom getAtom(size_t i) const {
+            if (i >= count || values[i].getType() != OBJT_NAME) return NAME_UNKNOWN;
+            return values[i].getAtom();
+        }
+        // Raw string bytes (escapes not resolved) or name characters, empty for other types
+        std::string_view getString(size_t i) const {
+            if (i >= count) return std::string_view();
+            ObjectType type = values[i].getType();
+            if (type != OBJT_STRING_LITERAL && type != OBJT_STRING_HEXADECIMAL && type != OBJT_NAME) return std::string_view();
+            return values[i].getString();
+        }
+
+    private:
+        Value values[CONTENT_OPERAND_CAPACITY];
+        size_t count = 0;
+        bool overflowed = false;
+};
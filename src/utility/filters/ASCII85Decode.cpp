@@ -0,0 +1,130 @@
+#include "ASCII85Decode.h"
+#include "../parser/CharClass.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Value of a group of 5 digits, above UINT32_MAX if the group is invalid
+static inline uint64_t groupValue(const char* group) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 5; i++) value = value * 85 + static_cast<uint8_t>(group[i] - '!');
+    return value;
+}
+
+static inline void storeGroup(uint32_t value, char* out) {
+    out[0] = static_cast<char>(value >> 24);
+    out[1] = static_cast<char>(value >> 16);
+    out[2] = static_cast<char>(value >> 8);
+    out[3] = static_cast<char>(value);
+}
+
+static inline bool isDigit85(char c) {
+    return static_cast<uint8_t>(c - '!') < 85;
+}
+
+size_t ASCII85Filter::decodeGroups(const char* input, size_t length, char* out, size_t capacity, size_t& written) {
+    size_t i = 0;
+    written = 0;
+#if defined(__SSE2__)
+    // 16 checked characters hold 3 complete groups
+    while (i + 16 <= length && written + 12 <= capacity) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        __m128i valid = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('!' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('u' + 1)));
+        if (_mm_movemask_epi8(valid) != 0xFFFF) break;
+        uint64_t first = groupValue(input + i), second = groupValue(input + i + 5), third = groupValue(input + i + 10);
+        if ((first | second | third) > UINT32_MAX) break;
+        storeGroup(static_cast<uint32_t>(first), out + written);
+        storeGroup(static_cast<uint32_t>(second), out + written + 4);
+        storeGroup(static_cast<uint32_t>(third), out + written + 8);
+        i += 15;
+        written += 12;
+    }
+#endif
+    while (i + 5 <= length && written + 4 <= capacity) {
+        const char* group = input + i;
+        if (!(isDigit85(group[0]) & isDigit85(group[1]) & isDigit85(group[2]) & isDigit85(group[3]) & isDigit85(group[4]))) break;
+        uint64_t value = groupValue(group);
+        if (value > UINT32_MAX) break;
+        storeGroup(static_cast<uint32_t>(value), out + written);
+        i += 5;
+        written += 4;
+    }
+    return i;
+}
+
+void ASCII85Filter::emit(uint32_t value, size_t bytes, char* out, size_t capacity, size_t& written) {
+    char group[4];
+    storeGroup(value, group);
+    size_t direct = std::min(bytes, capacity - written);
+    std::copy(group, group + direct, out + written);
+    written += direct;
+    std::copy(group + direct, group + bytes, this->rest);
+    this->restStart = 0;
+    this->restEnd = bytes - direct;
+}
+
+void ASCII85Filter::finish(char* out, size_t capacity, size_t& written) {
+    this->done = true;
+    if (this->count == 0) return;
+    // A single digit can't encode a byte
+    if (this->count == 1) {
+        this->failed = true;
+        return;
+    }
+    size_t bytes = this->count - 1;
+    for (; this->count < 5; this->count++) this->value = this->value * 85 + 84;
+    if (this->value > UINT32_MAX) {
+        this->failed = true;
+        return;
+    }
+    this->emit(static_cast<uint32_t>(this->value), bytes, out, capacity, written);
+}
+
+size_t ASCII85Filter::read(char* out, size_t capacity) {
+    size_t written = 0;
+    if (this->restStart < this->restEnd) {
+        written = std::min(capacity, this->restEnd - this->restStart);
+        std::copy(this->rest + this->restStart, this->rest + this->restStart + written, out);
+        this->restStart += written;
+    }
+
+    while (written < capacity && !this->done && !this->failed) {
+        if (!this->fill()) {
+            // Missing ~> at the end is tolerated like a present one
+            this->finish(out, capacity, written);
+            break;
+        }
+        if (this->count == 0) {
+            size_t produced;
+            size_t digits = decodeGroups(this->pending.data(), this->pending.size(), out + written, capacity - written, produced);
+            this->pending.remove_prefix(digits);
+            written += produced;
+            if (this->pending.empty() || written == capacity) continue;
+        }
+
+        char c = this->pending.front();
+        this->pending.remove_prefix(1);
+        if (isDigit85(c)) {
+            this->value = this->value * 85 + static_cast<uint8_t>(c - '!');
+            if (++this->count == 5) {
+                if (this->value > UINT32_MAX) {
+                    this->failed = true;
+                    break;
+                }
+                this->emit(static_cast<uint32_t>(this->value), 4, out, capacity, written);
+                this->value = 0;
+                this->count = 0;
+            }
+        } else if (c == 'z' && this->count == 0) {
+            this->emit(0, 4, out, capacity, written);
+        } else if (c == '~') {
+            this->finish(out, capacity, written);
+        } else if (!isPdfWhitespace(c)) {
+            this->failed = true;
+        }
+    }
+    return written;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "StreamFilter.h"
+
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+/* Streaming /ASCII85Decode: groups of 5 characters from ! to u encode 4 bytes in base 85,
+    z stands for 4 zero bytes & ~> ends the data. Whitespace is ignored. Runs of complete
+    groups are checked 16 characters at a time with SSE2 where available */
+class ASCII85Filter: public StreamFilter {
+    public:
+        explicit ASCII85Filter(std::unique_ptr<ByteSource> source) : StreamFilter(std::move(source)) {}
+        size_t read(char* out, size_t capacity) override;
+
+        /* Decode complete groups (no whitespace or z) into at most capacity bytes, written is
+            set to the bytes produced. Returns the characters decoded */
+        static size_t decodeGroups(const char* input, size_t length, char* out, size_t capacity, size_t& written);
+
+    private:
+        // Queue the bytes of a group, the ones not fitting into out are kept for the next read
+        void emit(uint32_t value, size_t bytes, char* out, size_t capacity, size_t& written);
+        // Pad a final partial group
+        void finish(char* out, size_t capacity, size_t& written);
+
+        uint64_t value = 0;
+        size_t count = 0;
+        bool done = false;
+
+        char rest[4];
+        size_t restStart = 0;
+        size_t restEnd = 0;
+};
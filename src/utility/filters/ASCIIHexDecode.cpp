@@ -0,0 +1,86 @@
+#include "ASCIIHexDecode.h"
+#include "../parser/CharClass.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+
+// Nibble values of 16 hex digits, false if any character isn't one
+static inline bool hexNibbles(__m128i chars, __m128i& nibbles) {
+    __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    // Signed compares, bytes above 0x7F are negative & fail both ranges
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    if (_mm_movemask_epi8(_mm_or_si128(digit, letter)) != 0xFFFF) return false;
+    __m128i digitValues = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i letterValues = _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10));
+    nibbles = _mm_or_si128(_mm_and_si128(digit, digitValues), _mm_andnot_si128(digit, letterValues));
+    return true;
+}
+
+// Combine the nibble pairs of each 16 bit lane (high digit first) into its low byte
+static inline __m128i combineNibbles(__m128i nibbles) {
+    __m128i high = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4);
+    __m128i low = _mm_srli_epi16(nibbles, 8);
+    return _mm_or_si128(high, low);
+}
+#endif
+
+size_t ASCIIHexFilter::decodeRun(const char* input, size_t length, char* out) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    while (i + 32 <= length) {
+        __m128i first, second;
+        if (!hexNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)), first)) break;
+        if (!hexNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 16)), second)) break;
+        __m128i bytes = _mm_packus_epi16(combineNibbles(first), combineNibbles(second));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 2), bytes);
+        i += 32;
+    }
+#endif
+    while (i + 1 < length) {
+        int high = hexDigitValue(input[i]);
+        int low = hexDigitValue(input[i + 1]);
+        if (high < 0 || low < 0) break;
+        out[i / 2] = static_cast<char>(high << 4 | low);
+        i += 2;
+    }
+    return i;
+}
+
+size_t ASCIIHexFilter::read(char* out, size_t capacity) {
+    size_t written = 0;
+    while (written < capacity && !this->done && !this->failed) {
+        if (!this->fill()) {
+            // Missing > at the end is tolerated like a present one
+            this->done = true;
+            if (this->high >= 0) out[written++] = static_cast<char>(this->high << 4);
+            break;
+        }
+        if (this->high < 0) {
+            size_t digits = decodeRun(this->pending.data(), std::min(this->pending.size(), (capacity - written) * 2), out + written);
+            this->pending.remove_prefix(digits);
+            written += digits / 2;
+            if (this->pending.empty() || written == capacity) continue;
+        }
+
+        char c = this->pending.front();
+        this->pending.remove_prefix(1);
+        int value = hexDigitValue(c);
+        if (value >= 0) {
+            if (this->high < 0) {
+                this->high = value;
+            } else {
+                out[written++] = static_cast<char>(this->high << 4 | value);
+                this->high = -1;
+            }
+        } else if (c == '>') {
+            this->done = true;
+            if (this->high >= 0) out[written++] = static_cast<char>(this->high << 4);
+        } else if (!isPdfWhitespace(c)) {
+            this->failed = true;
+        }
+    }
+    return written;
+}
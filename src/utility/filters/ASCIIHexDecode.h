@@ -0,0 +1,23 @@
+#pragma once
+
+#include "StreamFilter.h"
+
+#include <memory>
+#include <cstddef>
+
+/* Streaming /ASCIIHexDecode: pairs of hex digits up to >, whitespace is ignored & an odd
+    last digit counts as followed by 0. Runs of digits without whitespace are decoded
+    16 bytes at a time with SSE2 where available */
+class ASCIIHexFilter: public StreamFilter {
+    public:
+        explicit ASCIIHexFilter(std::unique_ptr<ByteSource> source) : StreamFilter(std::move(source)) {}
+        size_t read(char* out, size_t capacity) override;
+
+        // Decode a run of digits (no whitespace) into length / 2 bytes, returns the digits decoded
+        static size_t decodeRun(const char* input, size_t length, char* out);
+
+    private:
+        // High digit of a byte whose low digit hasn't been read yet, -1 if none
+        int high = -1;
+        bool done = false;
+};
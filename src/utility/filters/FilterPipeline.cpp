@@ -0,0 +1,47 @@
+#include "FilterPipeline.h"
+#include "FlateDecode.h"
+#include "LZWDecode.h"
+#include "ASCIIHexDecode.h"
+#include "ASCII85Decode.h"
+#include "RunLengthDecode.h"
+#include "Predictor.h"
+
+#include <string_view>
+
+FilterType FilterPipeline::getType(NameAtom name) {
+    switch (name) {
+        case NAME_FLATE_DECODE: return FILTER_FLATE;
+        case NAME_LZW_DECODE: return FILTER_LZW;
+        case NAME_ASCII_HEX_DECODE: return FILTER_ASCII_HEX;
+        case NAME_ASCII85_DECODE: return FILTER_ASCII85;
+        case NAME_RUN_LENGTH_DECODE: return FILTER_RUN_LENGTH;
+        default: break;
+    }
+    if (name == NAME_UNKNOWN) return FILTER_UNSUPPORTED;
+    std::string_view value = NameManager::global().get(name).value;
+    if (value == "Fl") return FILTER_FLATE;
+    if (value == "LZW") return FILTER_LZW;
+    if (value == "AHx") return FILTER_ASCII_HEX;
+    if (value == "A85") return FILTER_ASCII85;
+    if (value == "RL") return FILTER_RUN_LENGTH;
+    return FILTER_UNSUPPORTED;
+}
+
+std::unique_ptr<ByteSource> FilterPipeline::create(std::unique_ptr<ByteSource> source, const std::vector<FilterSpec>& filters) {
+    for (const FilterSpec& filter: filters) {
+        FilterType type = getType(filter.name);
+        switch (type) {
+            case FILTER_FLATE: source = std::make_unique<FlateFilter>(std::move(source)); break;
+            case FILTER_LZW: source = std::make_unique<LZWFilter>(std::move(source), filter.params); break;
+            case FILTER_ASCII_HEX: source = std::make_unique<ASCIIHexFilter>(std::move(source)); break;
+            case FILTER_ASCII85: source = std::make_unique<ASCII85Filter>(std::move(source)); break;
+            case FILTER_RUN_LENGTH: source = std::make_unique<RunLengthFilter>(std::move(source)); break;
+            case FILTER_UNSUPPORTED: return nullptr;
+        }
+        // Predictors only apply to Flate & LZW data
+        if ((type == FILTER_FLATE || type == FILTER_LZW) && filter.params.predictor > 1) {
+            source = std::make_unique<PredictorFilter>(std::move(source), filter.params);
+        }
+    }
+    return source;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "StreamFilter.h"
+#include "../objects/NameManager.h"
+
+#include <memory>
+#include <vector>
+
+enum FilterType {
+    FILTER_FLATE,
+    FILTER_LZW,
+    FILTER_ASCII_HEX,
+    FILTER_ASCII85,
+    FILTER_RUN_LENGTH,
+    // Image codecs (DCT, JPX, CCITT, JBIG2) & crypt filters, a pipeline with one of them isn't created
+    FILTER_UNSUPPORTED
+};
+
+// One entry of a /Filter array with its /DecodeParms
+struct FilterSpec {
+    NameAtom name;
+    DecodeParams params;
+};
+
+/* Chain of filters from a stream's /Filter entry, applied in array order. Every stage
+    pulls FILTER_CHUNK_SIZE bytes from the one before, so the pipeline holds a few chunks
+    no matter how large the stream decodes */
+class FilterPipeline {
+    public:
+        // Filter of a name, inline image abbreviations (AHx, A85, LZW, Fl, RL) included
+        static FilterType getType(NameAtom name);
+        // Pipeline over the encoded data, nullptr if a filter is unsupported
+        static std::unique_ptr<ByteSource> create(std::unique_ptr<ByteSource> source, const std::vector<FilterSpec>& filters);
+};
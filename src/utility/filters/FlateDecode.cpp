@@ -0,0 +1,55 @@
+#include "FlateDecode.h"
+#include "Predictor.h"
+
+FlateFilter::FlateFilter(std::unique_ptr<ByteSource> source) : StreamFilter(std::move(source)) {
+    this->initialized = inflateInit(&this->stream) == Z_OK;
+    if (!this->initialized) this->failed = true;
+}
+
+FlateFilter::~FlateFilter() {
+    if (this->initialized) inflateEnd(&this->stream);
+}
+
+size_t FlateFilter::read(char* out, size_t capacity) {
+    if (this->done || this->failed) return 0;
+    this->stream.next_out = reinterpret_cast<Bytef*>(out);
+    this->stream.avail_out = static_cast<uInt>(capacity);
+    while (this->stream.avail_out > 0) {
+        if (!this->fill()) {
+            // Input ending without the zlib end marker is common, keep what was decoded
+            this->done = true;
+            break;
+        }
+        this->stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(this->pending.data()));
+        this->stream.avail_in = static_cast<uInt>(this->pending.size());
+        int status = inflate(&this->stream, Z_NO_FLUSH);
+        this->pending.remove_prefix(this->pending.size() - this->stream.avail_in);
+
+        if (status == Z_STREAM_END) {
+            this->done = true;
+            break;
+        }
+        // Z_BUF_ERROR only means no progress was possible with the input & output given
+        if (status != Z_OK && status != Z_BUF_ERROR) {
+            this->failed = true;
+            break;
+        }
+    }
+    return capacity - this->stream.avail_out;
+}
+
+bool FlateDecode::decode(std::string_view input, std::string& output, const DecodeParams& params) {
+    std::unique_ptr<ByteSource> source = std::make_unique<FlateFilter>(std::make_unique<SpanSource>(input));
+    if (params.predictor > 1) source = std::make_unique<PredictorFilter>(std::move(source), params);
+    // Compressed streams usually expand a few times
+    return readAll(*source, output, input.size() * 4 + 64);
+}
+
+bool FlateDecode::encode(std::string_view input, std::string& output, int level) {
+    uLongf length = compressBound(static_cast<uLong>(input.size()));
+    output.resize(length);
+    int status = compress2(reinterpret_cast<Bytef*>(&output[0]), &length, reinterpret_cast<const Bytef*>(input.data()),
+        static_cast<uLong>(input.size()), level);
+    output.resize(status == Z_OK ? length : 0);
+    return status == Z_OK;
+}
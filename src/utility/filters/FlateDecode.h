@@ -0,0 +1,29 @@
+#pragma once
+
+#include "StreamFilter.h"
+
+#include <zlib.h>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Streaming inflate of zlib compressed data (/FlateDecode)
+class FlateFilter: public StreamFilter {
+    public:
+        explicit FlateFilter(std::unique_ptr<ByteSource> source);
+        ~FlateFilter() override;
+        size_t read(char* out, size_t capacity) override;
+
+    private:
+        z_stream stream{};
+        bool initialized = false;
+        bool done = false;
+};
+
+class FlateDecode {
+    public:
+        // Inflate zlib compressed data & undo a PNG/TIFF predictor, false on corrupt input
+        static bool decode(std::string_view input, std::string& output, const DecodeParams& params = DecodeParams());
+        // Deflate data for writing (zlib levels, -1 is zlib's default), false if zlib fails
+        static bool encode(std::string_view input, std::string& output, int level = Z_DEFAULT_COMPRESSION);
+};
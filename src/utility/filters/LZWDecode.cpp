@@ -0,0 +1,108 @@
+#include "LZWDecode.h"
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr uint16_t LZW_CLEAR = 256;
+static constexpr uint16_t LZW_END = 257;
+
+LZWFilter::LZWFilter(std::unique_ptr<ByteSource> source, const DecodeParams& params) : StreamFilter(std::move(source)), earlyChange(params.earlyChange ? 1 : 0) {
+    for (size_t code = 0; code < 256; code++) {
+        this->prefix[code] = 0;
+        this->suffix[code] = static_cast<uint8_t>(code);
+        this->first[code] = static_cast<uint8_t>(code);
+        this->length[code] = 1;
+    }
+    this->resetTable();
+}
+
+void LZWFilter::resetTable() {
+    this->nextCode = 258;
+    this->codeLength = 9;
+    this->previousCode = -1;
+}
+
+void LZWFilter::expand(uint16_t code, uint8_t* end) const {
+    while (code >= 258) {
+        *--end = this->suffix[code];
+        code = this->prefix[code];
+    }
+    *--end = static_cast<uint8_t>(code);
+}
+
+size_t LZWFilter::read(char* out, size_t capacity) {
+    uint8_t* output = reinterpret_cast<uint8_t*>(out);
+    size_t written = 0;
+
+    // Rest of a code that didn't fit last time
+    if (this->overflowStart < this->overflowEnd) {
+        written = std::min(capacity, this->overflowEnd - this->overflowStart);
+        std::memcpy(output, this->overflow + this->overflowStart, written);
+        this->overflowStart += written;
+    }
+
+    while (written < capacity && !this->done && !this->failed) {
+        // Gather the next code, data ending mid code simply ends the stream
+        while (this->bitCount < this->codeLength) {
+            if (this->pending.empty() && !this->fill()) {
+                this->done = true;
+                break;
+            }
+            this->bits = (this->bits << 8) | static_cast<uint8_t>(this->pending.front());
+            this->pending.remove_prefix(1);
+            this->bitCount += 8;
+        }
+        if (this->done) break;
+        this->bitCount -= this->codeLength;
+        uint16_t code = static_cast<uint16_t>((this->bits >> this->bitCount) & ((1u << this->codeLength) - 1));
+        this->bits &= (1u << this->bitCount) - 1;
+
+        if (code == LZW_CLEAR) {
+            this->resetTable();
+            continue;
+        }
+        if (code == LZW_END) {
+            this->done = true;
+            break;
+        }
+
+        if (this->previousCode >= 0) {
+            // New entry is the previous string plus the first byte of this one (or of itself when it is the new code)
+            if (code > this->nextCode) {
+                this->failed = true;
+                break;
+            }
+            uint16_t previous = static_cast<uint16_t>(this->previousCode);
+            if (this->nextCode < LZW_TABLE_SIZE) {
+                uint8_t firstByte = code == this->nextCode ? this->first[previous] : this->first[code];
+                this->prefix[this->nextCode] = previous;
+                this->suffix[this->nextCode] = firstByte;
+                this->first[this->nextCode] = this->first[previous];
+                this->length[this->nextCode] = static_cast<uint16_t>(this->length[previous] + 1);
+                this->nextCode++;
+            }
+            if (this->nextCode + this->earlyChange >= (size_t(1) << this->codeLength) && this->codeLength < 12) {
+                this->codeLength++;
+            }
+        } else if (code > 255) {
+            // The first code after a reset has to be a single byte
+            this->failed = true;
+            break;
+        }
+        this->previousCode = code;
+
+        size_t size = this->length[code];
+        if (size <= capacity - written) {
+            this->expand(code, output + written + size);
+            written += size;
+        } else {
+            this->expand(code, this->overflow + size);
+            size_t part = capacity - written;
+            std::memcpy(output + written, this->overflow, part);
+            written += part;
+            this->overflowStart = part;
+            this->overflowEnd = size;
+        }
+    }
+    return written;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "StreamFilter.h"
+
+#include <memory>
+#include <cstdint>
+
+// Largest code of the 12 bit LZW table
+constexpr size_t LZW_TABLE_SIZE = 4096;
+
+/* Streaming /LZWDecode (ISO32000 7.4.4): variable 9-12 bit codes, most significant bit
+    first, 256 resets the table & 257 ends the data. Entries are stored as prefix code plus
+    last byte, so the table is a few fixed arrays instead of one string per code */
+class LZWFilter: public StreamFilter {
+    public:
+        LZWFilter(std::unique_ptr<ByteSource> source, const DecodeParams& params);
+        size_t read(char* out, size_t capacity) override;
+
+    private:
+        void resetTable();
+        // Write the bytes of a code backwards from its end, the caller checked the length
+        void expand(uint16_t code, uint8_t* end) const;
+
+        int earlyChange;
+        uint16_t prefix[LZW_TABLE_SIZE];
+        uint8_t suffix[LZW_TABLE_SIZE];
+        uint8_t first[LZW_TABLE_SIZE];
+        uint16_t length[LZW_TABLE_SIZE];
+        size_t nextCode = 258;
+        int codeLength = 9;
+        int previousCode = -1;
+
+        uint32_t bits = 0;
+        int bitCount = 0;
+        bool done = false;
+
+        // Expansion of a code that didn't fit into the caller's output
+        uint8_t overflow[LZW_TABLE_SIZE];
+        size_t overflowStart = 0;
+        size_t overflowEnd = 0;
+};
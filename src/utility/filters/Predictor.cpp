@@ -0,0 +1,98 @@
+#include "Predictor.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// Rows longer than this come from broken /DecodeParms, not from real images
+static constexpr size_t MAX_ROW_LENGTH = 64 * 1024 * 1024;
+
+// Paeth predictor function from the PNG specification
+static uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+    if (pb <= pc) return static_cast<uint8_t>(b);
+    return static_cast<uint8_t>(c);
+}
+
+PredictorFilter::PredictorFilter(std::unique_ptr<ByteSource> source, const DecodeParams& params) : StreamFilter(std::move(source)) {
+    this->png = params.predictor >= 10;
+    this->bytesPerPixel = 0;
+    this->rowLength = 0;
+    if (params.colors > 0 && params.bitsPerComponent > 0 && params.columns > 0) {
+        size_t bitsPerPixel = static_cast<size_t>(params.colors) * static_cast<size_t>(params.bitsPerComponent);
+        this->bytesPerPixel = (bitsPerPixel + 7) / 8;
+        this->rowLength = (bitsPerPixel * static_cast<size_t>(params.columns) + 7) / 8;
+    }
+    // TIFF predictor 2, only 8 bit components are supported
+    bool supported = this->png || (params.predictor == 2 && params.bitsPerComponent == 8);
+    if (!supported || this->rowLength == 0 || this->rowLength > MAX_ROW_LENGTH) {
+        this->failed = true;
+        this->encodedLength = 0;
+        return;
+    }
+    this->encodedLength = this->rowLength + (this->png ? 1 : 0);
+    this->row.resize(this->encodedLength);
+    this->previous.assign(this->rowLength, 0);
+}
+
+bool PredictorFilter::nextRow() {
+    while (this->rowFilled < this->encodedLength) {
+        if (!this->fill()) return false;
+        size_t length = std::min(this->pending.size(), this->encodedLength - this->rowFilled);
+        std::memcpy(this->row.data() + this->rowFilled, this->pending.data(), length);
+        this->pending.remove_prefix(length);
+        this->rowFilled += length;
+    }
+    this->rowFilled = 0;
+
+    size_t bpp = this->bytesPerPixel;
+    size_t length = this->rowLength;
+    uint8_t* data = this->row.data() + (this->png ? 1 : 0);
+    const uint8_t* up = this->previous.data();
+    // PNG rows start with their own filter type, TIFF rows always subtract the pixel to the left
+    uint8_t type = this->png ? this->row[0] : 1;
+    switch (type) {
+        case 0: break;
+        case 1:
+            for (size_t i = bpp; i < length; i++) data[i] = static_cast<uint8_t>(data[i] + data[i - bpp]);
+            break;
+        case 2:
+            for (size_t i = 0; i < length; i++) data[i] = static_cast<uint8_t>(data[i] + up[i]);
+            break;
+        case 3:
+            for (size_t i = 0; i < length; i++) {
+                int left = i >= bpp ? data[i - bpp] : 0;
+                data[i] = static_cast<uint8_t>(data[i] + (left + up[i]) / 2);
+            }
+            break;
+        case 4:
+            for (size_t i = 0; i < length; i++) {
+                int left = i >= bpp ? data[i - bpp] : 0;
+                int upLeft = i >= bpp ? up[i - bpp] : 0;
+                data[i] = static_cast<uint8_t>(data[i] + paeth(left, up[i], upLeft));
+            }
+            break;
+        default:
+            this->failed = true;
+            return false;
+    }
+    std::memcpy(this->previous.data(), data, length);
+    this->rowRead = 0;
+    this->rowAvailable = length;
+    return true;
+}
+
+size_t PredictorFilter::read(char* out, size_t capacity) {
+    if (this->failed) return 0;
+    size_t written = 0;
+    while (written < capacity) {
+        if (this->rowRead == this->rowAvailable && !this->nextRow()) break;
+        size_t length = std::min(capacity - written, this->rowAvailable - this->rowRead);
+        std::memcpy(out + written, this->previous.data() + this->rowRead, length);
+        this->rowRead += length;
+        written += length;
+    }
+    return written;
+}
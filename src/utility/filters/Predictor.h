@@ -0,0 +1,31 @@
+#pragma once
+
+#include "StreamFilter.h"
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+/* Undo the PNG (10-15) or TIFF (2) predictor of /DecodeParms row by row, for Flate &
+    LZW data. Only the current & previous row are kept, a trailing partial row is dropped */
+class PredictorFilter: public StreamFilter {
+    public:
+        PredictorFilter(std::unique_ptr<ByteSource> source, const DecodeParams& params);
+        size_t read(char* out, size_t capacity) override;
+
+    private:
+        // Collect the next encoded row, false at the end of the data
+        bool nextRow();
+
+        bool png;
+        size_t bytesPerPixel;
+        size_t rowLength;
+        // Encoded row length, PNG rows start with their filter type byte
+        size_t encodedLength;
+        std::vector<uint8_t> row;
+        std::vector<uint8_t> previous;
+        size_t rowFilled = 0;
+        // Decoded bytes of the current row already handed out
+        size_t rowRead = 0;
+        size_t rowAvailable = 0;
+};
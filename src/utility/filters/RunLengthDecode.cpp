@@ -0,0 +1,41 @@
+#include "RunLengthDecode.h"
+
+#include <algorithm>
+#include <cstring>
+
+size_t RunLengthFilter::read(char* out, size_t capacity) {
+    size_t written = 0;
+    while (written < capacity && !this->failed) {
+        if (this->repeat > 0) {
+            size_t length = std::min(this->repeat, capacity - written);
+            std::memset(out + written, this->repeated, length);
+            this->repeat -= length;
+            written += length;
+            continue;
+        }
+        if (this->done || !this->fill()) break;
+        if (this->literal > 0) {
+            size_t length = std::min({this->literal, capacity - written, this->pending.size()});
+            std::memcpy(out + written, this->pending.data(), length);
+            this->pending.remove_prefix(length);
+            this->literal -= length;
+            written += length;
+            continue;
+        }
+
+        uint8_t length = static_cast<uint8_t>(this->pending.front());
+        this->pending.remove_prefix(1);
+        if (length < 128) {
+            this->literal = static_cast<size_t>(length) + 1;
+        } else if (length > 128) {
+            // Repeated byte may be in the next chunk
+            if (!this->fill()) break;
+            this->repeated = this->pending.front();
+            this->pending.remove_prefix(1);
+            this->repeat = 257 - static_cast<size_t>(length);
+        } else {
+            this->done = true;
+        }
+    }
+    return written;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "StreamFilter.h"
+
+#include <memory>
+#include <cstddef>
+
+/* Streaming /RunLengthDecode: a length byte 0-127 is followed by length + 1 literal bytes,
+    129-255 by one byte repeated 257 - length times & 128 ends the data */
+class RunLengthFilter: public StreamFilter {
+    public:
+        explicit RunLengthFilter(std::unique_ptr<ByteSource> source) : StreamFilter(std::move(source)) {}
+        size_t read(char* out, size_t capacity) override;
+
+    private:
+        // Bytes left of the current run
+        size_t literal = 0;
+        size_t repeat = 0;
+        char repeated = 0;
+        bool done = false;
+};
@@ -0,0 +1,73 @@
+#include "StreamFilter.h"
+
+#include "../Buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+std::string_view ByteSource::next(size_t maxLength) {
+    if (this->scratch.size() < maxLength) this->scratch.resize(maxLength);
+    size_t length = this->read(this->scratch.data(), maxLength);
+    return std::string_view(this->scratch.data(), length);
+}
+
+size_t SpanSource::read(char* out, size_t capacity) {
+    size_t length = std::min(capacity, this->data.size());
+    if (length > 0) std::memcpy(out, this->data.data(), length);
+    this->data.remove_prefix(length);
+    return length;
+}
+
+std::string_view SpanSource::next(size_t maxLength) {
+    std::string_view view = this->data.substr(0, maxLength);
+    this->data.remove_prefix(view.size());
+    return view;
+}
+
+size_t BufferSource::read(char* out, size_t capacity) {
+    std::string_view view = this->next(capacity);
+    if (!view.empty()) std::memcpy(out, view.data(), view.size());
+    return view.size();
+}
+
+std::string_view BufferSource::next(size_t maxLength) {
+    if (this->position >= this->end) return std::string_view();
+    std::string_view view = this->buffer.viewSpan(this->position, std::min(maxLength, this->end - this->position));
+    this->position += view.size();
+    if (view.empty()) {
+        // Stream data runs past the end of the file
+        this->failed = true;
+        this->position = this->end;
+        return view;
+    }
+    if (this->buffer.isContiguous()) return view;
+    // Views of windowed buffers end with the next access to the buffer, e.g. by the consumer
+    this->copy.assign(view);
+    return this->copy;
+}
+
+bool StreamFilter::fill() {
+    if (!this->pending.empty()) return true;
+    if (this->finished) return false;
+    this->pending = this->source->next(FILTER_CHUNK_SIZE);
+    if (this->pending.empty()) {
+        this->finished = true;
+        if (this->source->hasFailed()) this->failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool readAll(ByteSource& source, std::string& output, size_t sizeHint) {
+    output.clear();
+    output.resize(std::max<size_t>(sizeHint, 4096));
+    size_t written = 0;
+    while (true) {
+        if (written == output.size()) output.resize(output.size() * 2);
+        size_t length = source.read(&output[written], output.size() - written);
+        if (length == 0) break;
+        written += length;
+    }
+    output.resize(written);
+    return !source.hasFailed();
+}
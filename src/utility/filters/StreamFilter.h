@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+class Buffer;
+
+// Encoded bytes a filter pulls from its source at once
+constexpr size_t FILTER_CHUNK_SIZE = 64 * 1024;
+
+// Parameters from a stream's /DecodeParms dictionary (ISO32000 7.4.4.4)
+struct DecodeParams {
+    int predictor = 1;
+    int colors = 1;
+    int bitsPerComponent = 8;
+    int columns = 1;
+    // LZWDecode only, code length grows one code early
+    int earlyChange = 1;
+};
+
+/* Pull interface of the decode pipeline. Every filter is a source reading the encoded
+    bytes from the source before it, so decoded data never has to exist in memory as a whole */
+class ByteSource {
+    public:
+        virtual ~ByteSource() = default;
+        // Up to capacity decoded bytes into out, 0 once the data ended (or was corrupt)
+        virtual size_t read(char* out, size_t capacity) = 0;
+        // Next bytes as a view valid until the next call, empty at the end. Copies through read() unless overridden
+        virtual std::string_view next(size_t maxLength);
+        // Input was corrupt, the bytes read before are all that could be decoded
+        bool hasFailed() const { return failed; }
+
+    protected:
+        bool failed = false;
+
+    private:
+        std::vector<char> scratch;
+};
+
+// Bytes already in memory, views are handed out without copying
+class SpanSource: public ByteSource {
+    public:
+        explicit SpanSource(std::string_view data) : data(data) {}
+        size_t read(char* out, size_t capacity) override;
+        std::string_view next(size_t maxLength) override;
+
+    private:
+        std::string_view data;
+};
+
+/* Byte range of a Buffer, read a chunk at a time. Windowed buffers only keep a bounded part
+    of the file in memory, views of them are copied. The buffer has to outlive the source */
+class BufferSource: public ByteSource {
+    public:
+        BufferSource(Buffer& buffer, size_t start, size_t length) : buffer(buffer), position(start), end(start + length) {}
+        size_t read(char* out, size_t capacity) override;
+        std::string_view next(size_t maxLength) override;
+
+    private:
+        Buffer& buffer;
+        size_t position;
+        size_t end;
+        std::string copy;
+};
+
+// Filter of the pipeline, encoded input is pulled from the source in chunks of FILTER_CHUNK_SIZE
+class StreamFilter: public ByteSource {
+    public:
+        explicit StreamFilter(std::unique_ptr<ByteSource> source) : source(std::move(source)) {}
+
+    protected:
+        // Make encoded input available in pending, false once the source is exhausted
+        bool fill();
+
+        std::unique_ptr<ByteSource> source;
+        // Encoded bytes pulled from the source & not consumed yet
+        std::string_view pending;
+        bool finished = false;
+};
+
+// Pull everything left from a source, false if it failed (output keeps what was decoded)
+bool readAll(ByteSource& source, std::string& output, size_t sizeHint = 0);
@@ -0,0 +1,311 @@
+#include "ObjectGraph.h"
+#include "../PdfReader.h"
+#include "../objects/ReferenceObject.h"
+#include "../parallel/WorkStealingRange.h"
+#include "../writer/XRefWriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+static size_t workerCount(size_t threads, size_t items) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    // More workers than grains would only idle
+    return std::max<size_t>(1, std::min(threads, (items + GRAPH_GRAIN - 1) / GRAPH_GRAIN));
+}
+
+// Explicit stack, values nest up to MAX_VALUE_NESTING levels. Passed in so building reuses one per worker
+static void collectReferences(const Value& value, std::vector<size_t>& references, bool streamLengths, std::vector<const Value*>& stack) {
+    stack.clear();
+    stack.push_back(&value);
+    while (!stack.empty()) {
+        const Value* current = stack.back();
+        stack.pop_back();
+        switch (current->getType()) {
+            case OBJT_INDIRECT:
+                references.push_back(current->getNumber());
+                break;
+            case OBJT_ARRAY:
+                for (size_t i = 0; i < current->size(); i++) stack.push_back(&current->getItems()[i]);
+                break;
+            case OBJT_DICTIONARY:
+                for (size_t i = 0; i < current->size(); i++) stack.push_back(&current->getEntries()[i].value);
+                break;
+            case OBJT_STREAM: {
+                const Value& dictionary = current->getStream()->dictionary;
+                for (size_t i = 0; i < dictionary.size(); i++) {
+                    if (streamLengths || dictionary.getEntries()[i].key != NAME_LENGTH) stack.push_back(&dictionary.getEntries()[i].value);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+void ObjectGraph::collectReferences(const Value& value, std::vector<size_t>& references, bool streamLengths) {
+    std::vector<const Value*> stack;
+    ::collectReferences(value, references, streamLengths, stack);
+}
+
+std::vector<size_t> ObjectGraph::trailerRoots(PdfReader& reader) {
+    std::vector<size_t> roots;
+    std::shared_ptr<DictionaryObject> trailer = reader.getTrailer();
+    if (!trailer) return roots;
+    for (const auto& [key, value]: trailer->getElements()) {
+        // Keys of the xref section itself, e.g. an indirect /Length of an xref stream, aren't document objects
+        if (XRefWriter::isSectionKey(key)) continue;
+        std::shared_ptr<ReferenceObject> reference = std::dynamic_pointer_cast<ReferenceObject>(value);
+        if (reference) roots.push_back(reference->getNumber());
+    }
+    return roots;
+}
+
+bool ObjectGraph::build(PdfReader& reader, size_t threads, bool streamLengths) {
+    if (!reader.hasDocument()) return false;
+
+    // Nodes are the numbers with an xref entry that have an object, which decides which references are kept
+    this->numbers.clear();
+    for (size_t number: reader.getXRefIndex().getObjectNumbers()) {
+        if (number > 0 && number < UINT32_MAX && !reader.getDocumentObject(number).isNull()) this->numbers.push_back(static_cast<uint32_t>(number));
+    }
+    size_t count = this->numbers.size();
+    size_t denseCount = this->numbers.empty() ? 0 : std::min<size_t>(this->numbers.back() + 1, std::max(GRAPH_DENSE_MINIMUM, 2 * count));
+    this->denseNodes.assign(denseCount, GRAPH_NO_NODE);
+    for (size_t node = 0; node < count && this->numbers[node] < denseCount; node++) this->denseNodes[this->numbers[node]] = static_cast<uint32_t>(node);
+
+    // Workers collect the edges of their grains, grains are concatenated in order afterwards
+    size_t workers = workerCount(threads, count);
+    size_t grains = (count + GRAPH_GRAIN - 1) / GRAPH_GRAIN;
+    std::vector<std::vector<uint32_t>> grainTargets(grains);
+    std::vector<uint32_t> degrees(count, 0);
+    std::vector<size_t> workerDangling(workers, 0);
+    WorkStealingRange range(count, workers, GRAPH_GRAIN);
+    runOnWorkers(workers, [&](size_t worker) {
+        std::vector<size_t> references;
+        std::vector<const Value*> stack;
+        size_t begin, end;
+        while (range.next(worker, begin, end)) {
+            std::vector<uint32_t>& edges = grainTargets[begin / GRAPH_GRAIN];
+            for (size_t node = begin; node < end; node++) {
+                references.clear();
+                ::collectReferences(reader.getDocumentObject(this->numbers[node]), references, streamLengths, stack);
+                // Sorted numbers give sorted nodes
+                std::sort(references.begin(), references.end());
+                references.erase(std::unique(references.begin(), references.end()), references.end());
+                for (size_t target: references) {
+                    uint32_t targetNode = this->getNode(target);
+                    if (targetNode != GRAPH_NO_NODE) {
+                        edges.push_back(targetNode);
+                        degrees[node]++;
+                    } else {
+                        workerDangling[worker]++;
+                    }
+                }
+            }
+        }
+    });
+
+    this->offsets.assign(count + 1, 0);
+    for (size_t node = 0; node < count; node++) this->offsets[node + 1] = this->offsets[node] + degrees[node];
+    this->targets.resize(this->offsets[count]);
+    for (size_t grain = 0; grain < grains; grain++) {
+        std::vector<uint32_t>& edges = grainTargets[grain];
+        if (!edges.empty()) std::memcpy(&this->targets[this->offsets[grain * GRAPH_GRAIN]], edges.data(), edges.size() * sizeof(uint32_t));
+        edges = std::vector<uint32_t>();
+    }
+    this->dangling = 0;
+    for (size_t value: workerDangling) this->dangling += value;
+
+    // Sources are visited in order, so every list of referrers ends up sorted
+    this->reverseOffsets.assign(count + 1, 0);
+    for (uint32_t target: this->targets) this->reverseOffsets[target + 1]++;
+    for (size_t node = 0; node < count; node++) this->reverseOffsets[node + 1] += this->reverseOffsets[node];
+    this->sources.resize(this->targets.size());
+    std::vector<uint64_t> fill(this->reverseOffsets.begin(), this->reverseOffsets.end() - 1);
+    for (size_t node = 0; node < count; node++) {
+        for (uint64_t edge = this->offsets[node]; edge < this->offsets[node + 1]; edge++) {
+            this->sources[fill[this->targets[edge]]++] = static_cast<uint32_t>(node);
+        }
+    }
+    return true;
+}
+
+uint32_t ObjectGraph::getNode(size_t number) const {
+    if (number < this->denseNodes.size()) return this->denseNodes[number];
+    auto found = std::lower_bound(this->numbers.begin(), this->numbers.end(), number);
+    if (found == this->numbers.end() || *found != number) return GRAPH_NO_NODE;
+    return static_cast<uint32_t>(found - this->numbers.begin());
+}
+
+GraphEdges ObjectGraph::edges(const std::vector<uint64_t>& rows, const std::vector<uint32_t>& columns, size_t number) const {
+    uint32_t node = this->getNode(number);
+    if (node == GRAPH_NO_NODE) return GraphEdges();
+    return GraphEdges{columns.data() + rows[node], columns.data() + rows[node + 1], this->numbers.data()};
+}
+
+GraphEdges ObjectGraph::getReferences(size_t number) const {
+    return this->edges(this->offsets, this->targets, number);
+}
+
+GraphEdges ObjectGraph::getReferrers(size_t number) const {
+    return this->edges(this->reverseOffsets, this->sources, number);
+}
+
+std::vector<uint32_t> ObjectGraph::distances(const std::vector<size_t>& roots, size_t threads) const {
+    size_t count = this->numbers.size();
+    std::vector<std::atomic<uint32_t>> visited(count);
+    for (std::atomic<uint32_t>& distance: visited) distance.store(GRAPH_UNREACHED, std::memory_order_relaxed);
+
+    std::vector<uint32_t> frontier;
+    for (size_t root: roots) {
+        uint32_t node = this->getNode(root);
+        if (node == GRAPH_NO_NODE || visited[node].load(std::memory_order_relaxed) == 0) continue;
+        visited[node].store(0, std::memory_order_relaxed);
+        frontier.push_back(node);
+    }
+
+    // Whoever sets a distance first adds the node to the next frontier, each node is expanded once
+    std::vector<uint32_t> next;
+    for (uint32_t level = 1; !frontier.empty(); level++) {
+        size_t workers = workerCount(threads, frontier.size());
+        std::vector<std::vector<uint32_t>> found(workers);
+        WorkStealingRange range(frontier.size(), workers, GRAPH_GRAIN);
+        runOnWorkers(workers, [&](size_t worker) {
+            size_t begin, end;
+            while (range.next(worker, begin, end)) {
+                for (size_t i = begin; i < end; i++) {
+                    for (uint64_t edge = this->offsets[frontier[i]]; edge < this->offsets[frontier[i] + 1]; edge++) {
+                        uint32_t target = this->targets[edge];
+                        uint32_t expected = GRAPH_UNREACHED;
+                        if (visited[target].load(std::memory_order_relaxed) == GRAPH_UNREACHED &&
+                            visited[target].compare_exchange_strong(expected, level, std::memory_order_relaxed)) {
+                            found[worker].push_back(target);
+                        }
+                    }
+                }
+            }
+        });
+        next.clear();
+        for (const std::vector<uint32_t>& nodes: found) next.insert(next.end(), nodes.begin(), nodes.end());
+        frontier.swap(next);
+    }
+
+    std::vector<uint32_t> result(count);
+    for (size_t node = 0; node < count; node++) result[node] = visited[node].load(std::memory_order_relaxed);
+    return result;
+}
+
+std::vector<uint8_t> ObjectGraph::reachable(const std::vector<size_t>& roots, size_t threads) const {
+    std::vector<uint32_t> distance = this->distances(roots, threads);
+    std::vector<uint8_t> result(distance.size());
+    for (size_t node = 0; node < distance.size(); node++) result[node] = distance[node] != GRAPH_UNREACHED;
+    return result;
+}
+
+bool ObjectGraph::reaches(size_t from, size_t to) const {
+    uint32_t start = this->getNode(from);
+    uint32_t goal = this->getNode(to);
+    if (start == GRAPH_NO_NODE || goal == GRAPH_NO_NODE) return false;
+    if (start == goal) return true;
+    std::vector<uint8_t> visited(this->numbers.size(), 0);
+    std::vector<uint32_t> queue{start};
+    visited[start] = 1;
+    for (size_t i = 0; i < queue.size(); i++) {
+        for (uint64_t edge = this->offsets[queue[i]]; edge < this->offsets[queue[i] + 1]; edge++) {
+            uint32_t target = this->targets[edge];
+            if (target == goal) return true;
+            if (visited[target]) continue;
+            visited[target] = 1;
+            queue.push_back(target);
+        }
+    }
+    return false;
+}
+
+std::vector<uint32_t> ObjectGraph::components(size_t& count) const {
+    const uint32_t unvisited = UINT32_MAX;
+    size_t nodes = this->numbers.size();
+    std::vector<uint32_t> component(nodes, 0);
+    std::vector<uint32_t> index(nodes, unvisited);
+    std::vector<uint32_t> low(nodes, 0);
+    std::vector<uint8_t> onStack(nodes, 0);
+    std::vector<uint32_t> stack;
+    // Call stack of the recursive formulation: node & its next edge to follow
+    std::vector<std::pair<uint32_t, uint64_t>> calls;
+    uint32_t nextIndex = 0;
+    count = 0;
+
+    auto visit = [&](uint32_t node) {
+        index[node] = low[node] = nextIndex++;
+        stack.push_back(node);
+        onStack[node] = 1;
+        calls.emplace_back(node, this->offsets[node]);
+    };
+
+    for (size_t root = 0; root < nodes; root++) {
+        if (index[root] != unvisited) continue;
+        visit(static_cast<uint32_t>(root));
+        while (!calls.empty()) {
+            uint32_t node = calls.back().first;
+            uint64_t edge = calls.back().second;
+            if (edge < this->offsets[node + 1]) {
+                calls.back().second++;
+                uint32_t target = this->targets[edge];
+                if (index[target] == unvisited) {
+                    visit(target);
+                } else if (onStack[target]) {
+                    low[node] = std::min(low[node], index[target]);
+                }
+                continue;
+            }
+
+            // All edges followed, hand the lowest index reached up to the caller
+            calls.pop_back();
+            if (!calls.empty()) low[calls.back().first] = std::min(low[calls.back().first], low[node]);
+            if (low[node] != index[node]) continue;
+            uint32_t member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                onStack[member] = 0;
+                component[member] = static_cast<uint32_t>(count);
+            } while (member != node);
+            count++;
+        }
+    }
+    return component;
+}
+
+std::vector<std::vector<size_t>> ObjectGraph::cycles() const {
+    size_t count;
+    std::vector<uint32_t> component = this->components(count);
+    std::vector<std::vector<size_t>> members(count);
+    for (size_t node = 0; node < component.size(); node++) members[component[node]].push_back(node);
+
+    std::vector<std::vector<size_t>> result;
+    for (std::vector<size_t>& nodes: members) {
+        if (nodes.size() == 1) {
+            const uint32_t* first = this->targets.data() + this->offsets[nodes[0]];
+            const uint32_t* last = this->targets.data() + this->offsets[nodes[0] + 1];
+            if (!std::binary_search(first, last, static_cast<uint32_t>(nodes[0]))) continue;
+        }
+        for (size_t& node: nodes) node = this->numbers[node];
+        result.push_back(std::move(nodes));
+    }
+    return result;
+}
+
+std::vector<size_t> ObjectGraph::dependencyOrder() const {
+    size_t count;
+    std::vector<uint32_t> component = this->components(count);
+    // Counting sort by component, objects of a component stay in number order
+    std::vector<size_t> starts(count + 1, 0);
+    for (uint32_t id: component) starts[id + 1]++;
+    for (size_t id = 0; id < count; id++) starts[id + 1] += starts[id];
+    std::vector<size_t> order(component.size());
+    for (size_t node = 0; node < component.size(); node++) order[starts[component[node]]++] = this->numbers[node];
+    return order;
+}
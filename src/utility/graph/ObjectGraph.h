@@ -0,0 +1,117 @@
+#pragma once
+
+#include "../objects/Value.h"
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+class PdfReader;
+
+// Distance of objects no root reaches
+constexpr uint32_t GRAPH_UNREACHED = UINT32_MAX;
+// Node of object numbers without an object
+constexpr uint32_t GRAPH_NO_NODE = UINT32_MAX;
+// Objects (building) & frontier entries (traversal) a worker takes at once
+constexpr size_t GRAPH_GRAIN = 1024;
+// Number -> node table always covers this many numbers, beyond it only up to twice the nodes
+constexpr size_t GRAPH_DENSE_MINIMUM = 1 << 16;
+
+// Object numbers of one adjacency list, sorted & without repeats
+struct GraphEdges {
+    // Walks the stored nodes & yields their object numbers, nodes are in number order so both are sorted
+    class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = uint32_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const uint32_t*;
+            using reference = uint32_t;
+
+            iterator(const uint32_t* node, const uint32_t* numbers) : node(node), numbers(numbers) {};
+            uint32_t operator*() const { return numbers[*node]; }
+            iterator& operator++() { node++; return *this; }
+            iterator operator++(int) { iterator previous = *this; node++; return previous; }
+            bool operator==(const iterator& other) const { return node == other.node; }
+            bool operator!=(const iterator& other) const { return node != other.node; }
+
+        private:
+            const uint32_t* node;
+            const uint32_t* numbers;
+    };
+
+    const uint32_t* first = nullptr;
+    const uint32_t* last = nullptr;
+    const uint32_t* numbers = nullptr;
+
+    iterator begin() const { return iterator(first, numbers); }
+    iterator end() const { return iterator(last, numbers); }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+/* Indirect references between the objects of a document as a compressed sparse row graph:
+    one offsets array indexed by node into one array of target nodes, the same for the
+    reverse direction. Built once from the reader's arena model, after that no object is
+    touched again & queries only walk flat arrays.
+
+    Every object parsed into the arena is a node, nodes are numbered in object number order.
+    Memory grows with the objects, not with the highest object number. References to numbers
+    without an object (free, missing or null) are left out (ISO32000 7.3.10 reads them as null).
+    Per node results are indexed by node, getNumbers() gives the object number of each.
+    Building & breadth first queries run on worker threads, the results don't depend on
+    their number. Queries are const & can run concurrently */
+class ObjectGraph {
+    public:
+        /* Edges of every object parsed into the reader's arena, false if parseDocument() didn't run.
+            Without stream lengths the /Length of a stream isn't an edge (it's written directly
+            once a stream is written again), 0 threads uses every core */
+        bool build(PdfReader& reader, size_t threads = 1, bool streamLengths = true);
+        // References of a value, nested arrays & dictionaries included
+        static void collectReferences(const Value& value, std::vector<size_t>& references, bool streamLengths = true);
+        // Objects the trailer refers to directly (/Root, /Info), keys of the xref section itself left out
+        static std::vector<size_t> trailerRoots(PdfReader& reader);
+
+        size_t getNodeCount() const { return numbers.size(); }
+        size_t getEdgeCount() const { return targets.size(); }
+        // References to objects that don't exist
+        size_t getDanglingCount() const { return dangling; }
+        // Object number of every node, ascending
+        const std::vector<uint32_t>& getNumbers() const { return numbers; }
+        uint32_t getNode(size_t number) const;
+        bool hasObject(size_t number) const { return getNode(number) != GRAPH_NO_NODE; }
+
+        GraphEdges getReferences(size_t number) const;
+        GraphEdges getReferrers(size_t number) const;
+        // Objects referring to an object, e.g. how widely a font or image is shared
+        size_t getFanIn(size_t number) const { return getReferrers(number).size(); }
+
+        /* References followed from the nearest root object to every node, GRAPH_UNREACHED if none
+            leads there. Level by level, each level's frontier is split over the threads */
+        std::vector<uint32_t> distances(const std::vector<size_t>& roots, size_t threads = 1) const;
+        std::vector<uint8_t> reachable(const std::vector<size_t>& roots, size_t threads = 1) const;
+        // A chain of references leads from one object to the other, stops as soon as it's found
+        bool reaches(size_t from, size_t to) const;
+
+        /* Strongly connected components (iterative Tarjan), the component of every node. Components
+            are numbered as they complete, so references only go to the same or lower numbered components */
+        std::vector<uint32_t> components(size_t& count) const;
+        // Object numbers in reference cycles grouped by cycle, a cycle is a component with more than one object or a self reference
+        std::vector<std::vector<size_t>> cycles() const;
+        // Every object number after the objects it refers to, the objects of a cycle next to each other
+        std::vector<size_t> dependencyOrder() const;
+
+    private:
+        GraphEdges edges(const std::vector<uint64_t>& rows, const std::vector<uint32_t>& columns, size_t number) const;
+
+        // Forward & reverse adjacency in nodes, offsets have one slot more than there are nodes
+        std::vector<uint64_t> offsets;
+        std::vector<uint32_t> targets;
+        std::vector<uint64_t> reverseOffsets;
+        std::vector<uint32_t> sources;
+        std::vector<uint32_t> numbers;
+        // Node of the numbers below its size, numbers beyond it are searched in numbers
+        std::vector<uint32_t> denseNodes;
+        size_t dangling = 0;
+};
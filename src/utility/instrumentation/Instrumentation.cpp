@@ -0,0 +1,17 @@
+#include "Instrumentation.h"
+
+const char* phaseName(ReaderPhase phase) {
+    switch (phase) {
+        case PHASE_READ_FILE_HEADER: return "readFileHeader";
+        case PHASE_VALIDATE_EOF: return "validateEOF";
+        case PHASE_PARSE_XREF_OFFSET: return "parseXRefOffset";
+        case PHASE_PARSE_XREF_TABLE: return "parseXRefTable";
+        case PHASE_RECOVER_XREF: return "recoverXRef";
+        case PHASE_LOAD_INDEX: return "loadIndex";
+        case PHASE_RESOLVE_OBJECTS: return "resolveObjects";
+        case PHASE_DECODE_STREAMS: return "decodeStreams";
+        case PHASE_PARSE_DOCUMENT: return "parseDocument";
+        case PHASE_COUNT: break;
+    }
+    return "unknown";
+}
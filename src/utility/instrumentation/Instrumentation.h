@@ -0,0 +1,87 @@
+#pragma once
+
+#include "TraceRecorder.h"
+#include "../ObjectCache.h"
+#include "../StreamCache.h"
+#include "../buffer/BufferBackend.h"
+
+#include <chrono>
+#include <cstddef>
+
+/* Phase timers & counters of PdfReader. Building without WAVEPDF_INSTRUMENTATION (CMake option)
+    turns the macros below into nothing, the stats API stays & reports zeros then */
+#ifndef WAVEPDF_INSTRUMENTATION
+#define WAVEPDF_INSTRUMENTATION 0
+#endif
+
+enum ReaderPhase {
+    PHASE_READ_FILE_HEADER,
+    PHASE_VALIDATE_EOF,
+    PHASE_PARSE_XREF_OFFSET,
+    PHASE_PARSE_XREF_TABLE,
+    PHASE_RECOVER_XREF,
+    PHASE_LOAD_INDEX,
+    // Lazy getObject() calls that weren't served by the cache
+    PHASE_RESOLVE_OBJECTS,
+    PHASE_DECODE_STREAMS,
+    PHASE_PARSE_DOCUMENT,
+    PHASE_COUNT
+};
+
+const char* phaseName(ReaderPhase phase);
+
+// Times are inclusive, e.g. a stream decoded while parsing the xref table counts for both phases
+struct ReaderStats {
+    double phaseSeconds[PHASE_COUNT] = {};
+    size_t phaseCalls[PHASE_COUNT] = {};
+
+    // Bytes of objects & xref sections the parsers went through
+    size_t bytesParsed = 0;
+    // Indirect objects parsed, lazily or by parseDocument()
+    size_t objectsParsed = 0;
+    // Objects of the shared_ptr model created by the parser
+    size_t objectAllocations = 0;
+    // Memory of the values parseDocument() put into the document arena
+    size_t arenaBytesUsed = 0;
+    size_t arenaBytesReserved = 0;
+
+    ObjectCacheStats cache;
+    StreamCacheStats streams;
+    BufferStats buffer;
+};
+
+// Adds its lifetime to a phase of the stats & records a trace event if a recorder is given
+class ScopedPhase {
+    public:
+        ScopedPhase(ReaderStats& stats, ReaderPhase phase, TraceRecorder* trace)
+            : stats(stats), phase(phase), trace(trace), start(TraceRecorder::Clock::now()) {};
+        ~ScopedPhase() {
+            TraceRecorder::Clock::time_point end = TraceRecorder::Clock::now();
+            stats.phaseSeconds[phase] += std::chrono::duration<double>(end - start).count();
+            stats.phaseCalls[phase]++;
+            if (trace) trace->record(phaseName(phase), start, end);
+        }
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    private:
+        ReaderStats& stats;
+        ReaderPhase phase;
+        TraceRecorder* trace;
+        TraceRecorder::Clock::time_point start;
+};
+
+#define WAVEPDF_CONCAT_INNER(a, b) a##b
+#define WAVEPDF_CONCAT(a, b) WAVEPDF_CONCAT_INNER(a, b)
+
+#if WAVEPDF_INSTRUMENTATION
+// Time the rest of the enclosing scope as a phase
+#define WAVEPDF_PHASE(stats, phase, trace) ScopedPhase WAVEPDF_CONCAT(scopedPhase, __LINE__)(stats, phase, trace)
+// Trace event for the rest of the enclosing scope
+#define WAVEPDF_TRACE(trace, name) ScopedTraceEvent WAVEPDF_CONCAT(scopedTrace, __LINE__)(trace, name)
+#define WAVEPDF_COUNT(counter, amount) ((counter) += (amount))
+#else
+#define WAVEPDF_PHASE(stats, phase, trace) ((void)0)
+#define WAVEPDF_TRACE(trace, name) ((void)0)
+#define WAVEPDF_COUNT(counter, amount) ((void)0)
+#endif
@@ -0,0 +1,43 @@
+#include "TraceRecorder.h"
+
+#include <cstdio>
+#include <fstream>
+
+void TraceRecorder::record(const char* name, Clock::time_point start, Clock::time_point end) {
+    double startMicros = std::chrono::duration<double, std::micro>(start - this->origin).count();
+    double duration = std::chrono::duration<double, std::micro>(end - start).count();
+    std::lock_guard<std::mutex> guard(this->lock);
+    auto thread = this->threadIds.emplace(std::this_thread::get_id(), static_cast<uint32_t>(this->threadIds.size() + 1)).first;
+    this->events.push_back(Event{name, thread->second, startMicros, duration});
+}
+
+size_t TraceRecorder::getEventCount() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->events.size();
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->events.clear();
+}
+
+// Event names are identifiers from the code, they need no escaping
+std::string TraceRecorder::toJson() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    std::string json = "{\"traceEvents\":[";
+    char event[256];
+    for (size_t i = 0; i < this->events.size(); i++) {
+        const Event& e = this->events[i];
+        std::snprintf(event, sizeof(event), "%s\n{\"name\":\"%s\",\"cat\":\"WavePDF\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            i > 0 ? "," : "", e.name, e.thread, e.start, e.duration);
+        json += event;
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return json;
+}
+
+bool TraceRecorder::writeJson(const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    file << this->toJson();
+    return static_cast<bool>(file);
+}
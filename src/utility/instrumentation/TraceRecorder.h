@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+/* Collects complete trace events (name, thread, start & duration) & exports them in the
+    Chrome trace event format, viewable in chrome://tracing or Perfetto. Thread safe */
+class TraceRecorder {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        TraceRecorder() : origin(Clock::now()) {};
+
+        // name has to outlive the recorder, string literals only
+        void record(const char* name, Clock::time_point start, Clock::time_point end);
+        size_t getEventCount();
+        void clear();
+
+        std::string toJson();
+        bool writeJson(const std::string& path);
+
+    private:
+        struct Event {
+            const char* name;
+            uint32_t thread;
+            // Microseconds since the recorder was created
+            double start;
+            double duration;
+        };
+
+        Clock::time_point origin;
+        std::mutex lock;
+        std::vector<Event> events;
+        // Small stable ids for the trace viewer
+        std::unordered_map<std::thread::id, uint32_t> threadIds;
+};
+
+// Adds an event for its own lifetime, nothing if the recorder is nullptr
+class ScopedTraceEvent {
+    public:
+        ScopedTraceEvent(TraceRecorder* trace, const char* name) : trace(trace), name(name) {
+            if (trace) start = TraceRecorder::Clock::now();
+        }
+        ~ScopedTraceEvent() {
+            if (trace) trace->record(name, start, TraceRecorder::Clock::now());
+        }
+        ScopedTraceEvent(const ScopedTraceEvent&) = delete;
+        ScopedTraceEvent& operator=(const ScopedTraceEvent&) = delete;
+
+    private:
+        TraceRecorder* trace;
+        const char* name;
+        TraceRecorder::Clock::time_point start;
+};
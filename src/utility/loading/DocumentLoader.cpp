@@ -0,0 +1,166 @@
+#include "DocumentLoader.h"
+#include "../objects/ArrayObject.h"
+#include "../objects/ReferenceObject.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <wx/log.h>
+
+// Resource categories whose objects the first page needs before it can be drawn
+static const NameAtom FIRST_PAGE_RESOURCES[] = {NAME_FONT, NAME_XOBJECT, NAME_EXT_G_STATE, NAME_COLOR_SPACE, NAME_PATTERN, NAME_SHADING};
+
+DocumentLoader::~DocumentLoader() {
+    this->cancel();
+    this->join();
+}
+
+void DocumentLoader::join() {
+    if (this->thread.joinable()) this->thread.join();
+}
+
+std::future<LoadedDocument> DocumentLoader::start(const wxString& path, const ProgressCallback& onProgress, const FirstPageCallback& onFirstPage) {
+    if (this->running) throw std::logic_error("DocumentLoader::start() called while a load is running");
+    this->join();
+
+    this->onProgress = onProgress;
+    this->onFirstPage = onFirstPage;
+    this->control.cancelled = false;
+    this->control.objectsDone = 0;
+    this->started = std::chrono::steady_clock::now();
+    this->running = true;
+
+    std::promise<LoadedDocument> promise;
+    std::future<LoadedDocument> result = promise.get_future();
+    this->thread = std::thread(&DocumentLoader::run, this, path, std::move(promise));
+    return result;
+}
+
+double DocumentLoader::elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - this->started).count();
+}
+
+void DocumentLoader::report(LoadStage stage, size_t objectsDone, size_t objectCount) {
+    if (this->onProgress) this->onProgress(LoadProgress{stage, objectsDone, objectCount, this->elapsed()});
+}
+
+void DocumentLoader::run(const wxString& path, std::promise<LoadedDocument> promise) {
+    // Errors end up in the result, wxLog output of this thread would only reach the UI later
+    wxLogNull noLog;
+    LoadedDocument result;
+    std::unique_ptr<PdfReader> reader = std::make_unique<PdfReader>(path);
+    std::unique_ptr<PageTree> pages;
+    reader->setControl(&this->control);
+    reader->setRecovery(this->options.recoverXRef, this->options.threads);
+    reader->setIndexDirectory(this->options.indexDirectory);
+
+    bool ok = false;
+    try {
+        this->report(LOAD_INDEX);
+        ok = reader->process();
+        if (ok && !this->isCancelled()) {
+            pages = std::make_unique<PageTree>(*reader);
+            this->report(LOAD_FIRST_PAGE);
+            this->loadFirstPage(*reader, *pages);
+        }
+        // The reader still loads objects lazily if parsing them all fails
+        if (ok && this->options.parseObjects && !this->isCancelled() && !this->parseObjects(*reader)) {
+            result.log = reader->getLog();
+        }
+    } catch (const std::exception& e) {
+        ok = false;
+        result.errorMessage = "Can't read file";
+        result.log = e.what();
+    }
+
+    if (this->isCancelled()) {
+        result.stage = LOAD_CANCELLED;
+    } else if (ok) {
+        result.stage = LOAD_DONE;
+        reader->setControl(nullptr);
+        result.reader = std::move(reader);
+        result.pages = std::move(pages);
+    } else {
+        result.stage = LOAD_FAILED;
+        if (result.errorMessage.empty()) {
+            result.errorMessage = reader->getErrorMessage();
+            result.log = reader->getLog();
+        }
+        // Files that can't be opened fail before any step sets an error
+        if (result.errorMessage.empty()) result.errorMessage = "Can't open file";
+    }
+    // The page tree points into the reader, it goes first
+    pages.reset();
+    reader.reset();
+
+    LoadStage stage = result.stage;
+    result.seconds = this->elapsed();
+    // Cleared first, so whoever sees the future ready also sees the load as over
+    this->running = false;
+    promise.set_value(std::move(result));
+    this->report(stage);
+}
+
+bool DocumentLoader::loadFirstPage(PdfReader& reader, PageTree& pages) {
+    FirstPage first;
+    first.pageCount = pages.getPageCount();
+    std::optional<Page> page = pages.getPage(0);
+    if (!page.has_value()) return false;
+    first.page = page.value();
+
+    // Content is a stream or an array of streams, both indirect
+    auto appendContent = [&reader, &first](const std::shared_ptr<BaseObject>& value) {
+        std::shared_ptr<ReferenceObject> reference = std::dynamic_pointer_cast<ReferenceObject>(value);
+        if (!reference) return;
+        std::shared_ptr<const std::string> data = reader.getDecodedStream(reference->getNumber(), reference->getGeneration());
+        if (!data) return;
+        if (!first.content.empty()) first.content += '\n';
+        first.content += *data;
+    };
+    std::shared_ptr<BaseObject> contents = first.page.dictionary->getElement(NAME_CONTENTS);
+    std::shared_ptr<ArrayObject> parts = std::dynamic_pointer_cast<ArrayObject>(reader.resolve(contents));
+    if (parts) {
+        for (const std::shared_ptr<BaseObject>& part: parts->getObjects()) {
+            if (this->isCancelled()) return false;
+            appendContent(part);
+        }
+    } else {
+        appendContent(contents);
+    }
+
+    // Objects the content refers to by name are loaded into the caches now, ahead of the rest of the document
+    std::shared_ptr<DictionaryObject> resources = std::dynamic_pointer_cast<DictionaryObject>(reader.resolve(first.page.attributes.resources));
+    for (NameAtom category: FIRST_PAGE_RESOURCES) {
+        std::shared_ptr<DictionaryObject> entries = resources ? std::dynamic_pointer_cast<DictionaryObject>(reader.resolve(resources->getElement(category))) : nullptr;
+        if (!entries) continue;
+        for (const auto& [name, value]: entries->getElements()) {
+            if (this->isCancelled()) return false;
+            std::shared_ptr<ReferenceObject> reference = std::dynamic_pointer_cast<ReferenceObject>(value);
+            // Images & forms are decoded, the stream cache keeps them for drawing the page
+            if (category == NAME_XOBJECT && reference) {
+                reader.getDecodedStream(reference->getNumber(), reference->getGeneration());
+            } else {
+                reader.resolve(value);
+            }
+        }
+    }
+
+    first.seconds = this->elapsed();
+    if (this->onFirstPage) this->onFirstPage(first);
+    return true;
+}
+
+bool DocumentLoader::parseObjects(PdfReader& reader) {
+    // parseDocument() goes through the numbers with an xref entry
+    size_t count = reader.getXRefIndex().getObjectNumbers().size();
+    this->control.objectsDone = 0;
+    this->report(LOAD_OBJECTS, 0, count);
+
+    // Parsed on another thread, this one only reports how far it got
+    std::future<bool> parsed = std::async(std::launch::async, [this, &reader] { return reader.parseDocument(this->options.threads); });
+    while (parsed.wait_for(std::chrono::milliseconds(LOAD_PROGRESS_INTERVAL_MS)) != std::future_status::ready) {
+        this->report(LOAD_OBJECTS, std::min(this->control.objectsDone.load(), count), count);
+    }
+    if (!parsed.get()) return false;
+    this->report(LOAD_OBJECTS, count, count);
+    return true;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "../PdfReader.h"
+#include "../pages/PageTree.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstddef>
+
+// How often the object count is reported while the document is parsed
+constexpr size_t LOAD_PROGRESS_INTERVAL_MS = 100;
+
+enum LoadStage {
+    // Header & xref index
+    LOAD_INDEX,
+    // Page tree root & the objects of the first page
+    LOAD_FIRST_PAGE,
+    // Every object of the document, objectsDone counts up to objectCount
+    LOAD_OBJECTS,
+    // Final stages, the result is ready when they are reported
+    LOAD_DONE,
+    LOAD_FAILED,
+    LOAD_CANCELLED
+};
+
+struct LoadOptions {
+    // Threads parsing the objects, 0 uses every core
+    size_t threads = 0;
+    // Parse every object into the reader's arena after the first page
+    bool parseObjects = true;
+    // Rebuild the xref of damaged documents by scanning for objects
+    bool recoverXRef = true;
+    // Parse index files are kept there, unchanged documents skip xref parsing. Empty is off
+    std::string indexDirectory;
+};
+
+struct LoadProgress {
+    LoadStage stage = LOAD_INDEX;
+    size_t objectsDone = 0;
+    size_t objectCount = 0;
+    // Since the load started
+    double seconds = 0;
+};
+
+/* What a viewer needs to show the first page before the rest is loaded. Parsed objects aren't
+    changed after parsing, so it can be read on another thread while the loader goes on */
+struct FirstPage {
+    Page page;
+    size_t pageCount = 0;
+    // Decoded /Contents streams of the page, joined by newlines
+    std::string content;
+    double seconds = 0;
+};
+
+struct LoadedDocument {
+    LoadStage stage = LOAD_FAILED;
+    // Both are null unless the load is done, the page tree reads through the reader
+    std::unique_ptr<PdfReader> reader;
+    std::unique_ptr<PageTree> pages;
+    std::string errorMessage;
+    std::string log;
+    double seconds = 0;
+};
+
+/* Loads a document on its own thread: header & xref first, then the first page & the
+    objects it uses, then (optionally) every object of the document. Progress & the first
+    page are reported through callbacks on the loading thread, the result through a future.
+    cancel() stops it between xref sections, pages & parse grains */
+class DocumentLoader {
+    public:
+        // Called on the loading thread, never concurrently. They may cancel() but not start() or join()
+        using ProgressCallback = std::function<void(const LoadProgress&)>;
+        using FirstPageCallback = std::function<void(const FirstPage&)>;
+
+        explicit DocumentLoader(const LoadOptions& options = LoadOptions()) : options(options) {};
+        // Cancels a running load & waits for its thread
+        ~DocumentLoader();
+        DocumentLoader(const DocumentLoader&) = delete;
+        DocumentLoader& operator=(const DocumentLoader&) = delete;
+
+        /* Start loading a file, the future becomes ready before the final stage is reported.
+            Throws std::logic_error if a load is already running */
+        std::future<LoadedDocument> start(const wxString& path, const ProgressCallback& onProgress = nullptr,
+            const FirstPageCallback& onFirstPage = nullptr);
+        void cancel() { control.cancelled = true; }
+        bool isCancelled() { return control.cancelled; }
+        // False by the time the result is set, start() joins the thread that is still reporting
+        bool isRunning() { return running; }
+        // Wait for the loading thread, e.g. before dropping the objects the callbacks use
+        void join();
+
+    private:
+        void run(const wxString& path, std::promise<LoadedDocument> promise);
+        bool loadFirstPage(PdfReader& reader, PageTree& pages);
+        bool parseObjects(PdfReader& reader);
+        void report(LoadStage stage, size_t objectsDone = 0, size_t objectCount = 0);
+        double elapsed() const;
+
+        LoadOptions options;
+        ProgressCallback onProgress;
+        FirstPageCallback onFirstPage;
+        ReaderControl control;
+        std::thread thread;
+        std::atomic<bool> running{false};
+        std::chrono::steady_clock::time_point started;
+};
@@ -9,6 +9,7 @@ class ArrayObject: public BaseObject {
         explicit ArrayObject(size_t start) : BaseObject(start) {};
         void addObject(std::shared_ptr<BaseObject> obj) { objects.push_back(obj); } 
         ObjectType getType() override { return OBJT_ARRAY; }
+        const std::vector<std::shared_ptr<BaseObject>>& getObjects() const { return objects; }
 
     private:
         std::vector<std::shared_ptr<BaseObject>> objects;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
 enum ObjectType {
@@ -31,5 +32,5 @@ class BaseObject {
 
     protected:
         size_t start;
-        size_t end;
+        size_t end = 0;
 };
@@ -4,6 +4,7 @@
 
 class BooleanObject: public BaseObject {
     public:
+        explicit BooleanObject(size_t start, size_t end, bool value) : BaseObject(start, end), value(value) {};
         ObjectType getType() override { return OBJT_BOOLEAN; }
         bool getValue() const { return value; }
 
@@ -1,15 +1,42 @@
 #pragma once
 
 #include "BaseObject.h"
-#include <unordered_map>
+#include "NameObject.h"
+#include "NameManager.h"
+#include <vector>
 #include <memory>
+#include <string_view>
+#include <utility>
 
+/* Dictionaries are small, a flat list keyed by name atom beats hashing.
+    A key added twice keeps the later value */
 class DictionaryObject: public BaseObject {
     public:
         explicit DictionaryObject(size_t start) : BaseObject(start) {};
         ObjectType getType() override { return OBJT_DICTIONARY; }
-        void addElement(std::shared_ptr<NameObject> name, std::shared_ptr<BaseObject> obj) { objects[name] = obj; }  
+        void addElement(std::shared_ptr<NameObject> name, std::shared_ptr<BaseObject> obj) { addElement(name->getAtom(), obj); }
+        void addElement(NameAtom key, std::shared_ptr<BaseObject> obj) {
+            for (auto& element: objects) {
+                if (element.first == key) {
+                    element.second = obj;
+                    return;
+                }
+            }
+            objects.emplace_back(key, obj);
+        }
+
+        // Look up a value by its key, nullptr if missing
+        std::shared_ptr<BaseObject> getElement(NameAtom key) const {
+            for (const auto& element: objects) {
+                if (element.first == key) return element.second;
+            }
+            return nullptr;
+        }
+        // Same by key name (without the leading /)
+        std::shared_ptr<BaseObject> getElement(std::string_view name) const { return getElement(NameManager::global().find(name)); }
+
+        const std::vector<std::pair<NameAtom, std::shared_ptr<BaseObject>>>& getElements() const { return objects; }
 
     private:
-        std::unordered_map<std::shared_ptr<NameObject>, std::shared_ptr<BaseObject>> objects;
+        std::vector<std::pair<NameAtom, std::shared_ptr<BaseObject>>> objects;
 };
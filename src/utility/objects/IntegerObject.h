@@ -0,0 +1,14 @@
+#pragma once
+
+#include "BaseObject.h"
+#include <cstdint>
+
+class IntegerObject: public BaseObject {
+    public:
+        explicit IntegerObject(size_t start, size_t end, int64_t value) : BaseObject(start, end), value(value) {};
+        ObjectType getType() override { return OBJT_INTEGER; }
+        int64_t getValue() const { return value; }
+
+    private:
+        int64_t value;
+};
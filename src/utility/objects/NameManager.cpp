@@ -0,0 +1,168 @@
+#include "NameManager.h"
+
+#include <atomic>
+#include <mutex>
+
+// Strings of the KnownName atoms in the same order
+static const char* const KNOWN_NAMES[] = {
+    "Type", "Subtype", "Catalog", "Pages", "Page", "Kids", "Count", "Parent",
+    "Root", "Info", "Size", "Prev", "XRefStm", "XRef", "ObjStm", "W", "Index", "N", "First", "Extends",
+    "Length", "Filter", "DecodeParms", "Predictor", "Colors", "BitsPerComponent", "Columns", "EarlyChange",
+    "FlateDecode", "LZWDecode", "ASCIIHexDecode", "ASCII85Decode", "RunLengthDecode", "DCTDecode",
+    "Contents", "Resources", "MediaBox", "CropBox", "Rotate",
+    "Font", "XObject", "ExtGState", "ColorSpace", "Pattern", "Shading", "ProcSet",
+    "BaseFont", "Encoding", "Widths", "FirstChar", "LastChar", "FontDescriptor",
+    "Annots", "Encrypt", "ID"
+};
+static_assert(sizeof(KNOWN_NAMES) / sizeof(KNOWN_NAMES[0]) == NAME_KNOWN_COUNT, "Every KnownName needs its string");
+
+// Ids of tables & scopes, tags of the per thread cache
+static uint64_t nextOwnerId() {
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+NameManager::NameManager() : id(nextOwnerId()) {
+    for (const char* name: KNOWN_NAMES) {
+        this->intern(name);
+    }
+}
+
+NameManager& NameManager::global() {
+    static NameManager table;
+    return table;
+}
+
+// Slots of the per thread cache in front of the tables, power of two
+static constexpr size_t NAME_CACHE_SIZE = 256;
+
+/* Documents repeat the same few names over & over, recently interned names are found in a
+    small per thread cache without taking a lock. A slot is tagged with the id of the table or
+    scope that filled it & only holds names that one keeps. The cache outlives scopes & non
+    global tables, but ids are never reused, so a slot of one that is gone never matches again
+    & its name (maybe released or reused since) is never read */
+struct NameCacheSlot {
+    uint64_t owner;
+    const InternedName* name;
+};
+
+// Cheap hash for the per thread cache, collisions only cost a trip through the table
+static NameCacheSlot& cacheSlot(std::string_view name) {
+    // Zero initialized, no guard on access
+    thread_local NameCacheSlot cache[NAME_CACHE_SIZE];
+    size_t hash = name.size();
+    if (!name.empty()) hash = hash * 31 + static_cast<unsigned char>(name.front());
+    if (name.size() > 1) hash = hash * 31 + static_cast<unsigned char>(name[name.size() / 2]);
+    if (name.size() > 2) hash = hash * 31 + static_cast<unsigned char>(name.back());
+    return cache[hash & (NAME_CACHE_SIZE - 1)];
+}
+
+const InternedName& NameManager::intern(std::string_view name) {
+    NameCacheSlot& slot = cacheSlot(name);
+    if (slot.owner == this->id && slot.name->value == name) return *slot.name;
+
+    const InternedName& interned = this->internLocked(name, true);
+    slot.owner = this->id;
+    slot.name = &interned;
+    return interned;
+}
+
+const InternedName& NameManager::internLocked(std::string_view name, bool pin) {
+    {
+        // Names held for good need no update
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        auto found = this->atoms.find(name);
+        if (found != this->atoms.end() && this->holders[found->second] == NAME_PINNED) return this->names[found->second];
+    }
+
+    std::unique_lock<std::shared_mutex> lock(this->mutex);
+    auto found = this->atoms.find(name);
+    if (found != this->atoms.end()) {
+        uint32_t& holders = this->holders[found->second];
+        if (pin) holders = NAME_PINNED;
+        else if (holders != NAME_PINNED) holders++;
+        return this->names[found->second];
+    }
+
+    NameAtom atom;
+    if (!this->freeAtoms.empty()) {
+        atom = this->freeAtoms.back();
+        this->freeAtoms.pop_back();
+        this->names[atom].value.assign(name);
+    } else {
+        atom = static_cast<NameAtom>(this->names.size());
+        this->names.push_back(InternedName{std::string(name), atom});
+        this->holders.push_back(0);
+    }
+    this->holders[atom] = pin ? NAME_PINNED : 1;
+    this->atoms.emplace(this->names[atom].value, atom);
+    return this->names[atom];
+}
+
+void NameManager::release(const std::vector<NameAtom>& released) {
+    std::unique_lock<std::shared_mutex> lock(this->mutex);
+    for (NameAtom atom: released) {
+        uint32_t& holders = this->holders[atom];
+        if (holders == NAME_PINNED || --holders > 0) continue;
+        // The map's key is a view into the entry, it goes first
+        this->atoms.erase(this->names[atom].value);
+        this->names[atom].value = std::string();
+        this->freeAtoms.push_back(atom);
+    }
+}
+
+NameAtom NameManager::find(std::string_view name) const {
+    std::shared_lock<std::shared_mutex> lock(this->mutex);
+    auto found = this->atoms.find(name);
+    return found != this->atoms.end() ? found->second : NAME_UNKNOWN;
+}
+
+const InternedName& NameManager::get(NameAtom atom) const {
+    std::shared_lock<std::shared_mutex> lock(this->mutex);
+    return this->names.at(atom);
+}
+
+size_t NameManager::size() const {
+    std::shared_lock<std::shared_mutex> lock(this->mutex);
+    return this->names.size() - this->freeAtoms.size();
+}
+
+NameScope::NameScope(NameManager& table) : table(table), id(nextOwnerId()) {}
+
+NameScope::~NameScope() {
+    std::vector<NameAtom> released;
+    released.reserve(this->held.size());
+    for (const auto& [value, name]: this->held) released.push_back(name->atom);
+    this->table.release(released);
+}
+
+const InternedName& NameScope::intern(std::string_view name) {
+    NameCacheSlot& slot = cacheSlot(name);
+    if (slot.owner == this->id && slot.name->value == name) return *slot.name;
+
+    const InternedName* interned = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> lock(this->mutex);
+        auto found = this->held.find(name);
+        if (found != this->held.end()) interned = found->second;
+    }
+    if (!interned) {
+        // Each name is taken from the table once per scope, the scope gives it back once
+        std::unique_lock<std::shared_mutex> lock(this->mutex);
+        auto found = this->held.find(name);
+        if (found != this->held.end()) {
+            interned = found->second;
+        } else {
+            interned = &this->table.internLocked(name, false);
+            this->held.emplace(interned->value, interned);
+        }
+    }
+    slot.owner = this->id;
+    slot.name = interned;
+    return *interned;
+}
+
+size_t NameScope::size() const {
+    std::shared_lock<std::shared_mutex> lock(this->mutex);
+    return this->held.size();
+}
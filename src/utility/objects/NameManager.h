@@ -1,14 +1,153 @@
 #pragma once
 
-#include "NameObject.h"
-#include <vector>
+#include <deque>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <shared_mutex>
+#include <cstddef>
+#include <cstdint>
+
+using NameAtom = uint32_t;
+
+// Atoms of names seeded into every table, same order as the strings in NameManager.cpp
+enum KnownName : NameAtom {
+    NAME_TYPE,
+    NAME_SUBTYPE,
+    NAME_CATALOG,
+    NAME_PAGES,
+    NAME_PAGE,
+    NAME_KIDS,
+    NAME_COUNT,
+    NAME_PARENT,
+    NAME_ROOT,
+    NAME_INFO,
+    NAME_SIZE,
+    NAME_PREV,
+    NAME_XREFSTM,
+    NAME_XREF,
+    NAME_OBJSTM,
+    NAME_W,
+    NAME_INDEX,
+    NAME_N,
+    NAME_FIRST,
+    NAME_EXTENDS,
+    NAME_LENGTH,
+    NAME_FILTER,
+    NAME_DECODE_PARMS,
+    NAME_PREDICTOR,
+    NAME_COLORS,
+    NAME_BITS_PER_COMPONENT,
+    NAME_COLUMNS,
+    NAME_EARLY_CHANGE,
+    NAME_FLATE_DECODE,
+    NAME_LZW_DECODE,
+    NAME_ASCII_HEX_DECODE,
+    NAME_ASCII85_DECODE,
+    NAME_RUN_LENGTH_DECODE,
+    NAME_DCT_DECODE,
+    NAME_CONTENTS,
+    NAME_RESOURCES,
+    NAME_MEDIA_BOX,
+    NAME_CROP_BOX,
+    NAME_ROTATE,
+    NAME_FONT,
+    NAME_XOBJECT,
+    NAME_EXT_G_STATE,
+    NAME_COLOR_SPACE,
+    NAME_PATTERN,
+    NAME_SHADING,
+    NAME_PROC_SET,
+    NAME_BASE_FONT,
+    NAME_ENCODING,
+    NAME_WIDTHS,
+    NAME_FIRST_CHAR,
+    NAME_LAST_CHAR,
+    NAME_FONT_DESCRIPTOR,
+    NAME_ANNOTS,
+    NAME_ENCRYPT,
+    NAME_ID,
+    NAME_KNOWN_COUNT
+};
 
-class NameManger {
+// Atom of a name that was never interned, no dictionary can contain it
+constexpr NameAtom NAME_UNKNOWN = UINT32_MAX;
+// Holder count of names that are never released
+constexpr uint32_t NAME_PINNED = UINT32_MAX;
+
+struct InternedName {
+    std::string value;
+    NameAtom atom;
+};
+
+/* Interning table for names (without the leading /). Every distinct name is stored once
+    & gets a small integer atom, so comparing names is an integer compare. The entries
+    never move, references to them stay valid for the lifetime of the table. Thread safe.
+
+    Names interned through the table itself (the seeded KnownName set & names the code uses)
+    stay for good. Names of documents are interned through a NameScope instead: once no scope
+    holds a name any more it is released & its atom is given to the next new name, so a process
+    reading one document after another only keeps the names of the open ones */
+class NameManager {
     public:
-        bool createName(std::string);
-        NameObject* getCreated();
+        NameManager();
+        NameManager(const NameManager&) = delete;
+        NameManager& operator=(const NameManager&) = delete;
+
+        // Process wide table used by the parsers
+        static NameManager& global();
+
+        // Entry of a name, added on first use & never released
+        const InternedName& intern(std::string_view name);
+        // Atom of a name interned & not released, NAME_UNKNOWN otherwise (doesn't grow the table)
+        NameAtom find(std::string_view name) const;
+        const InternedName& get(NameAtom atom) const;
+        // Names currently interned, released ones don't count
+        size_t size() const;
+
+    private:
+        friend class NameScope;
+
+        // pin: never release the name, otherwise one more scope holds it
+        const InternedName& internLocked(std::string_view name, bool pin);
+        // One scope less holds each of the names
+        void release(const std::vector<NameAtom>& released);
+
+        mutable std::shared_mutex mutex;
+        std::deque<InternedName> names;
+        // Scopes holding each name, NAME_PINNED for names that are never released
+        std::vector<uint32_t> holders;
+        // Atoms of released names, their entries are reused for new names
+        std::vector<NameAtom> freeAtoms;
+        // Views into names
+        std::unordered_map<std::string_view, NameAtom> atoms;
+        /* Tags the entries of the per thread lookup cache. The cache outlives scopes & tables other
+            than the global one, ids are never reused so it can't hand out an entry of one that is gone */
+        const uint64_t id;
+};
+
+/* Names of one document or parse session, e.g. owned by a PdfReader. Names interned here are
+    held until the scope is destroyed, values & objects using them must not outlive it (their
+    atoms may stand for other names later). Known names & names the table holds for good are
+    shared with it. Thread safe */
+class NameScope {
+    public:
+        explicit NameScope(NameManager& table = NameManager::global());
+        ~NameScope();
+        NameScope(const NameScope&) = delete;
+        NameScope& operator=(const NameScope&) = delete;
+
+        const InternedName& intern(std::string_view name);
+        NameManager& getTable() { return table; }
+        // Names this scope holds
+        size_t size() const;
 
     private:
-        std::vector<NameObject> names;
+        NameManager& table;
+        mutable std::shared_mutex mutex;
+        // Views into the table's entries, they stay put while held
+        std::unordered_map<std::string_view, const InternedName*> held;
+        // Tag in the per thread lookup cache, as for the table
+        const uint64_t id;
 };
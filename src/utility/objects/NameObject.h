@@ -1,21 +1,28 @@
 #pragma once
 
 #include "BaseObject.h"
+#include "NameManager.h"
 #include <string>
+#include <string_view>
 #include <functional>
 
 class NameObject: public BaseObject {
     public:
-        explicit NameObject(size_t start, size_t end, const std::string& name) : BaseObject(start, end), value(name) {};
+        // Name held by the global table for good, for names the code writes itself
+        explicit NameObject(size_t start, size_t end, std::string_view name) : BaseObject(start, end), name(&NameManager::global().intern(name)) {};
+        // Name interned by the caller, e.g. through the NameScope of a document
+        explicit NameObject(size_t start, size_t end, const InternedName& name) : BaseObject(start, end), name(&name) {};
         ObjectType getType() override { return OBJT_NAME; }
-        const std::string getValue() const { return value; }
+        std::string_view getValue() const { return name->value; }
+        NameAtom getAtom() const { return name->atom; }
 
         bool operator==(const NameObject& other) const {
-            return value == other.value;
+            return name == other.name;
         }
 
     private:
-        const std::string value;
+        // Entry of the name table, equal names share it
+        const InternedName* name;
 };
 
 // Prove hash function for NameObject -> allow usage in Hashtables
@@ -23,7 +30,7 @@ namespace std {
     template <>
     struct hash<NameObject> {
         std::size_t operator()(const NameObject& n) const noexcept {
-            return std::hash<std::string>{}(n.getValue());
+            return std::hash<NameAtom>{}(n.getAtom());
         }
     };
 }
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "BaseObject.h"
+
+class NullObject: public BaseObject {
+    public:
+        explicit NullObject(size_t start, size_t end) : BaseObject(start, end) {};
+        ObjectType getType() override { return OBJT_NULL; }
+};
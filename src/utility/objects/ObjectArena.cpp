@@ -0,0 +1,78 @@
+#include "ObjectArena.h"
+
+#include <cstring>
+
+void* ObjectArena::allocate(size_t bytes, size_t alignment) {
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(this->current) % alignment) % alignment;
+    if (this->current == nullptr || padding + bytes > this->remaining) {
+        // Large allocations get a block of their own, the current block stays in use
+        if (bytes + alignment > this->blockSize / 4) {
+            this->blocks.emplace_back(new char[bytes + alignment]);
+            this->bytesReserved += bytes + alignment;
+            this->bytesUsed += bytes;
+            char* block = this->blocks.back().get();
+            return block + (alignment - reinterpret_cast<uintptr_t>(block) % alignment) % alignment;
+        }
+        this->blocks.emplace_back(new char[this->blockSize]);
+        this->bytesReserved += this->blockSize;
+        this->currentBlock = this->blocks.back().get();
+        this->current = this->currentBlock;
+        this->remaining = this->blockSize;
+        padding = (alignment - reinterpret_cast<uintptr_t>(this->current) % alignment) % alignment;
+    }
+
+    char* result = this->current + padding;
+    this->current += padding + bytes;
+    this->remaining -= padding + bytes;
+    this->bytesUsed += bytes;
+    return result;
+}
+
+std::string_view ObjectArena::copyString(std::string_view text) {
+    if (text.empty()) return std::string_view();
+    char* copy = static_cast<char*>(this->allocate(text.size(), 1));
+    std::memcpy(copy, text.data(), text.size());
+    return std::string_view(copy, text.size());
+}
+
+void ObjectArena::release() {
+    this->blocks.clear();
+    this->currentBlock = nullptr;
+    this->current = nullptr;
+    this->remaining = 0;
+    this->bytesUsed = 0;
+    this->bytesReserved = 0;
+}
+
+void ObjectArena::reset() {
+    if (this->currentBlock == nullptr) {
+        this->release();
+        return;
+    }
+    // Large & adopted blocks are freed, a single regular block doesn't have to be moved
+    if (this->blocks.size() > 1) {
+        std::unique_ptr<char[]> kept;
+        for (std::unique_ptr<char[]>& block: this->blocks) {
+            if (block.get() == this->currentBlock) kept = std::move(block);
+        }
+        this->blocks.clear();
+        this->blocks.push_back(std::move(kept));
+    }
+    this->current = this->currentBlock;
+    this->remaining = this->blockSize;
+    this->bytesUsed = 0;
+    this->bytesReserved = this->blockSize;
+}
+
+void ObjectArena::adopt(ObjectArena& other) {
+    // The current block stays the one allocated from, the adopted blocks are only kept alive
+    for (std::unique_ptr<char[]>& block: other.blocks) this->blocks.push_back(std::move(block));
+    this->bytesUsed += other.bytesUsed;
+    this->bytesReserved += other.bytesReserved;
+    other.blocks.clear();
+    other.currentBlock = nullptr;
+    other.current = nullptr;
+    other.remaining = 0;
+    other.bytesUsed = 0;
+    other.bytesReserved = 0;
+}
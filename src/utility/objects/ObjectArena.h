@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+/* Bump allocator owning all values parsed for a document. Values are never freed on
+    their own, release() drops every block at once. Only for trivially destructible types */
+class ObjectArena {
+    public:
+        explicit ObjectArena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {};
+        ObjectArena(const ObjectArena&) = delete;
+        ObjectArena& operator=(const ObjectArena&) = delete;
+        ObjectArena(ObjectArena&&) = default;
+        ObjectArena& operator=(ObjectArena&&) = default;
+
+        void* allocate(size_t bytes, size_t alignment);
+
+        template <typename T>
+        T* allocateArray(size_t count) {
+            if (count == 0) return nullptr;
+            return static_cast<T*>(this->allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        // Copy of the bytes owned by the arena
+        std::string_view copyString(std::string_view text);
+
+        void release();
+        // Drop all values but keep the block allocated from, for short lived values parsed over & over
+        void reset();
+        /* Take over all blocks of another arena, values allocated there stay valid & are
+            released with this arena. Used to merge the arenas of parallel parsers */
+        void adopt(ObjectArena& other);
+
+        // Bytes handed out & bytes of all blocks
+        size_t getBytesUsed() const { return bytesUsed; }
+        size_t getBytesReserved() const { return bytesReserved; }
+
+    private:
+        size_t blockSize;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        // Free range of the newest regular block
+        char* currentBlock = nullptr;
+        char* current = nullptr;
+        size_t remaining = 0;
+
+        size_t bytesUsed = 0;
+        size_t bytesReserved = 0;
+};
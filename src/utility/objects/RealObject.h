@@ -0,0 +1,13 @@
+#pragma once
+
+#include "BaseObject.h"
+
+class RealObject: public BaseObject {
+    public:
+        explicit RealObject(size_t start, size_t end, double value) : BaseObject(start, end), value(value) {};
+        ObjectType getType() override { return OBJT_REAL; }
+        double getValue() const { return value; }
+
+    private:
+        double value;
+};
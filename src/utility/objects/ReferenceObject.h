@@ -0,0 +1,18 @@
+#pragma once
+
+#include "BaseObject.h"
+#include <cstdint>
+
+// Indirect reference to another object (N G R)
+class ReferenceObject: public BaseObject {
+    public:
+        explicit ReferenceObject(size_t start, size_t end, size_t number, uint16_t generation) 
+            : BaseObject(start, end), number(number), generation(generation) {};
+        ObjectType getType() override { return OBJT_INDIRECT; }
+        size_t getNumber() const { return number; }
+        uint16_t getGeneration() const { return generation; }
+
+    private:
+        size_t number;
+        uint16_t generation;
+};
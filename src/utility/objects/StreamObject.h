@@ -0,0 +1,21 @@
+#pragma once
+
+#include "BaseObject.h"
+#include "DictionaryObject.h"
+#include <memory>
+
+// Stream dictionary with the byte range of its (still encoded) data in the file
+class StreamObject: public BaseObject {
+    public:
+        explicit StreamObject(size_t start, size_t end, std::shared_ptr<DictionaryObject> dictionary, size_t dataStart, size_t dataLength)
+            : BaseObject(start, end), dictionary(dictionary), dataStart(dataStart), dataLength(dataLength) {};
+        ObjectType getType() override { return OBJT_STREAM; }
+        std::shared_ptr<DictionaryObject> getDictionary() const { return dictionary; }
+        size_t getDataStart() const { return dataStart; }
+        size_t getDataLength() const { return dataLength; }
+
+    private:
+        std::shared_ptr<DictionaryObject> dictionary;
+        size_t dataStart;
+        size_t dataLength;
+};
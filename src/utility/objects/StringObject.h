@@ -0,0 +1,18 @@
+#pragma once
+
+#include "BaseObject.h"
+#include <string>
+#include <utility>
+
+// Literal or hexadecimal string, the value is the decoded bytes
+class StringObject: public BaseObject {
+    public:
+        explicit StringObject(size_t start, size_t end, std::string value, bool hexadecimal)
+            : BaseObject(start, end), value(std::move(value)), hexadecimal(hexadecimal) {};
+        ObjectType getType() override { return hexadecimal ? OBJT_STRING_HEXADECIMAL : OBJT_STRING_LITERAL; }
+        const std::string& getValue() const { return value; }
+
+    private:
+        std::string value;
+        bool hexadecimal;
+};
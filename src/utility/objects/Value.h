@@ -0,0 +1,113 @@
+#pragma once
+
+#include "BaseObject.h"
+#include "NameManager.h"
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+struct DictEntry;
+struct StreamValue;
+
+/* Compact value of the arena object model (16 bytes, no vtable & no refcount).
+    Strings, arrays, dictionaries & streams point into the ObjectArena they were parsed
+    into, values are non-owning handles that stay valid as long as that arena */
+class Value {
+    public:
+        Value() : type(OBJT_NULL) { data.integer = 0; }
+
+        static Value makeBoolean(bool boolean) { Value v(OBJT_BOOLEAN); v.data.boolean = boolean; return v; }
+        static Value makeInteger(int64_t integer) { Value v(OBJT_INTEGER); v.data.integer = integer; return v; }
+        static Value makeReal(double real) { Value v(OBJT_REAL); v.data.real = real; return v; }
+        static Value makeName(const InternedName& name) { Value v(OBJT_NAME); v.data.name = &name; return v; }
+        // Strings are the raw bytes between the delimiters
+        static Value makeString(ObjectType type, std::string_view text) {
+            Value v(type);
+            v.data.chars = text.data();
+            v.count = static_cast<uint32_t>(text.size());
+            return v;
+        }
+        static Value makeArray(const Value* items, size_t count) {
+            Value v(OBJT_ARRAY);
+            v.data.items = items;
+            v.count = static_cast<uint32_t>(count);
+            return v;
+        }
+        static Value makeDictionary(const DictEntry* entries, size_t count) {
+            Value v(OBJT_DICTIONARY);
+            v.data.entries = entries;
+            v.count = static_cast<uint32_t>(count);
+            return v;
+        }
+        static Value makeReference(size_t number, uint16_t generation) {
+            Value v(OBJT_INDIRECT);
+            v.data.integer = static_cast<int64_t>(number);
+            v.generation = generation;
+            return v;
+        }
+        static Value makeStream(const StreamValue* stream) { Value v(OBJT_STREAM); v.data.stream = stream; return v; }
+        static Value makeInvalid() { return Value(OBJT_INVALID); }
+
+        ObjectType getType() const { return static_cast<ObjectType>(type); }
+        bool isNull() const { return type == OBJT_NULL; }
+
+        bool getBoolean() const { return data.boolean; }
+        int64_t getInteger() const { return data.integer; }
+        // Integers are valid reals as well
+        double getReal() const { return type == OBJT_INTEGER ? static_cast<double>(data.integer) : data.real; }
+        // Characters of a string, or of a name without the /
+        std::string_view getString() const { return type == OBJT_NAME ? std::string_view(data.name->value) : std::string_view(data.chars, count); }
+        NameAtom getAtom() const { return data.name->atom; }
+
+        // Elements of an array or entries of a dictionary
+        size_t size() const { return count; }
+        const Value* getItems() const { return data.items; }
+        const DictEntry* getEntries() const { return data.entries; }
+        // Dictionary (or stream dictionary) lookup, nullptr if missing
+        const Value* find(NameAtom key) const;
+        // Same by key name without the /
+        const Value* find(std::string_view key) const { return find(NameManager::global().find(key)); }
+
+        size_t getNumber() const { return static_cast<size_t>(data.integer); }
+        uint16_t getGeneration() const { return generation; }
+        const StreamValue* getStream() const { return data.stream; }
+
+    private:
+        explicit Value(ObjectType type) : type(static_cast<uint8_t>(type)) { data.integer = 0; }
+
+        uint8_t type;
+        uint16_t generation = 0;
+        uint32_t count = 0;
+        union {
+            bool boolean;
+            int64_t integer;
+            double real;
+            const char* chars;
+            const InternedName* name;
+            const Value* items;
+            const DictEntry* entries;
+            const StreamValue* stream;
+        } data;
+};
+static_assert(sizeof(Value) == 16, "Value should stay 16 bytes");
+
+struct DictEntry {
+    NameAtom key;
+    Value value;
+};
+
+// Stream dictionary & the position of the raw (still encoded) data in its source
+struct StreamValue {
+    Value dictionary;
+    size_t dataStart;
+    size_t dataLength;
+};
+
+inline const Value* Value::find(NameAtom key) const {
+    if (type == OBJT_STREAM) return data.stream->dictionary.find(key);
+    if (type != OBJT_DICTIONARY) return nullptr;
+    for (uint32_t i = 0; i < count; i++) {
+        if (data.entries[i].key == key) return &data.entries[i].value;
+    }
+    return nullptr;
+}
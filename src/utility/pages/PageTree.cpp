@@ -0,0 +1,184 @@
+#include "PageTree.h"
+#include "../PdfReader.h"
+#include "../objects/ArrayObject.h"
+#include "../objects/IntegerObject.h"
+#include "../objects/NameObject.h"
+#include "../objects/ReferenceObject.h"
+
+#include <algorithm>
+
+// Values of a dictionary replace the inherited ones
+static void applyAttributes(PageAttributes& attributes, const std::shared_ptr<DictionaryObject>& dict) {
+    std::shared_ptr<BaseObject> value;
+    if ((value = dict->getElement(NAME_RESOURCES))) attributes.resources = value;
+    if ((value = dict->getElement(NAME_MEDIA_BOX))) attributes.mediaBox = value;
+    if ((value = dict->getElement(NAME_CROP_BOX))) attributes.cropBox = value;
+    if ((value = dict->getElement(NAME_ROTATE))) attributes.rotate = value;
+}
+
+// Intermediate node, /Type is required but some writers leave it out
+static bool isPagesNode(const std::shared_ptr<DictionaryObject>& dict) {
+    std::shared_ptr<NameObject> type = std::dynamic_pointer_cast<NameObject>(dict->getElement(NAME_TYPE));
+    if (type) return type->getAtom() == NAME_PAGES;
+    return dict->getElement(NAME_KIDS) != nullptr;
+}
+
+std::shared_ptr<DictionaryObject> PageTree::loadDictionary(size_t number, uint16_t generation) {
+    this->stats.objectLoads++;
+    return std::dynamic_pointer_cast<DictionaryObject>(this->reader.getObject(number, generation));
+}
+
+bool PageTree::loadRoot() {
+    if (this->rootLoaded) return this->root != nullptr;
+    this->rootLoaded = true;
+
+    std::shared_ptr<DictionaryObject> trailer = this->reader.getTrailer();
+    if (!trailer) return false;
+    std::shared_ptr<DictionaryObject> catalog = std::dynamic_pointer_cast<DictionaryObject>(this->reader.resolve(trailer->getElement(NAME_ROOT)));
+    if (!catalog) return false;
+
+    // /Pages has to be indirect, a direct dictionary is kept under object 0
+    std::shared_ptr<BaseObject> pages = catalog->getElement(NAME_PAGES);
+    std::shared_ptr<ReferenceObject> reference = std::dynamic_pointer_cast<ReferenceObject>(pages);
+    std::shared_ptr<DictionaryObject> dict = reference ? this->loadDictionary(reference->getNumber(), reference->getGeneration())
+        : std::dynamic_pointer_cast<DictionaryObject>(pages);
+    if (!dict) return false;
+    this->root = reference ? this->loadNode(reference->getNumber(), reference->getGeneration(), dict, PageAttributes())
+        : this->loadNode(0, 0, dict, PageAttributes());
+    return this->root != nullptr;
+}
+
+PageTree::Node* PageTree::loadNode(size_t number, uint16_t generation, const std::shared_ptr<DictionaryObject>& dict, const PageAttributes& inherited) {
+    uint64_t key = makeKey(number, generation);
+    auto found = this->nodes.find(key);
+    if (found != this->nodes.end()) return &found->second;
+
+    Node node;
+    node.attributes = inherited;
+    applyAttributes(node.attributes, dict);
+    std::shared_ptr<IntegerObject> count = std::dynamic_pointer_cast<IntegerObject>(this->reader.resolve(dict->getElement(NAME_COUNT)));
+    node.count = count && count->getValue() > 0 ? static_cast<size_t>(count->getValue()) : 0;
+
+    std::shared_ptr<ArrayObject> kids = std::dynamic_pointer_cast<ArrayObject>(this->reader.resolve(dict->getElement(NAME_KIDS)));
+    if (kids) {
+        node.kids.reserve(kids->getObjects().size());
+        for (const std::shared_ptr<BaseObject>& kid: kids->getObjects()) {
+            std::shared_ptr<ReferenceObject> reference = std::dynamic_pointer_cast<ReferenceObject>(kid);
+            // Kids have to be indirect, anything else holds no pages
+            if (reference) {
+                node.kids.push_back(Kid{reference->getNumber(), reference->getGeneration(), -1});
+            } else {
+                node.kids.push_back(Kid{0, 0, 0});
+                node.knownCounts++;
+            }
+        }
+    }
+    return &this->nodes.emplace(key, std::move(node)).first->second;
+}
+
+int64_t PageTree::countKid(Kid& kid, const PageAttributes& inherited) {
+    if (kid.count >= 0) return kid.count;
+    std::shared_ptr<DictionaryObject> dict = this->loadDictionary(kid.number, kid.generation);
+    if (!dict) {
+        kid.count = 0;
+    } else if (isPagesNode(dict)) {
+        // Loaded anyway, the node is kept for descending into it later
+        kid.count = static_cast<int64_t>(this->loadNode(kid.number, kid.generation, dict, inherited)->count);
+    } else {
+        kid.count = 1;
+        this->lastPage = {makeKey(kid.number, kid.generation), dict};
+    }
+    return kid.count;
+}
+
+PageTree::Kid* PageTree::findKid(Node& node, size_t& index) {
+    if (node.kids.empty()) return nullptr;
+    if (!node.starts.empty()) {
+        // Last kid starting at or before the index
+        size_t k = static_cast<size_t>(std::upper_bound(node.starts.begin(), node.starts.end(), index) - node.starts.begin()) - 1;
+        index -= node.starts[k];
+        return index < static_cast<size_t>(node.kids[k].count) ? &node.kids[k] : nullptr;
+    }
+
+    // Counts of kids are learned from the nearer end of /Kids
+    Kid* result = nullptr;
+    if (index < node.count / 2) {
+        size_t start = 0;
+        for (Kid& kid: node.kids) {
+            if (kid.count < 0) node.knownCounts++;
+            size_t count = static_cast<size_t>(this->countKid(kid, node.attributes));
+            if (index < start + count) {
+                index -= start;
+                result = &kid;
+                break;
+            }
+            start += count;
+        }
+    } else {
+        int64_t start = static_cast<int64_t>(node.count);
+        for (size_t k = node.kids.size(); k-- > 0;) {
+            Kid& kid = node.kids[k];
+            if (kid.count < 0) node.knownCounts++;
+            start -= this->countKid(kid, node.attributes);
+            if (start <= static_cast<int64_t>(index) && kid.count > 0) {
+                // /Count of the node disagrees with its kids
+                if (start < 0) break;
+                index -= static_cast<size_t>(start);
+                result = &kid;
+                break;
+            }
+        }
+    }
+
+    if (node.knownCounts == node.kids.size()) {
+        node.starts.resize(node.kids.size());
+        size_t start = 0;
+        for (size_t k = 0; k < node.kids.size(); k++) {
+            node.starts[k] = start;
+            start += static_cast<size_t>(node.kids[k].count);
+        }
+    }
+    return result;
+}
+
+size_t PageTree::getPageCount() {
+    return this->loadRoot() ? this->root->count : 0;
+}
+
+std::optional<Page> PageTree::getPage(size_t index) {
+    this->stats.lookups++;
+    if (!this->loadRoot() || index >= this->root->count) return std::nullopt;
+
+    Node* node = this->root;
+    for (size_t depth = 0; depth < MAX_PAGE_TREE_DEPTH; depth++) {
+        Kid* kid = this->findKid(*node, index);
+        if (!kid) return std::nullopt;
+        auto known = this->nodes.find(makeKey(kid->number, kid->generation));
+        if (known != this->nodes.end()) {
+            node = &known->second;
+            continue;
+        }
+        // Page dictionary that was just loaded for its count
+        uint64_t key = makeKey(kid->number, kid->generation);
+        std::shared_ptr<DictionaryObject> dict = this->lastPage.first == key && this->lastPage.second ? this->lastPage.second
+            : this->loadDictionary(kid->number, kid->generation);
+        this->lastPage = {0, nullptr};
+        if (!dict) return std::nullopt;
+        if (isPagesNode(dict)) {
+            node = this->loadNode(kid->number, kid->generation, dict, node->attributes);
+            continue;
+        }
+
+        Page page{kid->number, kid->generation, dict, node->attributes};
+        applyAttributes(page.attributes, dict);
+        return page;
+    }
+    return std::nullopt;
+}
+
+void PageTree::clear() {
+    this->nodes.clear();
+    this->root = nullptr;
+    this->rootLoaded = false;
+    this->lastPage = {0, nullptr};
+}
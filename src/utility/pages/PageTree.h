@@ -0,0 +1,95 @@
+#pragma once
+
+#include "../objects/BaseObject.h"
+#include "../objects/DictionaryObject.h"
+
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class PdfReader;
+
+// Limit for nested /Pages nodes, deeper trees are treated as broken (or cyclic)
+constexpr size_t MAX_PAGE_TREE_DEPTH = 64;
+
+// Attributes a page inherits from its ancestors if it doesn't have them (ISO32000 7.7.3.4)
+struct PageAttributes {
+    std::shared_ptr<BaseObject> resources;
+    std::shared_ptr<BaseObject> mediaBox;
+    std::shared_ptr<BaseObject> cropBox;
+    std::shared_ptr<BaseObject> rotate;
+};
+
+struct Page {
+    size_t number;
+    uint16_t generation;
+    std::shared_ptr<DictionaryObject> dictionary;
+    // Own values of the page where present, inherited ones otherwise. References stay unresolved
+    PageAttributes attributes;
+};
+
+struct PageTreeStats {
+    size_t lookups = 0;
+    // Objects requested from the reader, page dictionaries included
+    size_t objectLoads = 0;
+    size_t cachedNodes = 0;
+};
+
+/* Random access to the pages of a document. Nodes are loaded lazily from /Root /Pages
+    along the path to the requested page & kept with the /Count of their kids & their
+    inherited attributes. A lookup descends using these counts (binary search once all
+    kids of a node are known), so it costs O(depth) object loads on the first visit of a
+    path & none afterwards. Kid counts are learned from the nearer end of /Kids, only the
+    siblings between the target & that end are loaded. Not thread safe, like the reader */
+class PageTree {
+    public:
+        explicit PageTree(PdfReader& reader) : reader(reader) {};
+
+        // /Count of the root node, 0 if the document has no usable page tree
+        size_t getPageCount();
+        // Page by zero based index, nullopt if it is out of range or the tree is broken there
+        std::optional<Page> getPage(size_t index);
+        // Forget the cached nodes, e.g. after the document changed
+        void clear();
+        PageTreeStats getStats() { stats.cachedNodes = nodes.size(); return stats; }
+
+    private:
+        struct Kid {
+            size_t number;
+            uint16_t generation;
+            // Pages below this kid, -1 until the kid was loaded
+            int64_t count;
+        };
+        struct Node {
+            std::vector<Kid> kids;
+            size_t count;
+            // Start index of every kid, filled once all kid counts are known
+            std::vector<size_t> starts;
+            size_t knownCounts = 0;
+            // Inherited attributes with the ones of this node applied
+            PageAttributes attributes;
+        };
+
+        static uint64_t makeKey(size_t number, uint16_t generation) { return (static_cast<uint64_t>(number) << 16) | generation; }
+        // Load the root node, false if the catalog has no /Pages dictionary
+        bool loadRoot();
+        // Build the node of a /Pages dictionary below a parent with the given attributes
+        Node* loadNode(size_t number, uint16_t generation, const std::shared_ptr<DictionaryObject>& dict, const PageAttributes& inherited);
+        std::shared_ptr<DictionaryObject> loadDictionary(size_t number, uint16_t generation);
+        // Pages below a kid of a node with the given attributes, 0 if it can't be loaded
+        int64_t countKid(Kid& kid, const PageAttributes& inherited);
+        // Kid of a node holding the page index, index is made relative to it
+        Kid* findKid(Node& node, size_t& index);
+
+        PdfReader& reader;
+        bool rootLoaded = false;
+        Node* root = nullptr;
+        std::unordered_map<uint64_t, Node> nodes;
+        // Last page dictionary loaded while counting kids, saves loading it again right after
+        std::pair<uint64_t, std::shared_ptr<DictionaryObject>> lastPage{0, nullptr};
+        PageTreeStats stats;
+};
@@ -0,0 +1,89 @@
+#include "WorkStealingRange.h"
+
+#include <thread>
+#include <exception>
+#include <algorithm>
+
+WorkStealingRange::WorkStealingRange(size_t count, size_t workers, size_t grain) : count(count), grain(std::max<size_t>(grain, 1)) {
+    workers = std::max<size_t>(workers, 1);
+    size_t grains = (count + this->grain - 1) / this->grain;
+    size_t start = 0;
+    for (size_t i = 0; i < workers; i++) {
+        std::unique_ptr<Share> share = std::make_unique<Share>();
+        share->front = start;
+        start += grains / workers + (i < grains % workers ? 1 : 0);
+        share->back = start;
+        this->shares.push_back(std::move(share));
+    }
+}
+
+bool WorkStealingRange::next(size_t worker, size_t& begin, size_t& end) {
+    size_t grainIndex;
+    if (!this->takeOwn(worker, grainIndex) && !this->steal(worker, grainIndex)) return false;
+    begin = grainIndex * this->grain;
+    end = std::min(begin + this->grain, this->count);
+    return true;
+}
+
+bool WorkStealingRange::takeOwn(size_t worker, size_t& grainIndex) {
+    Share& own = *this->shares[worker];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (own.front >= own.back) return false;
+    grainIndex = own.front++;
+    return true;
+}
+
+size_t WorkStealingRange::getSteals(size_t worker) const {
+    std::lock_guard<std::mutex> guard(this->shares[worker]->lock);
+    return this->shares[worker]->steals;
+}
+
+// Only one share is locked at a time, so workers stealing from each other can't deadlock
+bool WorkStealingRange::steal(size_t worker, size_t& grainIndex) {
+    while (true) {
+        size_t victim = worker;
+        size_t largest = 0;
+        for (size_t i = 0; i < this->shares.size(); i++) {
+            if (i == worker) continue;
+            std::lock_guard<std::mutex> guard(this->shares[i]->lock);
+            size_t remaining = this->shares[i]->back - this->shares[i]->front;
+            if (remaining > largest) {
+                largest = remaining;
+                victim = i;
+            }
+        }
+        if (victim == worker) return false;
+
+        // The victim may have been drained in between, look again then
+        {
+            Share& share = *this->shares[victim];
+            std::lock_guard<std::mutex> guard(share.lock);
+            if (share.front >= share.back) continue;
+            grainIndex = --share.back;
+        }
+        std::lock_guard<std::mutex> guard(this->shares[worker]->lock);
+        this->shares[worker]->steals++;
+        return true;
+    }
+}
+
+void runOnWorkers(size_t workers, const std::function<void(size_t worker)>& work) {
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(workers);
+    auto run = [&work, &errors](size_t worker) {
+        try {
+            work(worker);
+        } catch (...) {
+            errors[worker] = std::current_exception();
+        }
+    };
+
+    threads.reserve(workers > 0 ? workers - 1 : 0);
+    for (size_t i = 1; i < workers; i++) threads.emplace_back(run, i);
+    if (workers > 0) run(0);
+    for (std::thread& thread: threads) thread.join();
+
+    for (const std::exception_ptr& error: errors) {
+        if (error) std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstddef>
+
+/* Index range [0, count) split into grains & dealt out evenly to the workers up front.
+    A worker takes grains from the front of its own share, once that is empty it steals
+    from the back of the largest other share. Keeps all workers busy when the cost per
+    index is skewed, e.g. a few huge objects between many small ones */
+class WorkStealingRange {
+    public:
+        WorkStealingRange(size_t count, size_t workers, size_t grain);
+
+        // Next range of indices for a worker, false once all grains are taken
+        bool next(size_t worker, size_t& begin, size_t& end);
+        // Grains a worker took from other shares
+        size_t getSteals(size_t worker) const;
+
+    private:
+        // Grain indices [front, back) not taken yet
+        struct Share {
+            std::mutex lock;
+            size_t front = 0;
+            size_t back = 0;
+            size_t steals = 0;
+        };
+
+        bool takeOwn(size_t worker, size_t& grainIndex);
+        bool steal(size_t worker, size_t& grainIndex);
+
+        size_t count;
+        size_t grain;
+        std::vector<std::unique_ptr<Share>> shares;
+};
+
+/* Run work(worker) for workers 0..workers-1, worker 0 on the calling thread.
+    Returns after all of them finished, the first exception thrown by a worker is rethrown */
+void runOnWorkers(size_t workers, const std::function<void(size_t worker)>& work);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+// Character classes of ISO32000 7.2.3, combined as flags
+enum CharClassFlag : uint8_t {
+    CHAR_WHITESPACE = 1,
+    CHAR_DELIMITER = 2,
+    CHAR_DIGIT = 4,
+    CHAR_HEX_DIGIT = 8,
+    // Characters that can start a number (digits, sign & decimal point)
+    CHAR_NUMBER_START = 16
+};
+
+// Lookup table for all 256 byte values, built at compile time
+struct CharClassTable {
+    uint8_t flags[256];
+    int8_t hexValues[256];
+
+    constexpr CharClassTable() : flags(), hexValues() {
+        for (int c = 0; c < 256; c++) hexValues[c] = -1;
+
+        // NUL, HT, LF, FF, CR & space
+        const char whitespace[] = {'\0', '\t', '\n', '\f', '\r', ' '};
+        for (char c: whitespace) flags[static_cast<uint8_t>(c)] |= CHAR_WHITESPACE;
+        const char delimiters[] = {'(', ')', '<', '>', '[', ']', '{', '}', '/', '%'};
+        for (char c: delimiters) flags[static_cast<uint8_t>(c)] |= CHAR_DELIMITER;
+
+        for (int c = '0'; c <= '9'; c++) {
+            flags[c] |= CHAR_DIGIT | CHAR_HEX_DIGIT | CHAR_NUMBER_START;
+            hexValues[c] = static_cast<int8_t>(c - '0');
+        }
+        for (int c = 'a'; c <= 'f'; c++) {
+            flags[c] |= CHAR_HEX_DIGIT;
+            hexValues[c] = static_cast<int8_t>(c - 'a' + 10);
+        }
+        for (int c = 'A'; c <= 'F'; c++) {
+            flags[c] |= CHAR_HEX_DIGIT;
+            hexValues[c] = static_cast<int8_t>(c - 'A' + 10);
+        }
+        flags[static_cast<uint8_t>('+')] |= CHAR_NUMBER_START;
+        flags[static_cast<uint8_t>('-')] |= CHAR_NUMBER_START;
+        flags[static_cast<uint8_t>('.')] |= CHAR_NUMBER_START;
+    }
+};
+
+inline constexpr CharClassTable CHAR_CLASSES{};
+
+inline bool isPdfWhitespace(char c) { return CHAR_CLASSES.flags[static_cast<uint8_t>(c)] & CHAR_WHITESPACE; }
+inline bool isPdfDelimiter(char c) { return CHAR_CLASSES.flags[static_cast<uint8_t>(c)] & CHAR_DELIMITER; }
+inline bool isPdfDigit(char c) { return CHAR_CLASSES.flags[static_cast<uint8_t>(c)] & CHAR_DIGIT; }
+// Neither whitespace nor delimiter
+inline bool isPdfRegular(char c) { return !(CHAR_CLASSES.flags[static_cast<uint8_t>(c)] & (CHAR_WHITESPACE | CHAR_DELIMITER)); }
+// Value of a hex digit, -1 for other characters
+inline int hexDigitValue(char c) { return CHAR_CLASSES.hexValues[static_cast<uint8_t>(c)]; }
@@ -0,0 +1,308 @@
+#include "Lexer.h"
+
+#include <string>
+#include <cstdlib>
+
+// Exact powers of ten for converting short decimal fractions without strtod
+static const double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static constexpr int MAX_EXACT_POWER = 22;
+
+bool Lexer::skipWhitespace() {
+    const size_t size = this->data.size();
+    while (this->pos < size) {
+        char current = this->data[this->pos];
+        if (current == '%') {
+            // Comments run to the end of the line
+            while (this->pos < size && this->data[this->pos] != '\n' && this->data[this->pos] != '\r') this->pos++;
+        } else if (isPdfWhitespace(current)) {
+            this->pos++;
+        } else {
+            return true;
+        }
+    }
+    this->endReached = true;
+    return false;
+}
+
+bool Lexer::peek(TokenType& type) {
+    size_t saved = this->pos;
+    Token token;
+    LexerStatus status = this->next(token);
+    this->pos = saved;
+    if (status != LEX_OK) return false;
+    type = token.type;
+    return true;
+}
+
+bool Lexer::readReferenceTail(const Token& number, uint16_t& generation) {
+    // Object numbers are unsigned integers without sign
+    if (number.type != TOKEN_INTEGER || number.text.empty() || !isPdfDigit(number.text[0])) return false;
+
+    size_t saved = this->pos;
+    Token second, keyword;
+    if (this->next(second) == LEX_OK && second.type == TOKEN_INTEGER && isPdfDigit(second.text[0]) && second.integer <= 65535 &&
+        this->next(keyword) == LEX_OK && keyword.type == TOKEN_KEYWORD && keyword.text == "R") {
+        generation = static_cast<uint16_t>(second.integer);
+        return true;
+    }
+    this->pos = saved;
+    return false;
+}
+
+LexerStatus Lexer::next(Token& token) {
+    if (!this->skipWhitespace()) return LEX_END;
+
+    token.start = this->baseOffset + this->pos;
+    token.escaped = false;
+    LexerStatus status = LEX_OK;
+    char current = this->data[this->pos];
+    bool hasNext = this->pos + 1 < this->data.size();
+
+    switch (current) {
+        case '/': {
+            // Name runs until the next whitespace or delimiter
+            size_t start = ++this->pos;
+            while (this->pos < this->data.size() && isPdfRegular(this->data[this->pos])) {
+                if (this->data[this->pos] == '#') token.escaped = true;
+                this->pos++;
+            }
+            if (this->pos == this->data.size()) this->endReached = true;
+            token.type = TOKEN_NAME;
+            token.text = this->data.substr(start, this->pos - start);
+            break;
+        }
+
+        case '(':
+            status = this->lexLiteralString(token);
+            break;
+
+        case '<':
+            if (hasNext && this->data[this->pos + 1] == '<') {
+                token.type = TOKEN_DICTIONARY_BEGIN;
+                this->pos += 2;
+            } else {
+                status = this->lexHexString(token);
+            }
+            break;
+
+        case '>':
+            if (hasNext && this->data[this->pos + 1] == '>') {
+                token.type = TOKEN_DICTIONARY_END;
+                this->pos += 2;
+            } else {
+                if (!hasNext) this->endReached = true;
+                status = LEX_UNEXPECTED_CHAR;
+                this->pos++;
+            }
+            break;
+
+        case ')':
+            status = LEX_UNEXPECTED_CHAR;
+            this->pos++;
+            break;
+
+        case '[': token.type = TOKEN_ARRAY_BEGIN; this->pos++; break;
+        case ']': token.type = TOKEN_ARRAY_END; this->pos++; break;
+        case '{': token.type = TOKEN_PROCEDURE_BEGIN; this->pos++; break;
+        case '}': token.type = TOKEN_PROCEDURE_END; this->pos++; break;
+
+        default:
+            if (CHAR_CLASSES.flags[static_cast<uint8_t>(current)] & CHAR_NUMBER_START) {
+                status = this->lexNumber(token);
+            } else {
+                this->lexRegular(token);
+            }
+            break;
+    }
+
+    token.end = this->baseOffset + this->pos;
+    if (token.type != TOKEN_NAME && token.type != TOKEN_STRING_LITERAL && token.type != TOKEN_STRING_HEXADECIMAL) {
+        token.text = this->data.substr(token.start - this->baseOffset, this->pos - (token.start - this->baseOffset));
+    }
+    return status;
+}
+
+// Integers & reals: optional sign, digits with at most one decimal point (ISO32000 7.3.3)
+LexerStatus Lexer::lexNumber(Token& token) {
+    const size_t size = this->data.size();
+    size_t start = this->pos;
+    bool negative = false;
+    if (this->data[this->pos] == '+' || this->data[this->pos] == '-') {
+        negative = this->data[this->pos] == '-';
+        this->pos++;
+    }
+
+    uint64_t mantissa = 0;
+    int fractionDigits = 0;
+    bool isReal = false;
+    bool hasDigit = false;
+    bool overflow = false;
+    while (this->pos < size) {
+        char current = this->data[this->pos];
+        if (isPdfDigit(current)) {
+            hasDigit = true;
+            if (mantissa <= (UINT64_MAX - 9) / 10) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(current - '0');
+                if (isReal) fractionDigits++;
+            } else {
+                overflow = true;
+            }
+        } else if (current == '.' && !isReal) {
+            isReal = true;
+        } else {
+            break;
+        }
+        this->pos++;
+    }
+    if (this->pos == size) this->endReached = true;
+    if (!hasDigit) return LEX_INVALID_NUMBER;
+
+    if (!isReal && !overflow && mantissa <= static_cast<uint64_t>(INT64_MAX) + (negative ? 1 : 0)) {
+        token.type = TOKEN_INTEGER;
+        token.integer = negative ? static_cast<int64_t>(0 - mantissa) : static_cast<int64_t>(mantissa);
+        return LEX_OK;
+    }
+
+    // Reals, and integers beyond 64 bit which are kept approximately
+    token.type = TOKEN_REAL;
+    if (!overflow && fractionDigits <= MAX_EXACT_POWER) {
+        token.real = static_cast<double>(mantissa) / POWERS_OF_TEN[fractionDigits];
+        if (negative) token.real = -token.real;
+    } else {
+        token.real = std::strtod(std::string(this->data.substr(start, this->pos - start)).c_str(), nullptr);
+    }
+    return LEX_OK;
+}
+
+// Literal string up to the balancing parenthesis, a backslash escapes the next character
+LexerStatus Lexer::lexLiteralString(Token& token) {
+    const size_t size = this->data.size();
+    size_t start = ++this->pos;
+    size_t nesting = 1;
+    token.type = TOKEN_STRING_LITERAL;
+    while (this->pos < size) {
+        char current = this->data[this->pos++];
+        if (current == '\\') {
+            token.escaped = true;
+            if (this->pos < size) this->pos++;
+        } else if (current == '(') {
+            nesting++;
+        } else if (current == ')' && --nesting == 0) {
+            token.text = this->data.substr(start, this->pos - 1 - start);
+            return LEX_OK;
+        }
+    }
+    this->endReached = true;
+    token.text = this->data.substr(start);
+    return LEX_UNTERMINATED_STRING;
+}
+
+LexerStatus Lexer::lexHexString(Token& token) {
+    const size_t size = this->data.size();
+    size_t start = ++this->pos;
+    bool valid = true;
+    token.type = TOKEN_STRING_HEXADECIMAL;
+    while (this->pos < size) {
+        char current = this->data[this->pos++];
+        if (current == '>') {
+            token.text = this->data.substr(start, this->pos - 1 - start);
+            return valid ? LEX_OK : LEX_INVALID_HEX;
+        }
+        if (!(CHAR_CLASSES.flags[static_cast<uint8_t>(current)] & (CHAR_HEX_DIGIT | CHAR_WHITESPACE))) valid = false;
+    }
+    this->endReached = true;
+    token.text = this->data.substr(start);
+    return LEX_UNTERMINATED_STRING;
+}
+
+// Run of regular characters, true, false & null are values, everything else a keyword
+void Lexer::lexRegular(Token& token) {
+    size_t start = this->pos;
+    while (this->pos < this->data.size() && isPdfRegular(this->data[this->pos])) this->pos++;
+    if (this->pos == this->data.size()) this->endReached = true;
+
+    std::string_view word = this->data.substr(start, this->pos - start);
+    if (word == "true") token.type = TOKEN_TRUE;
+    else if (word == "false") token.type = TOKEN_FALSE;
+    else if (word == "null") token.type = TOKEN_NULL;
+    else token.type = TOKEN_KEYWORD;
+}
+
+void Lexer::decodeName(std::string_view raw, std::string& output) {
+    output.clear();
+    output.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); i++) {
+        if (raw[i] == '#' && i + 2 < raw.size() && hexDigitValue(raw[i+1]) >= 0 && hexDigitValue(raw[i+2]) >= 0) {
+            output.push_back(static_cast<char>(hexDigitValue(raw[i+1]) * 16 + hexDigitValue(raw[i+2])));
+            i += 2;
+        } else {
+            output.push_back(raw[i]);
+        }
+    }
+}
+
+void Lexer::decodeLiteralString(std::string_view raw, std::string& output) {
+    output.clear();
+    output.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); i++) {
+        char current = raw[i];
+        if (current == '\r') {
+            // Any end of line in a string is a single LF
+            if (i + 1 < raw.size() && raw[i+1] == '\n') i++;
+            output.push_back('\n');
+            continue;
+        }
+        if (current != '\\' || i + 1 >= raw.size()) {
+            output.push_back(current);
+            continue;
+        }
+
+        char escaped = raw[++i];
+        switch (escaped) {
+            case 'n': output.push_back('\n'); break;
+            case 'r': output.push_back('\r'); break;
+            case 't': output.push_back('\t'); break;
+            case 'b': output.push_back('\b'); break;
+            case 'f': output.push_back('\f'); break;
+            case '\r':
+                // Backslash at the end of a line continues the string on the next one
+                if (i + 1 < raw.size() && raw[i+1] == '\n') i++;
+                break;
+            case '\n':
+                break;
+            default:
+                if (escaped >= '0' && escaped <= '7') {
+                    // Up to three octal digits
+                    int value = escaped - '0';
+                    for (int digits = 1; digits < 3 && i + 1 < raw.size() && raw[i+1] >= '0' && raw[i+1] <= '7'; digits++) {
+                        value = value * 8 + (raw[++i] - '0');
+                    }
+                    output.push_back(static_cast<char>(value & 0xFF));
+                } else {
+                    // \( \) \\ & unknown escapes are the character itself
+                    output.push_back(escaped);
+                }
+                break;
+        }
+    }
+}
+
+void Lexer::decodeHexString(std::string_view raw, std::string& output) {
+    output.clear();
+    output.reserve(raw.size() / 2 + 1);
+    int high = -1;
+    for (char c: raw) {
+        int value = hexDigitValue(c);
+        if (value < 0) continue;
+        if (high < 0) {
+            high = value;
+        } else {
+            output.push_back(static_cast<char>(high * 16 + value));
+            high = -1;
+        }
+    }
+    if (high >= 0) output.push_back(static_cast<char>(high * 16));
+}
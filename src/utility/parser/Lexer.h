@@ -0,0 +1,125 @@
+#pragma once
+
+#include "CharClass.h"
+#include "../Buffer.h"
+
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+enum LexerStatus {
+    LEX_OK,
+    // No more tokens in the data
+    LEX_END,
+    // ( without balancing ) or < without >, the token runs to the end of the data
+    LEX_UNTERMINATED_STRING,
+    // Hex string with characters other than hex digits & whitespace
+    LEX_INVALID_HEX,
+    // Sign or decimal point without digits
+    LEX_INVALID_NUMBER,
+    // ) or a single > outside of a string
+    LEX_UNEXPECTED_CHAR
+};
+
+enum TokenType : uint8_t {
+    TOKEN_INTEGER,
+    TOKEN_REAL,
+    TOKEN_NAME,
+    TOKEN_STRING_LITERAL,
+    TOKEN_STRING_HEXADECIMAL,
+    TOKEN_ARRAY_BEGIN,
+    TOKEN_ARRAY_END,
+    TOKEN_DICTIONARY_BEGIN,
+    TOKEN_DICTIONARY_END,
+    // { & } of PostScript calculator functions
+    TOKEN_PROCEDURE_BEGIN,
+    TOKEN_PROCEDURE_END,
+    TOKEN_TRUE,
+    TOKEN_FALSE,
+    TOKEN_NULL,
+    // Any other run of regular characters: obj, endobj, stream, R, content stream operators...
+    TOKEN_KEYWORD
+};
+
+struct Token {
+    TokenType type = TOKEN_NULL;
+    // Position of the first byte & after the last byte, including the lexer's base offset
+    size_t start = 0;
+    size_t end = 0;
+    /* Raw characters, points into the lexed data: names without the /, strings without their
+        delimiters (escapes not resolved), keywords & numbers as written */
+    std::string_view text;
+    int64_t integer = 0;
+    double real = 0;
+    // Name contains #xx escapes, literal string contains backslash escapes
+    bool escaped = false;
+};
+
+/* Single pass tokenizer for PDF syntax (ISO32000 7.2 & 7.3) over a contiguous span of bytes.
+    Never throws, malformed input is reported through the status & skipped, so a caller can always
+    continue with the next token. Whitespace & comments between tokens are skipped */
+class Lexer {
+    public:
+        // baseOffset is added to all reported positions, e.g. the file offset of the data
+        explicit Lexer(std::string_view data, size_t baseOffset = 0) : data(data), baseOffset(baseOffset) {};
+
+        LexerStatus next(Token& token);
+        // Type of the next token without consuming it, false at the end
+        bool peek(TokenType& type);
+        // Skip whitespace & comments, false if the end was reached
+        bool skipWhitespace();
+        /* After an integer token: consume "G R" if they follow & make it an indirect reference,
+            otherwise nothing is consumed */
+        bool readReferenceTail(const Token& number, uint16_t& generation);
+
+        size_t getPosition() const { return baseOffset + pos; }
+        void setPosition(size_t position) { pos = std::min(position - baseOffset, data.size()); }
+        bool atEnd() const { return pos >= data.size(); }
+        std::string_view getData() const { return data; }
+        size_t getBaseOffset() const { return baseOffset; }
+        // A token or the search for one ran into the end of the data, more data could change the result
+        bool reachedEnd() const { return endReached; }
+
+        // Resolve #xx escapes of a raw name
+        static void decodeName(std::string_view raw, std::string& output);
+        // Resolve escapes & normalize line ends of a raw literal string (ISO32000 7.3.4.2)
+        static void decodeLiteralString(std::string_view raw, std::string& output);
+        // Bytes of a raw hex string, a missing last digit counts as 0
+        static void decodeHexString(std::string_view raw, std::string& output);
+
+    private:
+        LexerStatus lexNumber(Token& token);
+        LexerStatus lexLiteralString(Token& token);
+        LexerStatus lexHexString(Token& token);
+        void lexRegular(Token& token);
+
+        std::string_view data;
+        size_t baseOffset;
+        size_t pos = 0;
+        bool endReached = false;
+};
+
+// Initial window for lexing from windowed buffers, grows while the lexer runs into its end
+constexpr size_t LEXER_WINDOW = 4096;
+
+/* Run parse(Lexer&) on the bytes of source from an absolute position on & leave the marker after
+    what was lexed. Contiguous buffers are lexed up to their end without copying. Windowed buffers
+    get a small window that is enlarged while the lexer needs bytes beyond it. The lexed view is
+    only valid inside parse, so parse must not access the buffer itself */
+template <typename ParseFunction>
+auto lexFrom(Buffer& source, size_t start, ParseFunction parse) -> decltype(parse(std::declval<Lexer&>())) {
+    size_t window = LEXER_WINDOW;
+    while (true) {
+        size_t available = start < source.getSize() ? source.getSize() - start : 0;
+        size_t length = source.isContiguous() ? available : std::min(window, available);
+        Lexer lexer(source.viewSpan(start, length), start);
+        auto result = parse(lexer);
+        if (!lexer.reachedEnd() || length == available) {
+            source.setPosition(std::min(lexer.getPosition(), source.getSize()));
+            return result;
+        }
+        window *= 4;
+    }
+}
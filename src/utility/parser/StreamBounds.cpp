@@ -0,0 +1,47 @@
+#include "StreamBounds.h"
+#include "CharClass.h"
+
+size_t StreamBounds::findDataStart(Buffer& source, size_t afterDict) {
+    size_t keywordStart = afterDict;
+    while (keywordStart < source.getSize() && isPdfWhitespace(source.byteAt(keywordStart))) keywordStart++;
+    if (keywordStart + 6 > source.getSize() || source.viewByteRange(keywordStart, keywordStart + 5) != "stream") {
+        return std::string::npos;
+    }
+
+    // Keyword is followed by CRLF or LF, tolerate a lone CR
+    size_t dataStart = keywordStart + 6;
+    if (dataStart < source.getSize() && source.byteAt(dataStart) == '\r') dataStart++;
+    if (dataStart < source.getSize() && source.byteAt(dataStart) == '\n') dataStart++;
+    return dataStart;
+}
+
+size_t StreamBounds::findDataLength(Buffer& source, size_t dataStart, std::optional<int64_t> length) {
+    if (length.has_value() && length.value() >= 0 && static_cast<uint64_t>(length.value()) <= source.getSize() - dataStart) {
+        size_t endPos = dataStart + static_cast<size_t>(length.value());
+        while (endPos < source.getSize() && isPdfWhitespace(source.byteAt(endPos))) endPos++;
+        if (endPos + 9 <= source.getSize() && source.viewByteRange(endPos, endPos + 8) == "endstream") {
+            return static_cast<size_t>(length.value());
+        }
+    }
+
+    /* Window by window, so a windowed buffer never copies more than one window. Windows overlap
+        by the keyword's length - 1 so a keyword across their border is still found */
+    const std::string_view keyword = "endstream";
+    size_t endstream = std::string::npos;
+    for (size_t start = dataStart; start < source.getSize();) {
+        std::string_view window = source.viewSpan(start, STREAM_SEARCH_WINDOW);
+        size_t found = window.find(keyword);
+        if (found != std::string_view::npos) {
+            endstream = start + found;
+            break;
+        }
+        if (start + window.size() >= source.getSize()) break;
+        start += window.size() - (keyword.size() - 1);
+    }
+    if (endstream == std::string::npos) return std::string::npos;
+    // The EOL before endstream isn't part of the data
+    size_t dataLength = endstream - dataStart;
+    if (dataLength > 0 && source.byteAt(dataStart + dataLength - 1) == '\n') dataLength--;
+    if (dataLength > 0 && source.byteAt(dataStart + dataLength - 1) == '\r') dataLength--;
+    return dataLength;
+}
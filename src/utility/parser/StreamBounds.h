@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../Buffer.h"
+
+#include <optional>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Bytes searched at once for the endstream of a stream without a usable /Length
+constexpr size_t STREAM_SEARCH_WINDOW = 64 * 1024;
+
+/* Locating the data of a stream object (ISO32000 7.3.8.1) in two steps, so an indirect
+    /Length only has to be resolved once the dictionary is known to belong to a stream */
+class StreamBounds {
+    public:
+        // Start of the data if the stream keyword follows the dictionary ending before afterDict, npos otherwise
+        static size_t findDataStart(Buffer& source, size_t afterDict);
+        /* Length of the data, /Length is trusted if endstream follows it, otherwise endstream is
+            searched for. npos if there is no endstream at all */
+        static size_t findDataLength(Buffer& source, size_t dataStart, std::optional<int64_t> length);
+};
@@ -0,0 +1,142 @@
+#include "ValueParser.h"
+#include "StreamBounds.h"
+
+#include <new>
+#include <memory>
+
+Value ValueParser::parse(Buffer& source, size_t byteOffset) {
+    Value value = lexFrom(source, byteOffset, [this](Lexer& lexer) { return this->parseValue(lexer, 0); });
+    this->end = source.getPosition();
+    return value;
+}
+
+/* Parse an indirect object definition (N G obj ... endobj) at the given position, 
+    returns its value or the stream, invalid if no object header is found */
+Value ValueParser::parseIndirect(Buffer& source, size_t byteOffset, const LengthResolver& resolveLength) {
+    Value value = lexFrom(source, byteOffset, [this](Lexer& lexer) {
+        Token number, generation, keyword;
+        if (lexer.next(number) != LEX_OK || number.type != TOKEN_INTEGER || number.integer < 0 ||
+            lexer.next(generation) != LEX_OK || generation.type != TOKEN_INTEGER || generation.integer < 0 ||
+            lexer.next(keyword) != LEX_OK || keyword.type != TOKEN_KEYWORD || keyword.text != "obj") {
+            return Value::makeInvalid();
+        }
+        return this->parseValue(lexer, 0);
+    });
+    this->end = source.getPosition();
+    if (value.getType() != OBJT_DICTIONARY) return value;
+
+    // A dictionary followed by the stream keyword is the stream's dictionary
+    size_t dataStart = StreamBounds::findDataStart(source, source.getPosition());
+    if (dataStart == std::string::npos) return value;
+
+    std::optional<int64_t> length;
+    const Value* lengthValue = value.find(NAME_LENGTH);
+    if (lengthValue && lengthValue->getType() == OBJT_INTEGER) {
+        length = lengthValue->getInteger();
+    } else if (lengthValue && lengthValue->getType() == OBJT_INDIRECT && resolveLength) {
+        length = resolveLength(lengthValue->getNumber(), lengthValue->getGeneration());
+    }
+    size_t dataLength = StreamBounds::findDataLength(source, dataStart, length);
+    if (dataLength == std::string::npos) return Value::makeInvalid();
+    this->end = dataStart + dataLength;
+
+    StreamValue* stream = new (this->arena.allocate(sizeof(StreamValue), alignof(StreamValue))) StreamValue{value, dataStart, dataLength};
+    return Value::makeStream(stream);
+}
+
+Value ValueParser::parseValue(Lexer& lexer, size_t depth) {
+    Token token;
+    LexerStatus status = lexer.next(token);
+    // Malformed hex digits are ignored when decoding, the string is still usable
+    if (status != LEX_OK && status != LEX_INVALID_HEX) return Value::makeInvalid();
+    return this->parseToken(lexer, token, depth);
+}
+
+Value ValueParser::parseToken(Lexer& lexer, const Token& token, size_t depth) {
+    switch (token.type) {
+        case TOKEN_INTEGER: {
+            uint16_t generation;
+            if (lexer.readReferenceTail(token, generation)) return Value::makeReference(static_cast<size_t>(token.integer), generation);
+            return Value::makeInteger(token.integer);
+        }
+        case TOKEN_REAL:
+            return Value::makeReal(token.real);
+        case TOKEN_NAME:
+            if (!token.escaped) return Value::makeName(this->names.intern(token.text));
+            Lexer::decodeName(token.text, this->text);
+            return Value::makeName(this->names.intern(this->text));
+        case TOKEN_STRING_LITERAL:
+            return Value::makeString(OBJT_STRING_LITERAL, this->arena.copyString(token.text));
+        case TOKEN_STRING_HEXADECIMAL:
+            return Value::makeString(OBJT_STRING_HEXADECIMAL, this->arena.copyString(token.text));
+        case TOKEN_ARRAY_BEGIN:
+            if (depth >= MAX_VALUE_NESTING) return Value::makeInvalid();
+            return this->parseArray(lexer, depth);
+        case TOKEN_DICTIONARY_BEGIN:
+            if (depth >= MAX_VALUE_NESTING) return Value::makeInvalid();
+            return this->parseDictionary(lexer, depth);
+        case TOKEN_TRUE:
+            return Value::makeBoolean(true);
+        case TOKEN_FALSE:
+            return Value::makeBoolean(false);
+        case TOKEN_NULL:
+            return Value();
+        default:
+            // Keywords & closing tokens aren't values
+            return Value::makeInvalid();
+    }
+}
+
+Value ValueParser::parseArray(Lexer& lexer, size_t depth) {
+    size_t base = this->items.size();
+    Token token;
+    while (true) {
+        LexerStatus status = lexer.next(token);
+        // Unterminated arrays end with the data
+        if (status == LEX_END) break;
+        if (status != LEX_OK && status != LEX_INVALID_HEX) continue;
+        if (token.type == TOKEN_ARRAY_END) break;
+        Value element = this->parseToken(lexer, token, depth + 1);
+        if (element.getType() != OBJT_INVALID) this->items.push_back(element);
+    }
+
+    size_t count = this->items.size() - base;
+    Value* copy = this->arena.allocateArray<Value>(count);
+    std::uninitialized_copy(this->items.begin() + base, this->items.end(), copy);
+    this->items.resize(base);
+    return Value::makeArray(copy, count);
+}
+
+Value ValueParser::parseDictionary(Lexer& lexer, size_t depth) {
+    size_t base = this->entries.size();
+    Token token;
+    while (true) {
+        LexerStatus status = lexer.next(token);
+        if (status == LEX_END) break;
+        if (status != LEX_OK) continue;
+        if (token.type == TOKEN_DICTIONARY_END) break;
+        // Anything but a name in key position is skipped
+        if (token.type != TOKEN_NAME) continue;
+        NameAtom key;
+        if (token.escaped) {
+            Lexer::decodeName(token.text, this->text);
+            key = this->names.intern(this->text).atom;
+        } else {
+            key = this->names.intern(token.text).atom;
+        }
+
+        status = lexer.next(token);
+        if (status == LEX_END) break;
+        // Key without a value right before the end
+        if (status == LEX_OK && token.type == TOKEN_DICTIONARY_END) break;
+        if (status != LEX_OK && status != LEX_INVALID_HEX) continue;
+        Value value = this->parseToken(lexer, token, depth + 1);
+        if (value.getType() != OBJT_INVALID) this->entries.push_back(DictEntry{key, value});
+    }
+
+    size_t count = this->entries.size() - base;
+    DictEntry* copy = this->arena.allocateArray<DictEntry>(count);
+    std::uninitialized_copy(this->entries.begin() + base, this->entries.end(), copy);
+    this->entries.resize(base);
+    return Value::makeDictionary(copy, count);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Lexer.h"
+#include "../Buffer.h"
+#include "../objects/ObjectArena.h"
+#include "../objects/Value.h"
+
+#include <vector>
+#include <string>
+#include <optional>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+// Deeper nesting of arrays & dictionaries is treated as invalid
+constexpr size_t MAX_VALUE_NESTING = 256;
+
+/* Parser for the arena object model. Nothing is allocated per object, elements of arrays &
+    dictionaries are collected on scratch stacks & copied into the arena once complete.
+    The stacks are reused between objects, so use one parser per thread. Names are interned
+    through the given scope, the values must not outlive it */
+class ValueParser {
+    public:
+        // Asked for the value of an indirect /Length, nullopt makes the parser search for endstream
+        using LengthResolver = std::function<std::optional<int64_t>(size_t number, uint16_t generation)>;
+
+        ValueParser(ObjectArena& arena, NameScope& names) : arena(arena), names(names) {};
+
+        // Parse the object at byteOffset, the marker is after it afterwards. Invalid value if nothing could be parsed
+        Value parse(Buffer& source, size_t byteOffset);
+        // Parse the next object of a lexer
+        Value parse(Lexer& lexer) { return parseValue(lexer, 0); }
+        // Parse an indirect object definition (N G obj ... endobj), streams get the range of their data
+        Value parseIndirect(Buffer& source, size_t byteOffset, const LengthResolver& resolveLength = nullptr);
+        /* Offset after the last object parsed, the end of the data for streams. Unlike the marker
+            it stays put when the length resolver reads through the same buffer */
+        size_t getEnd() const { return end; }
+
+    private:
+        Value parseValue(Lexer& lexer, size_t depth);
+        Value parseToken(Lexer& lexer, const Token& token, size_t depth);
+        Value parseArray(Lexer& lexer, size_t depth);
+        Value parseDictionary(Lexer& lexer, size_t depth);
+
+        ObjectArena& arena;
+        NameScope& names;
+        std::vector<Value> items;
+        std::vector<DictEntry> entries;
+        std::string text;
+        size_t end = 0;
+};
@@ -0,0 +1,319 @@
+#include "DocumentRewriter.h"
+#include "../objects/NameObject.h"
+#include "../objects/IntegerObject.h"
+#include "../objects/ReferenceObject.h"
+#include "../filters/FlateDecode.h"
+#include "../filters/StreamFilter.h"
+#include "../graph/ObjectGraph.h"
+#include "../parallel/WorkStealingRange.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+
+bool DocumentRewriter::setError(const std::string& msg) {
+    this->errorMessage = msg;
+    return false;
+}
+
+bool DocumentRewriter::emit(std::ostream& out, const std::string& data) {
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    this->position += data.size();
+    return static_cast<bool>(out) || this->setError("Can't write file");
+}
+
+// Function to parse every object & mark the ones reachable from the trailer
+bool DocumentRewriter::collect() {
+    std::shared_ptr<DictionaryObject> trailer = this->reader.getTrailer();
+    if (!trailer) return this->setError("Document isn't processed");
+    // Objects would have to be encrypted with the document's key
+    if (trailer->getElement(NAME_ENCRYPT)) return this->setError("Encrypted documents can't be written");
+    if (!this->reader.parseDocument(this->threads)) return this->setError(this->reader.getErrorMessage());
+
+    // Stream lengths are written directly, the objects holding them aren't needed anymore
+    ObjectGraph graph;
+    if (!graph.build(this->reader, this->threads, false)) return this->setError("Can't build the object graph");
+    this->numbers = graph.getNumbers();
+    this->stats.objectsIn = this->numbers.size();
+    if (!this->options.removeUnreachable) {
+        this->reachable.assign(this->numbers.size(), 1);
+        return true;
+    }
+
+    this->reachable = graph.reachable(ObjectGraph::trailerRoots(this->reader), this->threads);
+    size_t reached = std::count(this->reachable.begin(), this->reachable.end(), 1);
+    this->stats.unreachable = this->stats.objectsIn - reached;
+    return true;
+}
+
+// Function to find streams whose dictionary & data are the same, by a hash of their serialized form
+void DocumentRewriter::deduplicate() {
+    this->duplicateOf.assign(this->numbers.size(), 0);
+    if (!this->options.deduplicateStreams) return;
+
+    // Nodes of the reachable streams
+    std::vector<uint32_t> streams;
+    for (size_t node = 0; node < this->numbers.size(); node++) {
+        if (this->reachable[node] && this->reader.getDocumentObject(this->numbers[node]).getType() == OBJT_STREAM) streams.push_back(static_cast<uint32_t>(node));
+    }
+    // Written as they are in the file (old numbers, stored data), equal text means an equal stream
+    auto render = [this](Buffer& source, uint32_t number, std::string& text, std::string& data) {
+        const Value& stream = this->reader.getDocumentObject(number);
+        BufferSource input(source, stream.getStream()->dataStart, stream.getStream()->dataLength);
+        readAll(input, data, stream.getStream()->dataLength);
+        text.clear();
+        ObjectSerializer::writeStream(text, 0, 0, stream, data);
+    };
+
+    std::vector<size_t> hashes(streams.size());
+    WorkStealingRange range(streams.size(), this->threads, REWRITE_GRAIN);
+    runOnWorkers(this->threads, [&](size_t worker) {
+        std::string text, data;
+        size_t begin, end;
+        while (range.next(worker, begin, end)) {
+            for (size_t i = begin; i < end; i++) {
+                render(*this->cursors[worker], this->numbers[streams[i]], text, data);
+                hashes[i] = std::hash<std::string_view>()(text);
+            }
+        }
+    });
+
+    // Equal hashes are compared byte by byte, the first stream of a kind stays
+    std::unordered_map<size_t, std::vector<uint32_t>> firsts;
+    std::string text, data, otherText, otherData;
+    for (size_t i = 0; i < streams.size(); i++) {
+        std::vector<uint32_t>& candidates = firsts[hashes[i]];
+        bool duplicate = false;
+        if (!candidates.empty()) {
+            render(*this->cursors[0], this->numbers[streams[i]], text, data);
+            for (uint32_t candidate: candidates) {
+                render(*this->cursors[0], candidate, otherText, otherData);
+                if (text != otherText) continue;
+                this->duplicateOf[streams[i]] = candidate;
+                this->stats.duplicateStreams++;
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate) candidates.push_back(this->numbers[streams[i]]);
+    }
+}
+
+void DocumentRewriter::renumber() {
+    // Indexed by old number, the xref limits object numbers to MAX_OBJECT_NUMBER
+    this->renumbering.assign(this->numbers.empty() ? 0 : this->numbers.back() + 1, 0);
+    this->order.clear();
+    for (size_t node = 0; node < this->numbers.size(); node++) {
+        if (!this->reachable[node] || this->duplicateOf[node] != 0) continue;
+        this->order.push_back(this->numbers[node]);
+        this->renumbering[this->numbers[node]] = static_cast<uint32_t>(this->order.size());
+    }
+    // Duplicates share the number of the stream they repeat
+    for (size_t node = 0; node < this->numbers.size(); node++) {
+        if (this->duplicateOf[node] != 0) this->renumbering[this->numbers[node]] = this->renumbering[this->duplicateOf[node]];
+    }
+    this->stats.objectsOut = this->order.size();
+}
+
+bool DocumentRewriter::renderStream(std::string& out, Buffer& source, size_t number, const Value& stream, std::string& data, bool& compressed) {
+    const StreamValue* value = stream.getStream();
+    BufferSource input(source, value->dataStart, value->dataLength);
+    if (!readAll(input, data, value->dataLength)) return false;
+
+    compressed = false;
+    if (this->options.compressStreams && !stream.find(NAME_FILTER) && data.size() >= REWRITE_COMPRESS_MINIMUM) {
+        std::string deflated;
+        compressed = FlateDecode::encode(data, deflated, this->options.compressionLevel) && deflated.size() < data.size();
+        if (compressed) data = std::move(deflated);
+    }
+    ObjectSerializer::writeStream(out, number, 0, stream, data, &this->renumbering, compressed);
+    return true;
+}
+
+// Function to render object streams on the workers & write them in order
+bool DocumentRewriter::writePacks(std::ostream& out, std::vector<ObjectStreamPack>& packs) {
+    std::vector<std::string> rendered(packs.size());
+    WorkStealingRange range(packs.size(), this->threads, 1);
+    runOnWorkers(this->threads, [&](size_t worker) {
+        size_t begin, end;
+        while (range.next(worker, begin, end)) {
+            for (size_t i = begin; i < end; i++) {
+                ObjectStreamPack& pack = packs[i];
+                std::string data;
+                for (size_t j = 0; j < pack.numbers.size(); j++) {
+                    data += std::to_string(pack.numbers[j]) + ' ' + std::to_string(pack.offsets[j]) + ' ';
+                }
+                size_t first = data.size();
+                data += pack.bodies;
+
+                std::shared_ptr<DictionaryObject> dictionary = std::make_shared<DictionaryObject>(0);
+                dictionary->addElement(NAME_TYPE, std::make_shared<NameObject>(0, 0, "ObjStm"));
+                dictionary->addElement(NAME_N, std::make_shared<IntegerObject>(0, 0, static_cast<int64_t>(pack.numbers.size())));
+                dictionary->addElement(NAME_FIRST, std::make_shared<IntegerObject>(0, 0, static_cast<int64_t>(first)));
+                std::string deflated;
+                if (FlateDecode::encode(data, deflated, this->options.compressionLevel)) {
+                    dictionary->addElement(NAME_FILTER, std::make_shared<NameObject>(0, 0, "FlateDecode"));
+                    data = std::move(deflated);
+                }
+                ObjectSerializer::writeStream(rendered[i], pack.number, 0, dictionary, data);
+            }
+        }
+    });
+
+    for (size_t i = 0; i < packs.size(); i++) {
+        this->entries[packs[i].number] = xrefEntry{this->position, 0, packs[i].number, 'n'};
+        if (!this->emit(out, rendered[i])) return false;
+    }
+    this->stats.objectStreams += packs.size();
+    packs.clear();
+    return true;
+}
+
+bool DocumentRewriter::writeObjects(std::ostream& out) {
+    size_t count = this->order.size();
+    this->entries.assign(count + 1, xrefEntry{0, MAX_GENERATION, 0, 'f'});
+
+    std::vector<std::string> rendered;
+    std::vector<size_t> compressedCounts(this->threads);
+    std::vector<ObjectStreamPack> fullPacks;
+    ObjectStreamPack pack;
+    std::atomic<bool> failed{false};
+
+    for (size_t windowStart = 0; windowStart < count; windowStart += REWRITE_WINDOW) {
+        size_t windowSize = std::min(REWRITE_WINDOW, count - windowStart);
+        rendered.assign(windowSize, std::string());
+
+        // Streams are rendered completely, other objects only as their value until it's known where they go
+        WorkStealingRange range(windowSize, this->threads, REWRITE_GRAIN);
+        runOnWorkers(this->threads, [&](size_t worker) {
+            std::string data;
+            size_t begin, end;
+            while (range.next(worker, begin, end)) {
+                for (size_t i = begin; i < end; i++) {
+                    const Value& value = this->reader.getDocumentObject(this->order[windowStart + i]);
+                    if (value.getType() != OBJT_STREAM) {
+                        ObjectSerializer::write(rendered[i], value, &this->renumbering);
+                        continue;
+                    }
+                    bool compressed;
+                    if (!this->renderStream(rendered[i], *this->cursors[worker], windowStart + i + 1, value, data, compressed)) failed = true;
+                    if (compressed) compressedCounts[worker]++;
+                }
+            }
+        });
+        if (failed) return this->setError("Can't read stream data");
+
+        for (size_t i = 0; i < windowSize; i++) {
+            size_t number = windowStart + i + 1;
+            const Value& value = this->reader.getDocumentObject(this->order[windowStart + i]);
+            std::string& text = rendered[i];
+            if (value.getType() != OBJT_STREAM && text.size() <= this->options.packLimit) {
+                // Object stream numbers follow the document's objects
+                if (pack.numbers.empty()) {
+                    pack.number = this->entries.size();
+                    this->entries.push_back(xrefEntry{0, 0, pack.number, 'n'});
+                }
+                this->entries[number] = xrefEntry{pack.number, 0, number, 'c', pack.numbers.size()};
+                pack.numbers.push_back(number);
+                pack.offsets.push_back(pack.bodies.size());
+                pack.bodies += text;
+                pack.bodies += '\n';
+                this->stats.packedObjects++;
+                if (pack.numbers.size() >= this->options.objectsPerStream) {
+                    fullPacks.push_back(std::move(pack));
+                    pack = ObjectStreamPack();
+                }
+                continue;
+            }
+            if (value.getType() != OBJT_STREAM) text = std::to_string(number) + " 0 obj\n" + text + "\nendobj\n";
+            this->entries[number] = xrefEntry{this->position, 0, number, 'n'};
+            if (!this->emit(out, text)) return false;
+        }
+        if (!this->writePacks(out, fullPacks)) return false;
+    }
+    if (!pack.numbers.empty()) {
+        fullPacks.push_back(std::move(pack));
+        if (!this->writePacks(out, fullPacks)) return false;
+    }
+    for (size_t compressed: compressedCounts) this->stats.compressedStreams += compressed;
+    return true;
+}
+
+std::shared_ptr<DictionaryObject> DocumentRewriter::makeTrailer(size_t size) {
+    std::shared_ptr<DictionaryObject> trailer = std::make_shared<DictionaryObject>(0);
+    trailer->addElement(NAME_SIZE, std::make_shared<IntegerObject>(0, 0, static_cast<int64_t>(size)));
+    for (const auto& [key, value]: this->reader.getTrailer()->getElements()) {
+        if (XRefWriter::isSectionKey(key)) continue;
+        std::shared_ptr<ReferenceObject> reference = std::dynamic_pointer_cast<ReferenceObject>(value);
+        if (!reference) {
+            trailer->addElement(key, value);
+            continue;
+        }
+        size_t number = reference->getNumber() < this->renumbering.size() ? this->renumbering[reference->getNumber()] : 0;
+        if (number != 0) trailer->addElement(key, std::make_shared<ReferenceObject>(0, 0, number, 0));
+    }
+    return trailer;
+}
+
+bool DocumentRewriter::write(std::ostream& out) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    this->stats = RewriteStats();
+    this->stats.bytesIn = this->reader.getFileSize();
+    this->position = 0;
+    this->threads = this->options.threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : this->options.threads;
+    this->options.objectsPerStream = std::max<size_t>(this->options.objectsPerStream, 1);
+
+    this->cursors.clear();
+    for (size_t i = 0; i < this->threads; i++) {
+        this->cursors.push_back(this->reader.createCursor());
+        if (!this->cursors.back()->isReady()) return this->setError("Can't read file");
+    }
+    if (!this->collect()) return false;
+    this->deduplicate();
+    this->renumber();
+
+    // Object & cross-reference streams need PDF 1.5
+    std::string version = std::max<std::string>(this->reader.getPdfVersion(), "1.5");
+    if (!this->emit(out, "%PDF-" + version + "\n%\xE2\xE3\xCF\xD3\n")) return false;
+    if (!this->writeObjects(out)) return false;
+
+    size_t number = this->entries.size();
+    size_t xrefOffset = this->position;
+    this->entries.push_back(xrefEntry{xrefOffset, 0, number, 'n'});
+    std::string tail;
+    XRefWriter::writeStream(tail, number, this->entries, this->makeTrailer(number + 1), xrefOffset);
+    if (!this->emit(out, tail)) return false;
+    if (!out.flush()) return this->setError("Can't write file");
+
+    // Arena model & cursors are only needed while writing
+    this->reader.releaseDocument();
+    this->cursors.clear();
+    this->entries = std::vector<xrefEntry>();
+    this->stats.bytesOut = this->position;
+    this->stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool DocumentRewriter::save(const wxString& path) {
+    std::string target = path.ToStdString();
+    std::string temporary = target + ".tmp";
+    bool ok;
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) return this->setError("Can't open file for writing");
+        ok = this->write(out);
+    }
+    if (ok) {
+        std::error_code error;
+        std::filesystem::rename(temporary, target, error);
+        if (error) ok = this->setError("Can't write file");
+    }
+    if (!ok) std::remove(temporary.c_str());
+    return ok;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "ObjectSerializer.h"
+#include "XRefWriter.h"
+#include "../PdfReader.h"
+#include "../objects/Value.h"
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <wx/string.h>
+
+// Objects other than streams up to this many bytes are packed into object streams
+constexpr size_t OBJECT_STREAM_PACK_LIMIT = 1024;
+// Objects per object stream, a reader decodes the whole stream for any of them
+constexpr size_t OBJECT_STREAM_CAPACITY = 100;
+// Objects serialized in parallel before they are written in order, bounds the memory of a rewrite
+constexpr size_t REWRITE_WINDOW = 16384;
+// Objects a worker takes at once while serializing
+constexpr size_t REWRITE_GRAIN = 64;
+// Unfiltered streams below this size aren't worth deflating
+constexpr size_t REWRITE_COMPRESS_MINIMUM = 64;
+
+struct RewriteOptions {
+    // Threads serializing & compressing, 0 uses every core
+    size_t threads = 0;
+    // Drop objects that can't be reached from the trailer (/Root, /Info)
+    bool removeUnreachable = true;
+    // Streams with the same dictionary & data are written once & shared
+    bool deduplicateStreams = true;
+    // Largest object packed into object streams, 0 writes every object on its own
+    size_t packLimit = OBJECT_STREAM_PACK_LIMIT;
+    size_t objectsPerStream = OBJECT_STREAM_CAPACITY;
+    // Deflate streams without a /Filter, at a zlib level (-1 is zlib's default)
+    bool compressStreams = true;
+    int compressionLevel = -1;
+};
+
+struct RewriteStats {
+    // Objects in use in the newest revision of the input
+    size_t objectsIn = 0;
+    size_t unreachable = 0;
+    size_t duplicateStreams = 0;
+    // Document objects written, object streams & the xref stream not counted
+    size_t objectsOut = 0;
+    size_t packedObjects = 0;
+    size_t objectStreams = 0;
+    size_t compressedStreams = 0;
+    size_t bytesIn = 0;
+    size_t bytesOut = 0;
+    double seconds = 0;
+};
+
+/* "Save as optimized": writes the newest revision of a document as a new file without its
+    update history. Objects that can't be reached from the trailer are dropped, identical
+    streams are written once, the rest is renumbered densely from 1 in the old order. Small
+    objects go into deflated object streams & the file ends in one cross-reference stream.
+
+    The document is parsed into the reader's arena model, objects are then serialized &
+    compressed on worker threads REWRITE_WINDOW at a time & written in order, so the output
+    is the same for any number of threads */
+class DocumentRewriter {
+    public:
+        // The reader has to be processed, a recovered xref is fine
+        explicit DocumentRewriter(PdfReader& reader, const RewriteOptions& options = RewriteOptions()) : reader(reader), options(options) {};
+
+        bool write(std::ostream& out);
+        // Written to a temporary file & renamed, the reader's file may be the target
+        bool save(const wxString& path);
+
+        const RewriteStats& getStats() const { return stats; }
+        std::string getErrorMessage() { return errorMessage; }
+
+    private:
+        // Non-stream objects collected into one object stream
+        struct ObjectStreamPack {
+            size_t number = 0;
+            std::vector<size_t> numbers;
+            std::vector<size_t> offsets;
+            std::string bodies;
+        };
+
+        bool collect();
+        void deduplicate();
+        void renumber();
+        bool writeObjects(std::ostream& out);
+        bool writePacks(std::ostream& out, std::vector<ObjectStreamPack>& packs);
+        std::shared_ptr<DictionaryObject> makeTrailer(size_t size);
+        // Serialized stream object with the data as stored in the file, deflated if it has no filter
+        bool renderStream(std::string& out, Buffer& source, size_t number, const Value& stream, std::string& data, bool& compressed);
+        bool emit(std::ostream& out, const std::string& data);
+        bool setError(const std::string& msg);
+
+        PdfReader& reader;
+        RewriteOptions options;
+        RewriteStats stats;
+        std::string errorMessage;
+
+        size_t threads = 1;
+        // Each worker reads stream data through its own cursor
+        std::vector<std::unique_ptr<Buffer>> cursors;
+        // Old numbers of the document's objects (the object graph's nodes), whether each is
+        // reachable & the old number of the first stream with the same content for duplicates
+        std::vector<uint32_t> numbers;
+        std::vector<uint8_t> reachable;
+        std::vector<uint32_t> duplicateOf;
+        // Old numbers in the order of their new numbers (new number = index + 1)
+        std::vector<uint32_t> order;
+        Renumbering renumbering;
+        // New number -> entry of the final xref stream
+        std::vector<xrefEntry> entries;
+        size_t position = 0;
+};
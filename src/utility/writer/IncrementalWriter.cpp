@@ -0,0 +1,253 @@
+#include "IncrementalWriter.h"
+#include "ObjectSerializer.h"
+#include "../objects/NameObject.h"
+#include "../objects/ArrayObject.h"
+#include "../objects/IntegerObject.h"
+#include "../objects/NullObject.h"
+#include "../objects/StreamObject.h"
+#include "../filters/FlateDecode.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+bool IncrementalWriter::setError(const std::string& msg) {
+    this->errorMessage = msg;
+    return false;
+}
+
+void IncrementalWriter::setObject(size_t number, std::shared_ptr<BaseObject> object, std::optional<uint16_t> generation) {
+    uint16_t resolved = generation.has_value() ? generation.value() : this->getGeneration(number);
+    DirtyObject& dirty = this->objects[number];
+    dirty = DirtyObject();
+    dirty.generation = resolved;
+    dirty.object = std::move(object);
+}
+
+void IncrementalWriter::setStream(size_t number, std::shared_ptr<DictionaryObject> dictionary, std::string data, bool compress, std::optional<uint16_t> generation) {
+    std::string encoded;
+    if (compress && FlateDecode::encode(data, encoded)) {
+        data = std::move(encoded);
+        // The dictionary may belong to an object of the reader, whose data in the file stays as it is
+        std::shared_ptr<DictionaryObject> copy = std::make_shared<DictionaryObject>(0);
+        for (const auto& [key, value]: dictionary->getElements()) copy->addElement(key, value);
+        dictionary = std::move(copy);
+
+        // Decoding runs the filters in order, the deflate written here is undone first
+        std::shared_ptr<BaseObject> filters = this->reader.resolve(dictionary->getElement(NAME_FILTER));
+        std::shared_ptr<NameObject> flate = std::make_shared<NameObject>(0, 0, "FlateDecode");
+        if (!filters) {
+            dictionary->addElement(NAME_FILTER, flate);
+        } else {
+            std::shared_ptr<ArrayObject> chain = std::make_shared<ArrayObject>(0);
+            chain->addObject(flate);
+            std::shared_ptr<ArrayObject> previous = std::dynamic_pointer_cast<ArrayObject>(filters);
+            if (previous) {
+                for (const std::shared_ptr<BaseObject>& filter: previous->getObjects()) chain->addObject(filter);
+            } else {
+                chain->addObject(filters);
+            }
+            dictionary->addElement(NAME_FILTER, chain);
+
+            std::shared_ptr<BaseObject> parameters = this->reader.resolve(dictionary->getElement(NAME_DECODE_PARMS));
+            if (parameters) {
+                std::shared_ptr<ArrayObject> shifted = std::make_shared<ArrayObject>(0);
+                shifted->addObject(std::make_shared<NullObject>(0, 0));
+                std::shared_ptr<ArrayObject> previousParameters = std::dynamic_pointer_cast<ArrayObject>(parameters);
+                if (previousParameters) {
+                    for (const std::shared_ptr<BaseObject>& parameter: previousParameters->getObjects()) shifted->addObject(parameter);
+                } else {
+                    shifted->addObject(parameters);
+                }
+                dictionary->addElement(NAME_DECODE_PARMS, shifted);
+            }
+        }
+    }
+
+    uint16_t resolved = generation.has_value() ? generation.value() : this->getGeneration(number);
+    DirtyObject& dirty = this->objects[number];
+    dirty = DirtyObject();
+    dirty.generation = resolved;
+    dirty.object = std::move(dictionary);
+    dirty.data = std::move(data);
+}
+
+size_t IncrementalWriter::addObject(std::shared_ptr<BaseObject> object) {
+    size_t number = this->getNextNumber();
+    this->setObject(number, std::move(object));
+    return number;
+}
+
+size_t IncrementalWriter::addStream(std::shared_ptr<DictionaryObject> dictionary, std::string data, bool compress) {
+    size_t number = this->getNextNumber();
+    this->setStream(number, std::move(dictionary), std::move(data), compress);
+    return number;
+}
+
+void IncrementalWriter::deleteObject(size_t number) {
+    // Object 0 heads the list of free objects & is never in use
+    if (number == 0) return;
+    std::optional<xrefEntry> entry = this->reader.getXRefIndex().lookup(number);
+    // Objects added by this writer were never in the file, they just go away
+    if (!entry.has_value() || entry->type == 'f') {
+        this->objects.erase(number);
+        return;
+    }
+
+    DirtyObject& dirty = this->objects[number];
+    dirty = DirtyObject();
+    // Compressed objects always have generation 0
+    uint16_t generation = entry->type == 'c' ? 0 : entry->generation;
+    dirty.generation = generation < MAX_GENERATION ? generation + 1 : MAX_GENERATION;
+    dirty.deleted = true;
+}
+
+uint16_t IncrementalWriter::getGeneration(size_t number) {
+    // Set or deleted here before, a deleted number is used again with the generation it was freed with
+    auto dirty = this->objects.find(number);
+    if (dirty != this->objects.end()) return dirty->second.generation;
+    std::optional<xrefEntry> entry = this->reader.getXRefIndex().lookup(number);
+    // Compressed objects always have generation 0
+    if (!entry.has_value() || entry->type == 'c') return 0;
+    return entry->generation;
+}
+
+size_t IncrementalWriter::getNextNumber() {
+    size_t next = std::max<size_t>(this->reader.getXRefIndex().getObjectCount(), 1);
+    std::shared_ptr<DictionaryObject> trailer = this->reader.getTrailer();
+    std::shared_ptr<IntegerObject> size = trailer ? std::dynamic_pointer_cast<IntegerObject>(trailer->getElement(NAME_SIZE)) : nullptr;
+    if (size && size->getValue() > 0) next = std::max(next, static_cast<size_t>(size->getValue()));
+    if (!this->objects.empty()) next = std::max(next, this->objects.rbegin()->first + 1);
+    return next;
+}
+
+bool IncrementalWriter::checkReader() {
+    if (this->reader.isRecovered()) return this->setError("Document has no intact xref to append to");
+    if (this->reader.getXRefOffset() == std::string::npos) return this->setError("Document isn't processed");
+    std::shared_ptr<DictionaryObject> trailer = this->reader.getTrailer();
+    if (!trailer) return this->setError("Document has no trailer");
+    // Objects would have to be encrypted with the document's key
+    if (trailer->getElement(NAME_ENCRYPT)) return this->setError("Encrypted documents can't be written");
+    if (!this->objects.empty() && this->objects.begin()->first == 0) return this->setError("Object 0 can't be written");
+    return true;
+}
+
+std::shared_ptr<DictionaryObject> IncrementalWriter::makeTrailer(size_t size) {
+    std::shared_ptr<DictionaryObject> trailer = std::make_shared<DictionaryObject>(0);
+    trailer->addElement(NAME_SIZE, std::make_shared<IntegerObject>(0, 0, static_cast<int64_t>(size)));
+    trailer->addElement(NAME_PREV, std::make_shared<IntegerObject>(0, 0, static_cast<int64_t>(this->reader.getXRefOffset())));
+    // /Root, /Info, /ID & everything else carries over
+    for (const auto& [key, value]: this->reader.getTrailer()->getElements()) {
+        if (!XRefWriter::isSectionKey(key)) trailer->addElement(key, value);
+    }
+    return trailer;
+}
+
+bool IncrementalWriter::writeObject(std::string& out, size_t number, const DirtyObject& dirty) {
+    if (dirty.data.has_value()) {
+        ObjectSerializer::writeStream(out, number, dirty.generation, std::static_pointer_cast<DictionaryObject>(dirty.object), dirty.data.value());
+        return true;
+    }
+    std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(dirty.object);
+    if (!stream) {
+        ObjectSerializer::writeIndirect(out, number, dirty.generation, dirty.object);
+        return true;
+    }
+    // Stream of the file with a changed dictionary, its data is copied as stored
+    std::string data;
+    if (!this->reader.readStreamData(stream, data)) return this->setError("Can't read the data of object " + std::to_string(number));
+    ObjectSerializer::writeStream(out, number, dirty.generation, stream->getDictionary(), data);
+    return true;
+}
+
+bool IncrementalWriter::writeUpdate(std::ostream& out) {
+    if (!this->checkReader()) return false;
+
+    // Offsets count from the header, the update starts where the file ends
+    size_t base = this->reader.getFileSize() - this->reader.getHeaderOffset();
+    size_t written = 0;
+    std::string chunk = "\n";
+    auto flush = [&out, &chunk, &written]() {
+        out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        written += chunk.size();
+        chunk.clear();
+        return static_cast<bool>(out);
+    };
+
+    // Freed objects are linked into a list starting at object 0 (ISO32000 7.5.4)
+    std::vector<size_t> freed;
+    for (const auto& [number, dirty]: this->objects) {
+        if (dirty.deleted) freed.push_back(number);
+    }
+    std::vector<xrefEntry> entries;
+    entries.reserve(this->objects.size() + 2);
+    if (!freed.empty()) entries.push_back(xrefEntry{freed.front(), MAX_GENERATION, 0, 'f'});
+
+    size_t freedIndex = 0;
+    for (const auto& [number, dirty]: this->objects) {
+        if (dirty.deleted) {
+            freedIndex++;
+            entries.push_back(xrefEntry{freedIndex < freed.size() ? freed[freedIndex] : 0, dirty.generation, number, 'f'});
+            continue;
+        }
+        entries.push_back(xrefEntry{base + written + chunk.size(), dirty.generation, number, 'n'});
+        if (!this->writeObject(chunk, number, dirty)) return false;
+        if (chunk.size() >= FILE_COPY_CHUNK && !flush()) return this->setError("Can't write file");
+    }
+
+    size_t xrefOffset = base + written + chunk.size();
+    if (this->format == XREF_FORMAT_STREAM || (this->format == XREF_FORMAT_AUTO && this->reader.hasXRefStream())) {
+        // The stream takes the next number & lists itself
+        size_t number = this->getNextNumber();
+        entries.push_back(xrefEntry{xrefOffset, 0, number, 'n'});
+        XRefWriter::writeStream(chunk, number, entries, this->makeTrailer(number + 1), xrefOffset);
+    } else {
+        XRefWriter::writeTable(chunk, entries, this->makeTrailer(this->getNextNumber()), xrefOffset);
+    }
+    if (!flush() || !out.flush()) return this->setError("Can't write file");
+    return true;
+}
+
+bool IncrementalWriter::appendToFile() {
+    std::string path = this->reader.getFilePath().ToStdString();
+    std::error_code error;
+    uintmax_t originalSize = std::filesystem::file_size(path, error);
+    if (error) return this->setError("Can't open file for writing");
+    // The offsets of the update count from the end of the file the reader read
+    if (originalSize != this->reader.getFileSize()) return this->setError("File changed since it was read");
+
+    bool ok;
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        if (!out) return this->setError("Can't open file for writing");
+        ok = this->writeUpdate(out);
+    }
+    // Chunks flushed before a failure aren't described by any xref section, cut them off again
+    if (!ok) std::filesystem::resize_file(path, originalSize, error);
+    return ok;
+}
+
+bool IncrementalWriter::save(const wxString& path) {
+    std::string target = path.ToStdString();
+    std::error_code error;
+    if (std::filesystem::equivalent(target, this->reader.getFilePath().ToStdString(), error)) {
+        return this->setError("Can't save over the open file, append the update instead");
+    }
+
+    std::string temporary = target + ".tmp";
+    bool ok;
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) return this->setError("Can't open file for writing");
+        ok = this->reader.copyFile(out) || this->setError("Can't copy file");
+        ok = ok && this->writeUpdate(out);
+    }
+    if (ok) {
+        std::filesystem::rename(temporary, target, error);
+        if (error) ok = this->setError("Can't write file");
+    }
+    if (!ok) std::remove(temporary.c_str());
+    return ok;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "XRefWriter.h"
+#include "../PdfReader.h"
+#include "../objects/BaseObject.h"
+#include "../objects/DictionaryObject.h"
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <wx/string.h>
+
+/* Saves changes to a document as an incremental update (ISO32000 7.5.6): only the objects
+    set, added or deleted here are written, followed by a new xref section whose trailer
+    links back to the newest one of the file through /Prev. The original bytes are never
+    rewritten, so saving costs the size of the change, not of the document.
+
+    The reader has to be processed & outlive the writer. It keeps describing the file as it
+    was, so the next update needs a reader of the saved file */
+class IncrementalWriter {
+    public:
+        explicit IncrementalWriter(PdfReader& reader) : reader(reader) {};
+
+        /* Replace an object or add one under a free number. A stream object of the reader keeps
+            its data from the file, only its dictionary is written again. Without a generation
+            the number's current one is used, see getGeneration() */
+        void setObject(size_t number, std::shared_ptr<BaseObject> object, std::optional<uint16_t> generation = std::nullopt);
+        /* Stream with new data, encoded as the /Filter of the dictionary says. With compress the data is
+            deflated here & /FlateDecode is put in front of the filters in a copy of the dictionary */
+        void setStream(size_t number, std::shared_ptr<DictionaryObject> dictionary, std::string data, bool compress = false, std::optional<uint16_t> generation = std::nullopt);
+        // Same under the next unused object number, which is returned
+        size_t addObject(std::shared_ptr<BaseObject> object);
+        size_t addStream(std::shared_ptr<DictionaryObject> dictionary, std::string data, bool compress = false);
+        // Free an object, its number may be used again with the next generation
+        void deleteObject(size_t number);
+        // Forget the change of an object
+        void revert(size_t number) { objects.erase(number); }
+
+        size_t getDirtyCount() { return objects.size(); }
+        bool isDirty(size_t number) { return objects.count(number) > 0; }
+        /* Generation an object under this number is written with: the one in use, the one a free
+            entry holds for the next use (ISO32000 7.5.4) or the one a deletion here gave it */
+        uint16_t getGeneration(size_t number);
+        // Next number addObject() would use
+        size_t getNextNumber();
+        void setXRefFormat(XRefFormat format) { this->format = format; }
+
+        /* Only the update, meant to be appended to the file as it is: a newline (the file may end
+            without one), the objects, the xref section & the trailer */
+        bool writeUpdate(std::ostream& out);
+        // Append the update to the reader's file, on failure the file is cut back to its original size
+        bool appendToFile();
+        // Copy of the file in chunks followed by the update, written to a temporary file & renamed
+        bool save(const wxString& path);
+
+        std::string getErrorMessage() { return errorMessage; }
+
+    private:
+        struct DirtyObject {
+            uint16_t generation = 0;
+            std::shared_ptr<BaseObject> object;
+            // New data of a stream, none for streams copied from the file & other objects
+            std::optional<std::string> data;
+            bool deleted = false;
+        };
+
+        bool checkReader();
+        std::shared_ptr<DictionaryObject> makeTrailer(size_t size);
+        bool writeObject(std::string& out, size_t number, const DirtyObject& dirty);
+        bool setError(const std::string& msg);
+
+        PdfReader& reader;
+        // Ordered by number, so the xref section follows directly
+        std::map<size_t, DirtyObject> objects;
+        XRefFormat format = XREF_FORMAT_AUTO;
+        std::string errorMessage;
+};
@@ -0,0 +1,278 @@
+#include "ObjectSerializer.h"
+#include "../objects/NameObject.h"
+#include "../objects/ArrayObject.h"
+#include "../objects/IntegerObject.h"
+#include "../objects/RealObject.h"
+#include "../objects/ReferenceObject.h"
+#include "../objects/StringObject.h"
+#include "../objects/BooleanObject.h"
+
+#include <cmath>
+#include <cstdio>
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+// Characters that end a name or start another token (ISO32000 7.2.3)
+static bool isDelimiter(unsigned char c) {
+    switch (c) {
+        case '(': case ')': case '<': case '>': case '[': case ']': case '{': case '}': case '/': case '%':
+            return true;
+        default:
+            return false;
+    }
+}
+
+void ObjectSerializer::write(std::string& out, const std::shared_ptr<BaseObject>& object) {
+    if (!object) {
+        out += "null";
+        return;
+    }
+    switch (object->getType()) {
+        case OBJT_BOOLEAN:
+            out += std::static_pointer_cast<BooleanObject>(object)->getValue() ? "true" : "false";
+            break;
+        case OBJT_INTEGER:
+            writeInteger(out, std::static_pointer_cast<IntegerObject>(object)->getValue());
+            break;
+        case OBJT_REAL:
+            writeReal(out, std::static_pointer_cast<RealObject>(object)->getValue());
+            break;
+        case OBJT_STRING_LITERAL:
+        case OBJT_STRING_HEXADECIMAL:
+            writeString(out, std::static_pointer_cast<StringObject>(object)->getValue(), object->getType() == OBJT_STRING_HEXADECIMAL);
+            break;
+        case OBJT_NAME:
+            writeName(out, std::static_pointer_cast<NameObject>(object)->getValue());
+            break;
+        case OBJT_ARRAY: {
+            out += '[';
+            bool first = true;
+            for (const std::shared_ptr<BaseObject>& element: std::static_pointer_cast<ArrayObject>(object)->getObjects()) {
+                if (!first) out += ' ';
+                write(out, element);
+                first = false;
+            }
+            out += ']';
+            break;
+        }
+        case OBJT_DICTIONARY:
+            writeDictionary(out, *std::static_pointer_cast<DictionaryObject>(object));
+            break;
+        case OBJT_INDIRECT: {
+            std::shared_ptr<ReferenceObject> reference = std::static_pointer_cast<ReferenceObject>(object);
+            writeReference(out, reference->getNumber(), reference->getGeneration());
+            break;
+        }
+        default:
+            out += "null";
+            break;
+    }
+}
+
+void ObjectSerializer::writeDictionary(std::string& out, const DictionaryObject& dictionary, std::optional<size_t> length) {
+    NameManager& names = NameManager::global();
+    out += "<<";
+    for (const auto& [key, value]: dictionary.getElements()) {
+        // The length of a written stream replaces whatever the dictionary said
+        if (length.has_value() && key == NAME_LENGTH) continue;
+        out += ' ';
+        writeName(out, names.get(key).value);
+        out += ' ';
+        write(out, value);
+    }
+    if (length.has_value()) {
+        out += " /Length ";
+        out += std::to_string(length.value());
+    }
+    out += " >>";
+}
+
+void ObjectSerializer::write(std::string& out, const Value& value, const Renumbering* renumbering) {
+    switch (value.getType()) {
+        case OBJT_BOOLEAN:
+            out += value.getBoolean() ? "true" : "false";
+            break;
+        case OBJT_INTEGER:
+            writeInteger(out, value.getInteger());
+            break;
+        case OBJT_REAL:
+            writeReal(out, value.getReal());
+            break;
+        // Raw bytes between the delimiters, escapes are still in there
+        case OBJT_STRING_LITERAL:
+            out += '(';
+            out += value.getString();
+            out += ')';
+            break;
+        case OBJT_STRING_HEXADECIMAL:
+            out += '<';
+            out += value.getString();
+            out += '>';
+            break;
+        case OBJT_NAME:
+            writeName(out, value.getString());
+            break;
+        case OBJT_ARRAY:
+            out += '[';
+            for (size_t i = 0; i < value.size(); i++) {
+                if (i > 0) out += ' ';
+                write(out, value.getItems()[i], renumbering);
+            }
+            out += ']';
+            break;
+        case OBJT_DICTIONARY:
+            writeDictionary(out, value, renumbering);
+            break;
+        case OBJT_INDIRECT: {
+            if (!renumbering) {
+                writeReference(out, value.getNumber(), value.getGeneration());
+                break;
+            }
+            uint32_t number = value.getNumber() < renumbering->size() ? (*renumbering)[value.getNumber()] : 0;
+            // Renumbered objects all have generation 0
+            if (number != 0) {
+                writeReference(out, number, 0);
+            } else {
+                out += "null";
+            }
+            break;
+        }
+        default:
+            out += "null";
+            break;
+    }
+}
+
+void ObjectSerializer::writeDictionary(std::string& out, const Value& dictionary, const Renumbering* renumbering, std::optional<size_t> length, bool flate) {
+    out += "<<";
+    for (size_t i = 0; i < dictionary.size(); i++) {
+        const DictEntry& entry = dictionary.getEntries()[i];
+        if (length.has_value() && entry.key == NAME_LENGTH) continue;
+        if (flate && (entry.key == NAME_FILTER || entry.key == NAME_DECODE_PARMS)) continue;
+        out += ' ';
+        writeName(out, NameManager::global().get(entry.key).value);
+        out += ' ';
+        write(out, entry.value, renumbering);
+    }
+    if (flate) out += " /Filter /FlateDecode";
+    if (length.has_value()) {
+        out += " /Length ";
+        out += std::to_string(length.value());
+    }
+    out += " >>";
+}
+
+void ObjectSerializer::writeReference(std::string& out, size_t number, uint16_t generation) {
+    out += std::to_string(number);
+    out += ' ';
+    out += std::to_string(generation);
+    out += " R";
+}
+
+void ObjectSerializer::writeIndirect(std::string& out, size_t number, uint16_t generation, const std::shared_ptr<BaseObject>& object) {
+    out += std::to_string(number);
+    out += ' ';
+    out += std::to_string(generation);
+    out += " obj\n";
+    write(out, object);
+    out += "\nendobj\n";
+}
+
+void ObjectSerializer::writeStream(std::string& out, size_t number, uint16_t generation, const std::shared_ptr<DictionaryObject>& dictionary, std::string_view data) {
+    out += std::to_string(number);
+    out += ' ';
+    out += std::to_string(generation);
+    out += " obj\n";
+    writeDictionary(out, *dictionary, data.size());
+    out += "\nstream\n";
+    out.append(data.data(), data.size());
+    out += "\nendstream\nendobj\n";
+}
+
+void ObjectSerializer::writeStream(std::string& out, size_t number, uint16_t generation, const Value& stream, std::string_view data,
+    const Renumbering* renumbering, bool flate) {
+    out += std::to_string(number);
+    out += ' ';
+    out += std::to_string(generation);
+    out += " obj\n";
+    writeDictionary(out, stream.getStream()->dictionary, renumbering, data.size(), flate);
+    out += "\nstream\n";
+    out.append(data.data(), data.size());
+    out += "\nendstream\nendobj\n";
+}
+
+void ObjectSerializer::writeName(std::string& out, std::string_view name) {
+    out += '/';
+    for (char c: name) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        // Regular characters are written as they are, everything else as #XX (ISO32000 7.3.5)
+        if (byte > 0x20 && byte < 0x7F && byte != '#' && !isDelimiter(byte)) {
+            out += c;
+        } else {
+            out += '#';
+            out += HEX_DIGITS[byte >> 4];
+            out += HEX_DIGITS[byte & 0x0F];
+        }
+    }
+}
+
+void ObjectSerializer::writeString(std::string& out, std::string_view value, bool hexadecimal) {
+    if (hexadecimal) {
+        out += '<';
+        for (char c: value) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            out += HEX_DIGITS[byte >> 4];
+            out += HEX_DIGITS[byte & 0x0F];
+        }
+        out += '>';
+        return;
+    }
+
+    // Parentheses are always escaped, so they never have to balance
+    out += '(';
+    for (char c: value) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        switch (c) {
+            case '(': out += "\\("; break;
+            case ')': out += "\\)"; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if (byte < 0x20 || byte >= 0x7F) {
+                    char escape[5];
+                    std::snprintf(escape, sizeof(escape), "\\%03o", byte);
+                    out += escape;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += ')';
+}
+
+void ObjectSerializer::writeReal(std::string& out, double value) {
+    if (!std::isfinite(value)) value = 0;
+    // Enough for every double in fixed notation with 6 decimals
+    char text[512];
+    int length = std::snprintf(text, sizeof(text), "%.6f", value);
+    if (length <= 0 || static_cast<size_t>(length) >= sizeof(text)) {
+        out += '0';
+        return;
+    }
+    while (length > 1 && text[length - 1] == '0') length--;
+    if (text[length - 1] == '.') length--;
+    // Values rounding to zero keep no sign
+    if (length == 2 && text[0] == '-' && text[1] == '0') {
+        out += '0';
+        return;
+    }
+    out.append(text, static_cast<size_t>(length));
+}
+
+void ObjectSerializer::writeInteger(std::string& out, int64_t value) {
+    out += std::to_string(value);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../objects/BaseObject.h"
+#include "../objects/DictionaryObject.h"
+#include "../objects/Value.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/* Old object number -> new one when a whole document is written with renumbered objects,
+    0 for objects that are gone (references to them become null) */
+using Renumbering = std::vector<uint32_t>;
+
+/* Writes the object model back as PDF syntax, appending to a string so one buffer can be
+    reused for many objects. Names & strings are escaped so the parser reads back the same
+    bytes, reals never use exponents (ISO32000 7.3.3) */
+class ObjectSerializer {
+    public:
+        // Direct value, a stream in there (not allowed by the syntax) is written as null
+        static void write(std::string& out, const std::shared_ptr<BaseObject>& object);
+        // "N G obj ... endobj", streams need writeStream()
+        static void writeIndirect(std::string& out, size_t number, uint16_t generation, const std::shared_ptr<BaseObject>& object);
+        // Stream object with its encoded data, /Length is set to the size of the data
+        static void writeStream(std::string& out, size_t number, uint16_t generation, const std::shared_ptr<DictionaryObject>& dictionary, std::string_view data);
+
+        /* Same for the arena model. Strings are kept as the raw bytes they were parsed from, references
+            are renumbered if a renumbering is given */
+        static void write(std::string& out, const Value& value, const Renumbering* renumbering = nullptr);
+        // Stream of the arena model, with flate its /Filter is set to /FlateDecode (the data must be deflated)
+        static void writeStream(std::string& out, size_t number, uint16_t generation, const Value& stream, std::string_view data,
+            const Renumbering* renumbering = nullptr, bool flate = false);
+
+        static void writeName(std::string& out, std::string_view name);
+        static void writeString(std::string& out, std::string_view value, bool hexadecimal);
+        static void writeReal(std::string& out, double value);
+        static void writeInteger(std::string& out, int64_t value);
+
+    private:
+        static void writeDictionary(std::string& out, const DictionaryObject& dictionary, std::optional<size_t> length = std::nullopt);
+        static void writeDictionary(std::string& out, const Value& dictionary, const Renumbering* renumbering, std::optional<size_t> length = std::nullopt, bool flate = false);
+        static void writeReference(std::string& out, size_t number, uint16_t generation);
+};
@@ -0,0 +1,106 @@
+#include "XRefWriter.h"
+#include "ObjectSerializer.h"
+#include "../objects/NameObject.h"
+#include "../objects/ArrayObject.h"
+#include "../objects/IntegerObject.h"
+#include "../filters/FlateDecode.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static const NameAtom SECTION_KEYS[] = {NAME_SIZE, NAME_PREV, NAME_XREFSTM, NAME_TYPE, NAME_W, NAME_INDEX, NAME_FILTER, NAME_DECODE_PARMS, NAME_LENGTH};
+
+// Bytes needed for a big endian field holding the value, at least one
+static size_t fieldWidth(uint64_t value) {
+    size_t width = 1;
+    while (width < 8 && (value >> (8 * width)) != 0) width++;
+    return width;
+}
+
+static void appendField(std::string& rows, uint64_t value, size_t width) {
+    for (size_t i = width; i > 0; i--) rows += static_cast<char>((value >> (8 * (i - 1))) & 0xFF);
+}
+
+bool XRefWriter::isSectionKey(NameAtom key) {
+    return std::find(std::begin(SECTION_KEYS), std::end(SECTION_KEYS), key) != std::end(SECTION_KEYS);
+}
+
+std::vector<std::pair<size_t, size_t>> XRefWriter::findRanges(const std::vector<xrefEntry>& entries) {
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (const xrefEntry& entry: entries) {
+        if (!ranges.empty() && ranges.back().first + ranges.back().second == entry.number) {
+            ranges.back().second++;
+        } else {
+            ranges.emplace_back(entry.number, 1);
+        }
+    }
+    return ranges;
+}
+
+void XRefWriter::writeTable(std::string& out, const std::vector<xrefEntry>& entries, const std::shared_ptr<DictionaryObject>& trailer, size_t offset) {
+    out += "xref\n";
+    size_t next = 0;
+    char record[32];
+    for (const auto& [first, count]: findRanges(entries)) {
+        out += std::to_string(first) + ' ' + std::to_string(count) + '\n';
+        for (size_t i = 0; i < count; i++, next++) {
+            const xrefEntry& entry = entries[next];
+            // Compressed entries only exist in xref streams, the table can't describe them
+            std::snprintf(record, sizeof(record), "%010zu %05u %c \n", entry.entryOne, static_cast<unsigned>(entry.generation), entry.type == 'n' ? 'n' : 'f');
+            out += record;
+        }
+    }
+    out += "trailer\n";
+    ObjectSerializer::write(out, trailer);
+    out += "\nstartxref\n" + std::to_string(offset) + "\n%%EOF\n";
+}
+
+void XRefWriter::encodeRows(const std::vector<xrefEntry>& entries, std::string& rows, size_t widths[3], std::vector<std::pair<size_t, size_t>>& ranges) {
+    uint64_t largestOne = 0;
+    uint64_t largestTwo = 0;
+    for (const xrefEntry& entry: entries) {
+        largestOne = std::max<uint64_t>(largestOne, entry.entryOne);
+        largestTwo = std::max<uint64_t>(largestTwo, entry.type == 'c' ? entry.streamIndex : entry.generation);
+    }
+    widths[0] = 1;
+    widths[1] = fieldWidth(largestOne);
+    widths[2] = fieldWidth(largestTwo);
+
+    rows.clear();
+    rows.reserve(entries.size() * (widths[0] + widths[1] + widths[2]));
+    for (const xrefEntry& entry: entries) {
+        appendField(rows, entry.type == 'n' ? 1 : entry.type == 'c' ? 2 : 0, widths[0]);
+        appendField(rows, entry.entryOne, widths[1]);
+        appendField(rows, entry.type == 'c' ? entry.streamIndex : entry.generation, widths[2]);
+    }
+    ranges = findRanges(entries);
+}
+
+void XRefWriter::writeStream(std::string& out, size_t number, const std::vector<xrefEntry>& entries, const std::shared_ptr<DictionaryObject>& trailer, size_t offset) {
+    std::string rows;
+    size_t widths[3];
+    std::vector<std::pair<size_t, size_t>> ranges;
+    encodeRows(entries, rows, widths, ranges);
+
+    std::shared_ptr<DictionaryObject> dictionary = std::make_shared<DictionaryObject>(0);
+    dictionary->addElement(NAME_TYPE, std::make_shared<NameObject>(0, 0, "XRef"));
+    for (const auto& [key, value]: trailer->getElements()) dictionary->addElement(key, value);
+    std::shared_ptr<ArrayObject> w = std::make_shared<ArrayObject>(0);
+    for (size_t width: widths) w->addObject(std::make_shared<IntegerObject>(0, 0, static_cast<int64_t>(width)));
+    dictionary->addElement(NAME_W, w);
+    std::shared_ptr<ArrayObject> index = std::make_shared<ArrayObject>(0);
+    for (const auto& [first, count]: ranges) {
+        index->addObject(std::make_shared<IntegerObject>(0, 0, static_cast<int64_t>(first)));
+        index->addObject(std::make_shared<IntegerObject>(0, 0, static_cast<int64_t>(count)));
+    }
+    dictionary->addElement(NAME_INDEX, index);
+
+    std::string data;
+    if (FlateDecode::encode(rows, data)) {
+        dictionary->addElement(NAME_FILTER, std::make_shared<NameObject>(0, 0, "FlateDecode"));
+    } else {
+        data = std::move(rows);
+    }
+    ObjectSerializer::writeStream(out, number, 0, dictionary, data);
+    out += "startxref\n" + std::to_string(offset) + "\n%%EOF\n";
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../xref/XRefEntry.h"
+#include "../objects/DictionaryObject.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Generation of a free entry whose number must not be used again (ISO32000 7.5.4)
+constexpr uint16_t MAX_GENERATION = 65535;
+
+enum XRefFormat {
+    // Same kind as the newest section of the document
+    XREF_FORMAT_AUTO,
+    XREF_FORMAT_TABLE,
+    XREF_FORMAT_STREAM
+};
+
+/* Writes xref sections for entries sorted by object number, consecutive numbers share a
+    subsection. Offsets are relative to the header like the ones the reader parses */
+class XRefWriter {
+    public:
+        // "xref", the 20 byte entries & the trailer dictionary up to %%EOF
+        static void writeTable(std::string& out, const std::vector<xrefEntry>& entries, const std::shared_ptr<DictionaryObject>& trailer, size_t offset);
+        /* Cross-reference stream object (ISO32000 7.5.8) holding the trailer keys, its own entry has to be
+            one of the entries. Rows use the smallest /W that fits & are deflated, then startxref & %%EOF */
+        static void writeStream(std::string& out, size_t number, const std::vector<xrefEntry>& entries, const std::shared_ptr<DictionaryObject>& trailer, size_t offset);
+
+        // Rows of a cross-reference stream without compression, widths & /Index ranges are set
+        static void encodeRows(const std::vector<xrefEntry>& entries, std::string& rows, size_t widths[3], std::vector<std::pair<size_t, size_t>>& ranges);
+        // Trailer keys describing the section they belong to (/Size, /Prev, the xref stream's own keys), a new section sets its own
+        static bool isSectionKey(NameAtom key);
+        // Ranges of consecutive object numbers as (first, count)
+        static std::vector<std::pair<size_t, size_t>> findRanges(const std::vector<xrefEntry>& entries);
+};
@@ -0,0 +1,336 @@
+#include "ParseIndexFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+// "WPDX" in the first bytes of the file
+static constexpr uint32_t PARSE_INDEX_MAGIC = 0x58445057;
+static constexpr uint32_t PARSE_INDEX_VERSION = 1;
+// Reads as another value on a host with the other byte order
+static constexpr uint32_t PARSE_INDEX_BYTE_ORDER = 0x01020304;
+static constexpr uint32_t FLAG_BINARY = 1;
+
+struct IndexFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t flags;
+    // Key of the PDF the index belongs to, its path follows the header
+    uint64_t fileSize;
+    int64_t modified;
+    uint64_t contentHash;
+    uint64_t pathLength;
+
+    uint64_t startOffset;
+    uint64_t tailEOF;
+    uint64_t tailStartXRef;
+    uint64_t tailXRefOffset;
+    uint64_t tailTrailer;
+    char pdfVersion[8];
+
+    // Element counts of the arrays following in this order
+    uint64_t revisionCount;
+    uint64_t subsectionCount;
+    uint64_t entryCount;
+    uint64_t denseCount;
+    uint64_t sparseCount;
+    uint64_t objectCount;
+};
+
+struct IndexRevisionRecord {
+    uint64_t offset;
+    uint64_t trailer;
+};
+
+struct IndexSubsectionRecord {
+    uint64_t startObject;
+    uint64_t amountObjects;
+    uint64_t entries;
+};
+
+struct IndexSparseRecord {
+    uint64_t number;
+    uint32_t newest;
+    uint32_t oldest;
+};
+
+static_assert(std::is_trivially_copyable<IndexFileHeader>::value && sizeof(IndexFileHeader) % 8 == 0, "index header is copied as bytes");
+
+// FNV-1a over 8 byte words, the tail of the data byte by byte
+static uint64_t hashBytes(std::string_view data, uint64_t hash = 14695981039346656037ULL) {
+    constexpr uint64_t prime = 1099511628211ULL;
+    size_t i = 0;
+    for (; i + 8 <= data.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data.data() + i, 8);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    for (; i < data.size(); i++) hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    return hash;
+}
+
+// Reads arrays from the mapped index, every array starts 8 byte aligned
+class IndexCursor {
+    public:
+        explicit IndexCursor(std::string_view data) : data(data) {};
+
+        template <typename T>
+        bool take(T* output, size_t count) {
+            if (count > (this->data.size() - this->position) / sizeof(T)) return false;
+            size_t bytes = count * sizeof(T);
+            if (bytes > 0) std::memcpy(output, this->data.data() + this->position, bytes);
+            this->position = std::min(this->data.size(), this->position + ((bytes + 7) & ~size_t(7)));
+            return true;
+        }
+        // Arrays start 8 byte aligned in a page aligned mapping, they are copied as they are
+        template <typename T>
+        bool take(std::vector<T>& output, size_t count) {
+            if (count > (this->data.size() - this->position) / sizeof(T)) return false;
+            const T* first = reinterpret_cast<const T*>(this->data.data() + this->position);
+            output.assign(first, first + count);
+            this->position = std::min(this->data.size(), this->position + ((count * sizeof(T) + 7) & ~size_t(7)));
+            return true;
+        }
+        bool atEnd() const { return this->position == this->data.size(); }
+
+    private:
+        std::string_view data;
+        size_t position = 0;
+};
+
+std::string ParseIndexFile::pathFor(const std::string& directory, const wxString& pdfPath) {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(pdfPath.ToStdString(), error);
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hashBytes(error ? pdfPath.ToStdString() : absolute.string())));
+    return (std::filesystem::path(directory) / (std::string(name) + PARSE_INDEX_EXTENSION)).string();
+}
+
+bool ParseIndexFile::makeKey(const wxString& pdfPath, Buffer& pdf, uint64_t& size, int64_t& modified, uint64_t& hash) {
+    std::error_code error;
+    std::filesystem::file_time_type time = std::filesystem::last_write_time(pdfPath.ToStdString(), error);
+    if (error || !pdf.isReady()) return false;
+    modified = static_cast<int64_t>(time.time_since_epoch().count());
+    size = pdf.getSize();
+
+    // Views of windowed buffers only last until the next access, each one is hashed right away
+    hash = hashBytes(std::string_view(reinterpret_cast<const char*>(&size), sizeof(size)));
+    hash = hashBytes(pdf.viewSpan(0, PARSE_INDEX_HASH_SPAN), hash);
+    size_t tailStart = size > PARSE_INDEX_HASH_SPAN ? size - PARSE_INDEX_HASH_SPAN : 0;
+    hash = hashBytes(pdf.viewSpan(tailStart, size - tailStart), hash);
+    return true;
+}
+
+bool ParseIndexFile::write(const std::string& indexPath, const wxString& pdfPath, Buffer& pdf, const ParseIndexState& state, const XRefIndex& index) {
+    size_t entryCount = index.types.size();
+    if (entryCount >= XRefIndex::NO_ENTRY || state.revisions.size() != index.revisionCount) return false;
+
+    std::vector<IndexSubsectionRecord> subsections;
+    size_t tableEntries = 0;
+    for (const ParseIndexSubsection& section: state.table) {
+        subsections.push_back(IndexSubsectionRecord{section.startObject, section.amountObjects, section.entries});
+        tableEntries += section.entries;
+    }
+    if (tableEntries > entryCount) return false;
+
+    IndexFileHeader header = {};
+    header.magic = PARSE_INDEX_MAGIC;
+    header.version = PARSE_INDEX_VERSION;
+    header.byteOrder = PARSE_INDEX_BYTE_ORDER;
+    header.flags = state.binary ? FLAG_BINARY : 0;
+    if (!makeKey(pdfPath, pdf, header.fileSize, header.modified, header.contentHash)) return false;
+    std::string path = pdfPath.ToStdString();
+    header.pathLength = path.size();
+    header.startOffset = state.startOffset;
+    header.tailEOF = state.tail.eof;
+    header.tailStartXRef = state.tail.startXRef;
+    header.tailXRefOffset = state.tail.xrefOffset;
+    header.tailTrailer = state.tail.trailer;
+    std::strncpy(header.pdfVersion, state.pdfVersion.c_str(), sizeof(header.pdfVersion) - 1);
+    header.revisionCount = state.revisions.size();
+    header.subsectionCount = subsections.size();
+    header.entryCount = entryCount;
+    header.denseCount = index.denseNewest.size();
+    header.sparseCount = index.sparse.size();
+    header.objectCount = index.objectCount;
+
+    std::vector<IndexRevisionRecord> revisions;
+    for (const std::pair<size_t, size_t>& revision: state.revisions) revisions.push_back(IndexRevisionRecord{revision.first, revision.second});
+    std::vector<IndexSparseRecord> sparse;
+    sparse.reserve(index.sparse.size());
+    for (const auto& [number, chain]: index.sparse) sparse.push_back(IndexSparseRecord{number, chain.newest, chain.oldest});
+
+    std::error_code directoryError;
+    std::filesystem::path directory = std::filesystem::path(indexPath).parent_path();
+    if (!directory.empty()) std::filesystem::create_directories(directory, directoryError);
+
+    // Unique per thread & moment, concurrent writers of the same index don't share a temporary file
+    std::string temporary = indexPath + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+        static_cast<size_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        auto put = [&out](const void* data, size_t bytes) {
+            static const char padding[8] = {};
+            if (bytes > 0) out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            out.write(padding, static_cast<std::streamsize>((8 - bytes % 8) % 8));
+        };
+        put(&header, sizeof(header));
+        put(path.data(), path.size());
+        put(revisions.data(), revisions.size() * sizeof(IndexRevisionRecord));
+        put(subsections.data(), subsections.size() * sizeof(IndexSubsectionRecord));
+        put(index.offsets.data(), entryCount * sizeof(uint64_t));
+        put(index.generations.data(), entryCount * sizeof(uint32_t));
+        put(index.depths.data(), entryCount * sizeof(uint32_t));
+        put(index.olderEntries.data(), entryCount * sizeof(uint32_t));
+        put(index.types.data(), entryCount);
+        put(index.denseNewest.data(), index.denseNewest.size() * sizeof(uint32_t));
+        put(index.denseOldest.data(), index.denseOldest.size() * sizeof(uint32_t));
+        put(sparse.data(), sparse.size() * sizeof(IndexSparseRecord));
+        out.close();
+        if (!out) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, indexPath, error);
+    if (error) std::remove(temporary.c_str());
+    return !error;
+}
+
+bool ParseIndexFile::read(const std::string& indexPath, const wxString& pdfPath, Buffer& pdf, ParseIndexState& state, XRefIndex& index, std::string& reason) {
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(indexPath, error)) {
+        reason = "no index file";
+        return false;
+    }
+    Buffer file(wxString(indexPath), BUFFER_MAPPED);
+    if (!file.isReady() || !file.isContiguous()) {
+        reason = "can't map index file";
+        return false;
+    }
+    // Every page is copied, read ahead instead of faulting them in one by one
+    file.advise(0, file.getSize(), ADVICE_WILLNEED);
+    IndexCursor cursor(file.viewSpan(0, file.getSize()));
+
+    IndexFileHeader header;
+    if (!cursor.take(&header, 1) || header.magic != PARSE_INDEX_MAGIC || header.byteOrder != PARSE_INDEX_BYTE_ORDER) {
+        reason = "not an index file";
+        return false;
+    }
+    if (header.version != PARSE_INDEX_VERSION) {
+        reason = "index file of another version";
+        return false;
+    }
+
+    uint64_t size, hash;
+    int64_t modified;
+    std::string path(header.pathLength <= file.getSize() ? header.pathLength : 0, '\0');
+    if (!makeKey(pdfPath, pdf, size, modified, hash) || !cursor.take(path.data(), path.size()) || path != pdfPath.ToStdString() ||
+        size != header.fileSize || modified != header.modified || hash != header.contentHash) {
+        reason = "file changed since the index was written";
+        return false;
+    }
+
+    uint64_t entryCount = header.entryCount;
+    std::vector<IndexRevisionRecord> revisions;
+    std::vector<IndexSubsectionRecord> subsections;
+    std::vector<IndexSparseRecord> sparse;
+    XRefIndex restored;
+    bool complete = entryCount < XRefIndex::NO_ENTRY && header.revisionCount > 0 && header.revisionCount < XRefIndex::NO_ENTRY &&
+        cursor.take(revisions, header.revisionCount) && cursor.take(subsections, header.subsectionCount) &&
+        cursor.take(restored.offsets, entryCount) && cursor.take(restored.generations, entryCount) &&
+        cursor.take(restored.depths, entryCount) && cursor.take(restored.olderEntries, entryCount) &&
+        cursor.take(restored.types, entryCount) && cursor.take(restored.denseNewest, header.denseCount) &&
+        cursor.take(restored.denseOldest, header.denseCount) && cursor.take(sparse, header.sparseCount) && cursor.atEnd();
+    if (!complete) {
+        reason = "index file is truncated";
+        return false;
+    }
+
+    // Every position has to stay inside the arrays, lookups don't check them again
+    auto validPosition = [entryCount](uint32_t position) { return position == XRefIndex::NO_ENTRY || position < entryCount; };
+    bool valid = true;
+    for (size_t position = 0; valid && position < entryCount; position++) {
+        char type = restored.types[position];
+        valid = (type == 'n' || type == 'f' || type == 'c') && restored.depths[position] < header.revisionCount &&
+            validPosition(restored.olderEntries[position]);
+    }
+    for (size_t number = 0; valid && number < header.denseCount; number++) {
+        valid = validPosition(restored.denseNewest[number]) && validPosition(restored.denseOldest[number]);
+    }
+    for (const IndexSparseRecord& record: sparse) {
+        valid = valid && record.newest < entryCount && record.oldest < entryCount;
+    }
+    size_t tableEntries = 0;
+    for (const IndexSubsectionRecord& record: subsections) {
+        valid = valid && record.entries <= entryCount - tableEntries;
+        if (valid) tableEntries += record.entries;
+    }
+    if (!valid) {
+        reason = "index file is damaged";
+        return false;
+    }
+
+    restored.sparse.reserve(sparse.size());
+    for (const IndexSparseRecord& record: sparse) restored.sparse.emplace(record.number, XRefIndex::SparseChain{record.newest, record.oldest});
+    restored.revisionCount = header.revisionCount;
+    restored.objectCount = header.objectCount;
+
+    state = ParseIndexState();
+    state.pdfVersion = std::string(header.pdfVersion, strnlen(header.pdfVersion, sizeof(header.pdfVersion)));
+    state.binary = header.flags & FLAG_BINARY;
+    state.startOffset = header.startOffset;
+    state.tail.eof = header.tailEOF;
+    state.tail.startXRef = header.tailStartXRef;
+    state.tail.xrefOffset = header.tailXRefOffset;
+    state.tail.trailer = header.tailTrailer;
+    for (const IndexRevisionRecord& record: revisions) state.revisions.push_back({record.offset, record.trailer});
+    for (const IndexSubsectionRecord& record: subsections) state.table.push_back(ParseIndexSubsection{record.startObject, record.amountObjects, record.entries});
+    index = std::move(restored);
+    return true;
+}
+
+bool ParseIndexFile::describeTable(const std::vector<xrefSubsection>& table, const XRefIndex& index, std::vector<ParseIndexSubsection>& layout) {
+    layout.clear();
+    size_t tableEntries = 0;
+    for (const xrefSubsection& section: table) {
+        for (size_t i = 0; i < section.objects.size(); i++) {
+            if (section.objects[i].number != section.startObject + i) return false;
+        }
+        layout.push_back(ParseIndexSubsection{section.startObject, section.amountObjects, section.objects.size()});
+        tableEntries += section.objects.size();
+    }
+    // The newest revision was added first, its entries are exactly the ones of depth 0
+    if (tableEntries > index.types.size()) return false;
+    for (size_t position = 0; position < index.types.size(); position++) {
+        if ((index.depths[position] == 0) != (position < tableEntries)) return false;
+    }
+    return true;
+}
+
+std::vector<xrefSubsection> ParseIndexFile::restoreTable(const std::vector<ParseIndexSubsection>& layout, const XRefIndex& index) {
+    std::vector<xrefSubsection> table;
+    uint32_t position = 0;
+    for (const ParseIndexSubsection& record: layout) {
+        xrefSubsection section;
+        section.startObject = record.startObject;
+        section.amountObjects = record.amountObjects;
+        section.initDone = true;
+        section.objects.reserve(record.entries);
+        for (size_t i = 0; i < record.entries && position < index.types.size(); i++) section.objects.push_back(index.makeEntry(record.startObject + i, position++));
+        table.push_back(std::move(section));
+    }
+    return table;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "XRefEntry.h"
+#include "XRefIndex.h"
+#include "TailLocator.h"
+#include "../Buffer.h"
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <wx/string.h>
+
+// Bytes at the start & end of a PDF hashed into the key of its index file
+constexpr size_t PARSE_INDEX_HASH_SPAN = 64 * 1024;
+constexpr const char* PARSE_INDEX_EXTENSION = ".wpidx";
+
+// Subsection of the newest xref table, its entries are the next ones of the index in order
+struct ParseIndexSubsection {
+    size_t startObject;
+    size_t amountObjects;
+    size_t entries;
+};
+
+// Results of PdfReader::process() stored in an index file, besides the merged xref index
+struct ParseIndexState {
+    std::string pdfVersion;
+    bool binary = false;
+    // Bytes in front of %PDF-
+    size_t startOffset = 0;
+    TailLocation tail;
+    // Offset of every xref section & the position of its trailer dictionary, newest first
+    std::vector<std::pair<size_t, size_t>> revisions;
+    // Table of the newest section, its entries are the first ones of the index
+    std::vector<ParseIndexSubsection> table;
+};
+
+/* Sidecar file with the parsed xref state of a PDF, so opening an unchanged file again
+    skips header, tail & xref parsing. Keyed by the path of the PDF, checked against its
+    size, modification time & a hash of its first & last PARSE_INDEX_HASH_SPAN bytes (an
+    incremental update changes all of them). The layout is a fixed header followed by the
+    arrays of the index in host byte order, 8 byte aligned, so reading it is one memory
+    map, a structural check & copying the arrays. Files of another version, byte order
+    or with any inconsistency are ignored & rebuilt */
+class ParseIndexFile {
+    public:
+        // Index file of a PDF inside a directory, named after a hash of the absolute path
+        static std::string pathFor(const std::string& directory, const wxString& pdfPath);
+
+        // Written to a temporary file & renamed, readers never see a partial index
+        static bool write(const std::string& indexPath, const wxString& pdfPath, Buffer& pdf, const ParseIndexState& state, const XRefIndex& index);
+        // False with the reason if the index is missing, stale or damaged
+        static bool read(const std::string& indexPath, const wxString& pdfPath, Buffer& pdf, ParseIndexState& state, XRefIndex& index, std::string& reason);
+
+        // Layout of a table whose entries are the first ones of the index, false if they aren't
+        static bool describeTable(const std::vector<xrefSubsection>& table, const XRefIndex& index, std::vector<ParseIndexSubsection>& layout);
+        // Entries of a described table taken from the index
+        static std::vector<xrefSubsection> restoreTable(const std::vector<ParseIndexSubsection>& layout, const XRefIndex& index);
+
+    private:
+        // Size, modification time & content hash of the PDF as it is now
+        static bool makeKey(const wxString& pdfPath, Buffer& pdf, uint64_t& size, int64_t& modified, uint64_t& hash);
+};
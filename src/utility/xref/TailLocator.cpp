@@ -0,0 +1,94 @@
+#include "TailLocator.h"
+#include "../parser/CharClass.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+namespace {
+    // Last occurrence of a byte, glibc's memrchr is vectorized like memchr
+    const char* findLastByte(const char* data, char byte, size_t length) {
+#if defined(__GLIBC__)
+        return static_cast<const char*>(memrchr(data, byte, length));
+#else
+        for (size_t i = length; i > 0; i--) {
+            if (data[i - 1] == byte) return data + i - 1;
+        }
+        return nullptr;
+#endif
+    }
+}
+
+size_t TailLocator::findLast(std::string_view data, std::string_view keyword, bool wholeToken) {
+    if (keyword.empty() || data.size() < keyword.size()) return std::string::npos;
+
+    // Candidates are found by the keyword's first byte, searching backwards from the latest possible start
+    size_t searchEnd = data.size() - keyword.size() + 1;
+    while (searchEnd > 0) {
+        const char* found = findLastByte(data.data(), keyword[0], searchEnd);
+        if (!found) return std::string::npos;
+        size_t start = found - data.data();
+        if (std::memcmp(found, keyword.data(), keyword.size()) == 0) {
+            size_t end = start + keyword.size();
+            bool alone = (start == 0 || !isPdfRegular(data[start - 1])) && (end == data.size() || !isPdfRegular(data[end]));
+            if (!wholeToken || alone) return start;
+        }
+        searchEnd = start;
+    }
+    return std::string::npos;
+}
+
+size_t TailLocator::findHeader(Buffer& buffer) {
+    // Header may start at the last byte of the window, so the view covers the rest of it
+    std::string_view head = buffer.viewSpan(0, HEADER_SEARCH_WINDOW + 4);
+    size_t header = head.find("%PDF-");
+    return header < HEADER_SEARCH_WINDOW ? header : std::string::npos;
+}
+
+std::string_view TailLocator::viewBefore(Buffer& buffer, size_t before, size_t& start) {
+    before = std::min(before, buffer.getSize());
+    start = before > this->window ? before - this->window : 0;
+    return buffer.viewSpan(start, before - start);
+}
+
+size_t TailLocator::findEOF(Buffer& buffer) {
+    size_t start;
+    size_t eof = findLast(this->viewBefore(buffer, buffer.getSize(), start), "%%EOF", false);
+    return eof == std::string::npos ? eof : start + eof;
+}
+
+bool TailLocator::findStartXRef(Buffer& buffer, size_t before, TailLocation& location) {
+    size_t start;
+    std::string_view tail = this->viewBefore(buffer, before, start);
+    size_t keyword = findLast(tail, "startxref", true);
+    if (keyword == std::string::npos) return false;
+    location.startXRef = start + keyword;
+
+    // Offset follows after any whitespace & EOL, at most 20 digits fit into 64 bits
+    size_t digits = keyword + 9;
+    while (digits < tail.size() && isPdfWhitespace(tail[digits])) digits++;
+    size_t value = 0, length = 0;
+    while (digits + length < tail.size() && isPdfDigit(tail[digits + length]) && length < 20) {
+        size_t digit = static_cast<size_t>(tail[digits + length] - '0');
+        if (value > (SIZE_MAX - digit) / 10) return true;
+        value = value * 10 + digit;
+        length++;
+    }
+    if (length > 0 && (digits + length == tail.size() || !isPdfDigit(tail[digits + length]))) location.xrefOffset = value;
+    return true;
+}
+
+size_t TailLocator::findTrailer(Buffer& buffer, size_t before) {
+    size_t start;
+    size_t trailer = findLast(this->viewBefore(buffer, before, start), "trailer", true);
+    return trailer == std::string::npos ? trailer : start + trailer;
+}
+
+TailLocation TailLocator::locate(Buffer& buffer) {
+    TailLocation location;
+    location.eof = this->findEOF(buffer);
+    if (this->findStartXRef(buffer, buffer.getSize(), location)) {
+        location.trailer = this->findTrailer(buffer, location.startXRef);
+    }
+    return location;
+}
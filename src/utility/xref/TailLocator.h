@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../Buffer.h"
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Bytes at the end of the file searched for %%EOF, startxref & trailer (ISO32000 7.5.5 only needs the last 1024)
+constexpr size_t TAIL_SEARCH_WINDOW = 1024;
+// Leading bytes that may precede %PDF- (ISO32000 7.5.2 note 1)
+constexpr size_t HEADER_SEARCH_WINDOW = 1024;
+
+// Absolute positions in the file, npos for everything not found
+struct TailLocation {
+    // Last %%EOF, anything after it is trailing garbage
+    size_t eof = std::string::npos;
+    // startxref keyword in effect (the last one of the file) & the offset after it
+    size_t startXRef = std::string::npos;
+    size_t xrefOffset = std::string::npos;
+    // Last trailer keyword before startxref, npos for files with cross-reference streams
+    size_t trailer = std::string::npos;
+};
+
+/* Finds the file header & the markers at the end of the file without copying or allocating:
+    reverse searches over views of the buffer, any EOL convention (CR, LF, CRLF) & whitespace
+    between the keywords, files shorter than the search window */
+class TailLocator {
+    public:
+        explicit TailLocator(size_t window = TAIL_SEARCH_WINDOW) : window(window) {};
+
+        // Position of %PDF-, npos if it doesn't start within the first HEADER_SEARCH_WINDOW bytes
+        static size_t findHeader(Buffer& buffer);
+
+        size_t findEOF(Buffer& buffer);
+        // Last startxref before the given position, the offset number after it is set in location
+        bool findStartXRef(Buffer& buffer, size_t before, TailLocation& location);
+        size_t findTrailer(Buffer& buffer, size_t before);
+        // All of the above, whatever isn't found stays npos
+        TailLocation locate(Buffer& buffer);
+
+        /* Start of the last occurrence of keyword in data, npos if there is none. Whole tokens only
+            have whitespace or delimiters (or the end of data) on both sides */
+        static size_t findLast(std::string_view data, std::string_view keyword, bool wholeToken);
+
+    private:
+        // View of the window ending before the given position & its absolute start
+        std::string_view viewBefore(Buffer& buffer, size_t before, size_t& start);
+
+        size_t window;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Highest object number a conforming file may use (ISO32000 Annex C), larger ones are rejected
+constexpr size_t MAX_OBJECT_NUMBER = 8388607;
+
+/* Entry types:
+    'n' in use, entryOne is the byte offset of the object
+    'f' free, entryOne is the next free object number
+    'c' compressed, entryOne is the number of the object stream holding it at streamIndex */
+struct xrefEntry {
+    size_t entryOne;
+    uint16_t generation;
+    size_t number;
+    char type;
+    size_t streamIndex = 0;
+
+    // Equal operator for tests
+    bool operator==(const xrefEntry& other) const {
+        return entryOne == other.entryOne &&
+               generation == other.generation &&
+               number == other.number &&
+               type == other.type &&
+               streamIndex == other.streamIndex;
+    }
+};
+
+struct xrefSubsection {
+    size_t startObject;
+    size_t amountObjects;
+    std::vector<xrefEntry> objects;
+    bool initDone = false;
+
+    // Equal operator for tests
+    bool operator==(const xrefSubsection& other) const {
+        return startObject == other.startObject &&
+               amountObjects == other.amountObjects &&
+               objects == other.objects;
+    }
+};
@@ -0,0 +1,61 @@
+#include "XRefEntryDecoder.h"
+
+#include <cstdint>
+#include <cstring>
+
+// Check & convert 8 ASCII digits at once (SWAR), false if any byte isn't a digit
+static bool parseEightDigits(const char* chars, uint64_t& value) {
+    uint64_t v;
+    std::memcpy(&v, chars, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    // Every byte has to be in 0x30..0x39: high nibble 3 & adding 6 must not carry into it
+    if ((v & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL ||
+        ((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL) {
+        return false;
+    }
+    // First char is in the lowest byte, combine pairs, then quads, then both halves
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+         (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    value = v;
+    return true;
+}
+
+static bool parseDigits(const char* chars, size_t length, uint64_t& value) {
+    value = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned digit = static_cast<unsigned char>(chars[i]) - '0';
+        if (digit > 9) return false;
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+size_t XRefEntryDecoder::decode(std::string_view data, size_t firstNumber, size_t count, std::vector<xrefEntry>& entries) {
+    size_t available = data.size() / XREF_ENTRY_SIZE;
+    if (count > available) count = available;
+
+    const char* record = data.data();
+    for (size_t i = 0; i < count; i++, record += XREF_ENTRY_SIZE) {
+        // Separators, type & one of the three allowed EOL forms
+        char type = record[17];
+        if (record[10] != ' ' || record[16] != ' ' || (type != 'n' && type != 'f')) return i;
+        char eolOne = record[18], eolTwo = record[19];
+        if (!((eolOne == ' ' && (eolTwo == '\r' || eolTwo == '\n')) || (eolOne == '\r' && eolTwo == '\n'))) return i;
+
+        uint64_t high, low, generation;
+        if (!parseEightDigits(record, high) || !parseDigits(record + 8, 2, low)) return i;
+        if (!parseDigits(record + 11, 5, generation) || generation > 65535) return i;
+
+        xrefEntry entry;
+        entry.entryOne = static_cast<size_t>(high * 100 + low);
+        entry.generation = static_cast<uint16_t>(generation);
+        entry.number = firstNumber + i;
+        entry.type = type;
+        entries.push_back(entry);
+    }
+    return count;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "XRefEntry.h"
+
+#include <vector>
+#include <string_view>
+
+// Classic xref entries are fixed records: 10 digit offset, space, 5 digit generation, space, type & a 2 byte EOL
+constexpr size_t XREF_ENTRY_SIZE = 20;
+
+// Allocation free decoder for the fixed-size entries of classic xref tables
+class XRefEntryDecoder {
+    public:
+        /* Decode up to count records from the start of data, appending to entries & numbering them from firstNumber.
+            Stops at the first record that isn't exactly 20 bytes, returns the amount decoded */
+        static size_t decode(std::string_view data, size_t firstNumber, size_t count, std::vector<xrefEntry>& entries);
+};
@@ -0,0 +1,145 @@
+#include "XRefIndex.h"
+
+#include <algorithm>
+#include <utility>
+
+void XRefIndex::clear() {
+    this->offsets.clear();
+    this->generations.clear();
+    this->types.clear();
+    this->depths.clear();
+    this->olderEntries.clear();
+    this->denseNewest.clear();
+    this->denseOldest.clear();
+    this->sparse.clear();
+    this->revisionCount = 0;
+    this->objectCount = 0;
+}
+
+void XRefIndex::addRevision(const std::vector<xrefSubsection>& subsections) {
+    uint32_t depth = static_cast<uint32_t>(this->revisionCount);
+
+    size_t added = 0;
+    for (const xrefSubsection& section: subsections) {
+        added += section.objects.size();
+    }
+    size_t total = this->types.size() + added;
+    this->offsets.reserve(total);
+    this->generations.reserve(total);
+    this->types.reserve(total);
+    this->depths.reserve(total);
+    this->olderEntries.reserve(total);
+    size_t denseLimit = std::max(DENSE_MINIMUM, 2 * total);
+
+    for (const xrefSubsection& section: subsections) {
+        for (const xrefEntry& entry: section.objects) {
+            uint32_t position = static_cast<uint32_t>(this->types.size());
+            this->offsets.push_back(entry.entryOne);
+            this->generations.push_back(entry.type == 'c' ? static_cast<uint32_t>(entry.streamIndex) : entry.generation);
+            this->types.push_back(entry.type);
+            this->depths.push_back(depth);
+            this->olderEntries.push_back(NO_ENTRY);
+            if (entry.number >= this->objectCount) this->objectCount = entry.number + 1;
+
+            // Newer revisions were added before, so this entry goes to the end of the chain
+            auto sparseChain = this->sparse.empty() ? this->sparse.end() : this->sparse.find(entry.number);
+            if (sparseChain != this->sparse.end()) {
+                this->olderEntries[sparseChain->second.oldest] = position;
+                sparseChain->second.oldest = position;
+            } else if (entry.number < denseLimit) {
+                if (entry.number >= this->denseNewest.size()) {
+                    this->denseNewest.resize(entry.number + 1, NO_ENTRY);
+                    this->denseOldest.resize(entry.number + 1, NO_ENTRY);
+                }
+                if (this->denseNewest[entry.number] == NO_ENTRY) {
+                    this->denseNewest[entry.number] = position;
+                } else {
+                    this->olderEntries[this->denseOldest[entry.number]] = position;
+                }
+                this->denseOldest[entry.number] = position;
+            } else {
+                this->sparse.emplace(entry.number, SparseChain{position, position});
+            }
+        }
+    }
+    this->revisionCount++;
+}
+
+std::vector<size_t> XRefIndex::getObjectNumbers() const {
+    std::vector<size_t> numbers;
+    numbers.reserve(this->denseNewest.size() + this->sparse.size());
+    for (size_t number = 0; number < this->denseNewest.size(); number++) {
+        if (this->denseNewest[number] != NO_ENTRY) numbers.push_back(number);
+    }
+    // Sparse numbers of older revisions can lie below the dense array's later size
+    for (const auto& [number, chain]: this->sparse) numbers.push_back(number);
+    if (!this->sparse.empty()) std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+uint32_t XRefIndex::findNewest(size_t number) const {
+    if (number < this->denseNewest.size() && this->denseNewest[number] != NO_ENTRY) {
+        return this->denseNewest[number];
+    }
+    if (this->sparse.empty()) return NO_ENTRY;
+    auto chain = this->sparse.find(number);
+    return chain == this->sparse.end() ? NO_ENTRY : chain->second.newest;
+}
+
+xrefEntry XRefIndex::makeEntry(size_t number, uint32_t position) const {
+    xrefEntry entry;
+    entry.entryOne = static_cast<size_t>(this->offsets[position]);
+    entry.number = number;
+    entry.type = this->types[position];
+    if (entry.type == 'c') {
+        entry.generation = 0;
+        entry.streamIndex = this->generations[position];
+    } else {
+        entry.generation = static_cast<uint16_t>(this->generations[position]);
+    }
+    return entry;
+}
+
+std::optional<xrefEntry> XRefIndex::lookup(size_t number) const {
+    uint32_t position = this->findNewest(number);
+    if (position == NO_ENTRY) return std::nullopt;
+    return this->makeEntry(number, position);
+}
+
+std::optional<xrefEntry> XRefIndex::lookup(size_t number, size_t revision) const {
+    if (revision >= this->revisionCount) return this->lookup(number);
+
+    // Skip entries from revisions newer than the requested one
+    size_t minDepth = this->revisionCount - 1 - revision;
+    uint32_t position = this->findNewest(number);
+    while (position != NO_ENTRY && this->depths[position] < minDepth) {
+        position = this->olderEntries[position];
+    }
+    if (position == NO_ENTRY) return std::nullopt;
+    return this->makeEntry(number, position);
+}
+
+bool XRefIndex::exceedsObjectLimit(const std::vector<xrefSubsection>& subsections, size_t first) {
+    for (size_t i = first; i < subsections.size(); i++) {
+        const xrefSubsection& section = subsections[i];
+        if (section.amountObjects == 0) continue;
+        if (section.startObject > MAX_OBJECT_NUMBER || section.amountObjects - 1 > MAX_OBJECT_NUMBER - section.startObject) return true;
+    }
+    return false;
+}
+
+bool XRefIndex::hasOverlap(const std::vector<xrefSubsection>& subsections, size_t first) {
+    // Sort the [start, start + amount) ranges, only neighbours can overlap then
+    std::vector<std::pair<size_t, size_t>> ranges;
+    ranges.reserve(subsections.size() - std::min(first, subsections.size()));
+    for (size_t i = first; i < subsections.size(); i++) {
+        if (subsections[i].amountObjects > 0) {
+            ranges.push_back({subsections[i].startObject, subsections[i].amountObjects});
+        }
+    }
+    std::sort(ranges.begin(), ranges.end());
+    for (size_t i = 1; i < ranges.size(); i++) {
+        if (ranges[i-1].first + ranges[i-1].second > ranges[i].first) return true;
+    }
+    return false;
+}
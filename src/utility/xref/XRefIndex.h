@@ -0,0 +1,87 @@
+#pragma once
+
+#include "XRefEntry.h"
+
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+/* Merged lookup over all xref revisions of a file. Revisions are added newest first
+    while following the /Prev chain, every object number keeps a chain of its entries
+    from newest to oldest so older revisions can be viewed without rebuilding anything.
+    Revision numbers count from the original file (0) to the newest update.
+
+    Entries are stored as structure of arrays. Object numbers map to their newest entry
+    through a dense array, numbers far beyond the amount of entries go to a sparse map */
+class XRefIndex {
+    public:
+        void clear();
+        // Add the sections of the next older revision
+        void addRevision(const std::vector<xrefSubsection>& subsections);
+
+        size_t getRevisionCount() const { return revisionCount; }
+        size_t getEntryCount() const { return types.size(); }
+        // Highest object number + 1 of all revisions
+        size_t getObjectCount() const { return objectCount; }
+        // Object numbers with an entry in any revision, ascending. Grows with the entries, not with the highest number
+        std::vector<size_t> getObjectNumbers() const;
+        // Numbers below this are looked up through the dense array, the rest through the sparse map
+        size_t getDenseCount() const { return denseNewest.size(); }
+
+        // Entry of an object as seen by the newest revision, nullopt if not in any section
+        std::optional<xrefEntry> lookup(size_t number) const;
+        // Entry of an object as seen by a given revision (0 = original file)
+        std::optional<xrefEntry> lookup(size_t number, size_t revision) const;
+
+        // Check subsections (from index first on) for overlapping object ranges
+        static bool hasOverlap(const std::vector<xrefSubsection>& subsections, size_t first = 0);
+        // Check subsections (from index first on) for object numbers above MAX_OBJECT_NUMBER
+        static bool exceedsObjectLimit(const std::vector<xrefSubsection>& subsections, size_t first = 0);
+
+    private:
+        // Index files store & restore the arrays as they are
+        friend class ParseIndexFile;
+
+        uint32_t findNewest(size_t number) const;
+        xrefEntry makeEntry(size_t number, uint32_t position) const;
+
+        // One slot per entry of every revision
+        std::vector<uint64_t> offsets;
+        // Generation, or the index inside the object stream for compressed entries
+        std::vector<uint32_t> generations;
+        std::vector<char> types;
+        // Position in the /Prev chain the entry came from (0 = newest revision)
+        std::vector<uint32_t> depths;
+        // Next older entry for the same object number
+        std::vector<uint32_t> olderEntries;
+
+        // Object number -> newest & oldest entry of its chain
+        std::vector<uint32_t> denseNewest;
+        std::vector<uint32_t> denseOldest;
+        struct SparseChain {
+            uint32_t newest;
+            uint32_t oldest;
+        };
+        std::unordered_map<size_t, SparseChain> sparse;
+
+        size_t revisionCount = 0;
+        size_t objectCount = 0;
+
+        static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+        // Dense array always covers this many numbers, beyond it only up to twice the entries
+        static constexpr size_t DENSE_MINIMUM = 1 << 16;
+};
+
+// Lookups bound to one revision, cheap to create for "open revision N"
+class XRefRevisionView {
+    public:
+        XRefRevisionView(const XRefIndex& index, size_t revision) : index(index), revision(revision) {};
+        std::optional<xrefEntry> lookup(size_t number) const { return index.lookup(number, revision); }
+        size_t getRevision() const { return revision; }
+
+    private:
+        const XRefIndex& index;
+        size_t revision;
+};
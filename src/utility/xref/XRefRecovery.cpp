@@ -0,0 +1,157 @@
+#include "XRefRecovery.h"
+#include "../parser/CharClass.h"
+#include "../parallel/WorkStealingRange.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
+void RecoveryScan::append(const RecoveryScan& other) {
+    this->objects.insert(this->objects.end(), other.objects.begin(), other.objects.end());
+    this->trailers.insert(this->trailers.end(), other.trailers.begin(), other.trailers.end());
+    this->objectStreams.insert(this->objectStreams.end(), other.objectStreams.begin(), other.objectStreams.end());
+    this->xrefStreams.insert(this->xrefStreams.end(), other.xrefStreams.begin(), other.xrefStreams.end());
+}
+
+namespace {
+    // Keyword at position is a whole token, the byte after it is whitespace, a delimiter or the end of data
+    bool endsToken(std::string_view data, size_t position) {
+        return position >= data.size() || !isPdfRegular(data[position]);
+    }
+
+    // Read the unsigned integer ending right before position, backwards. Returns its start or npos
+    size_t readNumberBefore(std::string_view data, size_t position, size_t maxDigits, uint64_t& value) {
+        size_t start = position;
+        while (start > 0 && position - start < maxDigits && isPdfDigit(data[start - 1])) start--;
+        if (start == position || (start > 0 && isPdfDigit(data[start - 1]))) return std::string::npos;
+        value = 0;
+        for (size_t i = start; i < position; i++) value = value * 10 + static_cast<uint64_t>(data[i] - '0');
+        return start;
+    }
+
+    size_t skipWhitespaceBefore(std::string_view data, size_t position) {
+        while (position > 0 && isPdfWhitespace(data[position - 1])) position--;
+        return position;
+    }
+
+    // N G obj with obj starting at position, false for endobj, names & other text
+    bool readObjectHeader(std::string_view data, size_t position, size_t baseOffset, RecoveredObject& object) {
+        if (!endsToken(data, position + 3)) return false;
+        size_t generationEnd = skipWhitespaceBefore(data, position);
+        if (generationEnd == position) return false;
+
+        uint64_t generation, number;
+        size_t generationStart = readNumberBefore(data, generationEnd, 5, generation);
+        if (generationStart == std::string::npos || generation > UINT16_MAX) return false;
+        size_t numberEnd = skipWhitespaceBefore(data, generationStart);
+        if (numberEnd == generationStart) return false;
+        size_t numberStart = readNumberBefore(data, numberEnd, 10, number);
+        if (numberStart == std::string::npos || number > MAX_OBJECT_NUMBER) return false;
+        if (numberStart > 0 && isPdfRegular(data[numberStart - 1])) return false;
+
+        object = RecoveredObject{static_cast<size_t>(number), static_cast<uint16_t>(generation), baseOffset + numberStart};
+        return true;
+    }
+
+    // Whole keywords starting in [begin, end), names can follow other tokens without whitespace
+    void findKeyword(std::string_view data, std::string_view keyword, bool isName, size_t begin, size_t end, size_t baseOffset, std::vector<size_t>& positions) {
+        std::string_view searched = data.substr(0, std::min(data.size(), end + keyword.size() - 1));
+        size_t position = searched.find(keyword, begin);
+        while (position != std::string::npos) {
+            if (endsToken(data, position + keyword.size()) && (isName || position == 0 || !isPdfRegular(data[position - 1]))) {
+                positions.push_back(baseOffset + position);
+            }
+            position = searched.find(keyword, position + 1);
+        }
+    }
+}
+
+void XRefRecovery::scan(std::string_view data, size_t begin, size_t end, size_t baseOffset, RecoveryScan& result) {
+    end = std::min(end, data.size());
+    if (begin >= end) return;
+
+    /* 'j' is rare in PDF syntax, every obj & /ObjStm keyword has one. The keyword starts up to
+        3 bytes before it, so the search runs a bit past end */
+    const char* base = data.data();
+    size_t searchEnd = std::min(data.size(), end + 3);
+    size_t position = begin;
+    while (position < searchEnd) {
+        const void* found = std::memchr(base + position, 'j', searchEnd - position);
+        if (!found) break;
+        size_t j = static_cast<const char*>(found) - base;
+        position = j + 1;
+
+        if (j >= begin + 2 && j - 2 < end && data[j - 2] == 'o' && data[j - 1] == 'b') {
+            RecoveredObject object;
+            if (readObjectHeader(data, j - 2, baseOffset, object)) result.objects.push_back(object);
+        } else if (j >= begin + 3 && j - 3 < end && data.substr(j - 3, 7) == "/ObjStm" && endsToken(data, j + 4)) {
+            result.objectStreams.push_back(baseOffset + j - 3);
+        }
+    }
+    findKeyword(data, "trailer", false, begin, end, baseOffset, result.trailers);
+    findKeyword(data, "/XRef", true, begin, end, baseOffset, result.xrefStreams);
+}
+
+RecoveryScan XRefRecovery::scan(Buffer& buffer, size_t threads) {
+    RecoveryScan result;
+    size_t size = buffer.getSize();
+    if (size == 0) return result;
+
+    if (!buffer.isContiguous()) {
+        // Views of a windowed buffer are only valid until the next access, scan window by window
+        for (size_t start = 0; start < size; start += RECOVERY_WINDOW) {
+            size_t viewStart = start >= RECOVERY_OVERLAP ? start - RECOVERY_OVERLAP : 0;
+            size_t end = std::min(size, start + RECOVERY_WINDOW);
+            std::string_view view = buffer.viewSpan(viewStart, end - viewStart + RECOVERY_OVERLAP);
+            XRefRecovery::scan(view, start - viewStart, end - viewStart, viewStart, result);
+        }
+        return result;
+    }
+
+    std::string_view data = buffer.viewSpan(0, size);
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min(threads, size / RECOVERY_MIN_CHUNK));
+
+    // Every worker scans one chunk, keeping the chunk results in order keeps the markers in file order
+    std::vector<RecoveryScan> chunks(threads);
+    size_t chunkSize = (size + threads - 1) / threads;
+    runOnWorkers(threads, [&](size_t worker) {
+        size_t begin = worker * chunkSize;
+        XRefRecovery::scan(data, begin, std::min(size, begin + chunkSize), 0, chunks[worker]);
+    });
+    for (const RecoveryScan& chunk: chunks) result.append(chunk);
+    return result;
+}
+
+std::vector<xrefSubsection> XRefRecovery::buildSections(const RecoveryScan& scan, size_t startOffset) {
+    // Later definitions replace earlier ones like incremental updates do
+    std::unordered_map<size_t, size_t> newest;
+    newest.reserve(scan.objects.size());
+    for (size_t i = 0; i < scan.objects.size(); i++) {
+        if (scan.objects[i].offset >= startOffset) newest[scan.objects[i].number] = i;
+    }
+
+    xrefSubsection section;
+    section.startObject = 0;
+    section.objects.reserve(newest.size());
+    for (size_t i = 0; i < scan.objects.size(); i++) {
+        const RecoveredObject& object = scan.objects[i];
+        auto found = newest.find(object.number);
+        if (found == newest.end() || found->second != i) continue;
+        section.objects.push_back(xrefEntry{object.offset - startOffset, object.generation, object.number, 'n'});
+    }
+    section.amountObjects = section.objects.size();
+    section.initDone = true;
+
+    std::vector<xrefSubsection> sections;
+    sections.push_back(std::move(section));
+    return sections;
+}
+
+const RecoveredObject* XRefRecovery::objectAt(const RecoveryScan& scan, size_t position) {
+    auto after = std::upper_bound(scan.objects.begin(), scan.objects.end(), position,
+        [](size_t value, const RecoveredObject& object) { return value < object.offset; });
+    if (after == scan.objects.begin()) return nullptr;
+    return &*(after - 1);
+}
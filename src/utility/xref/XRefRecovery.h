@@ -0,0 +1,54 @@
+#pragma once
+
+#include "XRefEntry.h"
+#include "../Buffer.h"
+
+#include <vector>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+// Bytes a windowed buffer is scanned in, markers crossing two windows are found through the overlap
+constexpr size_t RECOVERY_WINDOW = 4 * 1024 * 1024;
+constexpr size_t RECOVERY_OVERLAP = 64;
+// Contiguous buffers are only split over threads in chunks of at least this size
+constexpr size_t RECOVERY_MIN_CHUNK = 1024 * 1024;
+
+// Object header (N G obj) found by the recovery scan
+struct RecoveredObject {
+    size_t number;
+    uint16_t generation;
+    // Absolute position of the object number
+    size_t offset;
+};
+
+// Markers of a scan, each list in file order
+struct RecoveryScan {
+    std::vector<RecoveredObject> objects;
+    // Absolute positions of the trailer keyword
+    std::vector<size_t> trailers;
+    // Absolute positions of /ObjStm & /XRef names, they belong to the object before them
+    std::vector<size_t> objectStreams;
+    std::vector<size_t> xrefStreams;
+
+    void append(const RecoveryScan& other);
+};
+
+/* Rebuilds the object index of a damaged file (wrong startxref, broken xref table) from the
+    objects themselves by scanning every byte for N G obj, trailer, /ObjStm & /XRef markers.
+    Candidates come from memchr over the rarest byte of the keywords ('j' for obj & /ObjStm),
+    only those are checked byte by byte */
+class XRefRecovery {
+    public:
+        /* Scan markers whose keyword starts in [begin, end) of data. data may reach past both
+            ends, e.g. the object number before a keyword at begin. Positions are baseOffset + index */
+        static void scan(std::string_view data, size_t begin, size_t end, size_t baseOffset, RecoveryScan& result);
+        // Scan a whole buffer, contiguous buffers are split into chunks over threads (0 = every core)
+        static RecoveryScan scan(Buffer& buffer, size_t threads = 1);
+
+        /* Newest definition of each object (the last one in the file) as xref section,
+            offsets are made relative to the file header at startOffset like in a real xref table */
+        static std::vector<xrefSubsection> buildSections(const RecoveryScan& scan, size_t startOffset);
+        // Object a marker position belongs to, the last header before it, nullptr if there is none
+        static const RecoveredObject* objectAt(const RecoveryScan& scan, size_t position);
+};
@@ -0,0 +1,61 @@
+#include "XRefStream.h"
+
+// Read a big-endian field of the given width, missing fields use their default value
+static size_t readField(const unsigned char* row, size_t width, size_t defaultValue) {
+    if (width == 0) return defaultValue;
+    size_t value = 0;
+    for (size_t i = 0; i < width; i++) {
+        value = (value << 8) | row[i];
+    }
+    return value;
+}
+
+bool XRefStreamDecoder::decode(std::string_view data, const size_t widths[3], const std::vector<std::pair<size_t, size_t>>& index, std::vector<xrefSubsection>& subsections) {
+    size_t rowWidth = widths[0] + widths[1] + widths[2];
+    if (rowWidth == 0) return false;
+
+    const unsigned char* row = reinterpret_cast<const unsigned char*>(data.data());
+    size_t remainingRows = data.size() / rowWidth;
+    for (const auto& range: index) {
+        if (range.second > remainingRows) return false;
+        remainingRows -= range.second;
+
+        xrefSubsection section;
+        section.startObject = range.first;
+        section.amountObjects = range.second;
+        section.initDone = true;
+        section.objects.reserve(range.second);
+
+        for (size_t i = 0; i < range.second; i++) {
+            // Type defaults to 1 (in use) if its field is omitted
+            size_t type = readField(row, widths[0], 1);
+            size_t fieldTwo = readField(row + widths[0], widths[1], 0);
+            size_t fieldThree = readField(row + widths[0] + widths[1], widths[2], 0);
+            row += rowWidth;
+
+            xrefEntry entry;
+            entry.number = range.first + i;
+            entry.entryOne = fieldTwo;
+            switch (type) {
+                case 1:
+                    entry.type = 'n';
+                    entry.generation = static_cast<uint16_t>(fieldThree);
+                    break;
+                case 2:
+                    // Objects in object streams always have generation 0
+                    entry.type = 'c';
+                    entry.generation = 0;
+                    entry.streamIndex = fieldThree;
+                    break;
+                default:
+                    // Type 0 & unknown types are references to the null object
+                    entry.type = 'f';
+                    entry.generation = static_cast<uint16_t>(fieldThree);
+                    break;
+            }
+            section.objects.push_back(entry);
+        }
+        subsections.push_back(std::move(section));
+    }
+    return true;
+}
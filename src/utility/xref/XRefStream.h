@@ -0,0 +1,15 @@
+#pragma once
+
+#include "XRefEntry.h"
+
+#include <vector>
+#include <string_view>
+#include <utility>
+
+// Decoder for the binary rows of cross-reference streams (ISO32000 7.5.8)
+class XRefStreamDecoder {
+    public:
+        /* Split decoded stream data into subsections. widths are the /W field widths,
+            index the (first object, count) pairs of /Index. False if the data is too short */
+        static bool decode(std::string_view data, const size_t widths[3], const std::vector<std::pair<size_t, size_t>>& index, std::vector<xrefSubsection>& subsections);
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+
+/* Document of the given numbered objects with a classic xref table, written to the temp
+    directory. Numbers without an object are free entries, the trailer gets /Size & the
+    given entries. Returns the path of the file */
+inline std::string writeTestPdf(const std::string& name, const std::map<size_t, std::string>& objects, const std::string& trailer = "/Root 1 0 R") {
+    std::string data = "%PDF-1.4\n";
+    std::map<size_t, size_t> offsets;
+    for (const auto& [number, value]: objects) {
+        offsets[number] = data.size();
+        data += std::to_string(number) + " 0 obj\n" + value + "\nendobj\n";
+    }
+    size_t size = objects.rbegin()->first + 1;
+    size_t xref = data.size();
+    data += "xref\n0 " + std::to_string(size) + "\n";
+    char record[32];
+    for (size_t number = 0; number < size; number++) {
+        auto found = offsets.find(number);
+        std::snprintf(record, sizeof(record), found != offsets.end() ? "%010zu 00000 n \n" : "%010zu 65535 f \n", found != offsets.end() ? found->second : 0);
+        data += record;
+    }
+    data += "trailer\n<< /Size " + std::to_string(size) + " " + trailer + " >>\nstartxref\n" + std::to_string(xref) + "\n%%EOF\n";
+
+    std::string path = (std::filesystem::temp_directory_path() / name).string();
+    std::ofstream(path, std::ios::binary) << data;
+    return path;
+}
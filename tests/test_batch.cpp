@@ -0,0 +1,62 @@
+#include "../src/utility/batch/BatchRunner.h"
+#include <wx/wx.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+TEST(BatchRunnerTest, SampleDirectory) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    size_t samples = 0;
+    for (const auto& entry: std::filesystem::directory_iterator("../tests/samples")) {
+        if (entry.path().extension() == ".pdf") samples++;
+    }
+
+    // Tight limits, documents have to wait for each other
+    BatchOptions options;
+    options.threads = 4;
+    options.maxOpenFiles = 2;
+    options.memoryBudget = 1;
+    options.queueCapacity = 1;
+    options.parseObjects = true;
+    BatchRunner runner(options);
+
+    std::vector<std::string> seen;
+    BatchSummary summary = runner.run({"../tests/samples", "../tests/samples/missing.pdf"}, [&seen](const DocumentResult& result) {
+        seen.push_back(result.path);
+        if (result.path.find("missing.pdf") != std::string::npos) {
+            EXPECT_FALSE(result.ok);
+        } else {
+            EXPECT_GT(result.bytes, size_t(0));
+            EXPECT_TRUE(result.ok) << result.path << ": " << result.log;
+        }
+        // Failed documents always carry a reason
+        EXPECT_TRUE(result.ok || !result.errorMessage.empty());
+    });
+
+    EXPECT_EQ(seen.size(), samples + 1);
+    EXPECT_EQ(summary.documents, samples + 1);
+    EXPECT_EQ(summary.failures, size_t(1));
+    EXPECT_EQ(summary.failureReasons["Error opening file"], size_t(1));
+    EXPECT_GT(summary.bytes, size_t(0));
+    EXPECT_LE(summary.latencyP50, summary.latencyP99);
+    EXPECT_LE(summary.latencyP99, summary.latencyMax);
+}
+
+TEST(BatchRunnerTest, LatencyPercentiles) {
+    std::vector<DocumentResult> results(200);
+    for (size_t i = 0; i < results.size(); i++) {
+        results[i].ok = true;
+        results[i].bytes = 1024 * 1024;
+        results[i].seconds = (i + 1) / 1000.0;
+    }
+    BatchSummary summary = BatchRunner::summarize(results, 2.0);
+    EXPECT_DOUBLE_EQ(summary.latencyP50, 0.1);
+    EXPECT_DOUBLE_EQ(summary.latencyP99, 0.198);
+    EXPECT_DOUBLE_EQ(summary.latencyMax, 0.2);
+    EXPECT_DOUBLE_EQ(summary.documentsPerSecond(), 100.0);
+    EXPECT_DOUBLE_EQ(summary.megabytesPerSecond(), 100.0);
+}
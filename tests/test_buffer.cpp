@@ -0,0 +1,71 @@
+#include "../src/utility/Buffer.h"
+#include <wx/wx.h>
+#include <gtest/gtest.h>
+
+TEST(BufferTest, MappedMatchesMemory) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    Buffer memory("../tests/samples/sample.pdf", BUFFER_MEMORY);
+    Buffer mapped("../tests/samples/sample.pdf", BUFFER_MAPPED);
+    ASSERT_TRUE(memory.isReady());
+    ASSERT_TRUE(mapped.isReady());
+    ASSERT_EQ(mapped.getMode(), BUFFER_MAPPED);
+    ASSERT_EQ(memory.getSize(), mapped.getSize());
+
+    // Views of both backends must contain the same bytes
+    size_t size = memory.getSize();
+    EXPECT_EQ(memory.viewByteRange(0, size), mapped.viewByteRange(0, size));
+    EXPECT_EQ(mapped.viewByteRange(0, 4), "%PDF-");
+
+    // Sequential reads through the marker
+    mapped.setPosition(size - 5);
+    std::string tail;
+    while (!mapped.markerIsAtEnd()) {
+        tail.push_back(mapped.readNext());
+    }
+    EXPECT_EQ(tail, memory.readByteRange(size - 5, size));
+    EXPECT_THROW(mapped.readNext(), std::runtime_error);
+}
+
+TEST(BufferTest, MissingFileNotReady) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    Buffer buffer("../tests/samples/does_not_exist.pdf");
+    EXPECT_FALSE(buffer.isReady());
+}
+
+TEST(BufferTest, WindowedMatchesMemory) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    BufferOptions options;
+    options.mode = BUFFER_WINDOWED;
+    options.blockSize = 512;
+    options.memoryCap = 2048;
+    Buffer windowed("../tests/samples/sample.pdf", options);
+    Buffer memory("../tests/samples/sample.pdf", BUFFER_MEMORY);
+    ASSERT_TRUE(windowed.isReady());
+    ASSERT_EQ(windowed.getSize(), memory.getSize());
+
+    // Views crossing block boundaries are assembled from multiple blocks
+    size_t size = memory.getSize();
+    EXPECT_EQ(windowed.viewByteRange(100, 3000), memory.viewByteRange(100, 3000));
+    EXPECT_EQ(windowed.viewByteRange(size - 20, size), memory.viewByteRange(size - 20, size));
+
+    // Reading the whole file byte by byte never holds more than the memory cap
+    windowed.setPosition(0);
+    memory.setPosition(0);
+    while (!memory.markerIsAtEnd()) {
+        ASSERT_EQ(windowed.readNext(), memory.readNext());
+    }
+    // The block before the last one is still resident
+    EXPECT_EQ(windowed.viewByteRange(size - 600, size - 590), memory.viewByteRange(size - 600, size - 590));
+
+    BufferStats stats = windowed.getStats();
+    EXPECT_LE(stats.residentBytes, options.memoryCap);
+    EXPECT_GT(stats.blockMisses, size / options.blockSize);
+    EXPECT_GT(stats.blockEvictions, size_t(0));
+    EXPECT_GT(stats.blockHits, size_t(0));
+}
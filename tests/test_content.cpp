@@ -0,0 +1,179 @@
+#include "../src/utility/content/ContentParser.h"
+#include "../src/utility/PdfReader.h"
+#include <wx/wx.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+// Records every operation as text, e.g. "Tf F1 12"
+class RecordingVisitor : public ContentVisitor {
+    public:
+        std::vector<std::string> operations;
+        std::vector<size_t> errors;
+        std::vector<std::string> imageData;
+
+        void onOperator(ContentOperator op, const OperandStack& operands) override {
+            operations.push_back(contentOperatorKeyword(op) + describe(operands));
+        }
+        void onUnknownOperator(std::string_view keyword, const OperandStack& operands) override {
+            operations.push_back("?" + std::string(keyword) + describe(operands));
+        }
+        void onInlineImage(const Value& dictionary, std::string_view data) override {
+            operations.push_back("BI " + std::to_string(dictionary.size()));
+            imageData.push_back(std::string(data));
+        }
+        void onError(size_t position, LexerStatus /*status*/) override {
+            errors.push_back(position);
+        }
+
+    private:
+        static std::string describe(const OperandStack& operands) {
+            std::string text;
+            for (size_t i = 0; i < operands.size(); i++) {
+                const Value& operand = operands[i];
+                text += " ";
+                switch (operand.getType()) {
+                    case OBJT_INTEGER: text += std::to_string(operand.getInteger()); break;
+                    case OBJT_REAL: text += std::to_string(operand.getReal()).substr(0, 4); break;
+                    case OBJT_NAME: text += "/" + std::string(operand.getString()); break;
+                    case OBJT_STRING_LITERAL: text += "(" + std::string(operand.getString()) + ")"; break;
+                    case OBJT_STRING_HEXADECIMAL: text += "<" + std::string(operand.getString()) + ">"; break;
+                    case OBJT_ARRAY: text += "[" + std::to_string(operand.size()) + "]"; break;
+                    case OBJT_DICTIONARY: text += "<<" + std::to_string(operand.size()) + ">>"; break;
+                    default: text += "?"; break;
+                }
+            }
+            return text;
+        }
+};
+
+TEST(ContentOperatorTest, KeywordsRoundTrip) {
+    for (int op = 1; op < OP_COUNT; op++) {
+        EXPECT_EQ(findContentOperator(CONTENT_OPERATORS[op].keyword), static_cast<ContentOperator>(op)) << CONTENT_OPERATORS[op].keyword;
+    }
+    EXPECT_EQ(findContentOperator("Tj"), OP_SHOW_TEXT);
+    EXPECT_EQ(findContentOperator("\""), OP_NEXT_LINE_SHOW_TEXT_SPACING);
+    for (const char* keyword: {"", "x", "Tjj", "BTX", "TX", "scnx", "\xff"}) {
+        EXPECT_EQ(findContentOperator(keyword), OP_UNKNOWN) << keyword;
+    }
+}
+
+TEST(ContentParserTest, OperandsAndOperators) {
+    std::string content =
+        "q 1 0 0 1 72.5 -10 cm\n"
+        "BT /F1 12 Tf 10 20 Td (Hello \\(World\\)) Tj [(A) -250 <4142>] TJ ET\n"
+        "[3 2] 0 d /Span << /ActualText (x) /MCID 3 >> BDC EMC\n"
+        "/A#20B sh 0.5 g %comment\r\n"
+        "1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30 31 32 33 34 SCN\n"
+        "BX 1 foo EX Q";
+
+    ContentParser parser;
+    RecordingVisitor visitor;
+    ContentStats stats = parser.parse(content, visitor);
+
+    std::vector<std::string> expected = {
+        "q", "cm 1 0 0 1 72.5 -10",
+        "BT", "Tf /F1 12", "Td 10 20", "Tj (Hello \\(World\\))", "TJ [3]", "ET",
+        "d [2] 0", "BDC /Span <<2>>", "EMC",
+        "sh /A B", "g 0.50",
+        "SCN 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30 31 32",
+        "BX", "?foo 1", "EX", "Q"
+    };
+    EXPECT_EQ(visitor.operations, expected);
+    EXPECT_EQ(stats.operators, expected.size() - 1);
+    EXPECT_EQ(stats.unknownOperators, size_t(1));
+    EXPECT_EQ(stats.errors, size_t(0));
+    EXPECT_TRUE(visitor.errors.empty());
+}
+
+TEST(ContentParserTest, TypedOperandAccess) {
+    ContentParser parser;
+    ContentDispatcher dispatcher;
+    std::vector<std::string> shown;
+    std::string decoded;
+    double fontSize = 0;
+    NameAtom font = NAME_UNKNOWN;
+    dispatcher.on(OP_SET_FONT, [&](const OperandStack& operands) {
+        font = operands.getAtom(0);
+        fontSize = operands.getReal(1);
+    });
+    dispatcher.on(OP_SHOW_TEXT_ARRAY, [&](const OperandStack& operands) {
+        const Value& array = operands[0];
+        for (size_t i = 0; i < array.size(); i++) {
+            ContentParser::decodeString(array.getItems()[i], decoded);
+            if (!decoded.empty()) shown.push_back(decoded);
+        }
+    });
+    // Operators without a handler & missing operands are fine
+    ContentStats stats = parser.parse("BT /Helv 9.5 Tf [(a\\051b) 120 <48 49 7>] TJ Tf ET", dispatcher);
+    EXPECT_EQ(stats.operators, size_t(5));
+    EXPECT_EQ(font, NAME_UNKNOWN);
+    EXPECT_EQ(fontSize, 0);
+    EXPECT_EQ(shown, (std::vector<std::string>{"a)b", "HIp"}));
+
+    parser.parse("/Helv 9.5 Tf", dispatcher);
+    EXPECT_EQ(font, NameManager::global().intern("Helv").atom);
+    EXPECT_DOUBLE_EQ(fontSize, 9.5);
+}
+
+TEST(ContentParserTest, InlineImages) {
+    std::string data("\x00\xffI EI\x01", 7);
+    std::string content = "q BI /W 7 /H 1 /CS /G /BPC 8 ID " + data + "\nEI Q "
+        "BI /W 2 /H 1 /L 2 ID " + std::string("EI", 2) + "\nEI\n"
+        "BI /W 1 ID EI";
+
+    ContentParser parser;
+    RecordingVisitor visitor;
+    ContentStats stats = parser.parse(content, visitor);
+    EXPECT_EQ(visitor.operations, (std::vector<std::string>{"q", "BI 4", "Q", "BI 3", "BI 1"}));
+    EXPECT_EQ(stats.inlineImages, size_t(3));
+    ASSERT_EQ(visitor.imageData.size(), size_t(3));
+    // EI inside the data isn't the end, /L is trusted when EI follows it
+    EXPECT_EQ(visitor.imageData[0], data);
+    EXPECT_EQ(visitor.imageData[1], "EI");
+    EXPECT_EQ(visitor.imageData[2], "");
+
+    // Missing EI
+    visitor = RecordingVisitor();
+    stats = parser.parse("BI /W 1 ID xx Q", visitor);
+    EXPECT_EQ(stats.errors, size_t(1));
+    EXPECT_TRUE(visitor.operations.empty());
+}
+
+TEST(ContentParserTest, MalformedContent) {
+    ContentParser parser;
+    RecordingVisitor visitor;
+    // Stray closing tokens, an array cut off by an operator & dangling operands at the end
+    ContentStats stats = parser.parse("] 1 >> w [1 2 S (a) Tj 5", visitor);
+    EXPECT_EQ(visitor.operations, (std::vector<std::string>{"w 1", "S [2]", "Tj (a)"}));
+    EXPECT_EQ(stats.errors, size_t(2));
+    EXPECT_EQ(visitor.errors, (std::vector<size_t>{0, 4}));
+}
+
+TEST(ContentParserTest, SamplePageContent) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    PdfReader reader("../tests/samples/sample.pdf");
+    ASSERT_TRUE(reader.process()) << reader.getLog();
+    std::shared_ptr<DictionaryObject> page = std::dynamic_pointer_cast<DictionaryObject>(reader.getObject(2));
+    ASSERT_NE(page, nullptr);
+    std::shared_ptr<StreamObject> contents = std::dynamic_pointer_cast<StreamObject>(reader.resolve(page->getElement("Contents")));
+    ASSERT_NE(contents, nullptr);
+    std::string content;
+    ASSERT_TRUE(reader.decodeStream(contents, content));
+
+    size_t beginText = 0, endText = 0, shown = 0;
+    ContentDispatcher dispatcher;
+    dispatcher.on(OP_BEGIN_TEXT, [&](const OperandStack&) { beginText++; });
+    dispatcher.on(OP_END_TEXT, [&](const OperandStack&) { endText++; });
+    dispatcher.on(OP_SHOW_TEXT, [&](const OperandStack&) { shown++; });
+    dispatcher.on(OP_SHOW_TEXT_ARRAY, [&](const OperandStack&) { shown++; });
+    ContentStats stats = ContentParser().parse(content, dispatcher);
+    EXPECT_GT(stats.operators, size_t(0));
+    EXPECT_EQ(stats.errors, size_t(0));
+    EXPECT_GT(beginText, size_t(0));
+    EXPECT_EQ(beginText, endText);
+    EXPECT_GT(shown, size_t(0));
+}
@@ -0,0 +1,354 @@
+#include "../src/utility/filters/FilterPipeline.h"
+#include "../src/utility/filters/FlateDecode.h"
+#include "../src/utility/filters/ASCIIHexDecode.h"
+#include "../src/utility/filters/ASCII85Decode.h"
+#include "../src/utility/PdfReader.h"
+#include <wx/wx.h>
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+// Deterministic bytes with runs & repeats like real image data
+static std::string sampleBytes(size_t length, uint32_t seed = 7) {
+    std::string data;
+    uint32_t state = seed;
+    while (data.size() < length) {
+        state = state * 1103515245 + 12345;
+        size_t run = (state >> 28) % 3 == 0 ? (state >> 20) % 40 + 1 : 1;
+        data.append(std::min(run, length - data.size()), static_cast<char>(state >> 16));
+    }
+    return data;
+}
+
+// Decode through a pipeline, pulling at most chunk bytes at a time
+static bool decode(const std::string& encoded, const std::vector<FilterSpec>& filters, std::string& output, size_t chunk = 4096) {
+    std::unique_ptr<ByteSource> source = FilterPipeline::create(std::make_unique<SpanSource>(encoded), filters);
+    if (!source) return false;
+    output.clear();
+    std::vector<char> buffer(chunk);
+    size_t length;
+    while ((length = source->read(buffer.data(), chunk)) > 0) output.append(buffer.data(), length);
+    return !source->hasFailed();
+}
+
+static std::vector<FilterSpec> single(NameAtom name, DecodeParams params = DecodeParams()) {
+    return {FilterSpec{name, params}};
+}
+
+static std::string compress(const std::string& data) {
+    uLongf length = compressBound(static_cast<uLong>(data.size()));
+    std::string output(length, '\0');
+    compress2(reinterpret_cast<Bytef*>(&output[0]), &length, reinterpret_cast<const Bytef*>(data.data()), static_cast<uLong>(data.size()), 6);
+    output.resize(length);
+    return output;
+}
+
+static std::string encodeHex(const std::string& data) {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string output;
+    for (size_t i = 0; i < data.size(); i++) {
+        output += digits[static_cast<uint8_t>(data[i]) >> 4];
+        output += digits[static_cast<uint8_t>(data[i]) & 15];
+    }
+    return output + ">";
+}
+
+static std::string encode85(const std::string& data) {
+    std::string output;
+    for (size_t i = 0; i < data.size(); i += 4) {
+        size_t bytes = std::min<size_t>(4, data.size() - i);
+        uint32_t value = 0;
+        for (size_t j = 0; j < 4; j++) value = value << 8 | (j < bytes ? static_cast<uint8_t>(data[i + j]) : 0);
+        if (value == 0 && bytes == 4) {
+            output += 'z';
+            continue;
+        }
+        char group[5];
+        for (int j = 4; j >= 0; j--) {
+            group[j] = static_cast<char>('!' + value % 85);
+            value /= 85;
+        }
+        output.append(group, bytes + 1);
+    }
+    return output + "~>";
+}
+
+static std::string encodeRunLength(const std::string& data) {
+    std::string output;
+    size_t i = 0;
+    while (i < data.size()) {
+        size_t run = 1;
+        while (i + run < data.size() && run < 128 && data[i + run] == data[i]) run++;
+        if (run > 1) {
+            output += static_cast<char>(257 - run);
+            output += data[i];
+            i += run;
+            continue;
+        }
+        size_t literal = 1;
+        while (i + literal < data.size() && literal < 128 && (i + literal + 1 >= data.size() || data[i + literal] != data[i + literal + 1])) literal++;
+        output += static_cast<char>(literal - 1);
+        output.append(data, i, literal);
+        i += literal;
+    }
+    return output + static_cast<char>(128);
+}
+
+// LZW encoder mirroring the decoder's code length changes, clears the table before it is full
+static std::string encodeLZW(const std::string& data, int earlyChange = 1) {
+    std::string output;
+    uint32_t bits = 0;
+    int bitCount = 0, codeLength = 9;
+    size_t decoderNext = 258, codesSinceClear = 0;
+    auto emit = [&](int code) {
+        bits = bits << codeLength | static_cast<uint32_t>(code);
+        bitCount += codeLength;
+        while (bitCount >= 8) {
+            bitCount -= 8;
+            output += static_cast<char>(bits >> bitCount);
+        }
+        bits &= (1u << bitCount) - 1;
+        if (code == 256) {
+            codeLength = 9;
+            decoderNext = 258;
+            codesSinceClear = 0;
+            return;
+        }
+        if (codesSinceClear++ > 0 && decoderNext < 4096) decoderNext++;
+        if (decoderNext + earlyChange >= (size_t(1) << codeLength) && codeLength < 12) codeLength++;
+    };
+
+    std::map<std::string, int> table;
+    auto reset = [&]() {
+        table.clear();
+        for (int c = 0; c < 256; c++) table[std::string(1, static_cast<char>(c))] = c;
+    };
+    reset();
+    emit(256);
+    std::string word;
+    for (char c: data) {
+        std::string extended = word + c;
+        if (table.count(extended)) {
+            word = extended;
+            continue;
+        }
+        emit(table[word]);
+        int code = static_cast<int>(table.size()) + 2;
+        table[extended] = code;
+        word = std::string(1, c);
+        if (code + 1 == 4095) {
+            emit(256);
+            reset();
+        }
+    }
+    if (!word.empty()) emit(table[word]);
+    emit(257);
+    if (bitCount > 0) output += static_cast<char>(bits << (8 - bitCount));
+    return output;
+}
+
+TEST(FiltersTest, ASCIIHex) {
+    std::string output;
+    EXPECT_TRUE(decode("48 65\n6c6C 6f>", single(NAME_ASCII_HEX_DECODE), output));
+    EXPECT_EQ(output, "Hello");
+    // Odd last digit is followed by 0, missing > is tolerated
+    EXPECT_TRUE(decode("7", single(NAME_ASCII_HEX_DECODE), output));
+    EXPECT_EQ(output, "p");
+    EXPECT_FALSE(decode("48 6x>", single(NAME_ASCII_HEX_DECODE), output));
+    EXPECT_EQ(output, "H");
+
+    // Long runs go through the vectorized path, every chunk size has to give the same bytes
+    std::string data = sampleBytes(10000);
+    std::string encoded = encodeHex(data);
+    for (size_t chunk: {1, 7, 16, 4096}) {
+        EXPECT_TRUE(decode(encoded, single(NAME_ASCII_HEX_DECODE), output, chunk));
+        EXPECT_EQ(output, data) << chunk;
+    }
+    std::string lower = encoded;
+    for (char& c: lower) c = static_cast<char>(std::tolower(c));
+    lower.insert(999, "\r\n");
+    EXPECT_TRUE(decode(lower, single(NAME_ASCII_HEX_DECODE), output));
+    EXPECT_EQ(output, data);
+
+    std::vector<char> run(8);
+    EXPECT_EQ(ASCIIHexFilter::decodeRun("00fF7a\xC1", 7, run.data()), 6u);
+    EXPECT_EQ(std::string(run.data(), 3), std::string("\x00\xff\x7a", 3));
+}
+
+TEST(FiltersTest, ASCII85) {
+    std::string output;
+    EXPECT_TRUE(decode("87cURD]i,\"Ebo80~>", single(NAME_ASCII85_DECODE), output));
+    EXPECT_EQ(output, "Hello World!");
+    EXPECT_TRUE(decode("z !!*-'\n~>", single(NAME_ASCII85_DECODE), output));
+    EXPECT_EQ(output, std::string("\0\0\0\0\0\1\2\3", 8));
+    // Group above 2^32 - 1 & a single digit at the end are corrupt
+    EXPECT_FALSE(decode("uuuuu~>", single(NAME_ASCII85_DECODE), output));
+    EXPECT_FALSE(decode("87cURD~>", single(NAME_ASCII85_DECODE), output));
+    EXPECT_EQ(output, "Hell");
+
+    for (size_t length = 0; length < 12; length++) {
+        std::string data = sampleBytes(length, static_cast<uint32_t>(length));
+        EXPECT_TRUE(decode(encode85(data), single(NAME_ASCII85_DECODE), output));
+        EXPECT_EQ(output, data) << length;
+    }
+    std::string data = sampleBytes(10001) + std::string(8, '\0');
+    std::string encoded = encode85(data);
+    for (size_t chunk: {1, 3, 12, 4096}) {
+        EXPECT_TRUE(decode(encoded, single(NAME_ASCII85_DECODE), output, chunk));
+        EXPECT_EQ(output, data) << chunk;
+    }
+    encoded.insert(500, "\n  ");
+    EXPECT_TRUE(decode(encoded, single(NAME_ASCII85_DECODE), output));
+    EXPECT_EQ(output, data);
+}
+
+TEST(FiltersTest, RunLength) {
+    std::string output;
+    EXPECT_TRUE(decode(std::string("\x02" "abc" "\xfd" "x" "\x80" "ignored", 11), single(NAME_RUN_LENGTH_DECODE), output));
+    EXPECT_EQ(output, "abcxxxx");
+
+    std::string data = sampleBytes(20000);
+    std::string encoded = encodeRunLength(data);
+    EXPECT_LT(encoded.size(), data.size());
+    for (size_t chunk: {1, 5, 4096}) {
+        EXPECT_TRUE(decode(encoded, single(NAME_RUN_LENGTH_DECODE), output, chunk));
+        EXPECT_EQ(output, data) << chunk;
+    }
+}
+
+TEST(FiltersTest, LZW) {
+    // Example of ISO32000 7.4.4.2
+    std::string output;
+    EXPECT_TRUE(decode(std::string("\x80\x0b\x60\x50\x22\x0c\x0c\x85\x01", 9), single(NAME_LZW_DECODE), output));
+    EXPECT_EQ(output, "-----A---B");
+
+    // Large enough to fill the table & clear it a few times
+    std::string data = sampleBytes(200000);
+    for (int earlyChange: {1, 0}) {
+        DecodeParams params;
+        params.earlyChange = earlyChange;
+        std::string encoded = encodeLZW(data, earlyChange);
+        for (size_t chunk: {1, 13, 65536}) {
+            EXPECT_TRUE(decode(encoded, single(NAME_LZW_DECODE, params), output, chunk));
+            EXPECT_EQ(output, data) << earlyChange << " " << chunk;
+        }
+    }
+    // Code that isn't in the table yet
+    EXPECT_FALSE(decode(std::string("\x80\x0b\x7f\xf0", 4), single(NAME_LZW_DECODE), output));
+}
+
+// Paeth predictor function from the PNG specification
+static int paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+TEST(FiltersTest, Predictors) {
+    const size_t bpp = 3, columns = 7, rowLength = bpp * columns, rows = 40;
+    std::string image = sampleBytes(rowLength * rows);
+    DecodeParams params;
+    params.colors = 3;
+    params.columns = static_cast<int>(columns);
+
+    // Every PNG filter type, one per row
+    std::string png;
+    for (size_t row = 0; row < rows; row++) {
+        uint8_t type = static_cast<uint8_t>(row % 5);
+        png += static_cast<char>(type);
+        for (size_t i = 0; i < rowLength; i++) {
+            int x = static_cast<uint8_t>(image[row * rowLength + i]);
+            int left = i >= bpp ? static_cast<uint8_t>(image[row * rowLength + i - bpp]) : 0;
+            int up = row > 0 ? static_cast<uint8_t>(image[(row - 1) * rowLength + i]) : 0;
+            int upLeft = row > 0 && i >= bpp ? static_cast<uint8_t>(image[(row - 1) * rowLength + i - bpp]) : 0;
+            int predicted[] = {0, left, up, (left + up) / 2, paeth(left, up, upLeft)};
+            png += static_cast<char>(x - predicted[type]);
+        }
+    }
+    params.predictor = 15;
+    std::string output;
+    for (size_t chunk: {1, 20, 4096}) {
+        EXPECT_TRUE(decode(compress(png), single(NAME_FLATE_DECODE, params), output, chunk));
+        EXPECT_EQ(output, image) << chunk;
+    }
+    EXPECT_TRUE(FlateDecode::decode(compress(png), output, params));
+    EXPECT_EQ(output, image);
+    EXPECT_TRUE(decode(encodeLZW(png), single(NAME_LZW_DECODE, params), output));
+    EXPECT_EQ(output, image);
+
+    std::string tiff = image;
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t i = rowLength - 1; i >= bpp; i--) tiff[row * rowLength + i] = static_cast<char>(tiff[row * rowLength + i] - tiff[row * rowLength + i - bpp]);
+    }
+    params.predictor = 2;
+    EXPECT_TRUE(decode(compress(tiff), single(NAME_FLATE_DECODE, params), output, 5));
+    EXPECT_EQ(output, image);
+
+    // Unknown PNG filter type
+    png[rowLength + 1] = 9;
+    params.predictor = 12;
+    EXPECT_FALSE(decode(compress(png), single(NAME_FLATE_DECODE, params), output));
+    EXPECT_EQ(output, image.substr(0, rowLength));
+}
+
+TEST(FiltersTest, Pipeline) {
+    // Filters apply in array order, the encoding was done in reverse
+    std::string data = sampleBytes(300000);
+    std::string encoded = encodeHex(compress(data));
+    std::vector<FilterSpec> filters{FilterSpec{NAME_ASCII_HEX_DECODE, DecodeParams()}, FilterSpec{NAME_FLATE_DECODE, DecodeParams()}};
+    std::string output;
+    EXPECT_TRUE(decode(encoded, filters, output, 1000));
+    EXPECT_EQ(output, data);
+
+    // Abbreviations of inline images
+    filters[0].name = NameManager::global().intern("AHx").atom;
+    filters[1].name = NameManager::global().intern("Fl").atom;
+    EXPECT_TRUE(decode(encoded, filters, output));
+    EXPECT_EQ(output, data);
+
+    EXPECT_EQ(FilterPipeline::create(std::make_unique<SpanSource>(encoded), single(NAME_DCT_DECODE)), nullptr);
+    EXPECT_FALSE(decode("not zlib", single(NAME_FLATE_DECODE), output));
+    // Truncated zlib data keeps what was decoded
+    std::string truncated = compress(data).substr(0, 1000);
+    EXPECT_TRUE(decode(truncated, single(NAME_FLATE_DECODE), output));
+    EXPECT_FALSE(output.empty());
+    EXPECT_EQ(output, data.substr(0, output.size()));
+}
+
+TEST(FiltersTest, ReaderStreams) {
+    // Object & xref streams of the sample are Flate encoded with a PNG predictor
+    for (BufferMode mode: {BUFFER_MEMORY, BUFFER_WINDOWED}) {
+        BufferOptions options;
+        options.mode = mode;
+        options.blockSize = 4096;
+        PdfReader reader("../tests/samples/sample_xrefstream.pdf", options);
+        ASSERT_TRUE(reader.process());
+        size_t streams = 0;
+        for (size_t number = 1; number < reader.getXRefIndex().getEntryCount(); number++) {
+            std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(reader.getObject(number));
+            if (!stream) continue;
+            std::string decoded;
+            ASSERT_TRUE(reader.decodeStream(stream, decoded));
+
+            std::unique_ptr<ByteSource> source = reader.openStream(stream);
+            ASSERT_NE(source, nullptr);
+            std::string pulled;
+            char chunk[100];
+            size_t length;
+            while ((length = source->read(chunk, sizeof(chunk))) > 0) {
+                pulled.append(chunk, length);
+                // The consumer may use the reader in between
+                reader.getObject(1);
+            }
+            EXPECT_FALSE(source->hasFailed());
+            EXPECT_EQ(pulled, decoded);
+            streams++;
+        }
+        EXPECT_GT(streams, 0u);
+    }
+}
@@ -0,0 +1,195 @@
+#include "../src/utility/graph/ObjectGraph.h"
+#include "../src/utility/PdfReader.h"
+#include "TestPdf.h"
+#include <wx/wx.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+
+static std::vector<uint32_t> edges(GraphEdges list) {
+    return std::vector<uint32_t>(list.begin(), list.end());
+}
+
+/* Page tree with a shared font (5), the pages refer back to their parent (2, 3, 4 form a cycle),
+    two objects refer to each other (7, 8), one to itself (9), one to a missing object (10) &
+    a stream has its length in another object (12) */
+static std::string writeGraphDocument() {
+    return writeTestPdf("wavepdf_graph.pdf", {
+        {1, "<< /Type /Catalog /Pages 2 0 R >>"},
+        {2, "<< /Type /Pages /Kids [3 0 R 4 0 R] /Count 2 >>"},
+        {3, "<< /Type /Page /Parent 2 0 R /Resources << /Font << /F1 5 0 R >> >> /Contents 11 0 R >>"},
+        {4, "<< /Type /Page /Parent 2 0 R /Resources << /Font << /F1 5 0 R /F2 5 0 R >> >> >>"},
+        {5, "<< /Type /Font /FontDescriptor 6 0 R >>"},
+        {6, "<< /Type /FontDescriptor >>"},
+        {7, "[8 0 R]"},
+        {8, "[7 0 R]"},
+        {9, "<< /Self 9 0 R >>"},
+        {10, "[99 0 R]"},
+        {11, "<< /Length 12 0 R >>\nstream\nhello\nendstream"},
+        {12, "5"},
+    });
+}
+
+TEST(ObjectGraphTest, BuildsAdjacency) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    std::string path = writeGraphDocument();
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process());
+
+    ObjectGraph graph;
+    EXPECT_FALSE(graph.build(reader));
+    ASSERT_TRUE(reader.parseDocument());
+    ASSERT_TRUE(graph.build(reader));
+
+    // Object 0 is free, every other number has an object
+    EXPECT_EQ(graph.getNodeCount(), 12u);
+    EXPECT_EQ(graph.getNode(1), 0u);
+    EXPECT_EQ(graph.getNode(0), GRAPH_NO_NODE);
+    EXPECT_EQ(graph.getEdgeCount(), 13u);
+    EXPECT_EQ(graph.getDanglingCount(), 1u);
+    EXPECT_FALSE(graph.hasObject(0));
+    EXPECT_TRUE(graph.hasObject(12));
+    EXPECT_FALSE(graph.hasObject(13));
+
+    EXPECT_EQ(edges(graph.getReferences(3)), (std::vector<uint32_t>{2, 5, 11}));
+    // Repeated references are one edge
+    EXPECT_EQ(edges(graph.getReferences(4)), (std::vector<uint32_t>{2, 5}));
+    EXPECT_TRUE(graph.getReferences(10).empty());
+    EXPECT_EQ(edges(graph.getReferrers(2)), (std::vector<uint32_t>{1, 3, 4}));
+    EXPECT_EQ(graph.getFanIn(5), 2u);
+    EXPECT_EQ(graph.getFanIn(1), 0u);
+    EXPECT_EQ(graph.getFanIn(9), 1u);
+    EXPECT_TRUE(graph.getReferences(100).empty());
+
+    EXPECT_EQ(ObjectGraph::trailerRoots(reader), std::vector<size_t>{1});
+    std::vector<uint32_t> distances = graph.distances(ObjectGraph::trailerRoots(reader));
+    EXPECT_EQ(distances, (std::vector<uint32_t>{0, 1, 2, 2, 3, 4, GRAPH_UNREACHED, GRAPH_UNREACHED, GRAPH_UNREACHED, GRAPH_UNREACHED, 3, 4}));
+    EXPECT_TRUE(graph.reaches(1, 6));
+    EXPECT_FALSE(graph.reaches(6, 1));
+    EXPECT_TRUE(graph.reaches(8, 7));
+    EXPECT_FALSE(graph.reaches(10, 99));
+
+    // The object holding a stream's length isn't needed once the length is written directly
+    ObjectGraph withoutLengths;
+    ASSERT_TRUE(withoutLengths.build(reader, 1, false));
+    EXPECT_EQ(withoutLengths.getEdgeCount(), 12u);
+    std::vector<uint8_t> reachable = withoutLengths.reachable({1});
+    EXPECT_EQ(std::count(reachable.begin(), reachable.end(), 1), 7);
+    EXPECT_FALSE(reachable[withoutLengths.getNode(12)]);
+    std::filesystem::remove(path);
+}
+
+TEST(ObjectGraphTest, FindsCyclesAndDependencyOrder) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    std::string path = writeGraphDocument();
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process());
+    ASSERT_TRUE(reader.parseDocument());
+    ObjectGraph graph;
+    ASSERT_TRUE(graph.build(reader));
+
+    EXPECT_EQ(graph.cycles(), (std::vector<std::vector<size_t>>{{2, 3, 4}, {7, 8}, {9}}));
+
+    size_t count;
+    std::vector<uint32_t> components = graph.components(count);
+    EXPECT_EQ(count, 9u);
+    EXPECT_EQ(components[graph.getNode(2)], components[graph.getNode(4)]);
+    EXPECT_NE(components[graph.getNode(1)], components[graph.getNode(2)]);
+
+    // Objects come after everything they refer to, except for references within a cycle
+    std::vector<size_t> order = graph.dependencyOrder();
+    ASSERT_EQ(order.size(), 12u);
+    std::map<size_t, size_t> position;
+    for (size_t i = 0; i < order.size(); i++) position[order[i]] = i;
+    for (uint32_t number: graph.getNumbers()) {
+        for (uint32_t target: graph.getReferences(number)) {
+            if (components[graph.getNode(target)] == components[graph.getNode(number)]) continue;
+            EXPECT_LT(position[target], position[number]) << number << " -> " << target;
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(ObjectGraphTest, SameResultForAnyThreadCount) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    // More objects than one grain, each refers to a few others picked at random, some missing
+    const size_t objects = 5000;
+    std::map<size_t, std::string> values;
+    std::vector<std::set<uint32_t>> expected(objects + 1);
+    uint64_t state = 12345;
+    auto random = [&state](size_t bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<size_t>((state >> 33) % bound);
+    };
+    for (size_t number = 1; number <= objects; number++) {
+        std::string value = "[";
+        size_t references = random(4);
+        for (size_t i = 0; i < references; i++) {
+            size_t target = 1 + random(objects + 100);
+            value += std::to_string(target) + " 0 R ";
+            if (target <= objects) expected[number].insert(static_cast<uint32_t>(target));
+        }
+        values[number] = value + "]";
+    }
+    std::string path = writeTestPdf("wavepdf_graph_random.pdf", values);
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process());
+    ASSERT_TRUE(reader.parseDocument(4));
+
+    ObjectGraph serial, parallel;
+    ASSERT_TRUE(serial.build(reader, 1));
+    ASSERT_TRUE(parallel.build(reader, 4));
+    ASSERT_EQ(serial.getEdgeCount(), parallel.getEdgeCount());
+    EXPECT_EQ(serial.getDanglingCount(), parallel.getDanglingCount());
+    for (size_t number = 1; number <= objects; number++) {
+        std::vector<uint32_t> references = edges(parallel.getReferences(number));
+        ASSERT_EQ(references, edges(serial.getReferences(number))) << number;
+        ASSERT_EQ(references, std::vector<uint32_t>(expected[number].begin(), expected[number].end())) << number;
+        ASSERT_EQ(edges(parallel.getReferrers(number)), edges(serial.getReferrers(number))) << number;
+    }
+
+    std::vector<size_t> roots{1, 2, 3};
+    EXPECT_EQ(serial.distances(roots, 1), parallel.distances(roots, 4));
+    std::vector<uint8_t> reachable = parallel.reachable(roots, 4);
+    for (size_t number = 1; number <= objects; number += 97) {
+        bool fromRoot = parallel.reaches(1, number) || parallel.reaches(2, number) || parallel.reaches(3, number);
+        EXPECT_EQ(static_cast<bool>(reachable[parallel.getNode(number)]), fromRoot) << number;
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(ObjectGraphTest, SparseNumbersAndSectionKeys) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    // Numbers beyond the dense number -> node table, & a trailer key of the xref section referring to an object
+    std::string path = writeTestPdf("wavepdf_graph_sparse.pdf", {
+        {1, "<< /Type /Catalog /Next 200000 0 R >>"},
+        {2, "12"},
+        {200000, "<< /Back 1 0 R /Far 300000 0 R >>"},
+        {300000, "[200000 0 R]"},
+    }, "/Root 1 0 R /Length 2 0 R");
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process());
+    ASSERT_TRUE(reader.parseDocument());
+    ObjectGraph graph;
+    ASSERT_TRUE(graph.build(reader));
+
+    EXPECT_EQ(graph.getNodeCount(), 4u);
+    EXPECT_EQ(graph.getNumbers(), (std::vector<uint32_t>{1, 2, 200000, 300000}));
+    EXPECT_EQ(graph.getNode(300000), 3u);
+    EXPECT_EQ(graph.getNode(250000), GRAPH_NO_NODE);
+    EXPECT_EQ(edges(graph.getReferences(200000)), (std::vector<uint32_t>{1, 300000}));
+    EXPECT_EQ(edges(graph.getReferrers(200000)), (std::vector<uint32_t>{1, 300000}));
+    EXPECT_EQ(graph.cycles(), (std::vector<std::vector<size_t>>{{1, 200000, 300000}}));
+
+    EXPECT_EQ(ObjectGraph::trailerRoots(reader), std::vector<size_t>{1});
+    EXPECT_EQ(graph.reachable(ObjectGraph::trailerRoots(reader)), (std::vector<uint8_t>{1, 0, 1, 1}));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,148 @@
+#include "../src/utility/parser/Lexer.h"
+#include "../src/utility/Buffer.h"
+#include <wx/wx.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static std::vector<Token> lexAll(std::string_view data, std::vector<LexerStatus>* errors = nullptr) {
+    Lexer lexer(data);
+    std::vector<Token> tokens;
+    Token token;
+    LexerStatus status;
+    while ((status = lexer.next(token)) != LEX_END) {
+        if (status == LEX_OK) tokens.push_back(token);
+        else if (errors) errors->push_back(status);
+    }
+    return tokens;
+}
+
+TEST(LexerTest, AllTokenTypes) {
+    // The NUL is whitespace, the literal is taken at its full length so the name after it is lexed too
+    static const char input[] =
+        "<< /Type /Page /Kids [1 0 R] >> (str) <4142> { } true false null obj\n"
+        "% comment until the end of the line\r"
+        "-17 +3 4. -.002 0.5\t\f\x00/A#42";
+    std::vector<Token> tokens = lexAll(std::string_view(input, sizeof(input) - 1));
+    std::vector<TokenType> expected = {
+        TOKEN_DICTIONARY_BEGIN, TOKEN_NAME, TOKEN_NAME, TOKEN_NAME, TOKEN_ARRAY_BEGIN, TOKEN_INTEGER, TOKEN_INTEGER,
+        TOKEN_KEYWORD, TOKEN_ARRAY_END, TOKEN_DICTIONARY_END, TOKEN_STRING_LITERAL, TOKEN_STRING_HEXADECIMAL,
+        TOKEN_PROCEDURE_BEGIN, TOKEN_PROCEDURE_END, TOKEN_TRUE, TOKEN_FALSE, TOKEN_NULL, TOKEN_KEYWORD,
+        TOKEN_INTEGER, TOKEN_INTEGER, TOKEN_REAL, TOKEN_REAL, TOKEN_REAL, TOKEN_NAME
+    };
+    ASSERT_EQ(tokens.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(tokens[i].type, expected[i]) << "token " << i << " " << tokens[i].text;
+    }
+
+    EXPECT_EQ(tokens[1].text, "Type");
+    EXPECT_EQ(tokens[1].start, size_t(3));
+    EXPECT_EQ(tokens[1].end, size_t(8));
+    EXPECT_EQ(tokens[10].text, "str");
+    EXPECT_EQ(tokens[11].text, "4142");
+    EXPECT_EQ(tokens[17].text, "obj");
+    EXPECT_EQ(tokens[18].integer, -17);
+    EXPECT_EQ(tokens[19].integer, 3);
+    EXPECT_DOUBLE_EQ(tokens[20].real, 4.0);
+    EXPECT_DOUBLE_EQ(tokens[21].real, -0.002);
+    EXPECT_DOUBLE_EQ(tokens[22].real, 0.5);
+    EXPECT_EQ(tokens[23].text, "A#42");
+    EXPECT_TRUE(tokens[23].escaped);
+    EXPECT_EQ(tokens[23].end, sizeof(input) - 1);
+}
+
+TEST(LexerTest, NullByteIsWhitespace) {
+    std::string data("/A#42\0/B", 8);
+    std::vector<Token> tokens = lexAll(data);
+    ASSERT_EQ(tokens.size(), size_t(2));
+    EXPECT_TRUE(tokens[0].escaped);
+    std::string name;
+    Lexer::decodeName(tokens[0].text, name);
+    EXPECT_EQ(name, "AB");
+    EXPECT_EQ(tokens[1].text, "B");
+}
+
+TEST(LexerTest, StringDecoding) {
+    std::vector<Token> tokens = lexAll("(a (nested) \\(escaped\\) \\101\\n\\\nline\r\nend) <48 65 6c 6C 6f 7>");
+    ASSERT_EQ(tokens.size(), size_t(2));
+    EXPECT_TRUE(tokens[0].escaped);
+
+    std::string value;
+    Lexer::decodeLiteralString(tokens[0].text, value);
+    EXPECT_EQ(value, "a (nested) (escaped) A\nline\nend");
+    Lexer::decodeHexString(tokens[1].text, value);
+    EXPECT_EQ(value, "Hellop");
+}
+
+TEST(LexerTest, ErrorsAreReportedAndSkipped) {
+    std::vector<LexerStatus> errors;
+    std::vector<Token> tokens = lexAll(") /A > - <4G> /B (unterminated", &errors);
+    std::vector<LexerStatus> expected = {LEX_UNEXPECTED_CHAR, LEX_UNEXPECTED_CHAR, LEX_INVALID_NUMBER, LEX_INVALID_HEX, LEX_UNTERMINATED_STRING};
+    EXPECT_EQ(errors, expected);
+    ASSERT_EQ(tokens.size(), size_t(2));
+    EXPECT_EQ(tokens[0].text, "A");
+    EXPECT_EQ(tokens[1].text, "B");
+}
+
+TEST(LexerTest, ReferencesAndLargeNumbers) {
+    Lexer lexer("12 0 R 12 0 obj -1 0 R 99999999999999999999");
+    Token token;
+    uint16_t generation = 1;
+    ASSERT_EQ(lexer.next(token), LEX_OK);
+    EXPECT_TRUE(lexer.readReferenceTail(token, generation));
+    EXPECT_EQ(generation, 0);
+
+    // Not a reference, nothing consumed
+    ASSERT_EQ(lexer.next(token), LEX_OK);
+    EXPECT_FALSE(lexer.readReferenceTail(token, generation));
+    ASSERT_EQ(lexer.next(token), LEX_OK);
+    EXPECT_EQ(token.integer, 0);
+    ASSERT_EQ(lexer.next(token), LEX_OK);
+    EXPECT_EQ(token.text, "obj");
+
+    // Signed numbers are never object numbers
+    ASSERT_EQ(lexer.next(token), LEX_OK);
+    EXPECT_FALSE(lexer.readReferenceTail(token, generation));
+    lexer.next(token);
+    lexer.next(token);
+
+    // Beyond 64 bit as real
+    ASSERT_EQ(lexer.next(token), LEX_OK);
+    EXPECT_EQ(token.type, TOKEN_REAL);
+    EXPECT_DOUBLE_EQ(token.real, 1e20);
+    EXPECT_EQ(lexer.next(token), LEX_END);
+}
+
+TEST(LexerTest, WindowGrowsForLargeObjects) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // Array much larger than the initial window, lexed through a windowed buffer
+    std::string data = "[";
+    for (int i = 0; i < 5000; i++) data += std::to_string(i) + " ";
+    data += "]";
+    std::string path = (std::filesystem::temp_directory_path() / "wavepdf_test_lexer_window.txt").string();
+    std::ofstream(path, std::ios::binary) << data;
+
+    BufferOptions options;
+    options.mode = BUFFER_WINDOWED;
+    options.blockSize = 1024;
+    Buffer buffer(path, options);
+    ASSERT_TRUE(buffer.isReady());
+    ASSERT_FALSE(buffer.isContiguous());
+
+    size_t count = lexFrom(buffer, 0, [](Lexer& lexer) {
+        size_t integers = 0;
+        Token token;
+        while (lexer.next(token) == LEX_OK && token.type != TOKEN_ARRAY_END) {
+            if (token.type == TOKEN_INTEGER) integers++;
+        }
+        return integers;
+    });
+    EXPECT_EQ(count, size_t(5000));
+    EXPECT_EQ(buffer.getPosition(), data.size());
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,140 @@
+#include "../src/utility/loading/DocumentLoader.h"
+#include "../src/utility/objects/IntegerObject.h"
+#include "TestPdf.h"
+#include <wx/wx.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Catalog, page tree with the given pages & one content stream per page
+static std::string writePagedDocument(const std::string& name, size_t pageCount) {
+    std::map<size_t, std::string> objects;
+    objects[1] = "<< /Type /Catalog /Pages 2 0 R >>";
+    objects[3] = "<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>";
+    std::string kids;
+    for (size_t i = 0; i < pageCount; i++) {
+        size_t page = 10 + 2 * i;
+        std::string content = "BT /F1 12 Tf (Page " + std::to_string(i) + ") Tj ET";
+        objects[page] = "<< /Type /Page /Parent 2 0 R /PageIndex " + std::to_string(i) + " /Contents " + std::to_string(page + 1) + " 0 R >>";
+        objects[page + 1] = "<< /Length " + std::to_string(content.size()) + " >>\nstream\n" + content + "\nendstream";
+        kids += std::to_string(page) + " 0 R ";
+    }
+    objects[2] = "<< /Type /Pages /Count " + std::to_string(pageCount) + " /Kids [" + kids + "] /Resources << /Font << /F1 3 0 R >> >> >>";
+    return writeTestPdf(name, objects);
+}
+
+TEST(DocumentLoaderTest, FirstPageBeforeObjects) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    std::string path = writePagedDocument("wavepdf_loading_pages.pdf", 3000);
+
+    std::mutex lock;
+    std::vector<LoadStage> stages;
+    size_t objectsDone = 0;
+    bool progressMonotonic = true;
+    FirstPage first;
+    bool firstBeforeObjects = false;
+
+    LoadOptions options;
+    options.threads = 2;
+    DocumentLoader loader(options);
+    std::future<LoadedDocument> future = loader.start(path, [&](const LoadProgress& progress) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (stages.empty() || stages.back() != progress.stage) stages.push_back(progress.stage);
+        if (progress.stage == LOAD_OBJECTS) {
+            progressMonotonic = progressMonotonic && progress.objectsDone >= objectsDone && progress.objectsDone <= progress.objectCount;
+            objectsDone = progress.objectsDone;
+        }
+    }, [&](const FirstPage& page) {
+        std::lock_guard<std::mutex> guard(lock);
+        first = page;
+        firstBeforeObjects = std::find(stages.begin(), stages.end(), LOAD_OBJECTS) == stages.end();
+    });
+
+    LoadedDocument document = future.get();
+    // Over as soon as the result is there, even while the thread still reports the last stage
+    EXPECT_FALSE(loader.isRunning());
+    loader.join();
+    ASSERT_EQ(document.stage, LOAD_DONE) << document.log;
+    EXPECT_EQ(stages, (std::vector<LoadStage>{LOAD_INDEX, LOAD_FIRST_PAGE, LOAD_OBJECTS, LOAD_DONE}));
+    EXPECT_TRUE(progressMonotonic);
+
+    EXPECT_TRUE(firstBeforeObjects);
+    EXPECT_EQ(first.pageCount, 3000u);
+    EXPECT_EQ(first.page.number, 10u);
+    EXPECT_EQ(first.content, "BT /F1 12 Tf (Page 0) Tj ET");
+
+    // Reader & page tree are handed over ready to use, every object parsed
+    ASSERT_NE(document.reader, nullptr);
+    ASSERT_NE(document.pages, nullptr);
+    std::optional<Page> last = document.pages->getPage(2999);
+    ASSERT_TRUE(last.has_value());
+    EXPECT_EQ(std::dynamic_pointer_cast<IntegerObject>(last->dictionary->getElement("PageIndex"))->getValue(), 2999);
+    EXPECT_EQ(document.reader->getDocumentObject(10 + 2 * 2999).getType(), OBJT_DICTIONARY);
+    std::filesystem::remove(path);
+}
+
+TEST(DocumentLoaderTest, Cancel) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    std::string path = writePagedDocument("wavepdf_loading_cancel.pdf", 100);
+
+    // Cancelled while the xref is read, & once the first page is there
+    for (LoadStage cancelAt: {LOAD_INDEX, LOAD_FIRST_PAGE}) {
+        DocumentLoader loader;
+        std::vector<LoadStage> stages;
+        bool firstPage = false;
+        std::future<LoadedDocument> future = loader.start(path, [&](const LoadProgress& progress) {
+            stages.push_back(progress.stage);
+            if (progress.stage == LOAD_INDEX && cancelAt == LOAD_INDEX) loader.cancel();
+        }, [&](const FirstPage&) {
+            firstPage = true;
+            if (cancelAt == LOAD_FIRST_PAGE) loader.cancel();
+        });
+        LoadedDocument document = future.get();
+        loader.join();
+
+        EXPECT_EQ(document.stage, LOAD_CANCELLED);
+        EXPECT_EQ(document.reader, nullptr);
+        EXPECT_EQ(firstPage, cancelAt == LOAD_FIRST_PAGE);
+        EXPECT_EQ(std::find(stages.begin(), stages.end(), LOAD_OBJECTS), stages.end());
+        EXPECT_EQ(stages.back(), LOAD_CANCELLED);
+
+        // The loader can be started again after a cancelled load
+        std::future<LoadedDocument> again = loader.start(path);
+        EXPECT_EQ(again.get().stage, LOAD_DONE);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(DocumentLoaderTest, Failures) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    DocumentLoader loader;
+    LoadStage reported = LOAD_INDEX;
+    LoadedDocument missing = loader.start("../tests/samples/missing.pdf", [&reported](const LoadProgress& progress) {
+        reported = progress.stage;
+    }).get();
+    loader.join();
+    EXPECT_EQ(missing.stage, LOAD_FAILED);
+    EXPECT_EQ(reported, LOAD_FAILED);
+    EXPECT_FALSE(missing.errorMessage.empty());
+    EXPECT_EQ(missing.reader, nullptr);
+
+    // Parsing stops between grains once cancelled, the arena model is dropped
+    PdfReader reader("../tests/samples/sample.pdf");
+    ASSERT_TRUE(reader.process());
+    ReaderControl control;
+    control.cancelled = true;
+    reader.setControl(&control);
+    EXPECT_FALSE(reader.parseDocument(2));
+    EXPECT_EQ(reader.getErrorMessage(), "Loading cancelled");
+    EXPECT_EQ(reader.getDocumentObject(1).getType(), OBJT_NULL);
+    reader.setControl(nullptr);
+    EXPECT_TRUE(reader.parseDocument(2));
+}
@@ -0,0 +1,199 @@
+#include "../src/utility/Buffer.h"
+#include "../src/utility/objects/ObjectArena.h"
+#include "../src/utility/objects/Value.h"
+#include "../src/utility/objects/NameManager.h"
+#include "../src/utility/objects/NameObject.h"
+#include "../src/utility/objects/DictionaryObject.h"
+#include "../src/utility/objects/IntegerObject.h"
+#include "../src/utility/parser/ValueParser.h"
+#include "../src/utility/parser/StreamBounds.h"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+TEST(ValueParserTest, ParsesAllValueTypes) {
+    std::unique_ptr<Buffer> buffer = Buffer::fromData(
+        "<< /Type /Font /Widths [250 333.5 -1 ] /Name#20Escaped (a (nested\\) string)) /Hex <48656C6C6F>\n"
+        "   % comment\n /Flags true /Missing null /Parent 12 0 R /Nested << /A [ [ 1 ] ] >> >>");
+    ObjectArena arena;
+    NameScope names;
+    ValueParser parser(arena, names);
+
+    Value dict = parser.parse(*buffer, 0);
+    ASSERT_EQ(dict.getType(), OBJT_DICTIONARY);
+    EXPECT_EQ(dict.size(), size_t(8));
+    EXPECT_EQ(dict.find("Type")->getString(), "Font");
+
+    const Value* widths = dict.find("Widths");
+    ASSERT_NE(widths, nullptr);
+    ASSERT_EQ(widths->size(), size_t(3));
+    EXPECT_EQ(widths->getItems()[0].getInteger(), 250);
+    EXPECT_DOUBLE_EQ(widths->getItems()[1].getReal(), 333.5);
+    EXPECT_EQ(widths->getItems()[2].getInteger(), -1);
+
+    EXPECT_NE(dict.find("Name Escaped"), nullptr);
+    EXPECT_EQ(dict.find("Name Escaped")->getString(), "a (nested\\) string)");
+    EXPECT_EQ(dict.find("Hex")->getType(), OBJT_STRING_HEXADECIMAL);
+    EXPECT_EQ(dict.find("Hex")->getString(), "48656C6C6F");
+    EXPECT_TRUE(dict.find("Flags")->getBoolean());
+    EXPECT_TRUE(dict.find("Missing")->isNull());
+
+    const Value* parent = dict.find("Parent");
+    ASSERT_EQ(parent->getType(), OBJT_INDIRECT);
+    EXPECT_EQ(parent->getNumber(), size_t(12));
+    EXPECT_EQ(parent->getGeneration(), 0);
+
+    const Value* nested = dict.find("Nested")->find("A");
+    ASSERT_NE(nested, nullptr);
+    EXPECT_EQ(nested->getItems()[0].getItems()[0].getInteger(), 1);
+
+    // Everything lives in the arena & is dropped at once
+    EXPECT_GT(arena.getBytesUsed(), size_t(0));
+    arena.release();
+    EXPECT_EQ(arena.getBytesUsed(), size_t(0));
+    EXPECT_EQ(arena.getBytesReserved(), size_t(0));
+}
+
+TEST(ValueParserTest, ParsesIndirectStreams) {
+    std::unique_ptr<Buffer> buffer = Buffer::fromData(
+        "7 0 obj\n<< /Length 5 >>\nstream\r\nHello\nendstream\nendobj\n"
+        "8 0 obj\n<< /Length 9 0 R >>\nstream\nWorld!\nendstream\nendobj\n");
+    ObjectArena arena;
+    NameScope names;
+    ValueParser parser(arena, names);
+
+    Value first = parser.parseIndirect(*buffer, 0);
+    ASSERT_EQ(first.getType(), OBJT_STREAM);
+    EXPECT_EQ(first.getStream()->dataStart, size_t(32));
+    EXPECT_EQ(first.getStream()->dataLength, size_t(5));
+    EXPECT_EQ(first.find("Length")->getInteger(), 5);
+
+    // Unresolved indirect lengths fall back to searching endstream
+    Value second = parser.parseIndirect(*buffer, 55);
+    ASSERT_EQ(second.getType(), OBJT_STREAM);
+    EXPECT_EQ(second.getStream()->dataLength, size_t(6));
+
+    int resolved = 0;
+    second = parser.parseIndirect(*buffer, 55, [&](size_t number, uint16_t) -> std::optional<int64_t> {
+        resolved++;
+        EXPECT_EQ(number, size_t(9));
+        return 6;
+    });
+    EXPECT_EQ(resolved, 1);
+    EXPECT_EQ(second.getStream()->dataLength, size_t(6));
+
+    EXPECT_EQ(parser.parseIndirect(*buffer, 3).getType(), OBJT_INVALID);
+}
+
+TEST(StreamBoundsTest, SearchesEndstreamWindowByWindow) {
+    // endstream across the border of the first two search windows, a long tail after it
+    std::string data(STREAM_SEARCH_WINDOW - 4, 'x');
+    data += "\r\nendstream\nendobj\n" + std::string(16 * STREAM_SEARCH_WINDOW, 'y');
+    std::unique_ptr<Buffer> memory = Buffer::fromData(data);
+    EXPECT_EQ(StreamBounds::findDataLength(*memory, 0, std::nullopt), STREAM_SEARCH_WINDOW - 4);
+    // A /Length without endstream after it is searched past too
+    EXPECT_EQ(StreamBounds::findDataLength(*memory, 0, 10), STREAM_SEARCH_WINDOW - 4);
+    EXPECT_EQ(StreamBounds::findDataLength(*memory, STREAM_SEARCH_WINDOW + 10, std::nullopt), std::string::npos);
+
+    std::string path = (std::filesystem::temp_directory_path() / "wavepdf_stream_search.bin").string();
+    std::ofstream(path, std::ios::binary) << data;
+    BufferOptions options;
+    options.mode = BUFFER_WINDOWED;
+    options.blockSize = 4096;
+    options.memoryCap = 4 * 4096;
+    Buffer windowed(path, options);
+    ASSERT_TRUE(windowed.isReady());
+    EXPECT_EQ(StreamBounds::findDataLength(windowed, 0, std::nullopt), STREAM_SEARCH_WINDOW - 4);
+    // Only the windows up to the first endstream are read
+    EXPECT_LT(windowed.getStats().bytesRead, 3 * STREAM_SEARCH_WINDOW);
+    std::filesystem::remove(path);
+}
+
+TEST(NameManagerTest, InternsNamesOnce) {
+    NameManager& names = NameManager::global();
+
+    // Known names are seeded with fixed atoms
+    EXPECT_EQ(names.find("Type"), NAME_TYPE);
+    EXPECT_EQ(names.find("Length"), NAME_LENGTH);
+    EXPECT_EQ(names.find("ID"), NAME_ID);
+    EXPECT_EQ(names.get(NAME_FONT).value, "Font");
+
+    // New names are added once, lookups alone don't add them
+    EXPECT_EQ(names.find("WavePDFTestName"), NAME_UNKNOWN);
+    size_t size = names.size();
+    const InternedName& first = names.intern("WavePDFTestName");
+    const InternedName& second = names.intern(std::string("WavePDF") + "TestName");
+    EXPECT_EQ(&first, &second);
+    EXPECT_EQ(names.size(), size + 1);
+    EXPECT_EQ(names.find("WavePDFTestName"), first.atom);
+}
+
+TEST(NameManagerTest, ScopesReleaseTheirNames) {
+    NameManager names;
+    size_t seeded = names.size();
+    NameAtom atom;
+    {
+        NameScope first(names), second(names);
+        const InternedName& held = first.intern("WavePDFScoped");
+        atom = held.atom;
+        EXPECT_EQ(&second.intern("WavePDFScoped"), &held);
+        // Known names & names the table keeps are shared, not held by the scopes alone
+        EXPECT_EQ(first.intern("Type").atom, NAME_TYPE);
+        names.intern("WavePDFPinned");
+        EXPECT_EQ(first.intern("WavePDFPinned").atom, names.find("WavePDFPinned"));
+        EXPECT_EQ(first.size(), 3u);
+        EXPECT_EQ(names.size(), seeded + 2);
+        {
+            NameScope third(names);
+            third.intern("WavePDFScoped");
+        }
+        EXPECT_EQ(names.find("WavePDFScoped"), atom);
+    }
+    // Released once no scope holds it, the atom goes to the next new name
+    EXPECT_EQ(names.find("WavePDFScoped"), NAME_UNKNOWN);
+    EXPECT_NE(names.find("WavePDFPinned"), NAME_UNKNOWN);
+    EXPECT_EQ(names.find("Type"), NAME_TYPE);
+    EXPECT_EQ(names.size(), seeded + 1);
+    NameScope next(names);
+    EXPECT_EQ(next.intern("WavePDFOther").atom, atom);
+    EXPECT_EQ(names.get(atom).value, "WavePDFOther");
+}
+
+TEST(NameManagerTest, DictionaryKeysCompareByName) {
+    // Two separately parsed /Type keys are the same key
+    DictionaryObject dict(0);
+    dict.addElement(std::make_shared<NameObject>(3, 7, "Type"), std::make_shared<IntegerObject>(9, 9, 1));
+    dict.addElement(std::make_shared<NameObject>(11, 15, "Size"), std::make_shared<IntegerObject>(17, 18, 10));
+    dict.addElement(std::make_shared<NameObject>(20, 24, "Type"), std::make_shared<IntegerObject>(26, 26, 2));
+
+    EXPECT_EQ(dict.getElements().size(), size_t(2));
+    ASSERT_NE(dict.getElement(NAME_TYPE), nullptr);
+    EXPECT_EQ(std::dynamic_pointer_cast<IntegerObject>(dict.getElement("Type"))->getValue(), 2);
+    EXPECT_NE(dict.getElement(NAME_SIZE), nullptr);
+    EXPECT_EQ(dict.getElement("NeverSeenKey"), nullptr);
+    EXPECT_EQ(*std::make_shared<NameObject>(0, 4, "Size"), *std::make_shared<NameObject>(5, 9, "Size"));
+}
+
+TEST(ObjectArenaTest, ResetKeepsCurrentBlock) {
+    ObjectArena arena(1024);
+    arena.allocate(100, 8);
+    // Large allocation gets a block of its own
+    arena.allocate(4096, 8);
+    EXPECT_EQ(arena.getBytesReserved(), size_t(1024 + 4096 + 8));
+
+    arena.reset();
+    EXPECT_EQ(arena.getBytesUsed(), size_t(0));
+    EXPECT_EQ(arena.getBytesReserved(), size_t(1024));
+
+    // Values after the reset reuse the kept block
+    std::string_view copy = arena.copyString("reused");
+    EXPECT_EQ(copy, "reused");
+    EXPECT_EQ(arena.getBytesReserved(), size_t(1024));
+
+    ObjectArena empty;
+    empty.reset();
+    EXPECT_EQ(empty.getBytesReserved(), size_t(0));
+}
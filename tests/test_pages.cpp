@@ -0,0 +1,168 @@
+#include "../src/utility/pages/PageTree.h"
+#include "../src/utility/PdfReader.h"
+#include "../src/utility/objects/ArrayObject.h"
+#include "../src/utility/objects/IntegerObject.h"
+#include "../src/utility/objects/ReferenceObject.h"
+#include "TestPdf.h"
+#include <wx/wx.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <map>
+#include <string>
+
+static int64_t pageIndex(const Page& page) {
+    std::shared_ptr<IntegerObject> index = std::dynamic_pointer_cast<IntegerObject>(page.dictionary->getElement("PageIndex"));
+    return index ? index->getValue() : -1;
+}
+
+static std::string describeBox(const std::shared_ptr<BaseObject>& box) {
+    std::shared_ptr<ArrayObject> array = std::dynamic_pointer_cast<ArrayObject>(box);
+    if (!array) return "";
+    std::string text;
+    for (const std::shared_ptr<BaseObject>& value: array->getObjects()) {
+        std::shared_ptr<IntegerObject> integer = std::dynamic_pointer_cast<IntegerObject>(value);
+        text += (text.empty() ? "" : " ") + (integer ? std::to_string(integer->getValue()) : "?");
+    }
+    return text;
+}
+
+TEST(PageTreeTest, IrregularTree) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // Empty node, node without /Type, attributes on several levels & pages overriding them
+    std::string path = writeTestPdf("wavepdf_pagetree_irregular.pdf", {
+        {1, "<< /Type /Catalog /Pages 2 0 R >>"},
+        {2, "<< /Type /Pages /Count 7 /Kids [3 0 R 4 0 R 5 0 R 6 0 R] /MediaBox [0 0 612 792] /Resources 20 0 R >>"},
+        {3, "<< /Type /Page /Parent 2 0 R /PageIndex 0 >>"},
+        {4, "<< /Type /Pages /Parent 2 0 R /Count 0 /Kids [] >>"},
+        {5, "<< /Parent 2 0 R /Count 5 /Kids [7 0 R 8 0 R 9 0 R] /Rotate 90 >>"},
+        {6, "<< /Type /Page /Parent 2 0 R /PageIndex 6 /Resources << >> >>"},
+        {7, "<< /Type /Page /Parent 5 0 R /PageIndex 1 >>"},
+        {8, "<< /Type /Pages /Parent 5 0 R /Count 3 /Kids [10 0 R 11 0 R 12 0 R] /MediaBox [0 0 100 100] >>"},
+        {9, "<< /Type /Page /Parent 5 0 R /PageIndex 5 >>"},
+        {10, "<< /Type /Page /Parent 8 0 R /PageIndex 2 >>"},
+        {11, "<< /Type /Page /Parent 8 0 R /PageIndex 3 /Rotate 0 >>"},
+        {12, "<< /Type /Page /Parent 8 0 R /PageIndex 4 >>"},
+        {20, "<< /Font << >> >>"}
+    });
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process()) << reader.getLog();
+
+    // Same pages in any lookup order
+    for (bool reverse: {false, true}) {
+        PageTree tree(reader);
+        EXPECT_EQ(tree.getPageCount(), 7u);
+        for (size_t i = 0; i < 7; i++) {
+            size_t index = reverse ? 6 - i : i;
+            std::optional<Page> page = tree.getPage(index);
+            ASSERT_TRUE(page.has_value()) << index;
+            EXPECT_EQ(pageIndex(page.value()), static_cast<int64_t>(index));
+        }
+        EXPECT_FALSE(tree.getPage(7).has_value());
+    }
+
+    PageTree tree(reader);
+    std::optional<Page> page = tree.getPage(2);
+    ASSERT_TRUE(page.has_value());
+    EXPECT_EQ(page->number, 10u);
+    EXPECT_EQ(describeBox(page->attributes.mediaBox), "0 0 100 100");
+    EXPECT_EQ(std::dynamic_pointer_cast<IntegerObject>(page->attributes.rotate)->getValue(), 90);
+    // Inherited references stay references
+    std::shared_ptr<ReferenceObject> resources = std::dynamic_pointer_cast<ReferenceObject>(page->attributes.resources);
+    ASSERT_NE(resources, nullptr);
+    EXPECT_EQ(resources->getNumber(), 20u);
+
+    EXPECT_EQ(std::dynamic_pointer_cast<IntegerObject>(tree.getPage(3)->attributes.rotate)->getValue(), 0);
+    EXPECT_EQ(describeBox(tree.getPage(5)->attributes.mediaBox), "0 0 612 792");
+    EXPECT_EQ(tree.getPage(6)->attributes.resources->getType(), OBJT_DICTIONARY);
+    EXPECT_EQ(tree.getPage(0)->attributes.rotate, nullptr);
+    std::filesystem::remove(path);
+}
+
+TEST(PageTreeTest, LookupLoadsOnlyThePath) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // 20 x 20 x 50 = 20000 pages
+    std::map<size_t, std::string> objects{{1, ""}};
+    std::string rootKids;
+    size_t next = 3, page = 0;
+    for (size_t a = 0; a < 20; a++) {
+        size_t middle = next++;
+        std::string middleKids;
+        for (size_t b = 0; b < 20; b++) {
+            size_t lower = next++;
+            std::string lowerKids;
+            for (size_t c = 0; c < 50; c++) {
+                objects[next] = "<< /Type /Page /Parent " + std::to_string(lower) + " 0 R /PageIndex " + std::to_string(page++) + " >>";
+                lowerKids += std::to_string(next++) + " 0 R ";
+            }
+            objects[lower] = "<< /Type /Pages /Parent " + std::to_string(middle) + " 0 R /Count 50 /Kids [" + lowerKids + "] >>";
+            middleKids += std::to_string(lower) + " 0 R ";
+        }
+        objects[middle] = "<< /Type /Pages /Parent 2 0 R /Count 1000 /Kids [" + middleKids + "] >>";
+        rootKids += std::to_string(middle) + " 0 R ";
+    }
+    objects[1] = "<< /Type /Catalog /Pages 2 0 R >>";
+    objects[2] = "<< /Type /Pages /Count 20000 /Kids [" + rootKids + "] /MediaBox [0 0 612 792] >>";
+    std::string path = writeTestPdf("wavepdf_pagetree_large.pdf", objects);
+
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process()) << reader.getLog();
+    PageTree tree(reader);
+    EXPECT_EQ(tree.getPageCount(), 20000u);
+
+    // Kids are counted from the nearer end, far fewer loads than the 20421 objects of the tree
+    size_t loads = tree.getStats().objectLoads;
+    std::optional<Page> target = tree.getPage(15000);
+    ASSERT_TRUE(target.has_value());
+    EXPECT_EQ(pageIndex(target.value()), 15000);
+    EXPECT_EQ(describeBox(target->attributes.mediaBox), "0 0 612 792");
+    EXPECT_LE(tree.getStats().objectLoads - loads, 60u);
+
+    // Nodes on the path are cached, a neighbour only loads its own page dictionary
+    loads = tree.getStats().objectLoads;
+    std::optional<Page> neighbour = tree.getPage(15001);
+    ASSERT_TRUE(neighbour.has_value());
+    EXPECT_EQ(pageIndex(neighbour.value()), 15001);
+    EXPECT_EQ(tree.getStats().objectLoads - loads, 1u);
+
+    for (size_t index: {0, 1, 999, 1000, 12345, 19999}) {
+        EXPECT_EQ(pageIndex(tree.getPage(index).value()), static_cast<int64_t>(index));
+    }
+    EXPECT_FALSE(tree.getPage(20000).has_value());
+    std::filesystem::remove(path);
+}
+
+TEST(PageTreeTest, BrokenTrees) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // Node listing itself as a kid & a /Count larger than its pages
+    std::string path = writeTestPdf("wavepdf_pagetree_broken.pdf", {
+        {1, "<< /Type /Catalog /Pages 2 0 R >>"},
+        {2, "<< /Type /Pages /Count 4 /Kids [3 0 R 4 0 R] >>"},
+        {3, "<< /Type /Page /Parent 2 0 R /PageIndex 0 >>"},
+        {4, "<< /Type /Pages /Parent 2 0 R /Count 3 /Kids [4 0 R 5 0 R] >>"},
+        {5, "<< /Type /Page /Parent 4 0 R /PageIndex 1 >>"}
+    });
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process()) << reader.getLog();
+    PageTree tree(reader);
+    EXPECT_EQ(tree.getPageCount(), 4u);
+    EXPECT_EQ(pageIndex(tree.getPage(0).value()), 0);
+    for (size_t index = 1; index < 4; index++) tree.getPage(index);
+    EXPECT_FALSE(tree.getPage(4).has_value());
+    std::filesystem::remove(path);
+
+    // No page tree at all
+    path = writeTestPdf("wavepdf_pagetree_missing.pdf", {{1, "<< /Type /Catalog >>"}});
+    PdfReader missing(path);
+    ASSERT_TRUE(missing.process()) << missing.getLog();
+    PageTree empty(missing);
+    EXPECT_EQ(empty.getPageCount(), 0u);
+    EXPECT_FALSE(empty.getPage(0).has_value());
+    std::filesystem::remove(path);
+}
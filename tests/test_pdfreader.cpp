@@ -1,7 +1,17 @@
 #include "../src/utility/PdfReader.h"
+#include "../src/utility/ObjectCache.h"
+#include "../src/utility/objects/IntegerObject.h"
+#include "../src/utility/objects/NameObject.h"
+#include "TestPdf.h"
 #include <wx/wx.h>
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
 TEST(PdfReaderIntegrationTest, SamplePDFProcess) {
     // wxWidgets needs an app instance
     wxInitializer initializer;
@@ -48,4 +58,648 @@ TEST(PdfReaderIntegrationTest, SamplePDFProcess) {
     subsection0.objects.push_back({17302, 0, 25, 'n'});
     xrefTable.push_back(subsection0);
     ASSERT_EQ(reader.getXRefTable(), xrefTable);
-}
\ No newline at end of file
+}
+
+TEST(PdfReaderIntegrationTest, SamplePDFProcessWindowed) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // Blocks smaller than the xref table force the read window to grow
+    BufferOptions options;
+    options.mode = BUFFER_WINDOWED;
+    options.blockSize = 256;
+    options.memoryCap = 1024;
+    PdfReader reader("../tests/samples/sample.pdf", options);
+
+    EXPECT_TRUE(reader.process()) << "PdfReader::process() failed with log: " << reader.getLog();
+    ASSERT_EQ(reader.getXRefOffset(), size_t(18132));
+    ASSERT_EQ(reader.getXRefTable().size(), size_t(1));
+    ASSERT_EQ(reader.getXRefTable()[0].objects.size(), size_t(26));
+    EXPECT_GT(reader.getBufferStats().blockMisses, size_t(0));
+}
+
+TEST(PdfReaderIntegrationTest, IncrementalUpdateChain) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // sample2.pdf with two incremental updates appended
+    PdfReader reader("../tests/samples/sample_incremental.pdf");
+    EXPECT_TRUE(reader.process()) << "PdfReader::process() failed with log: " << reader.getLog();
+    ASSERT_EQ(reader.getRevisionCount(), size_t(3));
+
+    const XRefIndex& index = reader.getXRefIndex();
+    ASSERT_EQ(index.getRevisionCount(), size_t(3));
+
+    // Object 5 was replaced by the first update
+    ASSERT_TRUE(index.lookup(5).has_value());
+    EXPECT_EQ(index.lookup(5)->entryOne, size_t(742));
+    EXPECT_EQ(index.lookup(5, 0)->entryOne, size_t(372));
+
+    // Object 6 was added by the first update & deleted by the second
+    EXPECT_EQ(index.lookup(6)->type, 'f');
+    EXPECT_EQ(index.lookup(6, 1)->entryOne, size_t(837));
+    EXPECT_EQ(index.lookup(6, 0), std::nullopt);
+
+    // Object 3 was replaced by the second update, object 1 never changed
+    EXPECT_EQ(index.lookup(3)->entryOne, size_t(1032));
+    EXPECT_EQ(index.lookup(3, 1)->entryOne, size_t(133));
+    EXPECT_EQ(index.lookup(1)->entryOne, size_t(9));
+
+    // Views bound to one revision
+    XRefRevisionView original = reader.getRevisionView(0);
+    EXPECT_EQ(original.lookup(3)->entryOne, size_t(133));
+    EXPECT_EQ(original.lookup(5)->entryOne, size_t(372));
+
+    // Trailers of each revision
+    ASSERT_NE(reader.getTrailer(), nullptr);
+    EXPECT_NE(reader.getTrailer()->getElement("Prev"), nullptr);
+    EXPECT_NE(reader.getTrailer(1)->getElement("Info"), nullptr);
+    EXPECT_EQ(reader.getTrailer(0)->getElement("Prev"), nullptr);
+}
+
+TEST(PdfReaderIntegrationTest, XRefStreamWithObjectStreams) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // PDF 1.5 file with a Flate + PNG predictor xref stream & an object stream (6 0 obj)
+    PdfReader reader("../tests/samples/sample_xrefstream.pdf");
+    EXPECT_TRUE(reader.process()) << "PdfReader::process() failed with log: " << reader.getLog();
+    ASSERT_EQ(reader.getXRefOffset(), size_t(925));
+
+    const XRefIndex& index = reader.getXRefIndex();
+    ASSERT_EQ(index.getEntryCount(), size_t(9));
+    EXPECT_EQ(index.lookup(0)->type, 'f');
+    EXPECT_EQ(index.lookup(4)->type, 'n');
+    EXPECT_EQ(index.lookup(4)->entryOne, size_t(527));
+    EXPECT_EQ(index.lookup(7)->entryOne, size_t(925));
+
+    // Compressed objects point to their object stream & index in it
+    ASSERT_EQ(index.lookup(5)->type, 'c');
+    EXPECT_EQ(index.lookup(5)->entryOne, size_t(6));
+    EXPECT_EQ(index.lookup(5)->streamIndex, size_t(3));
+
+    // The stream dictionary is the trailer
+    ASSERT_NE(reader.getTrailer(), nullptr);
+    EXPECT_NE(reader.getTrailer()->getElement("Root"), nullptr);
+}
+
+TEST(PdfReaderIntegrationTest, LazyObjectResolution) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    PdfReader reader("../tests/samples/sample_xrefstream.pdf");
+    EXPECT_TRUE(reader.process()) << "PdfReader::process() failed with log: " << reader.getLog();
+
+    // Catalog is stored in the object stream, its /Pages reference resolves to the pages dictionary
+    std::shared_ptr<DictionaryObject> catalog = std::dynamic_pointer_cast<DictionaryObject>(reader.getObject(1));
+    ASSERT_NE(catalog, nullptr);
+    std::shared_ptr<BaseObject> pages = reader.resolve(catalog->getElement("Pages"));
+    ASSERT_NE(pages, nullptr);
+    EXPECT_EQ(pages->getType(), OBJT_DICTIONARY);
+
+    // Content stream with an indirect /Length
+    std::shared_ptr<StreamObject> content = std::dynamic_pointer_cast<StreamObject>(reader.getObject(4));
+    ASSERT_NE(content, nullptr);
+    EXPECT_EQ(content->getDataStart(), size_t(527 + 56));
+
+    // Second access is served from the cache, wrong generations & free objects are null
+    size_t parsed = reader.getObjectCacheStats().objectsParsed;
+    EXPECT_EQ(reader.getObject(1), catalog);
+    EXPECT_EQ(reader.getObjectCacheStats().objectsParsed, parsed);
+    EXPECT_GE(reader.getObjectCacheStats().hits, size_t(1));
+    EXPECT_EQ(reader.getObject(1, 1), nullptr);
+    EXPECT_EQ(reader.getObject(0), nullptr);
+    EXPECT_EQ(reader.getObject(100), nullptr);
+
+    // Tight limits evict older objects, which are parsed again on the next access
+    reader.setObjectCacheLimits(2, 1024 * 1024);
+    EXPECT_LE(reader.getObjectCacheStats().cachedObjects, size_t(2));
+    EXPECT_GE(reader.getObjectCacheStats().evictions, size_t(1));
+    reader.getObject(2);
+    reader.getObject(3);
+    reader.getObject(5);
+    parsed = reader.getObjectCacheStats().objectsParsed;
+    ASSERT_NE(reader.getObject(2), nullptr);
+    EXPECT_EQ(reader.getObjectCacheStats().objectsParsed, parsed + 1);
+}
+
+TEST(ObjectCacheTest, StreamsCostTheirDictionary) {
+    // A 16 MB image doesn't push the other objects out of a 1 MB cache
+    ObjectCache cache(16, 1024 * 1024);
+    cache.put(1, 0, std::make_shared<IntegerObject>(0, 10, 1));
+    cache.put(2, 0, std::make_shared<StreamObject>(100, 100 + 64 + 16 * 1024 * 1024, std::make_shared<DictionaryObject>(100), 164, 16 * 1024 * 1024));
+    EXPECT_EQ(cache.getStats().evictions, size_t(0));
+    EXPECT_NE(cache.get(1, 0), nullptr);
+    EXPECT_NE(cache.get(2, 0), nullptr);
+}
+
+TEST(PdfReaderIntegrationTest, ReferenceCycles) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // 2 0 obj & 3 0 obj reference each other, 4 0 obj is a stream whose /Length references itself
+    PdfReader reader("../tests/samples/sample_cycles.pdf");
+    EXPECT_TRUE(reader.process()) << "PdfReader::process() failed with log: " << reader.getLog();
+
+    EXPECT_EQ(reader.resolve(reader.getObject(2)), nullptr);
+    EXPECT_GE(reader.getObjectCacheStats().cyclesDetected, size_t(1));
+
+    // The stream is still found by searching for endstream
+    std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(reader.getObject(4));
+    ASSERT_NE(stream, nullptr);
+    EXPECT_EQ(stream->getDataLength(), size_t(3));
+    EXPECT_GE(reader.getObjectCacheStats().cyclesDetected, size_t(2));
+}
+
+TEST(PdfReaderIntegrationTest, ArenaDocument) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    PdfReader reader("../tests/samples/sample_xrefstream.pdf");
+    EXPECT_TRUE(reader.process()) << "PdfReader::process() failed with log: " << reader.getLog();
+    ASSERT_TRUE(reader.parseDocument()) << reader.getLog();
+
+    // Objects from the object stream & from the file itself
+    const Value& catalog = reader.getDocumentObject(1);
+    ASSERT_EQ(catalog.getType(), OBJT_DICTIONARY);
+    EXPECT_EQ(catalog.find("Type")->getString(), "Catalog");
+    EXPECT_EQ(catalog.find("Pages")->getNumber(), size_t(2));
+    EXPECT_EQ(reader.getDocumentObject(3).find("MediaBox")->size(), size_t(4));
+
+    const Value& content = reader.getDocumentObject(4);
+    ASSERT_EQ(content.getType(), OBJT_STREAM);
+    EXPECT_EQ(content.getStream()->dataStart, size_t(527 + 56));
+    EXPECT_EQ(static_cast<int64_t>(content.getStream()->dataLength), reader.getDocumentObject(8).getInteger());
+
+    EXPECT_TRUE(reader.getDocumentObject(0).isNull());
+    EXPECT_TRUE(reader.getDocumentObject(1000).isNull());
+
+    reader.releaseDocument();
+    EXPECT_EQ(reader.getArena().getBytesReserved(), size_t(0));
+    EXPECT_TRUE(reader.getDocumentObject(1).isNull());
+}
+
+TEST(PdfReaderIntegrationTest, ParallelArenaDocument) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // Enough objects for every worker to get several grains, every 100th one much larger
+    std::string pdf = "%PDF-1.7\n";
+    std::vector<size_t> offsets;
+    for (size_t i = 1; i <= 3000; i++) {
+        offsets.push_back(pdf.size());
+        pdf += std::to_string(i) + " 0 obj\n<< /Index " + std::to_string(i) + " /Next " + std::to_string(i % 3000 + 1) + " 0 R /Items [";
+        for (size_t w = 0; w < (i % 100 == 0 ? 2000 : 5); w++) pdf += std::to_string(w) + " ";
+        pdf += "] >>\nendobj\n";
+    }
+    size_t xref = pdf.size();
+    pdf += "xref\n0 3001\n0000000000 65535 f \n";
+    char record[32];
+    for (size_t offset: offsets) {
+        std::snprintf(record, sizeof(record), "%010zu 00000 n \n", offset);
+        pdf += record;
+    }
+    pdf += "trailer\n<< /Size 3001 /Root 1 0 R >>\nstartxref\n" + std::to_string(xref) + "\n%%EOF\n";
+    std::string path = (std::filesystem::temp_directory_path() / "wavepdf_test_parallel.pdf").string();
+    std::ofstream(path, std::ios::binary) << pdf;
+
+    BufferOptions windowed;
+    windowed.mode = BUFFER_WINDOWED;
+    windowed.blockSize = 4096;
+    for (const BufferOptions& options: {BufferOptions(), windowed}) {
+        PdfReader reader(path, options);
+        EXPECT_TRUE(reader.process()) << "PdfReader::process() failed with log: " << reader.getLog();
+        ASSERT_TRUE(reader.parseDocument(8)) << reader.getLog();
+
+        for (size_t i = 1; i <= 3000; i++) {
+            const Value& object = reader.getDocumentObject(i);
+            ASSERT_EQ(object.getType(), OBJT_DICTIONARY) << "object " << i;
+            EXPECT_EQ(object.find("Index")->getInteger(), static_cast<int64_t>(i));
+            EXPECT_EQ(object.find("Next")->getNumber(), i % 3000 + 1);
+            EXPECT_EQ(object.find("Items")->size(), size_t(i % 100 == 0 ? 2000 : 5));
+        }
+    }
+
+    // Object streams are shared between the workers
+    PdfReader reader("../tests/samples/sample_xrefstream.pdf");
+    EXPECT_TRUE(reader.process()) << "PdfReader::process() failed with log: " << reader.getLog();
+    ASSERT_TRUE(reader.parseDocument(0)) << reader.getLog();
+    EXPECT_EQ(reader.getDocumentObject(1).find("Type")->getString(), "Catalog");
+    EXPECT_EQ(reader.getDocumentObject(3).find("MediaBox")->size(), size_t(4));
+    std::filesystem::remove(path);
+}
+
+TEST(PdfReaderIntegrationTest, NamesReleasedWithTheReader) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    // One document after another in the same process, each with names no other one has
+    size_t size = NameManager::global().size();
+    for (int document = 0; document < 3; document++) {
+        std::string unique = "WavePDFFont" + std::to_string(document);
+        std::string path = writeTestPdf("wavepdf_test_names.pdf", {
+            {1, "<< /Type /Catalog /Fonts << /" + unique + " 2 0 R >> >>"},
+            {2, "<< /Type /Font /BaseFont /" + unique + "Base >>"},
+        });
+        {
+            PdfReader reader(path);
+            ASSERT_TRUE(reader.process()) << reader.getLog();
+            ASSERT_TRUE(reader.parseDocument(2)) << reader.getLog();
+            std::shared_ptr<DictionaryObject> font = std::dynamic_pointer_cast<DictionaryObject>(reader.getObject(2));
+            ASSERT_NE(font, nullptr);
+            EXPECT_EQ(std::dynamic_pointer_cast<NameObject>(font->getElement(NAME_BASE_FONT))->getValue(), unique + "Base");
+            EXPECT_NE(reader.getDocumentObject(1).find("Fonts")->find(unique), nullptr);
+            EXPECT_NE(NameManager::global().find(unique), NAME_UNKNOWN);
+        }
+        EXPECT_EQ(NameManager::global().find(unique), NAME_UNKNOWN);
+        std::filesystem::remove(path);
+    }
+    // "Fonts" is no known name either, nothing of the documents stays
+    EXPECT_EQ(NameManager::global().size(), size);
+}
+
+TEST(PdfReaderIntegrationTest, SparseObjectNumbers) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // Two objects, the second near the end of the allowed number range
+    auto write = [](const std::string& name, size_t highNumber) {
+        std::string pdf = "%PDF-1.7\n";
+        size_t first = pdf.size();
+        pdf += "1 0 obj\n<< /Type /Catalog >>\nendobj\n";
+        size_t second = pdf.size();
+        pdf += std::to_string(highNumber) + " 0 obj\n<< /High true >>\nendobj\n";
+        size_t xref = pdf.size();
+        char record[64];
+        std::snprintf(record, sizeof(record), "%010zu 00000 n \n", first);
+        pdf += "xref\n0 2\n0000000000 65535 f \n" + std::string(record);
+        std::snprintf(record, sizeof(record), "%zu 1\n%010zu 00000 n \n", highNumber, second);
+        pdf += record;
+        pdf += "trailer\n<< /Size " + std::to_string(highNumber + 1) + " /Root 1 0 R >>\nstartxref\n" + std::to_string(xref) + "\n%%EOF\n";
+        std::string path = (std::filesystem::temp_directory_path() / name).string();
+        std::ofstream(path, std::ios::binary) << pdf;
+        return path;
+    };
+
+    // The high number goes to a map slot, only two objects are parsed
+    std::string path = write("wavepdf_test_sparse.pdf", 8000000);
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process()) << reader.getLog();
+    ASSERT_TRUE(reader.parseDocument(2)) << reader.getLog();
+    EXPECT_EQ(reader.getDocumentObject(1).find("Type")->getString(), "Catalog");
+    ASSERT_EQ(reader.getDocumentObject(8000000).getType(), OBJT_DICTIONARY);
+    EXPECT_TRUE(reader.getDocumentObject(8000000).find("High")->getBoolean());
+    EXPECT_TRUE(reader.getDocumentObject(7999999).isNull());
+
+    // Numbers beyond ISO32000 Annex C are rejected before anything is sized by them
+    std::string beyond = write("wavepdf_test_beyond_limit.pdf", 200000000);
+    PdfReader rejected(beyond);
+    EXPECT_FALSE(rejected.process());
+    std::filesystem::remove(path);
+    std::filesystem::remove(beyond);
+}
+
+#if WAVEPDF_INSTRUMENTATION
+TEST(PdfReaderIntegrationTest, IndirectLengthBytesParsed) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    /* The length is resolved through the reader's buffer, which moves its marker past the padding.
+        Bytes counted from that marker would count the padding twice */
+    std::string path = writeTestPdf("wavepdf_test_indirect_length.pdf", {
+        {1, "<< /Type /Catalog >>"},
+        {2, "<< /Length 4 0 R >>\nstream\nhello\nendstream"},
+        {3, "(" + std::string(4096, 'x') + ")"},
+        {4, "5"},
+    });
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process()) << reader.getLog();
+    size_t before = reader.getStats().bytesParsed;
+    ASSERT_TRUE(reader.parseDocument(1)) << reader.getLog();
+    EXPECT_EQ(reader.getDocumentObject(2).getStream()->dataLength, size_t(5));
+    size_t parsed = reader.getStats().bytesParsed - before;
+    EXPECT_GT(parsed, size_t(0));
+    EXPECT_LE(parsed, static_cast<size_t>(std::filesystem::file_size(path)));
+    std::filesystem::remove(path);
+}
+
+TEST(PdfReaderIntegrationTest, PhaseStatsAndTrace) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    PdfReader reader("../tests/samples/sample_xrefstream.pdf");
+    reader.enableTrace();
+    EXPECT_TRUE(reader.process()) << "PdfReader::process() failed with log: " << reader.getLog();
+
+    ReaderStats stats = reader.getStats();
+    for (ReaderPhase phase: {PHASE_READ_FILE_HEADER, PHASE_VALIDATE_EOF, PHASE_PARSE_XREF_OFFSET, PHASE_PARSE_XREF_TABLE}) {
+        EXPECT_EQ(stats.phaseCalls[phase], size_t(1)) << phaseName(phase);
+        EXPECT_GE(stats.phaseSeconds[phase], 0.0) << phaseName(phase);
+    }
+    // The xref stream itself was parsed & decoded
+    EXPECT_EQ(stats.phaseCalls[PHASE_DECODE_STREAMS], size_t(1));
+    EXPECT_GT(stats.bytesParsed, size_t(0));
+    EXPECT_GT(stats.objectAllocations, size_t(0));
+    EXPECT_EQ(stats.phaseCalls[PHASE_RESOLVE_OBJECTS], size_t(0));
+
+    // Only loads that miss the cache are a resolve phase, the object stream load is nested in it
+    ASSERT_NE(reader.getObject(1), nullptr);
+    ASSERT_NE(reader.getObject(1), nullptr);
+    stats = reader.getStats();
+    EXPECT_EQ(stats.phaseCalls[PHASE_RESOLVE_OBJECTS], size_t(1));
+    EXPECT_EQ(stats.objectsParsed, size_t(2));
+    EXPECT_EQ(stats.cache.hits, size_t(1));
+
+    ASSERT_TRUE(reader.parseDocument(2)) << reader.getLog();
+    stats = reader.getStats();
+    EXPECT_EQ(stats.phaseCalls[PHASE_PARSE_DOCUMENT], size_t(1));
+    EXPECT_GE(stats.objectsParsed, size_t(2 + 7));
+    EXPECT_GT(stats.arenaBytesUsed, size_t(0));
+
+    std::string json = reader.getTraceJson();
+    EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), size_t(0));
+    for (const char* name: {"readFileHeader", "parseXRefTable", "resolveObjects", "parseDocument", "parseGrain"}) {
+        EXPECT_NE(json.find(std::string("\"name\":\"") + name + "\""), std::string::npos) << name;
+    }
+
+    reader.resetStats();
+    stats = reader.getStats();
+    EXPECT_EQ(stats.phaseCalls[PHASE_PARSE_DOCUMENT], size_t(0));
+    EXPECT_EQ(stats.objectsParsed, size_t(0));
+    EXPECT_EQ(stats.cache.hits, size_t(0));
+    EXPECT_EQ(reader.getTraceJson().find("\"ph\""), std::string::npos);
+}
+#endif
+
+TEST(PdfReaderIntegrationTest, XRefRecovery) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // Broken copies of the samples: startxref pointing into an object, xref table cut off
+    struct Damage {
+        std::string sample;
+        std::string from;
+        std::string to;
+    };
+    std::vector<Damage> damages = {
+        {"sample.pdf", "startxref\n18132", "startxref\n18000"},
+        {"sample.pdf", "xref\n0", "xr\n\n0"},
+        {"sample_xrefstream.pdf", "startxref\n925", "startxref\n900"},
+        {"sample_incremental.pdf", "xref\n0", "xr\n\n0"}
+    };
+    for (const Damage& damage: damages) {
+        std::ifstream file("../tests/samples/" + damage.sample, std::ios::binary);
+        std::string pdf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        size_t found = pdf.rfind(damage.from);
+        ASSERT_NE(found, std::string::npos) << damage.sample;
+        pdf.replace(found, damage.from.size(), damage.to);
+        std::string path = (std::filesystem::temp_directory_path() / ("wavepdf_test_recovery_" + damage.sample)).string();
+        std::ofstream(path, std::ios::binary) << pdf;
+
+        PdfReader intact("../tests/samples/" + damage.sample);
+        ASSERT_TRUE(intact.process()) << intact.getLog();
+        {
+            PdfReader reader(path);
+            EXPECT_FALSE(reader.process()) << damage.sample << ": " << damage.to;
+        }
+
+        // Windowed buffers are scanned window by window
+        BufferOptions windowed;
+        windowed.mode = BUFFER_WINDOWED;
+        windowed.blockSize = 4096;
+        for (const BufferOptions& options: {BufferOptions(), windowed}) {
+            PdfReader reader(path, options);
+            reader.setRecovery(true, 4);
+            ASSERT_TRUE(reader.process()) << damage.sample << ": " << reader.getLog();
+            EXPECT_TRUE(reader.isRecovered());
+            ASSERT_NE(reader.getTrailer(), nullptr);
+            EXPECT_NE(reader.getTrailer()->getElement("Root"), nullptr);
+
+            // Every object of the intact file resolves to the same kind of object
+            for (size_t number = 1; number < intact.getXRefIndex().getObjectCount(); number++) {
+                std::optional<xrefEntry> entry = intact.getXRefIndex().lookup(number);
+                if (!entry.has_value() || entry->type == 'f') continue;
+                std::shared_ptr<BaseObject> expected = intact.getObject(number, entry->generation);
+                std::shared_ptr<BaseObject> recovered = reader.getObject(number, entry->generation);
+                ASSERT_NE(recovered, nullptr) << damage.sample << " object " << number;
+                EXPECT_EQ(recovered->getType(), expected->getType()) << damage.sample << " object " << number;
+            }
+        }
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(PdfReaderIntegrationTest, DamagedTail) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    // Smaller than the tail window
+    PdfReader small("../tests/samples/sample2.pdf");
+    EXPECT_TRUE(small.process()) << "PdfReader::process() failed with log: " << small.getLog();
+
+    // Last %%EOF cut off & followed by garbage, the newest startxref stays in effect
+    std::ifstream file("../tests/samples/sample_incremental.pdf", std::ios::binary);
+    std::string pdf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    PdfReader intact("../tests/samples/sample_incremental.pdf");
+    ASSERT_TRUE(intact.process()) << intact.getLog();
+    pdf.replace(pdf.rfind("%%EOF"), 5, "%%EO\r\n\x80\x81garbage");
+    std::string path = (std::filesystem::temp_directory_path() / "wavepdf_test_tail.pdf").string();
+    std::ofstream(path, std::ios::binary) << pdf;
+
+    PdfReader reader(path);
+    EXPECT_TRUE(reader.process()) << "PdfReader::process() failed with log: " << reader.getLog();
+    EXPECT_EQ(reader.getXRefOffset(), intact.getXRefOffset());
+    EXPECT_EQ(reader.getRevisionCount(), intact.getRevisionCount());
+    EXPECT_LT(reader.getTailLocation().eof, reader.getTailLocation().startXRef);
+    EXPECT_EQ(reader.getTailLocation().trailer, intact.getTailLocation().trailer);
+    std::filesystem::remove(path);
+}
+
+TEST(StreamCacheTest, CostAwareEviction) {
+    StreamCache cache(3 * 1024 + 3 * 128);
+    uint64_t document = StreamCache::newDocumentId();
+    auto data = [](size_t length) { return std::make_shared<const std::string>(length, 'x'); };
+
+    // Same size, the stream that was slow to decode outlives the fast ones
+    cache.put(document, 1, 0, data(1024), 0.010);
+    cache.put(document, 2, 0, data(1024), 0.0001);
+    cache.put(document, 3, 0, data(1024), 0.0001);
+    cache.put(document, 4, 0, data(1024), 0.0001);
+    EXPECT_NE(cache.get(document, 1, 0), nullptr);
+    EXPECT_EQ(cache.get(document, 2, 0), nullptr);
+    EXPECT_NE(cache.get(document, 4, 0), nullptr);
+
+    StreamCacheStats stats = cache.getStats(document);
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.bytesSaved, 2048u);
+    EXPECT_EQ(stats.cachedStreams, 3u);
+
+    // Data larger than the budget isn't kept, other documents & generations are separate entries
+    cache.put(document, 5, 0, data(8192), 1.0);
+    EXPECT_EQ(cache.get(document, 5, 0), nullptr);
+    EXPECT_EQ(cache.get(document, 1, 1), nullptr);
+    EXPECT_EQ(cache.get(StreamCache::newDocumentId(), 1, 0), nullptr);
+
+    cache.setMaxBytes(1024 + 128);
+    EXPECT_EQ(cache.getStats(document).cachedStreams, 1u);
+    EXPECT_NE(cache.get(document, 1, 0), nullptr);
+    cache.removeDocument(document);
+    EXPECT_EQ(cache.getStats().cachedBytes, 0u);
+}
+
+TEST(StreamCacheTest, ConcurrentReaders) {
+    StreamCache cache(64 * 1024);
+    std::vector<std::thread> threads;
+    for (uint64_t document = 1; document <= 4; document++) {
+        threads.emplace_back([&cache, document]() {
+            for (size_t i = 0; i < 2000; i++) {
+                size_t number = i % 50;
+                std::shared_ptr<const std::string> data = cache.get(document, number, 0);
+                if (data) {
+                    EXPECT_EQ(*data, std::to_string(document * 1000 + number));
+                } else {
+                    cache.put(document, number, 0, std::make_shared<const std::string>(std::to_string(document * 1000 + number)), 0.001);
+                }
+            }
+        });
+    }
+    for (std::thread& thread: threads) thread.join();
+    StreamCacheStats stats = cache.getStats();
+    EXPECT_EQ(stats.hits + stats.misses, 8000u);
+    EXPECT_GT(stats.hits, 0u);
+    EXPECT_LE(stats.cachedBytes, 64u * 1024);
+}
+
+TEST(PdfReaderIntegrationTest, DecodedStreamCache) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    StreamCache cache;
+    PdfReader reader("../tests/samples/sample.pdf");
+    reader.setStreamCache(&cache);
+    ASSERT_TRUE(reader.process()) << reader.getLog();
+
+    // Page content 4 0 obj, decoded once & shared afterwards
+    std::shared_ptr<const std::string> first = reader.getDecodedStream(4);
+    ASSERT_NE(first, nullptr);
+    std::string decoded;
+    ASSERT_TRUE(reader.decodeStream(std::dynamic_pointer_cast<StreamObject>(reader.getObject(4)), decoded));
+    EXPECT_EQ(*first, decoded);
+    EXPECT_EQ(reader.getDecodedStream(4), first);
+    EXPECT_EQ(reader.getDecodedStream(1), nullptr);
+
+    StreamCacheStats stats = reader.getStreamCacheStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.bytesSaved, decoded.size());
+    EXPECT_DOUBLE_EQ(stats.hitRate(), 1.0 / 3);
+    EXPECT_EQ(reader.getStats().streams.hits, 1u);
+
+    // A second reader of the same file is another document
+    {
+        PdfReader other("../tests/samples/sample.pdf");
+        other.setStreamCache(&cache);
+        ASSERT_TRUE(other.process());
+        EXPECT_NE(other.getDecodedStream(4), first);
+        EXPECT_EQ(cache.getStats().cachedStreams, 2u);
+    }
+    // Closed documents leave the cache
+    EXPECT_EQ(cache.getStats().cachedStreams, 1u);
+
+    reader.setStreamCache(nullptr);
+    EXPECT_EQ(cache.getStats().cachedStreams, 0u);
+    EXPECT_NE(reader.getDecodedStream(4), first);
+}
+
+// Everything process() produced that later lookups depend on
+static void expectSameXRef(PdfReader& parsed, PdfReader& loaded) {
+    EXPECT_EQ(parsed.getXRefOffset(), loaded.getXRefOffset());
+    EXPECT_EQ(parsed.getXRefTable(), loaded.getXRefTable());
+    EXPECT_EQ(parsed.getTailLocation().eof, loaded.getTailLocation().eof);
+    EXPECT_EQ(parsed.getTailLocation().trailer, loaded.getTailLocation().trailer);
+    ASSERT_EQ(parsed.getRevisionCount(), loaded.getRevisionCount());
+    for (size_t revision = 0; revision < parsed.getRevisionCount(); revision++) {
+        EXPECT_EQ(parsed.getTrailer(revision)->getElements().size(), loaded.getTrailer(revision)->getElements().size());
+        for (size_t number = 0; number <= parsed.getXRefIndex().getObjectCount(); number++) {
+            EXPECT_EQ(parsed.getRevisionView(revision).lookup(number), loaded.getRevisionView(revision).lookup(number)) << number;
+        }
+    }
+    EXPECT_EQ(parsed.getXRefIndex().getEntryCount(), loaded.getXRefIndex().getEntryCount());
+}
+
+TEST(PdfReaderIntegrationTest, ParseIndexFile) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "wavepdf_parse_index";
+    std::filesystem::remove_all(directory);
+
+    // Classic table, incremental updates & xref stream with object streams
+    for (const char* sample: {"sample.pdf", "sample_incremental.pdf", "sample_xrefstream.pdf"}) {
+        std::string path = "../tests/samples/" + std::string(sample);
+        PdfReader parsed(path);
+        parsed.setIndexDirectory(directory.string());
+        ASSERT_TRUE(parsed.process()) << parsed.getLog();
+        EXPECT_FALSE(parsed.isIndexLoaded());
+        EXPECT_TRUE(std::filesystem::exists(ParseIndexFile::pathFor(directory.string(), path))) << sample;
+
+        PdfReader loaded(path);
+        loaded.setIndexDirectory(directory.string());
+        ASSERT_TRUE(loaded.process()) << loaded.getLog();
+        EXPECT_TRUE(loaded.isIndexLoaded()) << sample;
+        expectSameXRef(parsed, loaded);
+        ASSERT_NE(loaded.getObject(1), nullptr);
+        EXPECT_EQ(loaded.getObject(1)->getType(), OBJT_DICTIONARY);
+#if WAVEPDF_INSTRUMENTATION
+        EXPECT_EQ(loaded.getStats().phaseCalls[PHASE_PARSE_XREF_TABLE], size_t(0));
+        EXPECT_EQ(loaded.getStats().phaseCalls[PHASE_LOAD_INDEX], size_t(1));
+#endif
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST(PdfReaderIntegrationTest, ParseIndexFileStaleOrDamaged) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "wavepdf_parse_index_stale";
+    std::filesystem::remove_all(directory);
+    std::string path = (std::filesystem::temp_directory_path() / "wavepdf_parse_index_stale.pdf").string();
+    std::filesystem::copy_file("../tests/samples/sample.pdf", path, std::filesystem::copy_options::overwrite_existing);
+    std::string indexPath = ParseIndexFile::pathFor(directory.string(), path);
+
+    auto open = [&directory, &path](bool& indexLoaded) {
+        PdfReader reader(path);
+        reader.setIndexDirectory(directory.string());
+        bool ok = reader.process();
+        indexLoaded = reader.isIndexLoaded();
+        return ok;
+    };
+    bool indexLoaded;
+    ASSERT_TRUE(open(indexLoaded));
+    ASSERT_TRUE(open(indexLoaded));
+    EXPECT_TRUE(indexLoaded);
+
+    // Appended bytes change size & hash of the tail, the index is rebuilt
+    std::ofstream(path, std::ios::binary | std::ios::app) << "\n% comment after %%EOF\n";
+    ASSERT_TRUE(open(indexLoaded));
+    EXPECT_FALSE(indexLoaded);
+    ASSERT_TRUE(open(indexLoaded));
+    EXPECT_TRUE(indexLoaded);
+
+    // Truncated & overwritten index files are parsed around
+    std::filesystem::resize_file(indexPath, std::filesystem::file_size(indexPath) - 4);
+    ASSERT_TRUE(open(indexLoaded));
+    EXPECT_FALSE(indexLoaded);
+    std::string data;
+    {
+        std::ifstream in(indexPath, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    // Entry position far outside of the arrays at the end of the file (last dense chain of sample.pdf)
+    std::fill(data.end() - 4, data.end(), '\x7f');
+    std::ofstream(indexPath, std::ios::binary | std::ios::trunc) << data;
+    ASSERT_TRUE(open(indexLoaded));
+    EXPECT_FALSE(indexLoaded);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove_all(directory);
+}
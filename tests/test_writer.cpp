@@ -0,0 +1,543 @@
+#include "../src/utility/writer/IncrementalWriter.h"
+#include "../src/utility/writer/DocumentRewriter.h"
+#include "../src/utility/writer/ObjectSerializer.h"
+#include "../src/utility/objects/NameObject.h"
+#include "../src/utility/objects/ArrayObject.h"
+#include "../src/utility/objects/IntegerObject.h"
+#include "../src/utility/objects/RealObject.h"
+#include "../src/utility/objects/ReferenceObject.h"
+#include "../src/utility/objects/StringObject.h"
+#include "../src/utility/objects/BooleanObject.h"
+#include "../src/utility/objects/NullObject.h"
+#include "TestPdf.h"
+#include <wx/wx.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream data;
+    data << in.rdbuf();
+    return data.str();
+}
+
+static std::string serialize(const std::shared_ptr<BaseObject>& object) {
+    std::string out;
+    ObjectSerializer::write(out, object);
+    return out;
+}
+
+// Copy of a sample in the temp directory, the writer tests change files in place
+static std::string copySample(const std::string& sample, const std::string& name) {
+    std::string path = (std::filesystem::temp_directory_path() / name).string();
+    std::filesystem::copy_file(sample, path, std::filesystem::copy_options::overwrite_existing);
+    return path;
+}
+
+// Every object of the newest revision of a reader, written out, with the free ones left empty
+static std::vector<std::string> serializeAll(PdfReader& reader) {
+    std::vector<std::string> objects(reader.getXRefIndex().getObjectCount());
+    for (size_t number = 1; number < objects.size(); number++) {
+        std::shared_ptr<BaseObject> object = reader.getObject(number);
+        if (!object) continue;
+        std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(object);
+        std::string data;
+        if (stream) reader.decodeStream(stream, data);
+        objects[number] = stream ? serialize(stream->getDictionary()) + data : serialize(object);
+    }
+    return objects;
+}
+
+/* Objects reachable from two values are the same, references of both documents are followed side
+    by side & have to map one to one. Stream data is compared decoded, filters may differ */
+static void expectSameGraph(PdfReader& a, PdfReader& b, const std::shared_ptr<BaseObject>& x, const std::shared_ptr<BaseObject>& y, std::map<size_t, size_t>& visited) {
+    ASSERT_EQ(x == nullptr, y == nullptr);
+    if (!x) return;
+    if (x->getType() == OBJT_INDIRECT) {
+        ASSERT_EQ(y->getType(), OBJT_INDIRECT);
+        size_t from = std::static_pointer_cast<ReferenceObject>(x)->getNumber();
+        size_t to = std::static_pointer_cast<ReferenceObject>(y)->getNumber();
+        auto found = visited.find(from);
+        if (found != visited.end()) {
+            EXPECT_EQ(found->second, to) << "object " << from;
+            return;
+        }
+        visited[from] = to;
+        expectSameGraph(a, b, a.getObject(from), b.getObject(to), visited);
+        return;
+    }
+    ASSERT_EQ(x->getType(), y->getType());
+    switch (x->getType()) {
+        case OBJT_STREAM: {
+            std::string first, second;
+            EXPECT_TRUE(a.decodeStream(std::static_pointer_cast<StreamObject>(x), first));
+            EXPECT_TRUE(b.decodeStream(std::static_pointer_cast<StreamObject>(y), second));
+            EXPECT_EQ(first, second);
+            expectSameGraph(a, b, std::static_pointer_cast<StreamObject>(x)->getDictionary(), std::static_pointer_cast<StreamObject>(y)->getDictionary(), visited);
+            break;
+        }
+        case OBJT_DICTIONARY: {
+            std::shared_ptr<DictionaryObject> left = std::static_pointer_cast<DictionaryObject>(x);
+            std::shared_ptr<DictionaryObject> right = std::static_pointer_cast<DictionaryObject>(y);
+            for (const std::shared_ptr<DictionaryObject>& dictionary: {left, right}) {
+                for (const auto& [key, value]: dictionary->getElements()) {
+                    if (key == NAME_LENGTH || key == NAME_FILTER || key == NAME_DECODE_PARMS) continue;
+                    ASSERT_NE(left->getElement(key), nullptr) << NameManager::global().get(key).value;
+                    ASSERT_NE(right->getElement(key), nullptr) << NameManager::global().get(key).value;
+                }
+            }
+            for (const auto& [key, value]: left->getElements()) {
+                if (key != NAME_LENGTH && key != NAME_FILTER && key != NAME_DECODE_PARMS) expectSameGraph(a, b, value, right->getElement(key), visited);
+            }
+            break;
+        }
+        case OBJT_ARRAY: {
+            const std::vector<std::shared_ptr<BaseObject>>& left = std::static_pointer_cast<ArrayObject>(x)->getObjects();
+            const std::vector<std::shared_ptr<BaseObject>>& right = std::static_pointer_cast<ArrayObject>(y)->getObjects();
+            ASSERT_EQ(left.size(), right.size());
+            for (size_t i = 0; i < left.size(); i++) expectSameGraph(a, b, left[i], right[i], visited);
+            break;
+        }
+        case OBJT_REAL:
+            EXPECT_NEAR(std::static_pointer_cast<RealObject>(x)->getValue(), std::static_pointer_cast<RealObject>(y)->getValue(), 0.000001);
+            break;
+        default:
+            EXPECT_EQ(serialize(x), serialize(y));
+    }
+}
+
+TEST(ObjectSerializerTest, Syntax) {
+    std::string out;
+    for (double value: {3.25, -100.0, 0.0000001, -0.0000001, 12345678.5}) {
+        ObjectSerializer::writeReal(out, value);
+        out += ' ';
+    }
+    EXPECT_EQ(out, "3.25 -100 0 0 12345678.5 ");
+
+    out.clear();
+    ObjectSerializer::writeName(out, "Name with#(delimiters)\xE9");
+    EXPECT_EQ(out, "/Name#20with#23#28delimiters#29#E9");
+
+    out.clear();
+    ObjectSerializer::writeString(out, std::string("a(b)\\c\n\x01\xFF", 9), false);
+    EXPECT_EQ(out, "(a\\(b\\)\\\\c\\n\\001\\377)");
+    out.clear();
+    ObjectSerializer::writeString(out, "\x0A\xBC", true);
+    EXPECT_EQ(out, "<0ABC>");
+
+    std::shared_ptr<DictionaryObject> dictionary = std::make_shared<DictionaryObject>(0);
+    dictionary->addElement(NAME_TYPE, std::make_shared<NameObject>(0, 0, "Page"));
+    dictionary->addElement(NAME_LENGTH, std::make_shared<ReferenceObject>(0, 0, 8, 0));
+    std::shared_ptr<ArrayObject> array = std::make_shared<ArrayObject>(0);
+    array->addObject(std::make_shared<IntegerObject>(0, 0, -7));
+    array->addObject(std::make_shared<BooleanObject>(0, 0, true));
+    array->addObject(std::make_shared<NullObject>(0, 0));
+    dictionary->addElement(NAME_KIDS, array);
+    EXPECT_EQ(serialize(dictionary), "<< /Type /Page /Length 8 0 R /Kids [-7 true null] >>");
+
+    // A written stream gets the length of its data, whatever the dictionary said
+    out.clear();
+    ObjectSerializer::writeStream(out, 4, 1, dictionary, "data");
+    EXPECT_EQ(out, "4 1 obj\n<< /Type /Page /Kids [-7 true null] /Length 4 >>\nstream\ndata\nendstream\nendobj\n");
+}
+
+TEST(IncrementalWriterTest, ClassicUpdate) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    std::string original = readFile("../tests/samples/sample.pdf");
+    std::string output = (std::filesystem::temp_directory_path() / "wavepdf_writer_classic.pdf").string();
+
+    PdfReader reader("../tests/samples/sample.pdf");
+    ASSERT_TRUE(reader.process());
+    std::vector<std::string> before = serializeAll(reader);
+    size_t rootNumber = std::dynamic_pointer_cast<ReferenceObject>(reader.getTrailer()->getElement(NAME_ROOT))->getNumber();
+
+    IncrementalWriter writer(reader);
+    // Changed catalog, a new object with every kind of value, a new compressed stream & a deleted object
+    std::shared_ptr<DictionaryObject> catalog = std::dynamic_pointer_cast<DictionaryObject>(reader.getObject(rootNumber));
+    ASSERT_NE(catalog, nullptr);
+    catalog->addElement(NameManager::global().intern("Lang").atom, std::make_shared<StringObject>(0, 0, "en-US", false));
+    writer.setObject(rootNumber, catalog);
+
+    std::shared_ptr<DictionaryObject> values = std::make_shared<DictionaryObject>(0);
+    values->addElement(NameManager::global().intern("Name").atom, std::make_shared<NameObject>(0, 0, "A B#C"));
+    values->addElement(NameManager::global().intern("Literal").atom, std::make_shared<StringObject>(0, 0, std::string("(x)\\\r\n\x01\xFF", 8), false));
+    values->addElement(NameManager::global().intern("Hex").atom, std::make_shared<StringObject>(0, 0, std::string("\x00\x7F", 2), true));
+    values->addElement(NameManager::global().intern("Real").atom, std::make_shared<RealObject>(0, 0, -3.125));
+    values->addElement(NameManager::global().intern("Integer").atom, std::make_shared<IntegerObject>(0, 0, 1234567890123));
+    values->addElement(NameManager::global().intern("Flag").atom, std::make_shared<BooleanObject>(0, 0, false));
+    values->addElement(NAME_PARENT, std::make_shared<ReferenceObject>(0, 0, rootNumber, 0));
+    size_t valuesNumber = writer.addObject(values);
+    EXPECT_EQ(valuesNumber, before.size());
+
+    std::string content = "BT /F1 12 Tf (Added by an incremental update) Tj ET";
+    size_t streamNumber = writer.addStream(std::make_shared<DictionaryObject>(0), content, true);
+    EXPECT_EQ(streamNumber, valuesNumber + 1);
+
+    size_t deleted = 0;
+    for (size_t number = 1; number < before.size() && !deleted; number++) {
+        if (number != rootNumber && !before[number].empty()) deleted = number;
+    }
+    writer.deleteObject(deleted);
+    EXPECT_EQ(writer.getDirtyCount(), 4u);
+    ASSERT_TRUE(writer.save(output)) << writer.getErrorMessage();
+
+    // The original bytes stay as they are, only the update follows
+    std::string saved = readFile(output);
+    ASSERT_GT(saved.size(), original.size());
+    EXPECT_EQ(saved.compare(0, original.size(), original), 0);
+    EXPECT_LT(saved.size() - original.size(), 1024u);
+
+    PdfReader updated(output);
+    ASSERT_TRUE(updated.process()) << updated.getLog();
+    EXPECT_FALSE(updated.isRecovered());
+    EXPECT_FALSE(updated.hasXRefStream());
+    EXPECT_EQ(updated.getRevisionCount(), reader.getRevisionCount() + 1);
+    EXPECT_EQ(std::dynamic_pointer_cast<IntegerObject>(updated.getTrailer()->getElement(NAME_PREV))->getValue(), static_cast<int64_t>(reader.getXRefOffset()));
+    EXPECT_EQ(std::dynamic_pointer_cast<IntegerObject>(updated.getTrailer()->getElement(NAME_SIZE))->getValue(), static_cast<int64_t>(streamNumber + 1));
+
+    std::vector<std::string> after = serializeAll(updated);
+    ASSERT_EQ(after.size(), streamNumber + 1);
+    for (size_t number = 1; number < before.size(); number++) {
+        if (number == rootNumber || number == deleted) continue;
+        EXPECT_EQ(after[number], before[number]) << "object " << number;
+    }
+    EXPECT_EQ(after[rootNumber], serialize(catalog));
+    EXPECT_TRUE(after[deleted].empty());
+    EXPECT_EQ(updated.getXRefIndex().lookup(deleted)->generation, reader.getXRefIndex().lookup(deleted)->generation + 1);
+    EXPECT_EQ(after[valuesNumber], serialize(values));
+
+    std::string decoded;
+    std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(updated.getObject(streamNumber));
+    ASSERT_NE(stream, nullptr);
+    ASSERT_TRUE(updated.decodeStream(stream, decoded));
+    EXPECT_EQ(decoded, content);
+
+    // The previous revision still reads as the original
+    XRefRevisionView previous = updated.getRevisionView(reader.getRevisionCount() - 1);
+    EXPECT_EQ(previous.lookup(deleted)->type, 'n');
+    EXPECT_FALSE(previous.lookup(valuesNumber).has_value());
+    std::filesystem::remove(output);
+}
+
+TEST(IncrementalWriterTest, XRefStreamAppend) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    std::string path = copySample("../tests/samples/sample_xrefstream.pdf", "wavepdf_writer_stream.pdf");
+    size_t originalSize = std::filesystem::file_size(path);
+
+    // Two updates appended in place, each needs a reader of the file as it is
+    std::vector<size_t> added;
+    size_t revisions = 0;
+    for (int update = 0; update < 2; update++) {
+        PdfReader reader(path);
+        ASSERT_TRUE(reader.process()) << reader.getLog();
+        ASSERT_TRUE(reader.hasXRefStream());
+        revisions = reader.getRevisionCount();
+
+        IncrementalWriter writer(reader);
+        std::shared_ptr<ArrayObject> value = std::make_shared<ArrayObject>(0);
+        value->addObject(std::make_shared<IntegerObject>(0, 0, update));
+        added.push_back(writer.addObject(value));
+        // A stream of the file with a changed dictionary keeps its data
+        if (update == 0) {
+            for (size_t number = 1; number < reader.getXRefIndex().getObjectCount(); number++) {
+                std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(reader.getObject(number));
+                if (!stream || reader.getXRefIndex().lookup(number)->type != 'n') continue;
+                std::string data;
+                ASSERT_TRUE(reader.decodeStream(stream, data));
+                stream->getDictionary()->addElement(NameManager::global().intern("Touched").atom, std::make_shared<BooleanObject>(0, 0, true));
+                writer.setObject(number, stream);
+                added.push_back(number);
+                break;
+            }
+        }
+        ASSERT_TRUE(writer.appendToFile()) << writer.getErrorMessage();
+    }
+
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process()) << reader.getLog();
+    EXPECT_TRUE(reader.hasXRefStream());
+    EXPECT_FALSE(reader.isRecovered());
+    EXPECT_EQ(reader.getRevisionCount(), revisions + 1);
+    EXPECT_GT(std::filesystem::file_size(path), originalSize);
+    ASSERT_EQ(added.size(), 3u);
+    EXPECT_EQ(serialize(reader.getObject(added[0])), "[0]");
+    EXPECT_EQ(serialize(reader.getObject(added[2])), "[1]");
+    std::shared_ptr<StreamObject> touched = std::dynamic_pointer_cast<StreamObject>(reader.getObject(added[1]));
+    ASSERT_NE(touched, nullptr);
+    EXPECT_NE(touched->getDictionary()->getElement("Touched"), nullptr);
+    std::string data;
+    EXPECT_TRUE(reader.decodeStream(touched, data));
+    EXPECT_FALSE(data.empty());
+
+    // A classic table can follow a cross-reference stream
+    IncrementalWriter writer(reader);
+    writer.setXRefFormat(XREF_FORMAT_TABLE);
+    writer.addObject(std::make_shared<NullObject>(0, 0));
+    ASSERT_TRUE(writer.appendToFile()) << writer.getErrorMessage();
+    PdfReader last(path);
+    ASSERT_TRUE(last.process()) << last.getLog();
+    EXPECT_FALSE(last.hasXRefStream());
+    EXPECT_EQ(serialize(last.getObject(added[2])), "[1]");
+    std::filesystem::remove(path);
+}
+
+TEST(IncrementalWriterTest, GenerationsOfReusedNumbers) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    std::string path = copySample("../tests/samples/sample.pdf", "wavepdf_writer_generations.pdf");
+
+    size_t number = 0;
+    uint16_t generation = 0;
+    {
+        PdfReader reader(path);
+        ASSERT_TRUE(reader.process());
+        size_t rootNumber = std::dynamic_pointer_cast<ReferenceObject>(reader.getTrailer()->getElement(NAME_ROOT))->getNumber();
+        for (size_t candidate = 1; candidate < reader.getXRefIndex().getObjectCount() && !number; candidate++) {
+            std::optional<xrefEntry> entry = reader.getXRefIndex().lookup(candidate);
+            if (candidate != rootNumber && entry.has_value() && entry->type == 'n') number = candidate;
+        }
+        ASSERT_NE(number, 0u);
+        generation = reader.getXRefIndex().lookup(number)->generation;
+
+        // An object in use keeps its generation, a number freed here is used again with the next one
+        IncrementalWriter writer(reader);
+        EXPECT_EQ(writer.getGeneration(number), generation);
+        writer.deleteObject(number);
+        EXPECT_EQ(writer.getGeneration(number), generation + 1);
+        writer.setObject(number, std::make_shared<IntegerObject>(0, 0, 1));
+        EXPECT_EQ(writer.getGeneration(number), generation + 1);
+        // Numbers beyond the file start at generation 0
+        EXPECT_EQ(writer.getGeneration(writer.getNextNumber()), 0u);
+        writer.revert(number);
+        writer.deleteObject(number);
+        ASSERT_TRUE(writer.appendToFile()) << writer.getErrorMessage();
+    }
+
+    // The free entry of the saved file holds the generation of the number's next use
+    PdfReader freed(path);
+    ASSERT_TRUE(freed.process()) << freed.getLog();
+    EXPECT_EQ(freed.getXRefIndex().lookup(number)->type, 'f');
+    IncrementalWriter writer(freed);
+    EXPECT_EQ(writer.getGeneration(number), generation + 1);
+    writer.setObject(number, std::make_shared<IntegerObject>(0, 0, 2));
+    ASSERT_TRUE(writer.appendToFile()) << writer.getErrorMessage();
+
+    PdfReader reused(path);
+    ASSERT_TRUE(reused.process()) << reused.getLog();
+    EXPECT_EQ(reused.getXRefIndex().lookup(number)->generation, generation + 1);
+    EXPECT_EQ(serialize(reused.getObject(number, generation + 1)), "2");
+    EXPECT_EQ(reused.getObject(number, generation), nullptr);
+    std::filesystem::remove(path);
+}
+
+TEST(IncrementalWriterTest, CompressesStreamOfTheReader) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    // The filter chain is an indirect array
+    std::string path = writeTestPdf("wavepdf_writer_compress.pdf", {
+        {1, "<< /Type /Catalog >>"},
+        {2, "<< /Length 11 /Filter 3 0 R >>\nstream\n68656C6C6F>\nendstream"},
+        {3, "[/ASCIIHexDecode]"},
+    });
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process()) << reader.getLog();
+    std::shared_ptr<StreamObject> original = std::dynamic_pointer_cast<StreamObject>(reader.getObject(2));
+    ASSERT_NE(original, nullptr);
+    std::string data;
+    ASSERT_TRUE(reader.decodeStream(original, data));
+    EXPECT_EQ(data, "hello");
+
+    // New data under the reader's own dictionary, the reader's object keeps decoding as it is stored
+    IncrementalWriter writer(reader);
+    writer.setStream(2, original->getDictionary(), "776F726C64>", true);
+    EXPECT_EQ(original->getDictionary()->getElement(NAME_FILTER)->getType(), OBJT_INDIRECT);
+    EXPECT_EQ(original->getDictionary()->getElement(NAME_DECODE_PARMS), nullptr);
+    data.clear();
+    ASSERT_TRUE(reader.decodeStream(original, data));
+    EXPECT_EQ(data, "hello");
+    ASSERT_TRUE(writer.appendToFile()) << writer.getErrorMessage();
+
+    PdfReader updated(path);
+    ASSERT_TRUE(updated.process()) << updated.getLog();
+    std::shared_ptr<StreamObject> stream = std::dynamic_pointer_cast<StreamObject>(updated.getObject(2));
+    ASSERT_NE(stream, nullptr);
+    EXPECT_EQ(serialize(stream->getDictionary()->getElement(NAME_FILTER)), "[/FlateDecode /ASCIIHexDecode]");
+    data.clear();
+    ASSERT_TRUE(updated.decodeStream(stream, data));
+    EXPECT_EQ(data, "world");
+    std::filesystem::remove(path);
+}
+
+TEST(IncrementalWriterTest, Refusals) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    std::string path = copySample("../tests/samples/sample.pdf", "wavepdf_writer_refusals.pdf");
+
+    PdfReader unprocessed(path);
+    IncrementalWriter early(unprocessed);
+    std::ostringstream out;
+    EXPECT_FALSE(early.writeUpdate(out));
+    EXPECT_EQ(early.getErrorMessage(), "Document isn't processed");
+
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process());
+    IncrementalWriter writer(reader);
+    writer.addObject(std::make_shared<NullObject>(0, 0));
+    EXPECT_FALSE(writer.save(path));
+    EXPECT_EQ(std::filesystem::file_size(path), reader.getFileSize());
+
+    // An object failing after earlier ones were flushed leaves the file as it was
+    std::string original = readFile(path);
+    IncrementalWriter failing(reader);
+    failing.setStream(failing.getNextNumber(), std::make_shared<DictionaryObject>(0), std::string(2 * FILE_COPY_CHUNK, 'x'));
+    std::shared_ptr<DictionaryObject> dictionary = std::make_shared<DictionaryObject>(0);
+    failing.setObject(failing.getNextNumber(), std::make_shared<StreamObject>(0, 0, dictionary, original.size() + 100, 10));
+    EXPECT_FALSE(failing.appendToFile());
+    EXPECT_EQ(std::filesystem::file_size(path), original.size());
+    EXPECT_TRUE(readFile(path) == original);
+
+    // Without an intact xref there is nothing for /Prev to point to
+    std::string damaged = readFile(path);
+    damaged.resize(damaged.size() - 40);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << damaged;
+    PdfReader recovered(path);
+    recovered.setRecovery(true);
+    ASSERT_TRUE(recovered.process());
+    ASSERT_TRUE(recovered.isRecovered());
+    IncrementalWriter refused(recovered);
+    EXPECT_FALSE(refused.writeUpdate(out));
+    EXPECT_EQ(refused.getErrorMessage(), "Document has no intact xref to append to");
+    std::filesystem::remove(path);
+}
+
+TEST(DocumentRewriterTest, CompactsDocument) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+
+    std::string content = "BT /F1 12 Tf ";
+    while (content.size() < 200) content += "(Compressible content) Tj ";
+    content += "ET";
+    std::string form = "0 0 m 10 10 l S";
+    std::map<size_t, std::string> objects;
+    objects[1] = "<< /Type /Catalog /Pages 2 0 R >>";
+    objects[2] = "<< /Type /Pages /Kids [3 0 R] /Count 1 /Resources << /XObject << /A 5 0 R /B 6 0 R >> >> >>";
+    std::string items;
+    for (size_t number = 10; number < 260; number++) {
+        items += std::to_string(number) + " 0 R ";
+        objects[number] = "<< /Index " + std::to_string(number) + " /Label (Item \\(" + std::to_string(number) + "\\)) /Scale 0.25 /Key <0a0B> >>";
+    }
+    objects[3] = "<< /Type /Page /Parent 2 0 R /Contents 4 0 R /Items [" + items + "] >>";
+    // Content with an indirect /Length, two identical forms & two objects nothing refers to
+    objects[4] = "<< /Length 7 0 R >>\nstream\n" + content + "\nendstream";
+    objects[5] = "<< /Subtype /Form /Length " + std::to_string(form.size()) + " >>\nstream\n" + form + "\nendstream";
+    objects[6] = objects[5];
+    objects[7] = std::to_string(content.size());
+    objects[8] = "<< /Orphan true >>";
+    objects[9] = "<< /Length 4 >>\nstream\ngone\nendstream";
+    std::string path = writeTestPdf("wavepdf_rewrite_input.pdf", objects);
+    std::string output = (std::filesystem::temp_directory_path() / "wavepdf_rewrite_output.pdf").string();
+
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process());
+    RewriteOptions options;
+    options.threads = 3;
+    DocumentRewriter rewriter(reader, options);
+    ASSERT_TRUE(rewriter.save(output)) << rewriter.getErrorMessage();
+
+    const RewriteStats& stats = rewriter.getStats();
+    EXPECT_EQ(stats.objectsIn, 259u);
+    EXPECT_EQ(stats.unreachable, 3u);
+    EXPECT_EQ(stats.duplicateStreams, 1u);
+    EXPECT_EQ(stats.objectsOut, 255u);
+    // The page with its 250 references is too large for an object stream
+    EXPECT_EQ(stats.packedObjects, 252u);
+    EXPECT_EQ(stats.objectStreams, 3u);
+    EXPECT_EQ(stats.compressedStreams, 1u);
+    EXPECT_EQ(stats.bytesOut, std::filesystem::file_size(output));
+    EXPECT_LT(stats.bytesOut, stats.bytesIn);
+
+    PdfReader rewritten(output);
+    ASSERT_TRUE(rewritten.process()) << rewritten.getLog();
+    EXPECT_TRUE(rewritten.hasXRefStream());
+    EXPECT_EQ(rewritten.getRevisionCount(), 1u);
+    EXPECT_EQ(rewritten.getPdfVersion(), "1.5");
+    // Objects, 3 object streams & the xref stream, numbered densely
+    EXPECT_EQ(rewritten.getXRefIndex().getObjectCount(), 255u + 3 + 1 + 1);
+    std::map<size_t, size_t> visited;
+    expectSameGraph(reader, rewritten, reader.getTrailer()->getElement(NAME_ROOT), rewritten.getTrailer()->getElement(NAME_ROOT), visited);
+    EXPECT_EQ(visited.size(), 256u);
+    EXPECT_EQ(visited[5], visited[6]);
+
+    // Same bytes for any number of threads
+    std::ostringstream single, parallel;
+    options.threads = 1;
+    DocumentRewriter first(reader, options);
+    ASSERT_TRUE(first.write(single));
+    options.threads = 4;
+    DocumentRewriter second(reader, options);
+    ASSERT_TRUE(second.write(parallel));
+    EXPECT_EQ(single.str(), parallel.str());
+    EXPECT_EQ(single.str(), readFile(output));
+
+    // Everything kept & written on its own
+    options.removeUnreachable = false;
+    options.deduplicateStreams = false;
+    options.packLimit = 0;
+    DocumentRewriter plain(reader, options);
+    std::ostringstream unpacked;
+    ASSERT_TRUE(plain.write(unpacked));
+    EXPECT_EQ(plain.getStats().objectsOut, 259u);
+    EXPECT_EQ(plain.getStats().objectStreams, 0u);
+    std::filesystem::remove(path);
+    std::filesystem::remove(output);
+}
+
+TEST(DocumentRewriterTest, DropsUpdateHistory) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    std::string output = (std::filesystem::temp_directory_path() / "wavepdf_rewrite_incremental.pdf").string();
+
+    for (const char* sample: {"../tests/samples/sample_incremental.pdf", "../tests/samples/sample.pdf", "../tests/samples/sample_xrefstream.pdf"}) {
+        PdfReader reader(sample);
+        ASSERT_TRUE(reader.process());
+        DocumentRewriter rewriter(reader);
+        ASSERT_TRUE(rewriter.save(output)) << sample << ": " << rewriter.getErrorMessage();
+
+        PdfReader rewritten(output);
+        ASSERT_TRUE(rewritten.process()) << sample << ": " << rewritten.getLog();
+        EXPECT_EQ(rewritten.getRevisionCount(), 1u) << sample;
+        std::map<size_t, size_t> visited;
+        for (NameAtom key: {NAME_ROOT, NAME_INFO}) {
+            expectSameGraph(reader, rewritten, reader.getTrailer()->getElement(key), rewritten.getTrailer()->getElement(key), visited);
+        }
+        EXPECT_EQ(visited.size(), rewriter.getStats().objectsOut + rewriter.getStats().duplicateStreams) << sample;
+    }
+    std::filesystem::remove(output);
+}
+
+TEST(DocumentRewriterTest, SectionKeysAreNotRoots) {
+    wxInitializer initializer;
+    ASSERT_TRUE(initializer.IsOk());
+    // An indirect /Length in the trailer belongs to the old xref section, not to the document
+    std::string path = writeTestPdf("wavepdf_rewrite_section_keys.pdf", {
+        {1, "<< /Type /Catalog >>"},
+        {2, "12"},
+    }, "/Root 1 0 R /Length 2 0 R");
+    PdfReader reader(path);
+    ASSERT_TRUE(reader.process());
+    DocumentRewriter rewriter(reader);
+    std::ostringstream out;
+    ASSERT_TRUE(rewriter.write(out)) << rewriter.getErrorMessage();
+    EXPECT_EQ(rewriter.getStats().objectsIn, 2u);
+    EXPECT_EQ(rewriter.getStats().unreachable, 1u);
+    EXPECT_EQ(rewriter.getStats().objectsOut, 1u);
+    std::filesystem::remove(path);
+}
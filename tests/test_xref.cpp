@@ -0,0 +1,206 @@
+#include "../src/utility/xref/XRefEntryDecoder.h"
+#include "../src/utility/xref/XRefIndex.h"
+#include "../src/utility/xref/XRefRecovery.h"
+#include "../src/utility/xref/TailLocator.h"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+TEST(XRefEntryDecoderTest, DecodesFixedRecords) {
+    // All three allowed EOL forms
+    std::string records =
+        "0000000000 65535 f\r\n"
+        "0000017930 00000 n \n"
+        "9876543210 00012 n \r";
+
+    std::vector<xrefEntry> entries;
+    ASSERT_EQ(XRefEntryDecoder::decode(records, 7, 3, entries), size_t(3));
+    ASSERT_EQ(entries.size(), size_t(3));
+    EXPECT_EQ(entries[0], (xrefEntry{0, 65535, 7, 'f'}));
+    EXPECT_EQ(entries[1], (xrefEntry{17930, 0, 8, 'n'}));
+    EXPECT_EQ(entries[2], (xrefEntry{9876543210ULL, 12, 9, 'n'}));
+}
+
+TEST(XRefEntryDecoderTest, StopsAtMalformedRecord) {
+    // Second record only has a single byte EOL, third has a non digit
+    std::string records =
+        "0000000009 00000 n \n"
+        "0000000062 00000 n\n"
+        "00000001x3 00000 n \n";
+
+    std::vector<xrefEntry> entries;
+    EXPECT_EQ(XRefEntryDecoder::decode(records, 0, 3, entries), size_t(1));
+    EXPECT_EQ(entries.size(), size_t(1));
+
+    entries.clear();
+    EXPECT_EQ(XRefEntryDecoder::decode(std::string_view(records).substr(39), 0, 1, entries), size_t(0));
+
+    // Never reads past the data
+    entries.clear();
+    EXPECT_EQ(XRefEntryDecoder::decode(std::string_view(records).substr(0, 25), 0, 3, entries), size_t(1));
+}
+
+TEST(XRefIndexTest, DenseAndSparseLookups) {
+    // Newest revision first, as added while following /Prev
+    xrefSubsection newer{0, 2, {{0, 65535, 0, 'f'}, {500, 1, 1, 'n'}}, true};
+    xrefSubsection huge{4000000000ULL, 1, {{900, 0, 4000000000ULL, 'n'}}, true};
+    xrefSubsection older{0, 3, {{0, 65535, 0, 'f'}, {100, 0, 1, 'n'}, {200, 0, 2, 'n'}}, true};
+    xrefEntry compressed{7, 0, 3, 'c'};
+    compressed.streamIndex = 70000;
+    xrefSubsection compressedSection{3, 1, {compressed}, true};
+
+    XRefIndex index;
+    index.addRevision({newer, huge});
+    index.addRevision({older, compressedSection});
+    ASSERT_EQ(index.getRevisionCount(), size_t(2));
+    EXPECT_EQ(index.getEntryCount(), size_t(7));
+    EXPECT_EQ(index.getObjectCount(), size_t(4000000001ULL));
+
+    EXPECT_EQ(index.lookup(1), (xrefEntry{500, 1, 1, 'n'}));
+    EXPECT_EQ(index.lookup(1, 0), (xrefEntry{100, 0, 1, 'n'}));
+    EXPECT_EQ(index.lookup(2), (xrefEntry{200, 0, 2, 'n'}));
+    EXPECT_EQ(index.lookup(3), compressed);
+    EXPECT_EQ(index.lookup(4000000000ULL)->entryOne, size_t(900));
+    EXPECT_EQ(index.lookup(4000000000ULL, 0), std::nullopt);
+    EXPECT_EQ(index.lookup(5), std::nullopt);
+}
+
+TEST(XRefIndexTest, OverlapDetection) {
+    // Adjacent ranges are fine, ranges sharing an object number are not
+    std::vector<xrefSubsection> adjacent = {{5, 3, {}, true}, {0, 5, {}, true}, {8, 0, {}, true}};
+    EXPECT_FALSE(XRefIndex::hasOverlap(adjacent));
+
+    std::vector<xrefSubsection> overlapping = {{10, 5, {}, true}, {0, 5, {}, true}, {14, 2, {}, true}};
+    EXPECT_TRUE(XRefIndex::hasOverlap(overlapping));
+    EXPECT_FALSE(XRefIndex::hasOverlap(overlapping, 2));
+}
+
+TEST(XRefIndexTest, ObjectNumberLimit) {
+    // ISO32000 Annex C allows numbers up to 8388607, the last object of a range counts
+    std::vector<xrefSubsection> withinLimit = {{0, 2, {}, true}, {MAX_OBJECT_NUMBER, 1, {}, true}, {200000000, 0, {}, true}};
+    EXPECT_FALSE(XRefIndex::exceedsObjectLimit(withinLimit));
+    std::vector<xrefSubsection> beyondLimit = {{0, 2, {}, true}, {MAX_OBJECT_NUMBER - 1, 3, {}, true}, {200000000, 1, {}, true}};
+    EXPECT_TRUE(XRefIndex::exceedsObjectLimit(beyondLimit));
+    EXPECT_TRUE(XRefIndex::exceedsObjectLimit(beyondLimit, 2));
+    EXPECT_FALSE(XRefIndex::exceedsObjectLimit(beyondLimit, 3));
+
+    // Numbers far apart grow the number list with the entries
+    XRefIndex index;
+    index.addRevision({{0, 2, {{0, 65535, 0, 'f'}, {10, 0, 1, 'n'}}, true}, {8000000, 1, {{20, 0, 8000000, 'n'}}, true}});
+    EXPECT_EQ(index.getObjectNumbers(), (std::vector<size_t>{0, 1, 8000000}));
+    EXPECT_LT(index.getDenseCount(), size_t(8000000));
+}
+
+TEST(XRefRecoveryTest, FindsObjectHeaders) {
+    std::string data =
+        "%PDF-1.7\n"
+        "1 0 obj\n<< /Type /Catalog >>\nendobj\n"
+        "2 0 obj<</Type/ObjStm/N 0>>stream\nendstream endobj\r\n"
+        // Not headers: a name, text inside a string & a number glued to a keyword
+        "3 0 R /obj (4 obj) x5 0 obj 12 3obj\n"
+        "7 1 obj [] endobj\n"
+        "1 0 obj\n<< /Type /XRef >>\nendobj\n"
+        "trailer\n<< /Root 1 0 R >>\n%%EOF";
+
+    RecoveryScan scan;
+    XRefRecovery::scan(data, 0, data.size(), 100, scan);
+    ASSERT_EQ(scan.objects.size(), size_t(4));
+    EXPECT_EQ(scan.objects[0].number, size_t(1));
+    EXPECT_EQ(scan.objects[0].offset, size_t(100 + 9));
+    EXPECT_EQ(scan.objects[1].number, size_t(2));
+    EXPECT_EQ(scan.objects[2].number, size_t(7));
+    EXPECT_EQ(scan.objects[2].generation, uint16_t(1));
+    EXPECT_EQ(scan.objects[3].number, size_t(1));
+    ASSERT_EQ(scan.objectStreams.size(), size_t(1));
+    EXPECT_EQ(XRefRecovery::objectAt(scan, scan.objectStreams[0])->number, size_t(2));
+    ASSERT_EQ(scan.xrefStreams.size(), size_t(1));
+    EXPECT_EQ(XRefRecovery::objectAt(scan, scan.xrefStreams[0]), &scan.objects[3]);
+    ASSERT_EQ(scan.trailers.size(), size_t(1));
+    EXPECT_EQ(scan.trailers[0], 100 + data.find("trailer"));
+
+    // Newest definition wins, offsets are relative to the header
+    std::vector<xrefSubsection> sections = XRefRecovery::buildSections(scan, 100);
+    ASSERT_EQ(sections.size(), size_t(1));
+    ASSERT_EQ(sections[0].objects.size(), size_t(3));
+    XRefIndex index;
+    index.addRevision(sections);
+    EXPECT_EQ(index.lookup(1)->entryOne, scan.objects[3].offset - 100);
+    EXPECT_EQ(index.lookup(7)->generation, uint16_t(1));
+}
+
+TEST(XRefRecoveryTest, ChunksMatchSingleScan) {
+    std::string data;
+    for (size_t i = 1; i <= 500; i++) {
+        data += std::to_string(i) + " 0 obj\n<< /Index " + std::to_string(i) + " >>\nendobj\n";
+    }
+    data += "trailer\n<< /Size 501 >>\n";
+    RecoveryScan whole;
+    XRefRecovery::scan(data, 0, data.size(), 0, whole);
+    ASSERT_EQ(whole.objects.size(), size_t(500));
+
+    // Chunk borders at every byte of a header must not lose or duplicate it
+    for (size_t border = 1; border < 40; border++) {
+        RecoveryScan chunked;
+        size_t chunk = data.size() / 7 + border;
+        for (size_t begin = 0; begin < data.size(); begin += chunk) {
+            XRefRecovery::scan(data, begin, begin + chunk, 0, chunked);
+        }
+        ASSERT_EQ(chunked.objects.size(), whole.objects.size()) << "border " << border;
+        for (size_t i = 0; i < whole.objects.size(); i++) {
+            EXPECT_EQ(chunked.objects[i].offset, whole.objects[i].offset);
+        }
+        EXPECT_EQ(chunked.trailers, whole.trailers);
+    }
+}
+
+TEST(TailLocatorTest, LocatesTailMarkers) {
+    struct Tail {
+        std::string text;
+        size_t xrefOffset;
+    };
+    // LF, CRLF & CR endings, extra whitespace, trailing garbage, an older startxref before the one in effect
+    std::vector<Tail> tails = {
+        {"trailer\n<< /Size 3 >>\nstartxref\n123\n%%EOF\n", 123},
+        {"trailer\r\n<< /Size 3 >>\r\nstartxref\r\n4567\r\n%%EOF\r\n", 4567},
+        {"trailer\r<< /Size 3 >>\rstartxref\r89\r%%EOF", 89},
+        {"trailer <</Size 3>> startxref \t 10\n%%EOF\n\x80\xff garbage after the end\n", 10},
+        {"startxref\n1\n%%EOF\ntrailer\n<< /Prev 1 >>\nstartxref\n2\n%%EOF\n", 2}
+    };
+    for (const Tail& tail: tails) {
+        std::unique_ptr<Buffer> buffer = Buffer::fromData("%PDF-1.7\n" + tail.text);
+        TailLocation location = TailLocator().locate(*buffer);
+        std::string_view data = buffer->viewSpan(0, buffer->getSize());
+        EXPECT_EQ(location.eof, data.rfind("%%EOF")) << tail.text;
+        EXPECT_EQ(location.startXRef, data.rfind("startxref")) << tail.text;
+        EXPECT_EQ(location.xrefOffset, tail.xrefOffset) << tail.text;
+        EXPECT_EQ(location.trailer, data.rfind("trailer")) << tail.text;
+    }
+
+    // Cross-reference stream files have no trailer keyword, startxref needs a number
+    std::unique_ptr<Buffer> buffer = Buffer::fromData("%PDF-1.5\nstartxref\n%%EOF");
+    TailLocation location = TailLocator().locate(*buffer);
+    EXPECT_EQ(location.startXRef, size_t(9));
+    EXPECT_EQ(location.xrefOffset, std::string::npos);
+    EXPECT_EQ(location.trailer, std::string::npos);
+
+    // Tiny files & keywords that are only part of a token
+    buffer = Buffer::fromData("%%EOF");
+    EXPECT_EQ(TailLocator().findEOF(*buffer), size_t(0));
+    EXPECT_EQ(TailLocator::findLast("xstartxref 1", "startxref", true), std::string::npos);
+    EXPECT_EQ(TailLocator::findLast("startxref1", "startxref", true), std::string::npos);
+    EXPECT_EQ(TailLocator::findLast("startxref startxref", "startxref", true), size_t(10));
+    EXPECT_EQ(TailLocator::findLast("a", "startxref", false), std::string::npos);
+
+    // %%EOF before the window is not found
+    buffer = Buffer::fromData("%%EOF" + std::string(2000, ' '));
+    EXPECT_EQ(TailLocator().findEOF(*buffer), std::string::npos);
+    EXPECT_EQ(TailLocator(4096).findEOF(*buffer), size_t(0));
+}
+
+TEST(TailLocatorTest, FindsHeader) {
+    EXPECT_EQ(TailLocator::findHeader(*Buffer::fromData("%PDF-1.7\n")), size_t(0));
+    EXPECT_EQ(TailLocator::findHeader(*Buffer::fromData(std::string(1023, 'x') + "%PDF-1.7")), size_t(1023));
+    EXPECT_EQ(TailLocator::findHeader(*Buffer::fromData(std::string(1024, 'x') + "%PDF-1.7")), std::string::npos);
+    EXPECT_EQ(TailLocator::findHeader(*Buffer::fromData("%PD")), std::string::npos);
+}